@@ -76,7 +76,10 @@ VRFreeGLUTWindowToolkit::destroyWindow(int windowID) {
 
 void 
 VRFreeGLUTWindowToolkit::makeWindowCurrent(int windowID) {
-	glutSetWindow(_windows[windowID]);
+	// GLUT has no way to let go of the current window
+	if ((windowID >= 0) && ((unsigned int)windowID < _windows.size())) {
+		glutSetWindow(_windows[windowID]);
+	}
 }
 
 void 
@@ -59,6 +59,10 @@ namespace MinVR {
 
   PLUGIN_API void VRG3DWindowToolkit::makeWindowCurrent(int windowID)
   {
+    if ((windowID < 0) || (windowID >= (int)_windows.size()))
+    {
+      return;
+    }
     _windows[windowID]->makeCurrent();
     _frameCounter++;
     if (_frameCounter == 1)
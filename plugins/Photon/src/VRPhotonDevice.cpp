@@ -75,31 +75,39 @@ VRPhotonDevice::VRPhotonDevice(std::string appName, std::string appID, std::stri
 }
 
 void VRPhotonDevice::update_thread() {
+	std::string serialized;
 	while (isRunning) {
-		mtx.lock();
 		if (m_photon) {
 			m_photon->update();
-			if (!sendQueue.empty()) {
+			if (m_sendQueue.size() > 0) {
+				// Whatever has piled up since the last update goes out together.
+				VRDataQueue sendQueue;
+				while (m_sendQueue.pop(&serialized)) {
+					sendQueue.addSerializedQueue(serialized);
+				}
 				m_photon->sendData(sendQueue.serialize());
-				sendQueue.clear();
 			}
 			m_photon->update();
+
+			for (int f = 0; f < m_photon->getPendingEvents().size(); f++) {
+				pushSample(m_photon->getPendingEvents()[f]);
+			}
+			m_photon->getPendingEvents().clear();
 		}
-		mtx.unlock();
 		Sleep(m_updateSpeed);
 	}
 }
 
 void VRPhotonDevice::addEvents(VRDataQueue* queue) {
-	mtx.lock();
 	if(m_photon && !queue->empty()){
+		VRDataQueue sendQueue;
 		for (VRDataQueue::iterator iter = queue->begin(); iter != queue->end(); iter++) {
 				VRDataIndex tmpidx = iter->second.getData();
 				VRDataQueueItem item = VRDataQueueItem(tmpidx.serialize());
 				sendQueue.push(iter->first.first, item);
 		}
+		m_sendQueue.push(sendQueue.serialize());
 	}
-	mtx.unlock();
 	queue->clear();
 }
 
@@ -132,29 +140,29 @@ void VRPhotonDevice::appendNewInputEventsSinceLastCall(VRDataQueue *inputEvents)
 		return;
 	
 	if (!m_receiveOnly) {
-		mtx.lock();
-			int event_count = 0;
-			for (VRDataQueue::iterator iter = inputEvents->begin(); iter != inputEvents->end(); iter++) {
-				
-				//check if event is blacklisted
-				if (m_whitelist.empty() || m_whitelist.find(iter->second.getData().getName()) != m_whitelist.end())
-				{
-					VRDataIndex tmpidx = iter->second.getData();
-					//change name if required
-					if (m_replacements.find(tmpidx.getName()) != m_replacements.end()) {
-						tmpidx.setName(m_replacements[tmpidx.getName()]);
-					}
-					VRDataQueueItem item = VRDataQueueItem(tmpidx.serialize());
-					sendQueue.push(iter->first.first, item);
-					event_count++;
+		VRDataQueue sendQueue;
+		int event_count = 0;
+		for (VRDataQueue::iterator iter = inputEvents->begin(); iter != inputEvents->end(); iter++) {
+			
+			//check if event is blacklisted
+			if (m_whitelist.empty() || m_whitelist.find(iter->second.getData().getName()) != m_whitelist.end())
+			{
+				VRDataIndex tmpidx = iter->second.getData();
+				//change name if required
+				if (m_replacements.find(tmpidx.getName()) != m_replacements.end()) {
+					tmpidx.setName(m_replacements[tmpidx.getName()]);
 				}
+				VRDataQueueItem item = VRDataQueueItem(tmpidx.serialize());
+				sendQueue.push(iter->first.first, item);
+				event_count++;
 			}
-			if (event_count > 0) {
-				if (m_lastsend >= INT_MAX)
-					m_lastsend = 0;
-				sendQueue.push(VRAnalogEvent::createValidDataIndex("PhotonLoopFinished", m_lastsend++));
-			}
-		mtx.unlock();
+		}
+		if (event_count > 0) {
+			if (m_lastsend >= INT_MAX)
+				m_lastsend = 0;
+			sendQueue.push(VRAnalogEvent::createValidDataIndex("PhotonLoopFinished", m_lastsend++));
+			m_sendQueue.push(sendQueue.serialize());
+		}
 		
 #ifdef WRITEEVENTSTOFILE
 		std::ofstream outfile;
@@ -164,43 +172,9 @@ void VRPhotonDevice::appendNewInputEventsSinceLastCall(VRDataQueue *inputEvents)
 #endif
 		
 	}
-	mtx.lock();
-		for (int f = 0; f < m_photon->getPendingEvents().size(); f++) {
-			if (m_photon) {
-				inputEvents->addSerializedQueue(m_photon->getPendingEvents()[f]);
-			}
-
-#ifdef COUNTPACKAGES
-			VRDataQueue tmpQueue;
-			tmpQueue.addSerializedQueue(m_photon->getPendingEvents()[f]);
-			for (VRDataQueue::iterator iter = tmpQueue.begin(); iter != tmpQueue.end(); iter++) {
-				if (iter->second.getData().getName() == "PhotonLoopFinished" && iter->second.getData().exists("AnalogValue")) {
-					int id = iter->second.getData().getValue("AnalogValue");
-					if (m_lastreceived == -1) {
-						m_lastreceived = id;
-						std::cerr << "START " << m_lastreceived << std::endl;
-					}
-					if (id == m_lastreceived) {
-						m_lastreceived++;
-						std::cerr << "In order " << id << std::endl;
-					}
-					else {
-						std::cerr << "!!!!!!!!!!!!!!! OUT OF ORDER !!!!!!!!!!!!!!!!" << std::endl;
-					}
-				}
-			}
-			tmpQueue.clear();
-#endif
-#ifdef WRITEEVENTSTOFILE
-			std::ofstream outfile;
-			outfile.open("receive.txt", std::ios_base::app); // append instead of overwrite
-			outfile << m_photon->getPendingEvents()[f] << std::endl;
-			outfile.close();
-#endif
-		}
 
-		m_photon->getPendingEvents().clear();
-	mtx.unlock();
+	// What the update thread has received since the last frame.
+	appendSamples(inputEvents);
 
 #ifdef WRITEEVENTSTOFILE
 	if (m_photon->isConnected() && m_receiveOnly) {
@@ -212,6 +186,38 @@ void VRPhotonDevice::appendNewInputEventsSinceLastCall(VRDataQueue *inputEvents)
 #endif
 }
 
+void VRPhotonDevice::appendSampleEvents(const std::string &received, VRDataQueue *inputEvents) {
+	inputEvents->addSerializedQueue(received);
+
+#ifdef COUNTPACKAGES
+	VRDataQueue tmpQueue;
+	tmpQueue.addSerializedQueue(received);
+	for (VRDataQueue::iterator iter = tmpQueue.begin(); iter != tmpQueue.end(); iter++) {
+		if (iter->second.getData().getName() == "PhotonLoopFinished" && iter->second.getData().exists("AnalogValue")) {
+			int id = iter->second.getData().getValue("AnalogValue");
+			if (m_lastreceived == -1) {
+				m_lastreceived = id;
+				std::cerr << "START " << m_lastreceived << std::endl;
+			}
+			if (id == m_lastreceived) {
+				m_lastreceived++;
+				std::cerr << "In order " << id << std::endl;
+			}
+			else {
+				std::cerr << "!!!!!!!!!!!!!!! OUT OF ORDER !!!!!!!!!!!!!!!!" << std::endl;
+			}
+		}
+	}
+	tmpQueue.clear();
+#endif
+#ifdef WRITEEVENTSTOFILE
+	std::ofstream outfile;
+	outfile.open("receive.txt", std::ios_base::app); // append instead of overwrite
+	outfile << received << std::endl;
+	outfile.close();
+#endif
+}
+
 
 VRInputDevice*
 VRPhotonDevice::create(VRMainInterface *vrMain, VRDataIndex *config, const std::string &nameSpace) {
@@ -63,7 +63,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <unordered_map> 
 
 #include <config/VRDataIndex.h>
-#include <input/VRInputDevice.h>
+#include <input/VRBufferedInputDevice.h>
+#include <input/VRSampleRing.h>
 #include <main/VRFactory.h>
 #include <plugin/VRPlugin.h>
 
@@ -71,13 +72,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "StdIO_UIListener.h"
 
 #include <thread>
-#include <mutex>
 
 namespace MinVR {
 
 /**
+   The Photon connection is serviced on a thread of its own.  It hands
+   what it receives to the main thread, and takes what is to be sent from
+   it, through lock-free queues, so neither thread waits for the other.
 */
-class VRPhotonDevice : public VRInputDevice
+class VRPhotonDevice : public VRBufferedInputDevice<std::string>
 {
 
 public:
@@ -89,13 +92,17 @@ public:
 	PLUGIN_API static VRInputDevice* create(VRMainInterface *vrMain, VRDataIndex *config, const std::string &nameSpace);
 
 	PLUGIN_API void update_thread();
+	/// Sends the events.  Call this from the same thread as VRMain.
 	PLUGIN_API void addEvents(VRDataQueue* queue);
 
 	PLUGIN_API std::string getUsername();
 	PLUGIN_API int getServerTime();
 
+protected:
+	/// Adds a serialized queue received from the server.
+	void appendSampleEvents(const std::string &received, VRDataQueue *inputEvents);
+
 private:
-    std::vector<VRDataIndex>   _pendingEvents;
 	StdIO_UIListener * m_output_listener;
 
 	bool m_receiveOnly;
@@ -104,12 +111,12 @@ private:
 	int m_lastsend;
 	int m_lastreceived;
 
-	std::mutex mtx;
 	PhotonLib * m_photon;
 	std::thread * th1;
 	bool isRunning;
 	float m_updateSpeed;
-	VRDataQueue sendQueue;
+	/// Serialized queues waiting for the update thread to send them.
+	VRSampleRing<std::string> m_sendQueue;
 };
 
 
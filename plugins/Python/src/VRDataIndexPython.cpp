@@ -25,7 +25,8 @@ extern "C" {
 		else if (type == VRCORETYPE_INTARRAY) {
 			delete[] static_cast<int*>(value);
 		}
-		else if (type == VRCORETYPE_FLOATARRAY) {
+		else if ((type == VRCORETYPE_FLOATARRAY) || (type == VRCORETYPE_MATRIX4) ||
+		         (type == VRCORETYPE_VEC3)) {
 			delete[] static_cast<float*>(value);
 		}
 	}
@@ -137,7 +137,8 @@ class VRDataIndex(object):
 			self.toBeDeleted.append([datumType, a])
 			print arrSize
 			return list(a[0:arrSize.value])
-		if datumType == 5:
+		# Float arrays, and matrices (8) and vectors (9), which come as arrays.
+		if datumType == 5 or datumType == 8 or datumType == 9:
 			arrSize = ctypes.c_int()
 			a = self.getFloatArrayValue(self.index, valName, nameSpace, ctypes.byref(arrSize))
 			self.toBeDeleted.append([datumType, a])
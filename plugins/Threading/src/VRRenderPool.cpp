@@ -0,0 +1,164 @@
+/*
+ * Copyright Regents of the University of Minnesota, 2016.  This software is released under the following license: http://opensource.org/licenses/
+ * Source code originally developed at the University of Minnesota Interactive Visualization Lab (http://ivlab.cs.umn.edu).
+ *
+ * Code author(s):
+ * 		Dan Orban (dtorban)
+ */
+
+#include <VRRenderPool.h>
+#include "main/VRError.h"
+#include <sstream>
+
+#if defined(WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace MinVR {
+
+VRRenderPool::VRRenderPool(const std::vector<VRDisplayNode*> &nodes, int numThreads, bool stealing,
+		const std::vector<int> &cores, double spinTime) :
+		nodes(nodes), stealing(stealing), cores(cores), pool(numThreads, spinTime, false),
+		action(THREADACTION_None), renderState(NULL), renderHandler(NULL), numSteals(0) {
+
+	numThreads = pool.getNumThreads();
+
+	// Nodes are dealt out to the workers in turn to start with
+	for (int f = 0; f < (int)nodes.size(); f++) {
+		owners.push_back(f % numThreads);
+	}
+
+	for (int f = 0; f < numThreads; f++) {
+		workers.push_back(new Worker());
+	}
+}
+
+VRRenderPool::~VRRenderPool() {
+	// The pool's threads are waiting for the next run, and don't look at the workers
+	for (int f = 0; f < (int)workers.size(); f++) {
+		delete workers[f];
+	}
+}
+
+void VRRenderPool::run(VRRenderThreadAction action, VRDataIndex* renderState, VRRenderHandler* renderHandler) {
+	if (nodes.empty()) {
+		return;
+	}
+
+	this->action = action;
+	this->renderState = renderState;
+	this->renderHandler = renderHandler;
+
+	// Nodes only change hands before they are rendered.  The other actions have to run on
+	// the thread that rendered them.
+	Task task;
+	task.stealable = stealing && (action == THREADACTION_Init || action == THREADACTION_Render);
+
+	for (int f = 0; f < (int)nodes.size(); f++) {
+		Worker* worker = workers[owners[f]];
+		task.node = f;
+		UniqueMutexLock lock(worker->mutex);
+		worker->tasks.push_back(task);
+	}
+
+	pool.run(getNumThreads(), [this](int self) { work(self); });
+}
+
+void VRRenderPool::work(int self) {
+	// Job i always runs on the same thread of the pool, so each is pinned the first time
+	if (!workers[self]->pinned) {
+		pin(self);
+		workers[self]->pinned = true;
+	}
+
+	int node;
+	while (takeTask(self, node)) {
+		runTask(node);
+	}
+}
+
+void VRRenderPool::pin(int self) {
+	if (cores.empty()) {
+		return;
+	}
+
+	int core = cores[self % cores.size()];
+	bool pinned = false;
+#if defined(WIN32)
+	pinned = (core >= 0) && (core < 8 * (int)sizeof(DWORD_PTR)) &&
+			(SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) != 0);
+#elif defined(__linux__)
+	if ((core >= 0) && (core < CPU_SETSIZE)) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		pinned = (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0);
+	}
+#endif
+
+	if (!pinned) {
+		std::stringstream msg;
+		msg << "Could not pin render thread " << self << " to core " << core << ".";
+		VRWARNING(msg.str(), "Check the ThreadPoolCores of the VRThreadGroupNode.  Pinning is only supported on Linux and Windows.");
+	}
+}
+
+bool VRRenderPool::takeTask(int self, int& node) {
+	// Our own nodes first, in order
+	Worker* worker = workers[self];
+	{
+		UniqueMutexLock lock(worker->mutex);
+		if (!worker->tasks.empty()) {
+			node = worker->tasks.front().node;
+			worker->tasks.pop_front();
+			return true;
+		}
+	}
+
+	// Then the last node of another worker, which it would have got to last.  A worker's only
+	// node is left alone, or nodes would keep changing hands between evenly loaded workers.
+	for (int f = 1; f < (int)workers.size(); f++) {
+		Worker* victim = workers[(self + f) % workers.size()];
+		UniqueMutexLock lock(victim->mutex);
+		if ((victim->tasks.size() > 1) && victim->tasks.back().stealable) {
+			node = victim->tasks.back().node;
+			victim->tasks.pop_back();
+			owners[node] = self;
+			numSteals.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void VRRenderPool::runTask(int node) {
+	// As in VRRenderThread, each node gets its own render state to edit
+	VRDataIndex index;
+	VRDisplayNode* displayNode = nodes[node];
+
+	if (action == THREADACTION_Init) {
+		index.addData("/InitRender", 1);
+		displayNode->render(&index, renderHandler);
+	}
+	else if (action == THREADACTION_Render) {
+		index.addData("/InitRender", 0);
+		displayNode->render(&index, renderHandler);
+	}
+	else if (action == THREADACTION_WaitForRenderToComplete) {
+		displayNode->waitForRenderToComplete(&index);
+	}
+	else if (action == THREADACTION_DisplayFinishedRendering) {
+		// The node may be rendered by another thread next frame, so windows let go of
+		// their contexts when they are done.
+		if (stealing) {
+			index.addData("/ReleaseContext", 1);
+		}
+		displayNode->displayFinishedRendering(&index);
+	}
+}
+
+} /* namespace MinVR */
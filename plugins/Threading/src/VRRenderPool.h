@@ -0,0 +1,86 @@
+/*
+ * Copyright Regents of the University of Minnesota, 2016.  This software is released under the following license: http://opensource.org/licenses/
+ * Source code originally developed at the University of Minnesota Interactive Visualization Lab (http://ivlab.cs.umn.edu).
+ *
+ * Code author(s):
+ * 		Dan Orban (dtorban)
+ */
+
+#ifndef VRRENDERPOOL_H_
+#define VRRENDERPOOL_H_
+
+#include "VRThreadGroup.h"
+#include "main/VRThreadPool.h"
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace MinVR {
+
+/**
+ * VRRenderPool renders a list of display nodes with a fixed set of worker threads, which may be
+ * fewer than the nodes.  Each node belongs to one worker, which runs all three of its render actions,
+ * so anything bound to a thread (like a graphics context) stays where it is within a frame.  A worker
+ * that runs out of nodes to render may take one that hasn't started yet from another worker, and
+ * then that node belongs to it from then on, which evens out the load over a few frames.
+ *
+ * The workers are those of a VRThreadPool that the caller doesn't work in, so waiting workers, and
+ * the thread waiting on them, spin for a short time before they go to sleep, since the time between
+ * the render actions is often shorter than it takes to wake a thread.
+ */
+class VRRenderPool {
+public:
+	/// Starts numThreads workers for the nodes.  If stealing is true, nodes may move between workers
+	/// at the start of a frame.  If cores isn't empty, worker i is pinned to cores[i % cores.size()].
+	/// spinTime is in seconds.
+	VRRenderPool(const std::vector<VRDisplayNode*> &nodes, int numThreads, bool stealing,
+			const std::vector<int> &cores, double spinTime);
+	virtual ~VRRenderPool();
+
+	/// Runs the action on all the nodes, and returns when they are done.
+	void run(VRRenderThreadAction action, VRDataIndex* renderState, VRRenderHandler* renderHandler);
+
+	int getNumThreads() const { return pool.getNumThreads(); }
+
+	/// The worker that renders a node, as of the last action run.
+	int getOwner(int node) const { return owners[node]; }
+
+	/// The number of times a worker has taken a node from another.
+	long getNumSteals() const { return numSteals.load(std::memory_order_relaxed); }
+
+private:
+	struct Task {
+		int node;
+		bool stealable;
+	};
+
+	struct Worker {
+		Worker() : pinned(false) {}
+		Mutex mutex;
+		std::deque<Task> tasks;
+		bool pinned;
+	};
+
+	void work(int self);
+	void pin(int self);
+	bool takeTask(int self, int& node);
+	void runTask(int node);
+
+	std::vector<VRDisplayNode*> nodes;
+	std::vector<int> owners;
+	std::vector<Worker*> workers;
+	bool stealing;
+	std::vector<int> cores;
+	VRThreadPool pool;
+
+	// Set by run() before the tasks are queued, and read by the worker that takes each task.
+	VRRenderThreadAction action;
+	VRDataIndex* renderState;
+	VRRenderHandler* renderHandler;
+
+	std::atomic<long> numSteals;
+};
+
+} /* namespace MinVR */
+
+#endif /* VRRENDERPOOL_H_ */
@@ -11,12 +11,20 @@
 
 namespace MinVR {
 
-VRThreadGroupNode::VRThreadGroupNode(const std::string& name, bool asyncEnabled) : VRDisplayNode(name), threadGroup(NULL), async(false), asyncEnabled(asyncEnabled) {
+VRThreadGroupNode::VRThreadGroupNode(const std::string& name, bool asyncEnabled) : VRDisplayNode(name), threadGroup(NULL), renderPool(NULL),
+		poolEnabled(false), poolSize(0), poolStealing(true), poolSpinTime(0.0), async(false), asyncEnabled(asyncEnabled) {
 }
 
 VRThreadGroupNode::~VRThreadGroupNode() {
+	// Stop the pool threads
+	if (renderPool) {
+		delete renderPool;
+	}
+
 	// Terminate render thread loop
-	threadGroup->startThreadAction(THREADACTION_Terminate, NULL, NULL);
+	if (threadGroup) {
+		threadGroup->startThreadAction(THREADACTION_Terminate, NULL, NULL);
+	}
 
 	// Delete render threads
 	for (int f = 0; f < renderThreads.size(); f++) {
@@ -29,12 +37,40 @@ VRThreadGroupNode::~VRThreadGroupNode() {
 	}
 }
 
+void VRThreadGroupNode::usePool(int numThreads, bool stealing, const std::vector<int> &cores, double spinTime) {
+	poolEnabled = true;
+	poolSize = numThreads;
+	poolStealing = stealing;
+	poolCores = cores;
+	poolSpinTime = spinTime;
+}
+
 void VRThreadGroupNode::render(VRDataIndex* renderState,
 		VRRenderHandler* renderHandler) {
 
 	async = asyncEnabled;
 
-	if (async) {
+	if (async && poolEnabled) {
+		VRRenderThreadAction action = THREADACTION_Render;
+
+		// If the pool has not been created, start its threads
+		if (!renderPool) {
+			int numChildren = (int)getChildren().size();
+			int numThreads = poolSize;
+			if (numThreads <= 0) {
+				numThreads = (int)Thread::hardware_concurrency();
+				if ((numThreads <= 0) || (numThreads > numChildren)) {
+					numThreads = numChildren;
+				}
+			}
+			renderPool = new VRRenderPool(getChildren(), numThreads, poolStealing, poolCores, poolSpinTime);
+
+			action = THREADACTION_Init;
+		}
+
+		renderPool->run(action, renderState, renderHandler);
+	}
+	else if (async) {
 		VRRenderThreadAction action = THREADACTION_Render;
 
 		// If the threadGroup has not been created, create the render threads
@@ -61,7 +97,10 @@ void VRThreadGroupNode::render(VRDataIndex* renderState,
 }
 
 void VRThreadGroupNode::waitForRenderToComplete(VRDataIndex* renderState) {
-	if (async) {
+	if (async && poolEnabled) {
+		renderPool->run(THREADACTION_WaitForRenderToComplete, renderState, NULL);
+	}
+	else if (async) {
 		// Let threads know we are waiting for them to finish rendering
 		threadGroup->startThreadAction(THREADACTION_WaitForRenderToComplete, renderState, NULL);
 		threadGroup->waitForComplete();
@@ -72,7 +111,10 @@ void VRThreadGroupNode::waitForRenderToComplete(VRDataIndex* renderState) {
 }
 
 void VRThreadGroupNode::displayFinishedRendering(VRDataIndex* renderState) {
-	if (async) {
+	if (async && poolEnabled) {
+		renderPool->run(THREADACTION_DisplayFinishedRendering, renderState, NULL);
+	}
+	else if (async) {
 		// Let threads know that we should display the results
 		threadGroup->startThreadAction(THREADACTION_DisplayFinishedRendering, renderState, NULL);
 		threadGroup->waitForComplete();
@@ -85,7 +127,29 @@ void VRThreadGroupNode::displayFinishedRendering(VRDataIndex* renderState) {
 VRDisplayNode* VRThreadGroupNode::create(VRMainInterface* vrMain,
 		VRDataIndex* config, const std::string& nameSpace) {
 	bool asyncEnabled = int(config->getValue("AsyncEnabled", nameSpace));
-	return new VRThreadGroupNode(nameSpace, asyncEnabled);
+	VRThreadGroupNode* node = new VRThreadGroupNode(nameSpace, asyncEnabled);
+
+	if (int(config->getValueWithDefault("ThreadPool", 0, nameSpace))) {
+		int numThreads = config->getValueWithDefault("ThreadPoolSize", 0, nameSpace);
+		bool stealing = int(config->getValueWithDefault("ThreadPoolStealing", 1, nameSpace));
+		int spinTime = config->getValueWithDefault("ThreadPoolSpinTime", 200, nameSpace);
+
+		// A list of cores, or just one
+		std::vector<int> cores;
+		if (config->exists("ThreadPoolCores", nameSpace)) {
+			if (config->getType("ThreadPoolCores", nameSpace) == VRCORETYPE_INTARRAY) {
+				VRIntArray coreList = config->getValue("ThreadPoolCores", nameSpace);
+				cores = coreList;
+			}
+			else {
+				cores.push_back(int(config->getValue("ThreadPoolCores", nameSpace)));
+			}
+		}
+
+		node->usePool(numThreads, stealing, cores, 1.0e-6 * spinTime);
+	}
+
+	return node;
 }
 
 } /* namespace MinVR */
@@ -10,6 +10,7 @@
 #define VRTHREADGROUPNODE_H_
 
 #include "VRRenderThread.h"
+#include "VRRenderPool.h"
 #include "display/VRDisplayNode.h"
 #include <vector>
 
@@ -21,10 +22,18 @@ namespace MinVR {
  * at the display node level, while enforcing that nodes are displayed at the same time.  It also allows for
  * the potential for other threads in MinVR to use the time between render and waitForRenderComplete.  It is possible
  * to nest the VRThreadGroupNodes enableing multi levels of parallel processing.
+ *
+ * With ThreadPool set, the children are instead rendered by a VRRenderPool, with ThreadPoolSize threads
+ * (by default, one per core, but no more than there are children).  Children move between the threads
+ * to balance the load, unless ThreadPoolStealing is 0.  ThreadPoolCores is a list of cores to pin the
+ * threads to, and ThreadPoolSpinTime is how many microseconds a thread waits for work before it sleeps.
  */
 class VRThreadGroupNode : public VRDisplayNode {
 public:
 	VRThreadGroupNode(const std::string &name, bool asyncEnabled);
+
+	/// Renders the children with a pool of numThreads threads (0 for the default) instead of a thread each.
+	void usePool(int numThreads, bool stealing, const std::vector<int> &cores, double spinTime);
 	virtual ~VRThreadGroupNode();
 
 	virtual std::string getType() const { return "VRThreadGroupNode"; }
@@ -39,6 +48,12 @@ public:
 private:
 	std::vector<VRRenderThread*> renderThreads;
 	VRThreadGroup* threadGroup;
+	VRRenderPool* renderPool;
+	bool poolEnabled;
+	int poolSize;
+	bool poolStealing;
+	std::vector<int> poolCores;
+	double poolSpinTime;
 	bool async;
 	bool asyncEnabled;
 };
@@ -104,6 +104,11 @@ VRVRPNTrackerDevice::VRVRPNTrackerDevice(
 	_ignoreZeroes                 = ignoreZeroes;
 	_printSensor0                 = false;
 
+	for (size_t i = 0; i < _eventNames.size(); i++) {
+		_poseSlots.push_back(VRPoseSlot::get(_eventNames[i] + "_Move"));
+	}
+	_unknownPoseSlot = VRPoseSlot::get(getEventName((int)_eventNames.size()) + "_Move");
+
 	_vrpnDevice = new vrpn_Tracker_Remote(vrpnTrackerDeviceName.c_str());
 	if (!_vrpnDevice)
 	{
@@ -183,6 +188,13 @@ void VRVRPNTrackerDevice::processEvent(const VRMatrix4 &vrpnEvent, int sensorNum
     std::string name = getEventName(sensorNum) + "_Move";
     VRDataIndex event = VRTrackerEvent::createValidDataIndex(name, eventRoom.toVRFloatArray());
     _pendingEvents.push_back(event);
+
+    // For display nodes that read the latest pose when they render.
+    if ((sensorNum >= 0) && (sensorNum < (int)_poseSlots.size())) {
+        _poseSlots[sensorNum]->publish(eventRoom);
+    } else {
+        _unknownPoseSlot->publish(eventRoom);
+    }
 }
 
 std::string VRVRPNTrackerDevice::getEventName(int trackerNumber)
@@ -60,6 +60,7 @@ based on tracker data from VRPN.
 
 #include <config/VRDataIndex.h>
 #include <input/VRInputDevice.h>
+#include <input/VRPoseSlot.h>
 #include <main/VRFactory.h>
 #include <math/VRMath.h>
 #include <plugin/VRPlugin.h>
@@ -130,6 +131,10 @@ public:
 private:
 	vrpn_Tracker_Remote      *_vrpnDevice;
 	std::vector<std::string>  _eventNames;
+	// Where each sensor's poses are published, parallel to _eventNames,
+	// and for any other sensors.
+	std::vector<VRPoseSlot*>  _poseSlots;
+	VRPoseSlot               *_unknownPoseSlot;
 	float                    _trackerUnitsToRoomUnitsScale;
 	VRMatrix4                 _deviceToRoom;
 	std::vector<VRMatrix4>    _propToTracker;
@@ -14,7 +14,7 @@ Author(s) of Significant Updates/Modifications to the File:
 */
 
 #include "api/VRGraphicsState.h"
-#include <config/VRDataIndex.h>
+#include <config/VRDataHandle.h>
 
 namespace MinVR {
 
@@ -25,6 +25,16 @@ float VRGraphicsState::eyePos[3] = {0.0, 0.0, 0.0};
 int VRGraphicsState::defaultSharedContextID = 0;
 int VRGraphicsState::defaultWindowID = 0;
 
+// A graphics state is made fresh for each render callback, so the handles
+// for the values it reads live here instead, one set per render thread.
+// They only need to repeat the lookup when the render state has changed
+// shape since the last callback.
+static thread_local VRDataHandle projectionMatrixHandle("ProjectionMatrix");
+static thread_local VRDataHandle viewMatrixHandle("ViewMatrix");
+static thread_local VRDataHandle eyePositionHandle("EyePosition");
+static thread_local VRDataHandle sharedContextIdHandle("SharedContextId");
+static thread_local VRDataHandle windowIdHandle("WindowID");
+
 
 VRGraphicsState::VRGraphicsState(const VRDataIndex &internalIndex) : _index(internalIndex) {
 
@@ -40,25 +50,25 @@ const VRDataIndex& VRGraphicsState::index() const {
 
 
 const float * VRGraphicsState::getProjectionMatrix() const {
-    if (_index.exists("ProjectionMatrix")) {
-        const VRFloatArray* mat = (const VRFloatArray*)_index.getValue("ProjectionMatrix");
-        return &(*mat)[0];
+    const float* mat = projectionMatrixHandle.getPointerFloats(_index);
+    if (mat != NULL) {
+        return mat;
     }
     return projMat;
 }
 
 const float * VRGraphicsState::getViewMatrix() const {
-    if (_index.exists("ViewMatrix")) {
-        const VRFloatArray* mat = (const VRFloatArray*)_index.getValue("ViewMatrix");
-        return &(*mat)[0];
+    const float* mat = viewMatrixHandle.getPointerFloats(_index);
+    if (mat != NULL) {
+        return mat;
     }
     return viewMat;
 }
 
 const float * VRGraphicsState::getCameraPos() const {
-    if (_index.exists("EyePosition")) {
-        const VRFloatArray* vec = (const VRFloatArray*)_index.getValue("EyePosition");
-        return &(*vec)[0];
+    const float* vec = eyePositionHandle.getPointerFloats(_index);
+    if (vec != NULL) {
+        return vec;
     }
     return eyePos;
 }
@@ -69,8 +79,8 @@ bool VRGraphicsState::isInitialRenderCall() const {
 }
 
 int VRGraphicsState::getSharedContextId() const {
-    if (_index.exists("SharedContextId")) {
-        return _index.getValue("SharedContextId");
+    if (sharedContextIdHandle.exists(_index)) {
+        return sharedContextIdHandle.getValueInt(_index);
     }
     else {
         return defaultSharedContextID;
@@ -78,8 +88,8 @@ int VRGraphicsState::getSharedContextId() const {
 }
 
 int VRGraphicsState::getWindowId() const {
-    if (_index.exists("WindowID")) {
-        return _index.getValue("WindowID");
+    if (windowIdHandle.exists(_index)) {
+        return windowIdHandle.getValueInt(_index);
     }
     else {
         return defaultWindowID;
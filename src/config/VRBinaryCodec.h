@@ -0,0 +1,150 @@
+// -*-c++-*-
+#ifndef MINVR_BINARYCODEC_H
+#define MINVR_BINARYCODEC_H
+
+//
+// Copyright Brown University, 2017.  This software is released under the
+// following license: http://opensource.org/licenses/
+// Source code originally developed at the Brown University Center for
+// Computation and Visualization (ccv.brown.edu).
+//
+
+#include <string>
+#include <cstring>
+#include "stdint.h"
+
+#include <main/VRError.h>
+
+namespace MinVR {
+
+/// \brief Helpers for the binary wire format.
+///
+/// The binary encoding of VRDataIndex and VRDataQueue objects is a
+/// sequence of fixed-width little-endian integers, IEEE floats, and
+/// length-prefixed byte strings.  Every encoded object starts with a
+/// four-byte magic tag and a one-byte version number, so a receiver can
+/// tell it apart from the XML encoding (which always starts with '<')
+/// and refuse versions it does not understand.
+///
+/// These are deliberately minimal: they only exist so that the index and
+/// the queue spell the format the same way.
+class VRBinaryWriter {
+private:
+  std::string _buf;
+
+public:
+  VRBinaryWriter() {};
+
+  /// \brief Reserve some room, if you know roughly how big the result is.
+  void reserve(const size_t n) { _buf.reserve(n); };
+
+  void putByte(const unsigned char b) { _buf.push_back((char)b); };
+
+  void putUInt32(const uint32_t v) {
+    for (int i = 0; i < 4; i++) _buf.push_back((char)((v >> (8 * i)) & 0xff));
+  };
+
+  void putInt32(const int32_t v) { putUInt32((uint32_t)v); };
+
+  void putInt64(const int64_t v) {
+    uint64_t u = (uint64_t)v;
+    for (int i = 0; i < 8; i++) _buf.push_back((char)((u >> (8 * i)) & 0xff));
+  };
+
+  /// Floats go across bit-for-bit, so a round trip is exact.
+  void putFloat(const float v) {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    putUInt32(u);
+  };
+
+  /// A length-prefixed string.  May contain any bytes at all.
+  void putString(const std::string &s) {
+    putUInt32((uint32_t)s.size());
+    _buf.append(s);
+  };
+
+  /// Raw bytes, with no length prefix.  Used for the magic tags.
+  void putRaw(const char *bytes, const size_t n) { _buf.append(bytes, n); };
+
+  const std::string &str() const { return _buf; };
+};
+
+/// \brief Reads back what a VRBinaryWriter wrote.
+///
+/// Running off the end of the buffer means the data was truncated or is
+/// not what we think it is, so that throws a VRError.  The reader only
+/// looks at the bytes, so they can be anywhere: in a string, or in a
+/// file mapped into memory (see VRConfigCache).
+class VRBinaryReader {
+private:
+  const char *_data;
+  size_t _size;
+  size_t _pos;
+
+  void _need(const size_t n) {
+    if ((n > _size) || (_pos > _size - n)) {
+      VRERRORNOADV("Binary data appears truncated or corrupted.");
+    }
+  };
+
+public:
+  VRBinaryReader(const std::string &buf, const size_t start = 0) :
+    _data(buf.data()), _size(buf.size()), _pos(start) {};
+
+  VRBinaryReader(const char *data, const size_t size, const size_t start = 0) :
+    _data(data), _size(size), _pos(start) {};
+
+  bool atEnd() const { return _pos >= _size; };
+  size_t position() const { return _pos; };
+
+  unsigned char getByte() {
+    _need(1);
+    return (unsigned char)_data[_pos++];
+  };
+
+  uint32_t getUInt32() {
+    _need(4);
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+      v |= ((uint32_t)(unsigned char)_data[_pos++]) << (8 * i);
+    return v;
+  };
+
+  int32_t getInt32() { return (int32_t)getUInt32(); };
+
+  int64_t getInt64() {
+    _need(8);
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+      v |= ((uint64_t)(unsigned char)_data[_pos++]) << (8 * i);
+    return (int64_t)v;
+  };
+
+  float getFloat() {
+    uint32_t u = getUInt32();
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+  };
+
+  std::string getString() {
+    uint32_t n = getUInt32();
+    _need(n);
+    std::string out(_data + _pos, n);
+    _pos += n;
+    return out;
+  };
+
+  /// Checks for (and consumes) a magic tag.  Returns false, without
+  /// consuming anything, if the tag isn't there.
+  bool expectRaw(const char *bytes, const size_t n) {
+    if ((n > _size) || (_pos > _size - n) || (memcmp(_data + _pos, bytes, n) != 0))
+      return false;
+    _pos += n;
+    return true;
+  };
+};
+
+} // end namespace MinVR
+#endif
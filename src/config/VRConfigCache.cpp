@@ -0,0 +1,293 @@
+#include "VRConfigCache.h"
+#include "VRBinaryCodec.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace MinVR {
+
+// The cache format is a header, then the index:
+//
+//   "MVRC" version:u8 numSources:u32 { path:str size:u64 hash:u64 }*
+//   indexSize:u64 index
+//
+// using the integers and strings of VRBinaryCodec, where the index is the
+// output of VRDataIndex::serializeBinary().
+static const char cacheMagic[4] = { 'M', 'V', 'R', 'C' };
+const unsigned char VRConfigCache::version = 1;
+
+// A file mapped into memory, read-only, for as long as this is around.
+// On Windows it is only read into memory.
+class VRMappedFile {
+public:
+  VRMappedFile(const std::string &fileName) : _data(NULL), _size(0) {
+#ifdef WIN32
+    std::ifstream file(fileName.c_str(), std::ios::binary);
+    if (!file.is_open()) return;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    _contents = buffer.str();
+    _data = _contents.data();
+    _size = _contents.size();
+#else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info;
+    if ((fstat(fd, &info) == 0) && (info.st_size > 0)) {
+      void *mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        _data = (const char *)mapped;
+        _size = (size_t)info.st_size;
+      }
+    }
+    close(fd);
+#endif
+  }
+
+  ~VRMappedFile() {
+#ifndef WIN32
+    if (_data != NULL) munmap((void *)_data, _size);
+#endif
+  }
+
+  const char *data() const { return _data; }
+  size_t size() const { return _size; }
+
+private:
+  VRMappedFile(const VRMappedFile &);
+  VRMappedFile &operator=(const VRMappedFile &);
+
+  const char *_data;
+  size_t _size;
+#ifdef WIN32
+  std::string _contents;
+#endif
+};
+
+static bool isAbsolute(const std::string &fileName) {
+#ifdef WIN32
+  if ((fileName.size() > 1) && (fileName[1] == ':')) return true;
+  if (!fileName.empty() && (fileName[0] == '\\')) return true;
+#endif
+  return !fileName.empty() && (fileName[0] == '/');
+}
+
+// The cache records full path names, so it can be used from anywhere.
+static std::string fullPath(const std::string &fileName) {
+
+  if (isAbsolute(fileName)) return fileName;
+
+  char cwd[1024];
+#ifdef WIN32
+  if (_getcwd(cwd, sizeof(cwd)) == NULL) return fileName;
+#else
+  if (getcwd(cwd, sizeof(cwd)) == NULL) return fileName;
+#endif
+  return std::string(cwd) + "/" + fileName;
+}
+
+static std::string directoryOf(const std::string &fileName) {
+  size_t slash = fileName.find_last_of("/\\");
+  return (slash == std::string::npos) ? std::string("") : fileName.substr(0, slash + 1);
+}
+
+static std::string baseNameOf(const std::string &fileName) {
+  size_t slash = fileName.find_last_of("/\\");
+  return (slash == std::string::npos) ? fileName : fileName.substr(slash + 1);
+}
+
+std::string VRConfigCache::getCacheFileName(const std::string &configFile) {
+  return configFile + ".cache";
+}
+
+bool VRConfigCache::hashFile(const std::string &fileName, uint64_t *hash, uint64_t *size) {
+
+  VRMappedFile file(fileName);
+  if (file.data() == NULL) {
+    // It might just be empty.
+    std::ifstream test(fileName.c_str());
+    if (!test.is_open()) return false;
+  }
+
+  uint64_t h = 14695981039346656037ULL;
+  const unsigned char *p = (const unsigned char *)file.data();
+  for (size_t i = 0; i < file.size(); i++) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+
+  *hash = h;
+  *size = file.size();
+  return true;
+}
+
+void VRConfigCache::compile(const std::vector<std::string> &configFiles,
+                            const std::string &cacheFile) {
+
+  VRDataIndex index;
+  for (std::vector<std::string>::const_iterator it = configFiles.begin();
+       it != configFiles.end(); it++) {
+    index.processXMLFile(*it, "/");
+  }
+
+  write(index, configFiles, cacheFile);
+}
+
+void VRConfigCache::write(const VRDataIndex &index,
+                          const std::vector<std::string> &configFiles,
+                          const std::string &cacheFile) {
+
+  VRBinaryWriter out;
+  out.putRaw(cacheMagic, sizeof(cacheMagic));
+  out.putByte(version);
+
+  out.putUInt32((uint32_t)configFiles.size());
+  for (std::vector<std::string>::const_iterator it = configFiles.begin();
+       it != configFiles.end(); it++) {
+    std::string path = fullPath(VRDataIndex::dereferenceEnvVars(*it));
+    uint64_t hash, size;
+    if (!hashFile(path, &hash, &size)) {
+      VRERRORNOADV("Cannot read the configuration file " + *it + ".");
+    }
+    out.putString(path);
+    out.putInt64((int64_t)size);
+    out.putInt64((int64_t)hash);
+  }
+
+  std::string serialized = index.serializeBinary();
+  out.putInt64((int64_t)serialized.size());
+
+  // Write to a temporary file and rename it, so that nobody reading the
+  // cache at the same time sees half of it.
+  std::string tmpFile = cacheFile + ".tmp";
+  {
+    std::ofstream file(tmpFile.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      VRERRORNOADV("Cannot write the configuration cache " + cacheFile + ".");
+    }
+    file.write(out.str().data(), out.str().size());
+    file.write(serialized.data(), serialized.size());
+    if (!file.good()) {
+      VRERRORNOADV("Cannot write the configuration cache " + cacheFile + ".");
+    }
+  }
+
+#ifdef WIN32
+  std::remove(cacheFile.c_str());
+#endif
+  if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+    std::remove(tmpFile.c_str());
+    VRERRORNOADV("Cannot write the configuration cache " + cacheFile + ".");
+  }
+}
+
+// Why the cache can't be used, or "" if it can, in which case the index
+// has been added to loaded.
+static std::string readCache(const std::string &cacheFile, const VRMappedFile &file,
+                             VRDataIndex *loaded) {
+
+  VRBinaryReader in(file.data(), file.size());
+
+  if ((file.data() == NULL) || !in.expectRaw(cacheMagic, sizeof(cacheMagic))) {
+    return cacheFile + " is not a configuration cache.";
+  }
+  if (in.getByte() != VRConfigCache::version) {
+    return cacheFile + " was made by a different version of MinVR.";
+  }
+
+  uint32_t numSources = in.getUInt32();
+  for (uint32_t i = 0; i < numSources; i++) {
+    std::string path = in.getString();
+    uint64_t size = (uint64_t)in.getInt64();
+    uint64_t hash = (uint64_t)in.getInt64();
+
+    // If the files have all been moved somewhere else, they should at
+    // least still be next to the cache.
+    uint64_t newHash, newSize;
+    if (!VRConfigCache::hashFile(path, &newHash, &newSize) &&
+        !VRConfigCache::hashFile(directoryOf(cacheFile) + baseNameOf(path), &newHash, &newSize)) {
+      return "Cannot find " + path + ", which " + cacheFile + " was made from.";
+    }
+    if ((newSize != size) || (newHash != hash)) {
+      return path + " has changed since " + cacheFile + " was made.";
+    }
+  }
+
+  uint64_t indexSize = (uint64_t)in.getInt64();
+  const char *indexData = file.data() + in.position();
+  if (indexSize != file.size() - in.position()) {
+    return cacheFile + " appears truncated or corrupted.";
+  }
+
+  // The index has a version of its own, which can change when the
+  // cache's doesn't.
+  if ((indexSize <= 4) || !VRDataIndex::isBinary(std::string(indexData, 5)) ||
+      ((unsigned char)indexData[4] != VRDataIndex::binaryVersion)) {
+    return cacheFile + " holds an index made by a different version of MinVR.";
+  }
+
+  loaded->addSerializedBinary(indexData, (size_t)indexSize);
+  return "";
+}
+
+bool VRConfigCache::load(const std::string &cacheFile, VRDataIndex *index,
+                         std::string *whyNot) {
+
+  VRMappedFile file(cacheFile);
+
+  // The index is read into a copy of the caller's, so a damaged cache
+  // leaves that alone.  The copy shares the caller's data until the
+  // cache's entries are merged into it, and is decoded only once.
+  VRDataIndex loaded = *index;
+  std::string reason;
+  try {
+    reason = readCache(cacheFile, file, &loaded);
+  } catch (VRError &e) {
+    reason = cacheFile + " appears truncated or corrupted.";
+  }
+
+  if (!reason.empty()) {
+    if (whyNot != NULL) *whyNot = reason;
+    return false;
+  }
+
+  *index = loaded;
+  return true;
+}
+
+bool VRConfigCache::isCache(const std::string &fileName) {
+
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  char magic[sizeof(cacheMagic)];
+  if (!file.read(magic, sizeof(magic))) return false;
+  return std::string(magic, sizeof(magic)) == std::string(cacheMagic, sizeof(cacheMagic));
+}
+
+std::vector<std::string> VRConfigCache::getSourceFiles(const std::string &cacheFile) {
+
+  std::vector<std::string> out;
+  VRMappedFile file(cacheFile);
+  VRBinaryReader in(file.data(), file.size());
+  if ((file.data() == NULL) || !in.expectRaw(cacheMagic, sizeof(cacheMagic)) ||
+      (in.getByte() != version)) return out;
+
+  uint32_t numSources = in.getUInt32();
+  for (uint32_t i = 0; i < numSources; i++) {
+    out.push_back(in.getString());
+    in.getInt64();
+    in.getInt64();
+  }
+  return out;
+}
+
+} // end namespace MinVR
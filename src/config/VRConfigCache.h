@@ -0,0 +1,88 @@
+// -*-c++-*-
+#ifndef MINVR_CONFIGCACHE_H
+#define MINVR_CONFIGCACHE_H
+
+//
+// Copyright Brown University, 2017.  This software is released under the
+// following license: http://opensource.org/licenses/
+// Source code originally developed at the Brown University Center for
+// Computation and Visualization (ccv.brown.edu).
+//
+
+#include <string>
+#include <vector>
+#include "stdint.h"
+
+#include "VRDataIndex.h"
+
+namespace MinVR {
+
+/// \brief Compiled configuration files.
+///
+/// Reading a configuration means parsing its XML, resolving the links,
+/// and building the index, and on a cluster every node does that to the
+/// same files at once, often over a network file system.  A compiled
+/// configuration (a "cache") holds the finished index instead, in the
+/// binary encoding of VRDataIndex::serializeBinary(), and is read by
+/// mapping the file into memory.
+///
+/// A cache records the configuration files it was made from, with their
+/// sizes and a hash of their contents.  It is only used if they are all
+/// still the same, so editing a configuration without compiling it again
+/// does no harm; the cache is just passed over.
+///
+/// The MVRCompile program (in utils/) makes them:
+///
+///      $ MVRCompile desktop.minvr
+///
+/// writes desktop.minvr.cache, and VRMain::loadConfig() loads that in
+/// place of desktop.minvr whenever it is up to date.  Several files that
+/// are always loaded together (because one links to another, say) can be
+/// compiled into one cache, which can be named on the command line like
+/// any other configuration file.
+///
+/// Links are resolved when the cache is made, and the cache holds copies
+/// of the linked entries, like serializeBinary() always does.
+class VRConfigCache {
+public:
+
+  /// \brief The name of the cache that goes with a configuration file.
+  static std::string getCacheFileName(const std::string &configFile);
+
+  /// \brief Reads and compiles the configuration files, in order, and
+  /// writes the result to cacheFile.
+  static void compile(const std::vector<std::string> &configFiles,
+                      const std::string &cacheFile);
+
+  /// \brief Writes a cache of an index read from the given files.
+  static void write(const VRDataIndex &index,
+                    const std::vector<std::string> &configFiles,
+                    const std::string &cacheFile);
+
+  /// \brief Adds the contents of a cache to the index, if it is up to
+  /// date.
+  ///
+  /// Returns false, and leaves the index alone, if the file is not a
+  /// cache, if any of the configuration files it was made from has
+  /// changed, or if the cache was made by another version of MinVR or is
+  /// damaged.  The reason goes in whyNot, if it isn't NULL.
+  static bool load(const std::string &cacheFile, VRDataIndex *index,
+                   std::string *whyNot = NULL);
+
+  /// \brief Returns true if the file starts the way a cache does.
+  static bool isCache(const std::string &fileName);
+
+  /// \brief The configuration files a cache was made from.
+  static std::vector<std::string> getSourceFiles(const std::string &cacheFile);
+
+  /// \brief A 64-bit FNV-1a hash of the file's contents.
+  ///
+  /// Returns false if the file can't be read.
+  static bool hashFile(const std::string &fileName, uint64_t *hash, uint64_t *size);
+
+  /// The version of the cache format.
+  static const unsigned char version;
+};
+
+} // end namespace MinVR
+#endif
@@ -22,6 +22,32 @@ typedef std::vector<std::string> VRStringArray;
 // This one is a bit different than the others, but is still a core type.
 typedef std::list<std::string>   VRContainer;
 
+// A fixed number of floats, held in place rather than on the heap like
+// a VRFloatArray's.  These are how the matrices and vectors of VRMath go
+// into a VRDataIndex, so a pose can be stored and read back many times a
+// frame without allocating anything.
+template <int N>
+struct VRFixedFloatArray {
+  float v[N];
+
+  float operator[](const int i) const { return v[i]; }
+  float &operator[](const int i) { return v[i]; }
+  const float *data() const { return v; }
+  float *data() { return v; }
+  static int size() { return N; }
+
+  bool operator==(const VRFixedFloatArray &other) const {
+    for (int i = 0; i < N; i++) if (v[i] != other.v[i]) return false;
+    return true;
+  }
+  bool operator!=(const VRFixedFloatArray &other) const { return !(*this == other); }
+};
+
+// A 4x4 matrix, in column-major order like OpenGL's and VRMatrix4's.
+typedef VRFixedFloatArray<16>    VRFloatMatrix4;
+// An x, y, z vector or point, like VRVector3 and VRPoint3.
+typedef VRFixedFloatArray<3>     VRFloatVec3;
+
 // typedef int MVRInt;
 // typedef float MVRFloat;
 // typedef std::string MVRString;
@@ -39,10 +65,12 @@ typedef enum
   VRCORETYPE_INTARRAY    = 4,
   VRCORETYPE_FLOATARRAY  = 5,
   VRCORETYPE_STRINGARRAY = 6,
-  VRCORETYPE_CONTAINER   = 7
+  VRCORETYPE_CONTAINER   = 7,
+  VRCORETYPE_MATRIX4     = 8,
+  VRCORETYPE_VEC3        = 9
 } VRCORETYPE_ID;
 
-#define VRCORETYPE_NTYPES 8
+#define VRCORETYPE_NTYPES 10
 
 // The classes below are here to help with conversions from other
 // types to the MinVR2 core types.  If some class inherits from one of
@@ -81,6 +109,21 @@ public:
   virtual VRFloatArray toVRFloatArray() const = 0;
 };
 
+// Convert to a VRFloatMatrix4.  Anything that can be one can also be a
+// VRFloatArray, and when an object is both, VRDataIndex::addData() stores
+// it as the matrix.
+class VRFloatMatrix4Convertible : public VRFloatArrayConvertible {
+public:
+  virtual VRFloatMatrix4 toVRFloatMatrix4() const = 0;
+};
+
+// Convert to a VRFloatVec3.  As above, this takes precedence over the
+// VRFloatArray.
+class VRFloatVec3Convertible : public VRFloatArrayConvertible {
+public:
+  virtual VRFloatVec3 toVRFloatVec3() const = 0;
+};
+
 // Convert to a VRStringArray
 class VRStringArrayConvertible {
 public:
@@ -0,0 +1,178 @@
+// -*-c++-*-
+#ifndef MINVR_DATAHANDLE_H
+#define MINVR_DATAHANDLE_H
+
+//
+// Copyright Brown University, 2017.  This software is released under the
+// following license: http://opensource.org/licenses/
+// Source code originally developed at the Brown University Center for
+// Computation and Visualization (ccv.brown.edu).
+//
+
+#include "VRDataIndex.h"
+
+namespace MinVR {
+
+/// \brief A pre-resolved name for a frequently used data index value.
+///
+/// Code that reads the same value from a data index over and over, like a
+/// display node reading "HeadMatrix" on every frame, can create one of these
+/// once and use it in place of the name.  The first use looks up the name,
+/// with the same inheritance rules as VRDataIndex::getValue(), and remembers
+/// where the value is.  Later uses go straight to the value, and return it
+/// without making a VRDatumConverter or any other copy.
+///
+/// ~~~
+///   VRDataHandle headMatrix("HeadMatrix");
+///   ...
+///   const VRFloatMatrix4 *m = headMatrix.getPointerMatrix4(*renderState);
+/// ~~~
+///
+/// The lookup is repeated whenever the handle is used with a different index,
+/// or when an entry that might change the answer has been added, removed, or
+/// relinked since the last use, which is any entry whose name ends the same
+/// way as the key, and occasionally some others.  Changing a value in place
+/// does not count, nor does a pushed state that only adds and changes other
+/// names, so a handle stays good across frames like that.  A handle is not safe to share
+/// between threads; give each thread (or each display node) its own.
+class VRDataHandle {
+public:
+  /// \param key The name of the value, as for VRDataIndex::getValue().
+  /// \param nameSpace The namespace in which to look for key.
+  /// \param inherit Set to false to look only in the given namespace.
+  VRDataHandle(const std::string &key,
+               const std::string &nameSpace = "",
+               const bool inherit = true) :
+    _key(key), _nameSpace(nameSpace), _inherit(inherit),
+    _bucket(VRDataIndex::_handleBucket(key)),
+    _index(NULL), _epoch(0), _generation(0), _datum(NULL), _numLookups(0) {};
+
+  /// \brief Is there a value of this name in the index?
+  bool exists(const VRDataIndex &index) const {
+    return _resolve(index) != NULL;
+  };
+
+  /// \brief Returns the datum itself, or NULL if it does not exist.
+  const VRDatum *getDatum(const VRDataIndex &index) const {
+    return _resolve(index);
+  };
+
+  /// \name Typed access.
+  ///
+  /// The getPointer methods return NULL if the name is not in the index.
+  /// The pointers are good until the value is next changed.  The getValue
+  /// methods throw an error if the name is missing.  Both throw an error if
+  /// the value is not of the right type, with the same conversions allowed
+  /// as for VRDatum.
+  ///@{
+  const VRInt *getPointerInt(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerInt() : NULL;
+  };
+  const VRFloat *getPointerFloat(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerFloat() : NULL;
+  };
+  const VRString *getPointerString(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerString() : NULL;
+  };
+  const VRIntArray *getPointerIntArray(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerIntArray() : NULL;
+  };
+  const VRFloatArray *getPointerFloatArray(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerFloatArray() : NULL;
+  };
+  const VRStringArray *getPointerStringArray(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerStringArray() : NULL;
+  };
+  const VRFloatMatrix4 *getPointerMatrix4(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerMatrix4() : NULL;
+  };
+  const VRFloatVec3 *getPointerVec3(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    return d ? d->getPointerVec3() : NULL;
+  };
+
+  /// The floats of a matrix, a vector, or a float array, whichever the
+  /// value happens to be.  A matrix a display node stored is a
+  /// VRFloatMatrix4, but one read from a configuration file is usually a
+  /// VRFloatArray, and code that only wants the numbers can take either.
+  /// The number of them goes in size, if it isn't NULL.
+  const float *getPointerFloats(const VRDataIndex &index, int *size = NULL) const {
+    const VRDatum *d = _resolve(index);
+    if (d == NULL) return NULL;
+    switch (d->getType()) {
+    case VRCORETYPE_MATRIX4:
+      if (size != NULL) *size = VRFloatMatrix4::size();
+      return d->getPointerMatrix4()->data();
+    case VRCORETYPE_VEC3:
+      if (size != NULL) *size = VRFloatVec3::size();
+      return d->getPointerVec3()->data();
+    default: {
+      const VRFloatArray *a = d->getPointerFloatArray();
+      if (size != NULL) *size = (int)a->size();
+      return a->empty() ? NULL : &(*a)[0];
+    }
+    }
+  };
+
+  VRInt getValueInt(const VRDataIndex &index) const {
+    return _require(index)->getValueInt();
+  };
+  VRFloat getValueFloat(const VRDataIndex &index) const {
+    return _require(index)->getValueFloat();
+  };
+  ///@}
+
+  const std::string &getKey() const { return _key; };
+  const std::string &getNameSpace() const { return _nameSpace; };
+
+  /// How many times the handle has looked up its name, for profiling.
+  int getNumLookups() const { return _numLookups; };
+
+private:
+  std::string _key;
+  std::string _nameSpace;
+  bool _inherit;
+  int _bucket;
+
+  // What the name resolved to, and in which index, at which epoch and
+  // generation of the key's bucket.
+  mutable const VRDataIndex *_index;
+  mutable uint64_t _epoch;
+  mutable uint64_t _generation;
+  mutable const VRDatum *_datum;
+  mutable int _numLookups;
+
+  const VRDatum *_resolve(const VRDataIndex &index) const {
+    if ((&index != _index) || (index._handleEpoch != _epoch) ||
+        (index._handleGenerations[_bucket] != _generation)) {
+      _datum = index._resolveHandle(_key, _nameSpace, _inherit);
+      _index = &index;
+      _epoch = index._handleEpoch;
+      _generation = index._handleGenerations[_bucket];
+      _numLookups++;
+    }
+    return _datum;
+  };
+
+  const VRDatum *_require(const VRDataIndex &index) const {
+    const VRDatum *d = _resolve(index);
+    if (d == NULL) {
+      if (_nameSpace.empty()) {
+        VRERRORNOADV("Never heard of " + _key + ".");
+      } else {
+        VRERRORNOADV("Never heard of " + _key + " in namespace " + _nameSpace + ".");
+      }
+    }
+    return d;
+  };
+};
+
+} // end namespace MinVR
+#endif
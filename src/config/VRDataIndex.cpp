@@ -1,9 +1,49 @@
 #include "VRDataIndex.h"
+#include "VRBinaryCodec.h"
+#include "VRNumberCodec.h"
 
 namespace MinVR {
 
 std::string VRDataIndex::rootNameSpace = "/";
 
+// FNV-1a hashing, used for the hash index.  Its virtue here is that it
+// can be continued from a previous result, so hash(a + b) is
+// fnvHash(hash(a), b).
+static const uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+static const uint64_t fnvPrime = 1099511628211ULL;
+
+static inline uint64_t fnvHash(uint64_t h, const char *s, const size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    h ^= (unsigned char)s[i];
+    h *= fnvPrime;
+  }
+  return h;
+}
+
+// The hash of the root namespace, "/".
+static const uint64_t fnvRootHash = fnvHash(fnvOffsetBasis, "/", 1);
+
+// Adds the names in the given namespace from one set of the select
+// index to a list, if they are deep enough.  The names in a namespace
+// all begin with it, so they are together in the set.
+static void selectInNameSpace(const std::set<std::string> &names,
+                              const std::string &nameSpace,
+                              const bool childOnly,
+                              std::list<std::string> *outList) {
+
+  for (std::set<std::string>::const_iterator it = names.lower_bound(nameSpace);
+       (it != names.end()) && (it->compare(0, nameSpace.size(), nameSpace) == 0); it++) {
+    if (it->size() == nameSpace.size()) continue;
+    if (childOnly && (it->find('/', nameSpace.size()) != std::string::npos)) continue;
+    outList->push_back(*it);
+  }
+}
+
+// The binary encoding starts with this tag, followed by the version byte.
+static const char binaryIndexMagic[] = { 'M', 'V', 'R', 'I' };
+// Version 2 added matrix4 and vec3.
+const unsigned char VRDataIndex::binaryVersion = 2;
+
 // Step 7 of the specialization instructions (in VRDatum.h) is to
 // add an entry here to register the new data type.
 VRDatumFactory VRDataIndex::_initializeFactory() {
@@ -17,16 +57,28 @@ VRDatumFactory VRDataIndex::_initializeFactory() {
   newFactory.RegisterVRDatum(VRCORETYPE_FLOATARRAY, CreateVRDatumFloatArray);
   newFactory.RegisterVRDatum(VRCORETYPE_STRINGARRAY, CreateVRDatumStringArray);
   newFactory.RegisterVRDatum(VRCORETYPE_CONTAINER, CreateVRDatumContainer);
+  newFactory.RegisterVRDatum(VRCORETYPE_MATRIX4, CreateVRDatumMatrix4);
+  newFactory.RegisterVRDatum(VRCORETYPE_VEC3, CreateVRDatumVec3);
 
   return newFactory;
 }
 
 VRDatumFactory VRDataIndex::_factory = VRDataIndex::_initializeFactory();
 
+std::atomic<uint64_t> VRDataIndex::_handleEpochSource(0);
+std::atomic<uint64_t> VRDataIndex::_journalFrameSource(0);
+
 VRDataIndex::VRDataIndex(const std::string serializedData)  :
-  _indexName("MVR"), _overwrite(1), _linkNeeded(false) {
+  _store(std::make_shared<VRDataStore>()), _indexName("MVR"), _overwrite(1), _linkNeeded(false) {
+
+  _lastDatum = _store->theIndex.end();
+  _allEntriesChanged();
 
-  _lastDatum = _theIndex.end();
+  // The network may hand us the binary encoding instead of XML.
+  if (isBinary(serializedData)) {
+    _indexName = _deserializeBinary(serializedData.data(), serializedData.size());
+    return;
+  }
 
   // If this is just a name, we just need an empty data index with the
   // given name.
@@ -35,36 +87,11 @@ VRDataIndex::VRDataIndex(const std::string serializedData)  :
     return;
   }
 
-  // If you're here, the input data looks like XML. So parse it.
-  Cxml *xml = new Cxml();
-  xml->parse_string(serializedData);
-  element *xml_node = xml->get_root_element();
-  element* child = xml_node->get_next_child();
-  element* grandChild = child->get_next_child();
-  std::string out;
-
-  // If we have been given data from a valid XML file (which has only
-  // one root element), the 'child' points to the root node, which we
-  // don't want to keep.  So we'll work our way through the
-  // grandchildren in this loop.
-  while (child != NULL) {
-
-    // There should be only one child here, so this should only pick
-    // the root name off the serial data.
-    _indexName = child->get_name();
-
-    // Now scan through the child's children for the rest of the data.
-    while (grandChild != NULL) {
-
-      out = _walkXML(grandChild, "/");
-
-      grandChild = child->get_next_child();
-    }
-
-    child = xml_node->get_next_child();
-  }
-
-  delete xml;
+  // If you're here, the input data looks like XML. So parse it.  If we
+  // have been given data from a valid XML file (which has only one root
+  // element), the root element's name is the name of the index, and we
+  // don't keep it.  Its children are the data.
+  _parseXML(serializedData, "/", true);
 
   // If there are nodes in the tree with a 'linknode' attribute,
   // resolve them.
@@ -76,29 +103,52 @@ VRDataIndex::VRDataIndex(const std::string serializedData)  :
 
 }
 
-/// The copy constructor makes a deep copy.
-VRDataIndex::VRDataIndex(const VRDataIndex& orig) {
+// The copy constructor shares the original's store, and leaves the
+// copying to _detach(), which happens when one side changes something.
+VRDataIndex::VRDataIndex(const VRDataIndex& orig) :
+  _store(orig._store), _indexName(orig._indexName),
+  _overwrite(orig._overwrite), _linkNeeded(orig._linkNeeded) {
 
-  _indexName = orig._indexName;
-  _overwrite = orig._overwrite;
+  // The original's journal points into the store, and a pop on the
+  // original would change the entries under us, so if there are any
+  // pushed changes, copy now.
+  if (!orig._journal.empty()) _detach();
 
-  // Here's the shallow copy of the index.
-  _theIndex = orig._theIndex;
+  // This part is not copied, but it's only a convenience, not part of the data.
+  _lastDatum = _store->theIndex.end();
+  _allEntriesChanged();
+}
 
-  // Now we have to go through and do a deep copy of the data in the index.
-  for (VRDataMap::iterator it = _theIndex.begin(); it != _theIndex.end(); it++) {
-    it->second = it->second.clone();
-  }
+void VRDataIndex::_detach() {
 
-  // This part is not copied, but it's only a convenience, not part of the data.
-  _lastDatum = _theIndex.end();
+  if (_store.use_count() == 1) return;
+
+  std::shared_ptr<VRDataStore> copy = std::make_shared<VRDataStore>();
 
-  // Then recreate the links.
-  for (std::map<std::string, std::string>::const_iterator it = orig._linkRegister.begin();
-       it != orig._linkRegister.end(); it++) {
+  // Clone each datum only once, so that linked names, which share a
+  // datum, still share one in the copy.
+  std::unordered_map<const VRDatum*, VRDatumPtr> clones;
+  for (VRDataMap::iterator it = _store->theIndex.begin();
+       it != _store->theIndex.end(); it++) {
 
-    linkNode(it->first, it->second);
+    const VRDatum *original = &(*(it->second));
+    std::unordered_map<const VRDatum*, VRDatumPtr>::iterator c =
+      clones.find(original);
+    if (c == clones.end()) {
+      c = clones.insert(std::make_pair(original, it->second.clone())).first;
+    }
+
+    // The map is already in order, so each insertion goes at the end.
+    copy->theIndex.insert(copy->theIndex.end(),
+                          VRDataMap::value_type(it->first, c->second));
   }
+  copy->linkRegister = _store->linkRegister;
+
+  _store = copy;
+
+  // The hash index points into the map, so has to be redone.
+  _rebuildHashIndex();
+  _lastDatum = _store->theIndex.end();
 }
 
 std::string VRDataIndex::_getTrimName(const std::string &key,
@@ -174,7 +224,7 @@ std::string VRDataIndex::serialize(const std::string key,
     VRDataMap::const_iterator it =
       const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit);
 
-    if (it != _theIndex.end()) {
+    if (it != _store->theIndex.end()) {
 
       return _serialize(it->first, it->second);
 
@@ -236,17 +286,263 @@ std::string VRDataIndex::_serialize(const std::string &name,
   }
 }
 
+// The binary form is a header, then one record per entry in the index:
+//
+//   "MVRI" version:u8 indexName:str numEntries:u32
+//   { fullName:str type:u8 numAttrs:u32 {name:str value:str}* value }*
+//
+// where str is a u32 length followed by that many bytes, and the value is
+// encoded according to the type.  (An array is a u32 count and then the
+// elements; a matrix4 or vec3 is just its 16 or 3 floats.)  All the integers are little-endian.
+// Entries are written in index order, so a container always precedes
+// its members.
+std::string VRDataIndex::serializeBinary() const {
+
+  VRBinaryWriter out;
+  out.reserve(64 * (_store->theIndex.size() + 1));
+
+  out.putRaw(binaryIndexMagic, sizeof(binaryIndexMagic));
+  out.putByte(binaryVersion);
+  out.putString(_indexName);
+  out.putUInt32((uint32_t)_store->theIndex.size());
+
+  for (VRDataMap::const_iterator it = _store->theIndex.begin();
+       it != _store->theIndex.end(); it++) {
+
+    const VRDatumPtr &pdata = it->second;
+    out.putString(it->first);
+    out.putByte((unsigned char)pdata->getType());
+
+    const VRDatum::VRAttributeList attrs = pdata->getAttributeList();
+    out.putUInt32((uint32_t)attrs.size());
+    for (VRDatum::VRAttributeList::const_iterator at = attrs.begin();
+         at != attrs.end(); at++) {
+      out.putString(at->first);
+      out.putString(at->second);
+    }
+
+    switch (pdata->getType()) {
+    case VRCORETYPE_INT:
+      out.putInt32(*pdata->getPointerInt());
+      break;
+
+    case VRCORETYPE_FLOAT:
+      out.putFloat(*pdata->getPointerFloat());
+      break;
+
+    case VRCORETYPE_STRING:
+      out.putString(*pdata->getPointerString());
+      break;
+
+    case VRCORETYPE_INTARRAY: {
+      const VRIntArray *v = pdata->getPointerIntArray();
+      out.putUInt32((uint32_t)v->size());
+      for (VRIntArray::const_iterator vt = v->begin(); vt != v->end(); vt++)
+        out.putInt32(*vt);
+      break;
+    }
+
+    case VRCORETYPE_FLOATARRAY: {
+      const VRFloatArray *v = pdata->getPointerFloatArray();
+      out.putUInt32((uint32_t)v->size());
+      for (VRFloatArray::const_iterator vt = v->begin(); vt != v->end(); vt++)
+        out.putFloat(*vt);
+      break;
+    }
+
+    case VRCORETYPE_STRINGARRAY: {
+      const VRStringArray *v = pdata->getPointerStringArray();
+      out.putUInt32((uint32_t)v->size());
+      for (VRStringArray::const_iterator vt = v->begin(); vt != v->end(); vt++)
+        out.putString(*vt);
+      break;
+    }
+
+    case VRCORETYPE_CONTAINER: {
+      const VRContainer *v = pdata->getPointerContainer();
+      out.putUInt32((uint32_t)v->size());
+      for (VRContainer::const_iterator vt = v->begin(); vt != v->end(); vt++)
+        out.putString(*vt);
+      break;
+    }
+
+    case VRCORETYPE_MATRIX4: {
+      const VRFloatMatrix4 *v = pdata->getPointerMatrix4();
+      for (int i = 0; i < v->size(); i++) out.putFloat((*v)[i]);
+      break;
+    }
+
+    case VRCORETYPE_VEC3: {
+      const VRFloatVec3 *v = pdata->getPointerVec3();
+      for (int i = 0; i < v->size(); i++) out.putFloat((*v)[i]);
+      break;
+    }
+
+    default:
+      VRERRORNOADV("Cannot serialize " + it->first + ", of unknown type.");
+    }
+  }
+
+  return out.str();
+}
+
+bool VRDataIndex::isBinary(const std::string &serializedData) {
+  return (serializedData.size() > sizeof(binaryIndexMagic)) &&
+    (serializedData.compare(0, sizeof(binaryIndexMagic), binaryIndexMagic,
+                            sizeof(binaryIndexMagic)) == 0);
+}
+
+void VRDataIndex::addSerializedBinary(const std::string &binaryData) {
+  _deserializeBinary(binaryData.data(), binaryData.size());
+}
+
+void VRDataIndex::addSerializedBinary(const char *binaryData, const size_t size) {
+  _deserializeBinary(binaryData, size);
+}
+
+std::string VRDataIndex::_deserializeBinary(const char *binaryData, const size_t size) {
+
+  VRBinaryReader in(binaryData, size);
+
+  if (!in.expectRaw(binaryIndexMagic, sizeof(binaryIndexMagic))) {
+    VRERRORNOADV("This does not look like a binary-encoded data index.");
+  }
+
+  unsigned char version = in.getByte();
+  if (version > binaryVersion) {
+    std::stringstream ss;
+    ss << "Binary data index encoding version " << (int)version
+       << " is newer than this code understands (" << (int)binaryVersion << ").";
+    VRERRORNOADV(ss.str());
+  }
+
+  std::string indexName = in.getString();
+  uint32_t numEntries = in.getUInt32();
+
+  // Into an empty index, the entries can go straight in, since they are
+  // complete: each container already lists its members, and there is
+  // nothing to merge with.
+  _detach();
+  const bool bulk = _store->theIndex.empty();
+
+  for (uint32_t i = 0; i < numEntries; i++) {
+
+    std::string name = in.getString();
+    VRCORETYPE_ID type = (VRCORETYPE_ID)in.getByte();
+
+    VRDatum::VRAttributeList attrs;
+    uint32_t numAttrs = in.getUInt32();
+    for (uint32_t j = 0; j < numAttrs; j++) {
+      std::string attrName = in.getString();
+      attrs[attrName] = in.getString();
+    }
+
+    switch (type) {
+    case VRCORETYPE_INT: {
+      VRInt v = (VRInt)in.getInt32();
+      _addDeserialized<VRInt, VRCORETYPE_INT>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_FLOAT: {
+      VRFloat v = (VRFloat)in.getFloat();
+      _addDeserialized<VRFloat, VRCORETYPE_FLOAT>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_STRING: {
+      VRString v = in.getString();
+      _addDeserialized<VRString, VRCORETYPE_STRING>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_INTARRAY: {
+      VRIntArray v(in.getUInt32());
+      for (VRIntArray::iterator vt = v.begin(); vt != v.end(); vt++)
+        *vt = in.getInt32();
+      _addDeserialized<VRIntArray, VRCORETYPE_INTARRAY>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_FLOATARRAY: {
+      VRFloatArray v(in.getUInt32());
+      for (VRFloatArray::iterator vt = v.begin(); vt != v.end(); vt++)
+        *vt = in.getFloat();
+      _addDeserialized<VRFloatArray, VRCORETYPE_FLOATARRAY>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_STRINGARRAY: {
+      VRStringArray v(in.getUInt32());
+      for (VRStringArray::iterator vt = v.begin(); vt != v.end(); vt++)
+        *vt = in.getString();
+      _addDeserialized<VRStringArray, VRCORETYPE_STRINGARRAY>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_CONTAINER: {
+      VRContainer v;
+      uint32_t n = in.getUInt32();
+      for (uint32_t j = 0; j < n; j++) v.push_back(in.getString());
+      _addDeserialized<VRContainer, VRCORETYPE_CONTAINER>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_MATRIX4: {
+      VRFloatMatrix4 v;
+      for (int j = 0; j < v.size(); j++) v[j] = in.getFloat();
+      _addDeserialized<VRFloatMatrix4, VRCORETYPE_MATRIX4>(name, v, attrs, bulk);
+      break;
+    }
+
+    case VRCORETYPE_VEC3: {
+      VRFloatVec3 v;
+      for (int j = 0; j < v.size(); j++) v[j] = in.getFloat();
+      _addDeserialized<VRFloatVec3, VRCORETYPE_VEC3>(name, v, attrs, bulk);
+      break;
+    }
+
+    default:
+      VRERRORNOADV("Binary data index contains an unknown type for " + name);
+    }
+  }
+
+  return indexName;
+}
+
+template <typename T, const VRCORETYPE_ID TID>
+std::string VRDataIndex::_addDeserialized(const std::string &name, T &value,
+                                          const VRDatum::VRAttributeList &attrs,
+                                          const bool bulk) {
+
+  if (bulk && !name.empty() && (name[0] == '/')) {
+    VRDatumPtr obj = _factory.CreateVRDatum(TID, &value);
+    obj->setAttributeList(attrs);
+    if (!_insertEntry(name, obj).second) {
+      VRERRORNOADV("Binary data index contains " + name + " twice.");
+    }
+    return name;
+  }
+
+  std::string fullName = addData(name, value);
+
+  // Attributes come along for the ride.
+  for (VRDatum::VRAttributeList::const_iterator at = attrs.begin();
+       at != attrs.end(); at++) {
+    setAttributeValue(fullName, at->first, at->second);
+  }
+  return fullName;
+}
+
 VRInt VRDataIndex::_deserializeInt(const std::string valueString) {
-  int iVal;
-  std::istringstream stream(valueString);
-  stream >> iVal;
+  VRInt iVal;
+  VRNumberCodec::parseInt(valueString.data(), valueString.data() + valueString.size(), iVal);
   return iVal;
 }
 
 VRFloat VRDataIndex::_deserializeFloat(const std::string valueString) {
-  float fVal;
-  std::istringstream stream(valueString);
-  stream >> fVal;
+  VRFloat fVal;
+  VRNumberCodec::parseFloat(valueString.data(), valueString.data() + valueString.size(), fVal);
   return fVal;
 }
 
@@ -255,39 +551,17 @@ VRString VRDataIndex::_deserializeString(const std::string valueString) {
 }
 
 VRIntArray VRDataIndex::_deserializeIntArray(const std::string valueString,
-                                            const char separator) {
-
-  VRIntArray vVal;
-
-  // Separate the name space into its constituent elements.
-  std::string elem;
-  VRInt iVal;
-  std::stringstream ss(valueString);
-  while (std::getline(ss, elem, separator)) {
-	std::istringstream stream(elem);
-	stream >> iVal;
-    vVal.push_back(iVal);
-  }
+                                            const char separator,
+                                            const VRNumberCodec::Format format) {
 
-  return vVal;
+  return VRNumberCodec::parseIntArray(valueString, separator, format);
 }
 
 VRFloatArray VRDataIndex::_deserializeFloatArray(const std::string valueString,
-                                                  const char separator) {
+                                                  const char separator,
+                                                  const VRNumberCodec::Format format) {
 
-  VRFloatArray vVal;
-
-  // Separate the name space into its constituent elements.
-  std::string elem;
-  VRFloat fVal;
-  std::stringstream ss(valueString);
-  while (std::getline(ss, elem, separator)) {
-	std::istringstream stream(elem);
-	stream >> fVal;
-    vVal.push_back(fVal);
-  }
-
-  return vVal;
+  return VRNumberCodec::parseFloatArray(valueString, separator, format);
 }
 
 VRStringArray VRDataIndex::_deserializeStringArray(const std::string valueString,
@@ -325,10 +599,25 @@ VRStringArray VRDataIndex::_deserializeStringArray(const std::string valueString
   return vVal;
 }
 
+void VRDataIndex::_deserializeFixed(const std::string &name,
+                                    const std::string &valueString,
+                                    const char separator,
+                                    const VRNumberCodec::Format format,
+                                    float *values, const size_t n) {
+
+  size_t count = VRNumberCodec::parseFloats(valueString, separator, format, values, n);
+  if (count != n) {
+    std::stringstream ss;
+    ss << name << " has " << count << " values, but should have " << n << ".";
+    VRERRORNOADV(ss.str());
+  }
+}
+
 std::string VRDataIndex::_processValue(const std::string &name,
                                        VRCORETYPE_ID &type,
                                        std::string valueString,
-                                       const char separator) {
+                                       const char separator,
+                                       const VRNumberCodec::Format format) {
 
   std::string out;
   /// Step 9 of adding a data type is adding entries to this switch.
@@ -347,11 +636,11 @@ std::string VRDataIndex::_processValue(const std::string &name,
     break;
 
   case VRCORETYPE_INTARRAY:
-    out = addData(name, (VRIntArray)_deserializeIntArray(valueString, separator));
+    out = addData(name, (VRIntArray)_deserializeIntArray(valueString, separator, format));
     break;
 
   case VRCORETYPE_FLOATARRAY:
-    out = addData(name, (VRFloatArray)_deserializeFloatArray(valueString, separator));
+    out = addData(name, (VRFloatArray)_deserializeFloatArray(valueString, separator, format));
     break;
 
   case VRCORETYPE_STRINGARRAY:
@@ -364,6 +653,20 @@ std::string VRDataIndex::_processValue(const std::string &name,
     break;
   }
 
+  case VRCORETYPE_MATRIX4: {
+    VRFloatMatrix4 m;
+    _deserializeFixed(name, valueString, separator, format, m.data(), m.size());
+    out = addData(name, m);
+    break;
+  }
+
+  case VRCORETYPE_VEC3: {
+    VRFloatVec3 v;
+    _deserializeFixed(name, valueString, separator, format, v.data(), v.size());
+    out = addData(name, v);
+    break;
+  }
+
   case VRCORETYPE_NONE:
     out = "";
     break;
@@ -372,119 +675,192 @@ std::string VRDataIndex::_processValue(const std::string &name,
   return out;
 }
 
-std::string VRDataIndex::_walkXML(element* node, std::string nameSpace) {
-  // This method will return the name of the last top-level element in
-  // the input XML.
+// The parser hands us elements as it reads them.  An element is entered
+// into the index as soon as we know whether it has children: when its
+// first child starts, or when it ends if it has none.  That way a
+// container is always in place before its contents.
+class VRDataIndex::XMLLoader : public VRXMLHandler {
+public:
+  XMLLoader(VRDataIndex *index, const std::string &nameSpace, const bool skipRoot) :
+    _index(index), _path(nameSpace), _skipRoot(skipRoot), _depth(0) {};
+
+  void startElement(const VRXMLSpan &name, const VRXMLAttributeList &attributes) {
+
+    if (_depth > 0) _addPending(true);
+
+    if (_frames.size() <= _depth) _frames.resize(_depth + 1);
+    Frame &frame = _frames[_depth];
+    frame.pathSize = _path.size();
+    frame.value = VRXMLSpan();
+
+    if (_skipRoot && (_depth == 0)) {
+      // The root only names the index.
+      _index->_indexName = name.str();
+      frame.pending = false;
+    } else {
+      if ((_depth > 0) && !(_skipRoot && (_depth == 1))) _path += '/';
+      _path.append(name.begin(), name.size());
+      frame.attributes = attributes;
+      frame.pending = true;
+    }
+    _depth++;
+  };
+
+  void text(const VRXMLSpan &text) {
+
+    if (_depth == 0) return;
+
+    // The value is the last run of text, not counting line breaks and
+    // tabs at its start.  (This is how it worked with the old parser.)
+    const char *p = text.begin();
+    while ((p < text.end()) && ((*p == '\n') || (*p == '\t') || (*p == '\r'))) p++;
+    if (p < text.end()) _frames[_depth - 1].value = VRXMLSpan(p, text.end() - p);
+  };
 
-  std::string qualifiedName;
+  void endElement(const VRXMLSpan &/*name*/) {
+
+    _addPending(false);
+    _depth--;
+    _path.resize(_frames[_depth].pathSize);
+  };
+
+  // The name of the last top-level element entered.
   std::string out;
 
-  qualifiedName = nameSpace + std::string(node->get_name());
+private:
+  struct Frame {
+    size_t pathSize;
+    VRXMLAttributeList attributes;
+    VRXMLSpan value;
+    bool pending;
+  };
+
+  void _addPending(const bool hasChild) {
+    Frame &frame = _frames[_depth - 1];
+    if (!frame.pending) return;
+    frame.pending = false;
+
+    std::string entered =
+      _index->_addXMLElement(_path, frame.attributes, frame.value, hasChild);
+    if (_depth == (_skipRoot ? 2u : 1u)) out = entered;
+  };
+
+  VRDataIndex *_index;
+
+  // The qualified name of the innermost open element.
+  std::string _path;
+  bool _skipRoot;
+
+  // The open elements, outermost first.  Only the first _depth of these
+  // are in use; the rest are kept to save on allocations.
+  std::vector<Frame> _frames;
+  size_t _depth;
+};
+
+std::string VRDataIndex::_parseXML(const std::string &xml,
+                                   const std::string &nameSpace,
+                                   const bool skipRoot) {
+
+  XMLLoader loader(this, nameSpace, skipRoot);
+  VRXMLParser parser;
+  parser.parse(xml, &loader);
+
+  return loader.out;
+}
+
+std::string VRDataIndex::_addXMLElement(const std::string &qualifiedName,
+                                        const VRXMLAttributeList &attributes,
+                                        const VRXMLSpan &value,
+                                        const bool hasChild) {
+
+  // The attributes we care about.  If one is given twice, the first one
+  // counts.
+  const VRXMLAttribute *typeAttr = NULL;
+  const VRXMLAttribute *separatorAttr = NULL;
+  const VRXMLAttribute *formatAttr = NULL;
+  for (VRXMLAttributeList::const_iterator it = attributes.begin();
+       it != attributes.end(); it++) {
+
+    if ((typeAttr == NULL) && (it->name == "type")) typeAttr = &(*it);
+    if ((separatorAttr == NULL) && (it->name == "separator")) separatorAttr = &(*it);
+    if ((formatAttr == NULL) && (it->name == "format")) formatAttr = &(*it);
+
+    // Check to see if this is a link to anywhere.  If it is, signal
+    // that we'll need the linking step after the deserialize.
+    if ((it->name == "linkNode") || (it->name == "linkContent")) _linkNeeded = true;
+  }
+
+  // Trim leading and trailing spaces, tabs, whatever.
+  const char *first = value.begin();
+  const char *last = value.end();
+  while ((first < last) && strchr(" \t\r\n", *first)) first++;
+  while ((last > first) && strchr(" \t\r\n", *(last - 1))) last--;
+  std::string valueString(first, last - first);
 
   // What type is this node?
   VRCORETYPE_ID typeId;
-  if (node->get_value().empty()) {
+  if (valueString.empty()) {
     // If the node has no value, we hope it's a container.
     typeId = VRCORETYPE_CONTAINER;
 
-  } else if (node->get_attribute("type") == NULL) {
+  } else if (typeAttr == NULL) {
 
-    if (node->has_child()) {
+    if (hasChild) {
 
       typeId = VRCORETYPE_CONTAINER;
     } else {
 
-      typeId = _inferType(std::string(node->get_value()));
+      typeId = _inferType(valueString);
     }
 
   } else {
 
     // Check to see if the type is one we can handle.
-    VRDatum::VRTypeMap::iterator it =
-      VRDatum::typeMap.find(std::string(node->get_attribute("type")->get_value()));
+    VRDatum::VRTypeMap::iterator it = VRDatum::typeMap.find(typeAttr->value.str());
 
     if (it == VRDatum::typeMap.end()) {
       // If not, throw an error.
-      VRERRORNOADV("No known type called " +
-                   std::string(node->get_attribute("type")->get_value()));
+      VRERRORNOADV("No known type called " + typeAttr->value.str());
     } else {
       // Otherwise, pass it along as the typeID.
       typeId = it->second;
     }
   }
 
-  // Check to see if this is a link to anywhere.  If it is, signal
-  // that we'll need the linking step after the deserialize.
-  if (node->get_attribute("linkNode") != NULL) _linkNeeded = true;
-  if (node->get_attribute("linkContent") != NULL) _linkNeeded = true;
-
-  // Get a value for the node.
-  std::string valueString;
-  if (node->get_value().empty()) {
-
-    valueString = "";
-
-  } else {
+  char separator = MINVRSEPARATOR;
+  if ((separatorAttr != NULL) && !separatorAttr->value.empty()) {
 
-    // Convert to a string for some minor editing.
-    valueString = std::string(node->get_value());
-
-    // Trim leading and trailing spaces, tabs, whatever.
-    int firstChar = (int)valueString.find_first_not_of(" \t\r\n");
-    int lastChar = (int)valueString.find_last_not_of(" \t\r\n");
-
-    if ((firstChar >= 0) && (lastChar >= 0)) {
-
-      valueString = valueString.substr(firstChar, (1 + lastChar - firstChar));
-
-    } else {
-
-      valueString = "";
-      typeId = VRCORETYPE_CONTAINER;
-    }
+    separator = *(separatorAttr->value.begin());
   }
 
-  char separator;
-  if (node->get_attribute("separator") == NULL) {
-
-    separator = MINVRSEPARATOR;
+  // Arrays may be packed some other way than as text.
+  VRNumberCodec::Format format = VRNumberCodec::FORMAT_DEFAULT;
+  if (formatAttr != NULL) format = VRNumberCodec::getFormat(formatAttr->value.str());
 
-  } else {
-
-    separator = *(node->get_attribute("separator")->get_value());
-  }
-
-  out = _processValue(qualifiedName,
-                     typeId,
-                     valueString,
-                     separator);
+  std::string out = _processValue(qualifiedName,
+                                  typeId,
+                                  valueString,
+                                  separator,
+                                  format);
 
   // There should be a datum object entered for this by here.  So now
   // we can see if there are any attributes to add to the list.
-  VRDatum::VRAttributeList al = node->get_attribute_map();
-  if (al.find("type") != al.end()) al.erase(al.find("type"));
-  if (al.size() > 0) {
+  VRDatum::VRAttributeList al;
+  for (VRXMLAttributeList::const_iterator it = attributes.begin();
+       it != attributes.end(); it++) {
 
-    _getDatum(out)->setAttributeList(al);
+    if (!(it->name == "type")) al[it->name.str()] = it->value.str();
   }
+  if (al.size() > 0) {
 
-  // This loops through the node children, if there are any.
-  VRContainer childNames;
-  while (true) {
-
-    // Pick the next child.
-    element* child = node->get_next_child();
-    if (child == NULL) {
-
-      return out;
-    }
-
-    // Collect a child name on the container's child name list.
-    childNames.push_back(qualifiedName + "/" + child->get_name());
-
-    // And go walk its tree.
-    _walkXML(child, qualifiedName + "/");
+    VRDataMap::iterator entry = _getEntry(out);
+    _journalModified(entry);
+    _selectIndexBeforeAttributes(entry);
+    entry->second->setAttributeList(al);
+    _selectIndexAfterAttributes(entry);
   }
+
+  return out;
 }
 
   bool VRDataIndex::hasAttribute(const std::string &fullKey,
@@ -500,7 +876,14 @@ std::string VRDataIndex::_walkXML(element* node, std::string nameSpace) {
   void VRDataIndex::setAttributeValue(const std::string &fullKey,
                                       const std::string &attributeName,
                                       const std::string &attributeValue) {
-    _getDatum(fullKey)->setAttributeValue(attributeName, attributeValue);
+    _detach();
+    VRDataMap::iterator entry = _getEntry(fullKey);
+    if (entry == _store->theIndex.end())
+      VRERRORNOADV("What? Never heard of " + fullKey + " in namespace ");
+    _journalModified(entry);
+    _selectIndexBeforeAttributes(entry);
+    entry->second->setAttributeValue(attributeName, attributeValue);
+    _selectIndexAfterAttributes(entry);
   }
 
 // This function examines a value string and tries to determine what
@@ -549,7 +932,7 @@ VRCORETYPE_ID VRDataIndex::_inferType(const std::string &valueString) const {
 // just use getValue().
 std::list<std::string> VRDataIndex::findAllNames() const {
   VRContainer outList;
-  for (VRDataMap::const_iterator it = _theIndex.begin(); it != _theIndex.end(); it++) {
+  for (VRDataMap::const_iterator it = _store->theIndex.begin(); it != _store->theIndex.end(); it++) {
     outList.push_back(it->first);
   }
   return outList;
@@ -562,36 +945,25 @@ VRContainer VRDataIndex::selectByAttribute(const std::string &attrName,
                                            const bool childOnly) const {
 
   std::string validatedNameSpace = validateNameSpace(nameSpace);
+  const VRSelectIndex &select = _getSelectIndex();
 
   std::list<std::string> outList;
-	for (VRDataMap::const_iterator it = _theIndex.begin(); it != _theIndex.end(); it++) {
-		VRDatum::VRAttributeList al = it->second->getAttributeList();
-
-    // Use a string comparison to check if this name is within the given scope.
-    int child = isChild(nameSpace, it->first);
-    if ((childOnly && (child == 1)) || ((!childOnly) && (child >= 1))) {
+  if (attrVal == "*") {
 
-			// Check if attribute list has anything in it.
-			if (!al.empty()) {
+    std::map<std::string, VRNameSet>::const_iterator it = select.byAttribute.find(attrName);
+    if (it != select.byAttribute.end())
+      selectInNameSpace(it->second, validatedNameSpace, childOnly, &outList);
 
-				// Yes? Loop through the attributes.
-				for (VRDatum::VRAttributeList::iterator jt = al.begin();
-					jt != al.end(); jt++) {
-
-					// Do we have the correct attribute?
-					if (attrName.compare(jt->first) == 0) {
-
-						// Does it match the desired value, or a wildcard?
-						if ((attrVal == "*") || (attrVal.compare(jt->second) == 0)) {
+  } else {
 
-							// Put the name of the datum on the list.
-							outList.push_back(it->first);
-						}
-					}
-				}
-			}
-		}
-	}
+    std::map<std::string, std::map<std::string, VRNameSet> >::const_iterator it =
+      select.byAttributeValue.find(attrName);
+    if (it != select.byAttributeValue.end()) {
+      std::map<std::string, VRNameSet>::const_iterator jt = it->second.find(attrVal);
+      if (jt != it->second.end())
+        selectInNameSpace(jt->second, validatedNameSpace, childOnly, &outList);
+    }
+  }
 	return outList;
 }
 
@@ -603,44 +975,37 @@ std::string VRDataIndex::getByAttribute(const std::string &attrName,
   std::string validatedNameSpace = validateNameSpace(nameSpace);
   size_t matchedLength = 0;
 
-  // We are going to loop through all the names in the index to find the
-  // longest string match to the input name space.  That *is* the match at the
-  // lowest nested level.
-	for (VRDataMap::const_iterator it = _theIndex.begin(); it != _theIndex.end(); it++) {
+  const VRSelectIndex &select = _getSelectIndex();
+  const VRNameSet *names = NULL;
+  if (attrVal == "*") {
+    std::map<std::string, VRNameSet>::const_iterator it = select.byAttribute.find(attrName);
+    if (it != select.byAttribute.end()) names = &it->second;
+  } else {
+    std::map<std::string, std::map<std::string, VRNameSet> >::const_iterator it =
+      select.byAttributeValue.find(attrName);
+    if (it != select.byAttributeValue.end()) {
+      std::map<std::string, VRNameSet>::const_iterator jt = it->second.find(attrVal);
+      if (jt != it->second.end()) names = &jt->second;
+    }
+  }
+  if (names == NULL) return out;
+
+  // We are going to loop through the names with the attribute to find
+  // the longest string match to the input name space.  That *is* the
+  // match at the lowest nested level.
+	for (VRNameSet::const_iterator it = names->begin(); it != names->end(); it++) {
 
     // Use a string comparison to check if this name is within the given scope.
-    std::string ns = _getNameSpace(it->first);
+    std::string ns = _getNameSpace(*it);
     if (ns.compare(0, ns.size(), validatedNameSpace, 0, ns.size()) == 0) {
 
       // If we're here, we have found a name that could contain the given
-      // namespace.  If this one is not longer than the last, then skip it.
+      // namespace.  If this one is longer than the last, it's the one.
       if (ns.size() > matchedLength) {
-
-        VRDatum::VRAttributeList al = it->second->getAttributeList();
-
-        // Check if attribute list has anything in it.
-        if (!al.empty()) {
-
-          // Yes? Loop through the attributes.
-          for (VRDatum::VRAttributeList::iterator jt = al.begin();
-               jt != al.end(); jt++) {
-
-            // Do we have the correct attribute?
-            if (attrName.compare(jt->first) == 0) {
-
-              // Does it match the desired value, or a wildcard?
-              if ((attrVal == "*") || (attrVal.compare(jt->second) == 0)) {
-
-                // Put the name of the datum into the proposed output and
-                // record the length of the match.
-                out = it->first;
-                matchedLength = ns.size();
-              }
-            }
-					}
-				}
-			}
-		}
+        out = *it;
+        matchedLength = ns.size();
+      }
+    }
 	}
 	return out;
 }
@@ -649,21 +1014,17 @@ VRContainer VRDataIndex::selectByType(const VRCORETYPE_ID &typeID,
                                       const std::string nameSpace,
                                       const bool childOnly) const {
 
-  VRContainer outList;
-  for (VRDataMap::const_iterator it = _theIndex.begin(); it != _theIndex.end(); it++) {
-
-    // Check to see if the type is the type we're looking for.
-    if (typeID == it->second->getType()) {
+  // Unlike the others, this doesn't mind a namespace that isn't there.
+  std::string validatedNameSpace = nameSpace;
+  if ((validatedNameSpace.size() == 0) || (validatedNameSpace[0] != '/'))
+    validatedNameSpace = "/" + validatedNameSpace;
+  if (validatedNameSpace[validatedNameSpace.size() - 1] != '/') validatedNameSpace += '/';
+  const VRSelectIndex &select = _getSelectIndex();
 
-      // Use a string comparison to check if this name is within the given scope.
-      int child = isChild(nameSpace, it->first);
-      if ((childOnly && (child == 1)) || ((!childOnly) && (child >= 1))) {
-
-        // Put the name of the datum on the list.
-        outList.push_back(it->first);
-      }
-    }
-  }
+  VRContainer outList;
+  std::map<VRCORETYPE_ID, VRNameSet>::const_iterator it = select.byType.find(typeID);
+  if (it != select.byType.end())
+    selectInNameSpace(it->second, validatedNameSpace, childOnly, &outList);
   return outList;
 }
 
@@ -674,7 +1035,7 @@ VRContainer VRDataIndex::selectByKey(const std::string &inName,
   VRContainer outList;
 
   // Sort through the whole index.
-  for (VRDataMap::const_iterator it = _theIndex.begin(); it != _theIndex.end(); it++) {
+  for (VRDataMap::const_iterator it = _store->theIndex.begin(); it != _store->theIndex.end(); it++) {
 
     // This is our indicator.  If a name gets through all the
     // comparisons with test still equal to zero, it's a match.
@@ -768,7 +1129,7 @@ std::string VRDataIndex::validateNameSpace(const std::string &nameSpace) const {
 
     // Otherwise look for it in the index and throw an error if
     // it isn't there.
-    if (_theIndex.find(out.substr(0, out.size() - 1)) == _theIndex.end()) {
+    if (_findEntry(out.substr(0, out.size() - 1)) == _store->theIndex.end()) {
       VRERRORNOADV("Can't find a namespace called " + nameSpace);
     }
   }
@@ -834,10 +1195,10 @@ std::string VRDataIndex::_getNameSpace(const std::string &fullName) {
 
 void VRDataIndex::pushState() {
 
-  for (std::map<std::string, VRDatumPtr>::iterator it = _theIndex.begin();
-       it != _theIndex.end(); it++) {
-    it->second->push();
-  }
+  VRJournalFrame frame;
+  frame.start = _journal.size();
+  frame.id = _journalFrameSource.fetch_add(1, std::memory_order_relaxed) + 1;
+  _journalFrames.push_back(frame);
 }
 
 // Values that were added to the index after a push will be deleted on a pop,
@@ -846,19 +1207,101 @@ void VRDataIndex::pushState() {
 // complicated.
 void VRDataIndex::popState() {
 
-  std::map<std::string, VRDatumPtr>::iterator it = _theIndex.begin();
-  while (it != _theIndex.end()) {
+  if (_journalFrames.empty())
+    VRERRORNOADV("popState() called without a matching pushState().");
+
+  size_t frameStart = _journalFrames.back().start;
+  _journalFrames.pop_back();
+
+  // Undo the changes last to first, so that an entry added to a
+  // container is removed before the container's name list is restored.
+  while (_journal.size() > frameStart) {
+
+    VRJournalEntry &je = _journal.back();
+    switch (je.action) {
+    case VRJOURNAL_ADDED:
+      _eraseEntry(je.entry);
+      break;
+
+    case VRJOURNAL_MODIFIED:
+      {
+        // The datum may be linked under names we can't easily find, so
+        // if its attributes change back, the select index has to go.
+        const VRDatum &current = *je.datum;
+        const VRDatum &saved = *je.saved;
+        if (current.getAttributeList() != saved.getAttributeList()) _selectIndexDrop();
+      }
+      je.datum->copyValueFrom(*je.saved);
+      je.datum->journalFrame = je.savedFrame;
+      _spareDatums[je.saved->getType()].push_back(je.saved);
+      break;
+
+    case VRJOURNAL_REPLACED:
+      _selectIndexRemove(je.entry);
+      je.entry->second = je.datum;
+      _selectIndexAdd(je.entry);
+      _entryChanged(je.entry->first);
+      break;
+    }
+    _journal.pop_back();
+  }
+}
+
+void VRDataIndex::_journalModified(VRDataMap::iterator entry) {
 
-    if (it->second->pop()) {
-      _theIndex.erase(it++);
+  if (_journalFrames.empty()) return;
 
-    } else {
+  // Only the first change to a datum within a frame needs a record.
+  // Records are kept by datum rather than by name, since two linked
+  // names share one datum.  A datum added within this frame will be
+  // erased on the pop anyway.  Either way it carries the frame's id.
+  VRDatum *target = &(*entry->second);
+  const uint64_t frame = _journalFrames.back().id;
+  if (target->journalFrame == frame) return;
 
-      ++it;
-    }
+  std::vector<VRDatumPtr> &spares = _spareDatums[target->getType()];
+  if (spares.empty()) {
+    _journal.push_back(VRJournalEntry(VRJOURNAL_MODIFIED, entry,
+                                      entry->second, entry->second.clone(),
+                                      target->journalFrame));
+  } else {
+    spares.back()->copyValueFrom(*target);
+    _journal.push_back(VRJournalEntry(VRJOURNAL_MODIFIED, entry,
+                                      entry->second, spares.back(),
+                                      target->journalFrame));
+    spares.pop_back();
   }
+  target->journalFrame = frame;
+}
+
+void VRDataIndex::_journalReplaced(VRDataMap::iterator entry) {
+
+  if (_journalFrames.empty()) return;
+
+  // This isn't de-duplicated: if the datum was modified before being
+  // replaced, the pop will put the datum back and then restore its value.
+  _journal.push_back(VRJournalEntry(VRJOURNAL_REPLACED, entry,
+                                    entry->second, entry->second));
 }
 
+void VRDataIndex::_forgetJournalEntry(VRDataMap::iterator entry) {
+
+  // Records of a modified datum can stay; restoring a value nobody can
+  // see any more is harmless.
+  size_t i = 0;
+  while (i < _journal.size()) {
+    if ((_journal[i].action != VRJOURNAL_MODIFIED) &&
+        (_journal[i].entry == entry)) {
+
+      _journal.erase(_journal.begin() + i);
+      for (size_t f = 0; f < _journalFrames.size(); f++) {
+        if (_journalFrames[f].start > i) _journalFrames[f].start--;
+      }
+    } else {
+      i++;
+    }
+  }
+}
 
 // Combining the name and the namespace allows the caller to
 // 'inherit' values from higher-up namespaces.  Consider this example:
@@ -879,21 +1322,21 @@ void VRDataIndex::popState() {
 //  namespace.
 VRDataIndex::VRDataMap::iterator
 VRDataIndex::_getEntry(const std::string &key,
-                       const std::string nameSpace,
+                       const std::string &nameSpace,
                        const bool inherit) {
 
   // If the input key begins with a "/", it is a fully qualified
   // name already.  That is, it already includes the name space.
   if (key[0] == '/') {
 
-    _lastDatum = _theIndex.find(key);
+    _lastDatum = _findEntry(key);
     return _lastDatum;
 
-  } else if ((nameSpace.size() == 1) && (nameSpace.compare("/") == 0)) {
+  } else if ((nameSpace.size() == 1) && (nameSpace[0] == '/')) {
     // If we are looking for something in the root name space, that's
     // not so different than using a fully-qualified name.
 
-    _lastDatum = _theIndex.find(nameSpace + key);
+    _lastDatum = _findHashed(fnvRootHash, nameSpace, 1, key);
     return _lastDatum;
 
   } else {
@@ -904,45 +1347,253 @@ VRDataIndex::_getEntry(const std::string &key,
     // specified.  So answering the query for an entry to match the
     // given name requires looking through the senior namespaces.
 
-    std::string validatedNameSpace = validateNameSpace(nameSpace);
+    const VRNameSpaceChain &chain = _getNameSpaceChain(nameSpace);
 
     // If inheritance is turned off, just check if this name exists.
     if (!inherit) {
-      _lastDatum = _theIndex.find(validatedNameSpace + key);
+      _lastDatum = _findHashed(chain.prefixHashes.back(), chain.nameSpace,
+                               chain.prefixLengths.back(), key);
       return _lastDatum;
     }
 
-    // Separate the name space into its constituent elements.
-    std::vector<std::string> elems = _explodeName(validatedNameSpace);
-
     // We start from the longest name space and peel off the rightmost
     // element each iteration until we find a match, or not.  This
     // provides for the most local version of key to prevail.  The
-    // last iteration creates an empty testSpace, on purpose, to test
-    // the root level nameSpace.
-    for (int N = (int)elems.size(); N >= 0; --N) {
-
-      std::vector<std::string> names(&elems[0], &elems[0] + N);
-      std::string testSpace;
-
-      for (std::vector<std::string>::iterator it = names.begin();
-           it != names.end(); ++it) {
-
-        testSpace += *it + "/" ;
-      }
+    // last one tested is the root namespace.
+    for (int N = (int)chain.prefixLengths.size() - 1; N >= 0; --N) {
 
-      _lastDatum = _theIndex.find(testSpace + key);
-      if (_lastDatum != _theIndex.end()) {
+      _lastDatum = _findHashed(chain.prefixHashes[N], chain.nameSpace,
+                               chain.prefixLengths[N], key);
+      if (_lastDatum != _store->theIndex.end()) {
         return _lastDatum;
       }
     }
 
     // If we are here, there is no matching name in the index.
-    _lastDatum = _theIndex.end();
+    _lastDatum = _store->theIndex.end();
     return _lastDatum;
   }
 }
 
+const VRDataIndex::VRNameSpaceChain &
+VRDataIndex::_getNameSpaceChain(const std::string &nameSpace) {
+
+  VRNameSpaceChainMap::const_iterator it = _nameSpaceChains.find(nameSpace);
+  if (it != _nameSpaceChains.end()) return it->second;
+
+  // This throws an error if the namespace does not exist, so we only
+  // ever cache valid namespaces.
+  VRNameSpaceChain chain;
+  chain.nameSpace = validateNameSpace(nameSpace);
+
+  // Record the hash of every prefix that ends in a slash.
+  uint64_t h = fnvOffsetBasis;
+  for (size_t i = 0; i < chain.nameSpace.size(); i++) {
+    h = fnvHash(h, &chain.nameSpace[i], 1);
+    if (chain.nameSpace[i] == '/') {
+      chain.prefixLengths.push_back(i + 1);
+      chain.prefixHashes.push_back(h);
+    }
+  }
+
+  return _nameSpaceChains.insert(VRNameSpaceChainMap::value_type(nameSpace,
+                                                                 chain)).first->second;
+}
+
+VRDataIndex::VRDataMap::iterator
+VRDataIndex::_findHashed(const uint64_t prefixHash,
+                         const std::string &prefix,
+                         const size_t prefixLength,
+                         const std::string &key) const {
+
+  uint64_t h = fnvHash(prefixHash, key.data(), key.size());
+
+  std::pair<VRHashIndex::const_iterator, VRHashIndex::const_iterator> range =
+    _store->hashIndex.equal_range(h);
+
+  for (VRHashIndex::const_iterator it = range.first; it != range.second; it++) {
+
+    // Guard against hash collisions.
+    const std::string &name = it->second->first;
+    if ((name.size() == prefixLength + key.size()) &&
+        (name.compare(0, prefixLength, prefix, 0, prefixLength) == 0) &&
+        (name.compare(prefixLength, key.size(), key) == 0)) {
+      return it->second;
+    }
+  }
+
+  return const_cast<VRDataIndex*>(this)->_store->theIndex.end();
+}
+
+VRDataIndex::VRDataMap::iterator
+VRDataIndex::_findEntry(const std::string &fullName) const {
+  return _findHashed(fnvOffsetBasis, fullName, 0, fullName);
+}
+
+int VRDataIndex::_handleBucket(const std::string &name) {
+
+  // The last part of the name, not counting a trailing slash.
+  size_t end = name.size();
+  if ((end > 0) && (name[end - 1] == '/')) end--;
+  size_t start = name.rfind('/', (end > 0) ? end - 1 : 0);
+  start = (start == std::string::npos) ? 0 : start + 1;
+  if (start > end) start = end;
+
+  return (int)(fnvHash(fnvOffsetBasis, name.data() + start, end - start) %
+               _numHandleBuckets);
+}
+
+void VRDataIndex::_allEntriesChanged() {
+
+  _handleEpoch = _handleEpochSource.fetch_add(1, std::memory_order_relaxed) + 1;
+  std::fill(_handleGenerations, _handleGenerations + _numHandleBuckets, 0);
+}
+
+const VRDatum *VRDataIndex::_resolveHandle(const std::string &key,
+                                           const std::string &nameSpace,
+                                           const bool inherit) const {
+  VRDataMap::iterator p =
+    const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit);
+  if (p == _store->theIndex.end()) return NULL;
+  return &(*p->second);
+}
+
+std::pair<VRDataIndex::VRDataMap::iterator, bool>
+VRDataIndex::_insertEntry(const std::string &fullName, const VRDatumPtr &datum) {
+
+  std::pair<VRDataMap::iterator, bool> res =
+    _store->theIndex.insert(VRDataMap::value_type(fullName, datum));
+
+  if (res.second) {
+    uint64_t h = fnvHash(fnvOffsetBasis, fullName.data(), fullName.size());
+    _store->hashIndex.insert(VRHashIndex::value_type(h, res.first));
+    _entryChanged(fullName);
+    if (!datum.isNull()) _selectIndexAdd(res.first);
+
+    if (!_journalFrames.empty()) {
+      _journal.push_back(VRJournalEntry(VRJOURNAL_ADDED, res.first,
+                                        datum, datum));
+      if (!datum.isNull()) res.first->second->journalFrame = _journalFrames.back().id;
+    }
+  }
+
+  return res;
+}
+
+void VRDataIndex::_eraseEntry(VRDataMap::iterator entry) {
+
+  uint64_t h = fnvHash(fnvOffsetBasis, entry->first.data(), entry->first.size());
+  std::pair<VRHashIndex::iterator, VRHashIndex::iterator> range =
+    _store->hashIndex.equal_range(h);
+  for (VRHashIndex::iterator it = range.first; it != range.second; it++) {
+    if (it->second == entry) {
+      _store->hashIndex.erase(it);
+      break;
+    }
+  }
+
+  // The removed entry might have been a namespace.
+  if (entry->second->getType() == VRCORETYPE_CONTAINER) _nameSpaceChains.clear();
+
+  if (!entry->second.isNull()) _selectIndexRemove(entry);
+
+  if (_lastDatum == entry) _lastDatum = _store->theIndex.end();
+  _entryChanged(entry->first);
+  _store->theIndex.erase(entry);
+}
+
+void VRDataIndex::_rebuildHashIndex() {
+
+  _store->hashIndex.clear();
+  _nameSpaceChains.clear();
+  _allEntriesChanged();
+  for (VRDataMap::iterator it = _store->theIndex.begin(); it != _store->theIndex.end(); it++) {
+    uint64_t h = fnvHash(fnvOffsetBasis, it->first.data(), it->first.size());
+    _store->hashIndex.insert(VRHashIndex::value_type(h, it));
+  }
+}
+
+const VRDataIndex::VRSelectIndex &VRDataIndex::_getSelectIndex() const {
+
+  VRSelectIndex &select = _store->selectIndex;
+  if (select.built.load(std::memory_order_acquire)) return select;
+
+  std::lock_guard<std::mutex> lock(select.buildMutex);
+  if (select.built.load(std::memory_order_relaxed)) return select;
+
+  for (VRDataMap::const_iterator it = _store->theIndex.begin();
+       it != _store->theIndex.end(); it++) {
+    // The map is in order, so each insertion goes at the end.
+    const VRDatum &datum = *it->second;
+    const VRDatum::VRAttributeList &al = datum.getAttributeList();
+    for (VRDatum::VRAttributeList::const_iterator jt = al.begin(); jt != al.end(); jt++) {
+      VRNameSet &names = select.byAttribute[jt->first];
+      names.insert(names.end(), it->first);
+      VRNameSet &valueNames = select.byAttributeValue[jt->first][jt->second];
+      valueNames.insert(valueNames.end(), it->first);
+    }
+    VRNameSet &typeNames = select.byType[datum.getType()];
+    typeNames.insert(typeNames.end(), it->first);
+  }
+
+  select.built.store(true, std::memory_order_release);
+  return select;
+}
+
+void VRDataIndex::_selectIndexAdd(VRDataMap::const_iterator entry) {
+
+  VRSelectIndex &select = _store->selectIndex;
+  if (!select.built.load(std::memory_order_relaxed)) return;
+
+  const VRDatum &datum = *entry->second;
+  const VRDatum::VRAttributeList &al = datum.getAttributeList();
+  for (VRDatum::VRAttributeList::const_iterator it = al.begin(); it != al.end(); it++) {
+    select.byAttribute[it->first].insert(entry->first);
+    select.byAttributeValue[it->first][it->second].insert(entry->first);
+  }
+  select.byType[datum.getType()].insert(entry->first);
+}
+
+void VRDataIndex::_selectIndexRemove(VRDataMap::const_iterator entry) {
+
+  VRSelectIndex &select = _store->selectIndex;
+  if (!select.built.load(std::memory_order_relaxed)) return;
+
+  const VRDatum &datum = *entry->second;
+  const VRDatum::VRAttributeList &al = datum.getAttributeList();
+  for (VRDatum::VRAttributeList::const_iterator it = al.begin(); it != al.end(); it++) {
+    select.byAttribute[it->first].erase(entry->first);
+    select.byAttributeValue[it->first][it->second].erase(entry->first);
+  }
+  select.byType[datum.getType()].erase(entry->first);
+}
+
+void VRDataIndex::_selectIndexDrop() {
+
+  VRSelectIndex &select = _store->selectIndex;
+  if (!select.built.load(std::memory_order_relaxed)) return;
+
+  select.built.store(false, std::memory_order_relaxed);
+  select.byAttribute.clear();
+  select.byAttributeValue.clear();
+  select.byType.clear();
+}
+
+// A datum that is linked under more than one name has its attributes
+// under all of them, so if there are any links, it's simplest to start
+// over.
+void VRDataIndex::_selectIndexBeforeAttributes(VRDataMap::const_iterator entry) {
+  if (_store->linkRegister.empty()) {
+    _selectIndexRemove(entry);
+  } else {
+    _selectIndexDrop();
+  }
+}
+
+void VRDataIndex::_selectIndexAfterAttributes(VRDataMap::const_iterator entry) {
+  _selectIndexAdd(entry);
+}
+
 std::string VRDataIndex::getFullKey(const std::string &key,
                                     const std::string nameSpace,
                                     const bool inherit) const {
@@ -950,7 +1601,7 @@ std::string VRDataIndex::getFullKey(const std::string &key,
   VRDataMap::const_iterator p =
     const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit);
 
-  if (p == _theIndex.end()) {
+  if (p == _store->theIndex.end()) {
       VRERRORNOADV("Uh-oh. Never heard of " + key + " in namespace " + nameSpace);
   } else {
     return p->first;
@@ -959,12 +1610,12 @@ std::string VRDataIndex::getFullKey(const std::string &key,
 
 // Returns the data object for this name.
 VRDatumPtr VRDataIndex::_getDatum(const std::string &key,
-                                  const std::string nameSpace,
+                                  const std::string &nameSpace,
                                   const bool inherit) {
 
   VRDataMap::iterator p = _getEntry(key, nameSpace, inherit);
 
-  if (p == _theIndex.end()) {
+  if (p == _store->theIndex.end()) {
     VRERRORNOADV("What? Never heard of " + key + " in namespace " + nameSpace);
   } else {
     return p->second;
@@ -973,13 +1624,13 @@ VRDatumPtr VRDataIndex::_getDatum(const std::string &key,
 
 // Returns the data object for this name.
 const VRDatumPtr VRDataIndex::_getDatum(const std::string &key,
-                                  const std::string nameSpace,
+                                  const std::string &nameSpace,
                                   const bool inherit) const {
 
     VRDataMap::const_iterator p =
       const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit);
 
-    if (p == _theIndex.end()) {
+    if (p == _store->theIndex.end()) {
         VRERRORNOADV("Who? Never heard of " + key + " in namespace " + nameSpace);
     } else {
         return p->second;
@@ -991,20 +1642,7 @@ std::string VRDataIndex::addSerializedValue(const std::string serializedData,
                                             const std::string nameSpace,
                                             const bool expand) {
 
-  Cxml *xml = new Cxml();
-  xml->parse_string(serializedData);
-  element *xml_node = xml->get_root_element();
-  element* child = xml_node->get_next_child();
-  std::string out;
-
-  while (child != NULL) {
-
-    out = _walkXML(child, validateNameSpace(nameSpace));
-
-    child = xml_node->get_next_child();
-  }
-
-  delete xml;
+  std::string out = _parseXML(serializedData, validateNameSpace(nameSpace), false);
 
   // If there are nodes in the tree with a 'linknode' attribute,
   // resolve them.
@@ -1133,6 +1771,16 @@ std::string VRDataIndex::addData(const std::string &key, VRStringArray value) {
   return addDataSpecialized<VRStringArray, VRCORETYPE_STRINGARRAY>(key, value);
 }
 
+std::string VRDataIndex::addData(const std::string &key, const VRFloatMatrix4 &value) {
+
+  return addDataSpecialized<VRFloatMatrix4, VRCORETYPE_MATRIX4>(key, value);
+}
+
+std::string VRDataIndex::addData(const std::string &key, const VRFloatVec3 &value) {
+
+  return addDataSpecialized<VRFloatVec3, VRCORETYPE_VEC3>(key, value);
+}
+
 std::string VRDataIndex::addData(const std::string &key,
                                  VRContainer value) {
 
@@ -1140,19 +1788,21 @@ std::string VRDataIndex::addData(const std::string &key,
   if (key.compare("/") == 0)
     VRERRORNOADV("Cannot replace the root namespace");
 
+  _detach();
+
   // All names must be in some namespace. If there is no namespace, put this
   // into the root namespace.
   std::string fixedValName = key;
   if (key[0] != '/') fixedValName = std::string("/") + key;
 
   // Check if the name is already in use.
-  VRDataMap::iterator it = _theIndex.find(fixedValName);
-  if (it == _theIndex.end()) {
+  VRDataMap::iterator it = _findEntry(fixedValName);
+  if (it == _store->theIndex.end()) {
 
     // No.  Create a new object.
     VRDatumPtr obj = _factory.CreateVRDatum(VRCORETYPE_CONTAINER, &value);
     //std::cout << "added " << obj.containerVal()->_getDatum() << std::endl;
-    _theIndex.insert(VRDataMap::value_type(fixedValName, obj));
+    _insertEntry(fixedValName, obj);
 
     // Add this value to the parent container, if any.
     VRContainer cValue;
@@ -1163,6 +1813,7 @@ std::string VRDataIndex::addData(const std::string &key,
 
   } else {
     // Add value to existing container.
+    _journalModified(it);
     it->second.containerVal()->addToValue(value);
   }
   return fixedValName;
@@ -1192,7 +1843,7 @@ std::string VRDataIndex::addData(const std::string &keyAndValue) {
   }
 
   // Got the name, type, value.  Go ahead and insert it into the index.
-  return _processValue(key, type, value, MINVRSEPARATOR);
+  return _processValue(key, type, value, MINVRSEPARATOR, VRNumberCodec::FORMAT_DEFAULT);
 }
 
 // Returns a printable description of the data structure that isn't
@@ -1211,9 +1862,9 @@ std::string VRDataIndex::printStructure(const std::string itemName,
   // If we're printing the entire index, prepend the index name.
   if (itemName.compare("/") == 0) outBuffer += _indexName + "\n";
 
-  // We loop through *all* the values in the _theIndex, and only print
+  // We loop through *all* the values in the _store->theIndex, and only print
   // the ones that are asked for.
-  for (VRDataMap::const_iterator it = _theIndex.begin(); it != _theIndex.end(); ++it) {
+  for (VRDataMap::const_iterator it = _store->theIndex.begin(); it != _store->theIndex.end(); ++it) {
 
     bool printMe = true;
 
@@ -1282,9 +1933,11 @@ bool VRDataIndex::linkNode(const std::string &fullSourceName,
   if (depthLimit > 7)
     VRERROR("Too deep a recursion.", "Did you set up a circular reference?");
 
+  _detach();
+
   // Find source node, fail if it does not exist.
   VRDataMap::iterator sourceEntry = _getEntry(fullSourceName);
-  if (sourceEntry == _theIndex.end())
+  if (sourceEntry == _store->theIndex.end())
     VRERRORNOADV("Can't find the source node: " + fullSourceName);
 
   // It's possible the target name won't start with a '/', in which
@@ -1297,14 +1950,18 @@ bool VRDataIndex::linkNode(const std::string &fullSourceName,
   VRDataMap::iterator targetEntry = _getEntry(fixTargetName);
 
   // Does this name already exist?
-  if (targetEntry != _theIndex.end()) {
+  if (targetEntry != _store->theIndex.end()) {
 
     // Yes.  Make the copy.
+    _journalReplaced(targetEntry);
+    _selectIndexRemove(targetEntry);
     targetEntry->second = sourceNode;
+    _selectIndexAdd(targetEntry);
+    _entryChanged(targetEntry->first);
   } else {
 
     // No. Make an entry in the index, linked to the sourceNode.
-    _theIndex.insert(VRDataMap::value_type(fixTargetName, sourceNode));
+    _insertEntry(fixTargetName, sourceNode);
 
   }
 
@@ -1314,7 +1971,7 @@ bool VRDataIndex::linkNode(const std::string &fullSourceName,
             fullSourceName + " and " + fixTargetName + ".");
 
   // Record the link we made.  This is for use by the copy constructor.
-  _linkRegister[fullSourceName] = fixTargetName;
+  _store->linkRegister[fullSourceName] = fixTargetName;
 
   // If this is a container, recurse into the children, and copy them, too.
   if (sourceNode->getType() == VRCORETYPE_CONTAINER) {
@@ -1368,7 +2025,7 @@ bool VRDataIndex::_linkNodes() {
       linkNode(_getEntry(nameToCopy, nameSpace)->first, *it);
     }
 
-    // Then just modify the entry in _theIndex so that _theIndex[*]->second
+    // Then just modify the entry in the index so that its ->second
     // points to the found node's datum object.
   }
   return true;
@@ -1379,19 +2036,21 @@ bool VRDataIndex::_linkNodes() {
 // links within that namespace to the objects in the given namespace.
 bool VRDataIndex::_linkContent() {
 
+  _detach();
+
   // Find all the containers to be replaced.
   VRContainer targets = selectByAttribute("linkContent", "*");
 
   // Sift through them.
   for (VRContainer::iterator it = targets.begin(); it != targets.end(); it++) {
 
-    VRDataMap::const_iterator target = _getEntry(*it);
+    VRDataMap::iterator target = _getEntry(*it);
     std::string targetNameSpace = _getNameSpace(target->first);
 
     // Identify the source name (for the namespace) and the node.
     VRDataMap::iterator linkEntry =
       _getEntry(target->second->getAttributeValue("linkContent"));
-    if (linkEntry == _theIndex.end()) {
+    if (linkEntry == _store->theIndex.end()) {
       VRERROR("Can't find link target: " +
               target->second->getAttributeValue("linkContent"),
               "Check the spelling?");
@@ -1438,11 +2097,14 @@ bool VRDataIndex::_linkContent() {
       }
 
       // Replace the parent name list.
-      _getDatum(targetParentName).containerVal()->setValue(newList);
+      VRDataMap::iterator parentEntry = _getEntry(targetParentName);
+      _journalModified(parentEntry);
+      parentEntry->second.containerVal()->setValue(newList);
     }
 
     // Delete the entry from the index.
-    _theIndex.erase(target->first);
+    _forgetJournalEntry(target);
+    _eraseEntry(target);
     // Note that you might have done something pathological with
     // linkNode that would result in a corrupted structure after this
     // removal.  That is, there might be another name in the index
@@ -23,7 +23,14 @@
 #define MINVR_DATAINDEX_H
 
 #include "VRDatumFactory.h"
-#include "Cxml/Cxml.h"
+#include "VRXMLParser.h"
+#include "VRNumberCodec.h"
+#include <unordered_map>
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include "stdint.h"
 namespace MinVR {
 
 /// \brief A dynamically-typed data store.
@@ -150,7 +157,12 @@ namespace MinVR {
 ///  commonly used in VR apps can be stored in one or a combination of core
 ///  types.  For example, a 3D point, vector, quaternion, or 4x4 transformation
 ///  matrix can all be stored in a std::vector<float>, and the data index
-///  supports a VRFloatArray type to encapsulate that.
+///  supports a VRFloatArray type to encapsulate that.  Matrices and 3D
+///  vectors are common enough to have core types of their own,
+///  VRFloatMatrix4 and VRFloatVec3, which hold their values in place, so
+///  the VRMatrix4, VRVector3, and VRPoint3 classes go in and out of an index
+///  without allocating anything.  These can also be read as VRFloatArrays,
+///  and a VRFloatArray of the right size can be read as one of them.
 ///
 ///  If you use your own C++ classes for points, vectors, matrices, or other
 ///  objects you would like to store in a VRDataIndex, you can extend your
@@ -182,21 +194,22 @@ namespace MinVR {
 ///    <PixelPosition type="intarray">100, 125</PixelPosition>
 ///    <NormalizedPosition type="floatarray">0.5, 0.65</NormalizedPosition>
 ///    <Modifiers type="stringarray">Shift,Ctrl,Alt</Modifiers>
+///    <Origin type="vec3">0.0, 1.5, 0.0</Origin>
 ///    ~~~
 ///  The `type=` attribute is an optional directive for the parser.  It would
 ///  have been fine to leave it out of the example above because the type can
 ///  be inferred from the content in all but extreme cases (e.g., a string that
-///  contains only numbers).
+///  contains only numbers).  The exceptions are "matrix4" and "vec3", which
+///  are never inferred: an untyped list of sixteen numbers is a floatarray.
 ///
 ///  Containers are also represented as XML elements.  The start tag and end
 ///  tag use the name of the container (and thus the namespace of the contained
 ///  objects).  Container elements contain child elements, which can be either
 ///  other container elements or data elements.
 ///
-///  The XML parser used here is based on the "Simple C++ XML Parser" from the
-///  CodeProject article by "BratilaRazvan", 2010.
-///  see: http:///www.codeproject.com/Articles/111243/Simple-Cplusplus-XML-Parser
-///  It does not currently support entities, or CDATA declarations.
+///  The XML is read with VRXMLParser, a streaming parser that enters each
+///  element into the index as it reads it, without building a tree first.
+///  It supports CDATA sections, but not entities.
 ///
 ///
 ///  ### Serializing an Entire Index
@@ -248,6 +261,18 @@ namespace MinVR {
 ///  Comes out with four entries in the array, "Alpha", "Beta", "Gamma,Delta",
 ///  and "Epsilon".  See indextest.cpp for an example.
 ///
+///  A "format" attribute controls how numbers are written.  Floats are
+///  normally written with six decimal places, which is not quite exact.
+///  With `format="exact"`, a float or float array is written with enough
+///  digits to read back as exactly the same value.  With `format="base64"`,
+///  an int or float array is written as its raw bytes in base64, which is
+///  exact and much more compact for big arrays:
+///    ~~~
+///    <calib type="floatarray" format="base64">2g9JQJMMyT92/YU/</calib>
+///    ~~~
+///  Set it with setAttributeValue().  Like the separator, it stays with the
+///  value when the value is serialized and read back.
+///
 ///
 ///
 ///  ## More about Containers and Namespaces
@@ -398,8 +423,10 @@ public:
   ///
   /// The created index has the default name "MVR", which can be changed with
   /// setName().  The index name is used when the index is serialized.
-  VRDataIndex()  : _indexName("MVR"), _overwrite(1), _linkNeeded(false) {
-    _lastDatum = _theIndex.end();
+  VRDataIndex()  : _store(std::make_shared<VRDataStore>()),
+                   _indexName("MVR"), _overwrite(1), _linkNeeded(false) {
+    _lastDatum = _store->theIndex.end();
+    _allEntriesChanged();
   }
 
   /// \brief Creates an index containing the given data.
@@ -413,25 +440,39 @@ public:
   /// index with the given name.
   VRDataIndex(const std::string serializedData);
 
-  /// \brief Makes a deep copy.
+  /// \brief Makes a copy.
   ///
-  /// The copy constructor makes a deep copy (all the way down) of all the data
-  /// in the data index.
+  /// The copy shares its data with the original until one of them is
+  /// changed, so it costs the same no matter how many entries there are.
+  /// The first addData(), setAttributeValue(), or linkNode() on either
+  /// one makes it a private copy of its own (all the way down) before
+  /// going ahead, so a change to one is never seen in the other.
+  ///
+  /// An index with pushed states that have not been popped is copied
+  /// right away, since its saved states refer to the data it holds.
   VRDataIndex(const VRDataIndex &orig);
 
-  /// \brief Also makes a deep copy.
+  /// \brief Also makes a copy.
   ///
-  /// Like the copy constructor, the assignment operator makes a deep copy,
-  /// too.  Note that the argument is not a reference (i.e. it's a copy
-  /// created by the copy constructor).
+  /// Like the copy constructor, the assignment operator shares the data
+  /// until one side changes it.  Note that the argument is not a reference
+  /// (i.e. it's a copy created by the copy constructor).  Any pushed states
+  /// are discarded.
   VRDataIndex& operator=(const VRDataIndex rhs) {
 
-    _theIndex = rhs._theIndex;
+    _store = rhs._store;
     _indexName = rhs._indexName;
     _overwrite = rhs._overwrite;
-    _linkRegister = rhs._linkRegister;
     _linkNeeded = rhs._linkNeeded;
 
+    _lastDatum = _store->theIndex.end();
+    _nameSpaceChains.clear();
+    _allEntriesChanged();
+
+    // Any pushed states referred to the old contents.
+    _journal.clear();
+    _journalFrames.clear();
+
     return *this;
   };
 
@@ -487,6 +528,16 @@ public:
   /// \copydoc VRDataIndex::addData(const std::string &key, VRInt value);
   std::string addData(const std::string &key, VRStringArray value);
 
+  /// \copydoc VRDataIndex::addData(const std::string &key, VRInt value);
+  ///
+  /// If the name is already in use by a VRFloatArray, the matrix is stored
+  /// there as an array, and the same goes the other way around: adding a
+  /// VRFloatArray of sixteen elements to a matrix stores it as a matrix.
+  std::string addData(const std::string &key, const VRFloatMatrix4 &value);
+
+  /// \copydoc VRDataIndex::addData(const std::string &key, const VRFloatMatrix4 &value);
+  std::string addData(const std::string &key, const VRFloatVec3 &value);
+
 
   /// \copydoc VRDataIndex::addData(const std::string &key, VRInt value);
   ///
@@ -551,6 +602,16 @@ public:
     return addData(name, object.toVRFloatArray());
   }
 
+  /// For classes that implement the VRFloatMatrix4Convertible interface.
+  std::string addData(const std::string &name, const VRFloatMatrix4Convertible &object) {
+    return addData(name, object.toVRFloatMatrix4());
+  }
+
+  /// For classes that implement the VRFloatVec3Convertible interface.
+  std::string addData(const std::string &name, const VRFloatVec3Convertible &object) {
+    return addData(name, object.toVRFloatVec3());
+  }
+
   /// For classes that implement the VRStringArrayConvertible interface.
   std::string addData(const std::string &name, const VRStringArrayConvertible &object) {
     return addData(name, object.toVRStringArray());
@@ -625,12 +686,12 @@ public:
   /// \param inherit Set to false if you only want values from the specified
   /// container/namespace and not inherit from any namespace above.
   VRAnyCoreType getValue(const std::string &key,
-                         const std::string nameSpace = "",
+                         const std::string &nameSpace = "",
                          const bool inherit = true) const {
     VRDataMap::iterator p =
       const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit);
 
-    if (p == _theIndex.end()) {
+    if (p == _store->theIndex.end()) {
       if (nameSpace.empty()) {
         VRERRORNOADV("Never heard of " + key + ".");
       } else {
@@ -653,7 +714,7 @@ public:
   /// ~~~
   VRAnyCoreType getValue() const {
 
-    if (_lastDatum == _theIndex.end()) {
+    if (_lastDatum == _store->theIndex.end()) {
       VRERROR("Bad key access in data index.",
               "The no-arg version of getValue() must be preceded by a call to exists().");
     } else {
@@ -684,12 +745,12 @@ public:
   template <typename T>
   T getValueWithDefault(const std::string &key,
                         const T &defaultVal,
-                        const std::string nameSpace = "",
+                        const std::string &nameSpace = "",
                         const bool inherit = true) const {
     VRDataMap::iterator p =
       const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit);
 
-    if (p == _theIndex.end()) {
+    if (p == _store->theIndex.end()) {
       return defaultVal;
     } else {
       return p->second->getValue();
@@ -720,7 +781,7 @@ public:
   /// This is comparable to the argument-free getValue().  Use it to
   /// get the type of whatever you looked for last.
   VRCORETYPE_ID getType() {
-    if (_lastDatum == _theIndex.end()) {
+    if (_lastDatum == _store->theIndex.end()) {
       VRERRORNOADV("Bad key access in data index.");
     } else {
       return _lastDatum->second->getType();
@@ -747,7 +808,7 @@ public:
   /// This is comparable to the argument-free getValue().  Use it to
   /// get the description of whatever you looked for last.
   std::string getTypeString() {
-    if (_lastDatum == _theIndex.end()) {
+    if (_lastDatum == _store->theIndex.end()) {
       VRERRORNOADV("Bad key access in data index.");
     } else {
       return _lastDatum->second->getDescription();
@@ -774,7 +835,7 @@ public:
   /// This is comparable to the argument-free getValue().  Use it to
   /// get the full name of whatever you looked for last.
   std::string getFullKey() {
-    if (_lastDatum == _theIndex.end()) {
+    if (_lastDatum == _store->theIndex.end()) {
       VRERRORNOADV("Bad key access in data index.");
     } else {
       return _lastDatum->first;
@@ -804,9 +865,9 @@ public:
   /// Otherwise, it will search in parent nameSpaces for the matching
   /// key.  (Default: true)
   bool exists(const std::string &key,
-              const std::string nameSpace = "",
+              const std::string &nameSpace = "",
               const bool inherit = true) const {
-	  return const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit) != _theIndex.end();
+	  return const_cast<VRDataIndex*>(this)->_getEntry(key, nameSpace, inherit) != _store->theIndex.end();
   }
 
   ///@}
@@ -903,6 +964,34 @@ public:
   /// The serialize method does not record any links in the index.
   std::string serialize() const;
 
+  /// \brief Returns a compact binary representation of the entire index.
+  ///
+  /// This is a versioned, length-prefixed encoding meant for the network,
+  /// where the XML form is expensive to produce and to parse.  It is not
+  /// human-readable.  (VRConfigCache keeps it in files, but checks that
+  /// they are still up to date before using them.)  Every entry is recorded
+  /// with its full name, type, attributes, and value; floats are recorded
+  /// bit-for-bit, so a round trip is exact.  Like serialize(), it does not
+  /// record links.  The constructor that takes a serialized string will
+  /// accept either this or the XML form.
+  std::string serializeBinary() const;
+
+  /// \brief Incorporates data produced by serializeBinary() into the index.
+  ///
+  /// Entries are merged into the index following the same overwrite rules
+  /// as addData().  The index name in the binary data is ignored; use the
+  /// constructor if you want to adopt it.
+  void addSerializedBinary(const std::string &binaryData);
+
+  /// \brief The same, reading the encoding straight from memory.
+  void addSerializedBinary(const char *binaryData, const size_t size);
+
+  /// \brief Returns true if the input looks like the output of serializeBinary().
+  static bool isBinary(const std::string &serializedData);
+
+  /// The version of the binary encoding written by serializeBinary().
+  static const unsigned char binaryVersion;
+
   /// Incorporates a serialized bit of data into the data index within
   /// the specified container.
   /// \param serializedData XML-formatted data, such as is output from
@@ -993,29 +1082,31 @@ public:
   /// \name Saving and restoring state.
   ///
   /// The data index has a "state" that can be saved.  If you "push" the state
-  /// onto the stack, it can be restored later with a "pop", which will delete
+  /// onto the stack, it can be restored later with a "pop", which will undo
   /// any of the changes made to the index after the push.  (Though it cannot
-  /// restore data values deleted after a push.)
+  /// restore data values deleted after a push.)  See also VRDataIndexScope,
+  /// which pops the state for you at the end of a block.
 
   /// \brief Saves the current index state.
   ///
   /// The data index has a state that can be pushed and popped.  All the
   /// changes to the index made after a pushState() can be rolled back by
-  /// calling popState().  This works by pushing and popping values for each of
-  /// the VRDatum objects represented in the index.  Values that were added to
-  /// the index after a push will be deleted on a pop, but the system cannot
-  /// restore deleted values.
-  ///
-  /// The stack is recorded at the level of the data values, so there is
-  /// currently no way to record a name of a stack entry, or even to count
-  /// them.  Too many pops will delete entries from your data index, so it's
-  /// up to you to be careful about keeping it symmetric.
+  /// calling popState().  Nothing is copied at the push.  Instead, the index
+  /// keeps a journal of the changes made since, recording the old value of
+  /// an entry the first time it is modified, and the name of each entry
+  /// added.  So a push and pop costs in proportion to the number of values
+  /// changed in between, not to the size of the index, and the space used to
+  /// save old values is reused from one push to the next.
+  ///
+  /// Values that were added to the index after a push will be deleted on a
+  /// pop, but the system cannot restore deleted values.  Pushes nest, and
+  /// each pop undoes only the changes made since the matching push.
   void pushState();
 
   /// \brief Restores the index state to the last push.
   ///
-  /// Replaces the current contents of the data index with the data saved via
-  /// an earlier call to pushState().
+  /// Undoes all the changes made to the data index since the matching call
+  /// to pushState().  Calling this without a matching push is an error.
   void popState();
 
   ///@}
@@ -1156,7 +1247,7 @@ public:
    /// \brief Does the index have any entries?
   ///
   /// \return A boolean value, true if empty.
-  bool empty() { return _theIndex.empty(); };
+  bool empty() const { return _store->theIndex.empty(); };
   ///@}
 
 
@@ -1167,9 +1258,174 @@ private:
   typedef std::map<std::string, VRDatumPtr> VRDataMap;
   // Aspirational:
   //typedef std::map<std::string, std::vector<VRDatumPtr> > VRDataMap;
-  VRDataMap _theIndex;
+
+  // The ordered map above owns the names and the data, and gives the
+  // serializers and the select methods their order.  Lookups go through
+  // this hash table instead, which maps the hash of a full name to its
+  // entry in the map, so each name is stored only once.  The hash is
+  // FNV-1a, which can be computed piecewise, so a namespace and a key
+  // can be looked up together without concatenating them.
+  typedef std::unordered_multimap<uint64_t, VRDataMap::iterator> VRHashIndex;
+
+  // Indices for the select methods, so they need not look at every
+  // entry: for each attribute, the names that have it, and for each
+  // value of it, the names that have that value, and the names of each
+  // type.  The sets are ordered like the map, and a namespace's contents
+  // are a contiguous range of any of them.  They are built the first
+  // time one of the select methods is called, and kept up to date from
+  // then on by the methods that add, remove, and change entries.  A
+  // change that is awkward to follow (an attribute of a datum that is
+  // linked under several names, say) just drops them, to be built again
+  // when they are next wanted.
+  typedef std::set<std::string> VRNameSet;
+  struct VRSelectIndex {
+    VRSelectIndex() : built(false) {}
+    std::atomic<bool> built;
+    // Copies sharing a store can select from different threads.
+    std::mutex buildMutex;
+    std::map<std::string, VRNameSet> byAttribute;
+    std::map<std::string, std::map<std::string, VRNameSet> > byAttributeValue;
+    std::map<VRCORETYPE_ID, VRNameSet> byType;
+  };
+
+  // The entries themselves, and everything that points into them.  Copies
+  // of an index share one of these until one of them is changed; see
+  // _detach().
+  struct VRDataStore {
+    VRDataMap theIndex;
+    VRHashIndex hashIndex;
+
+    // We need this to keep track of links so a copy can tell which
+    // names were linked.
+    std::map<std::string, std::string> linkRegister;
+
+    VRSelectIndex selectIndex;
+  };
+  std::shared_ptr<VRDataStore> _store;
   VRDataMap::iterator _lastDatum;
 
+  // Gives this index a private copy of its store, if it is sharing one.
+  // Every method that changes the entries calls this before it looks
+  // anything up, since the copy invalidates iterators into the old one.
+  // Datums are cloned once apiece, so names linked to the same datum
+  // still are afterward.
+  void _detach();
+
+  // The namespaces senior to a given one, longest last, with the hash of
+  // each, so that inherited lookups need not rebuild any strings.  These
+  // are computed the first time a namespace is used in a lookup, and are
+  // discarded whenever something is removed from the index.
+  struct VRNameSpaceChain {
+    std::string nameSpace;             // validated, e.g. "/a/b/"
+    std::vector<size_t> prefixLengths; // e.g. 1, 3, 5 for "/", "/a/", "/a/b/"
+    std::vector<uint64_t> prefixHashes;
+  };
+  typedef std::unordered_map<std::string, VRNameSpaceChain> VRNameSpaceChainMap;
+  VRNameSpaceChainMap _nameSpaceChains;
+
+  // All insertions into and removals from the map go through these,
+  // to keep the hash index in step.
+  std::pair<VRDataMap::iterator, bool> _insertEntry(const std::string &fullName,
+                                                    const VRDatumPtr &datum);
+  void _eraseEntry(VRDataMap::iterator entry);
+  void _rebuildHashIndex();
+
+  // Maintenance of the select index.  The add and remove methods do
+  // nothing until it has been built.
+  const VRSelectIndex &_getSelectIndex() const;
+  void _selectIndexAdd(VRDataMap::const_iterator entry);
+  void _selectIndexRemove(VRDataMap::const_iterator entry);
+  void _selectIndexDrop();
+  // For when an entry's datum is about to have its attributes changed,
+  // and once they have been.
+  void _selectIndexBeforeAttributes(VRDataMap::const_iterator entry);
+  void _selectIndexAfterAttributes(VRDataMap::const_iterator entry);
+
+  // What a VRDataHandle checks to tell whether what it found last time
+  // is still the answer.  Adding, removing, or relinking an entry can
+  // only change the answer for keys with the same last part as its name
+  // ("HeadMatrix" for "/MinVR/HeadMatrix"), so each such change counts
+  // against the bucket of that last part, and handles for other names
+  // don't notice.  The epoch changes when everything might have, as when
+  // the index is copied; its values are drawn from one counter shared by
+  // all indices, so no two indices are ever in the same epoch.
+  static const int _numHandleBuckets = 64;
+  static int _handleBucket(const std::string &name);
+  uint64_t _handleGenerations[_numHandleBuckets];
+  uint64_t _handleEpoch;
+  static std::atomic<uint64_t> _handleEpochSource;
+  void _entryChanged(const std::string &fullName) {
+    _handleGenerations[_handleBucket(fullName)]++;
+  }
+  void _allEntriesChanged();
+
+  // Does the lookup for a VRDataHandle.  Returns NULL if there is no match.
+  const VRDatum *_resolveHandle(const std::string &key,
+                                const std::string &nameSpace,
+                                const bool inherit) const;
+  friend class VRDataHandle;
+
+  // The journal of changes made since a pushState(), in the order they
+  // were made.  Each pushed state is a frame, beginning at the recorded
+  // position in the journal, and popState() undoes a frame's changes in
+  // reverse order.
+  enum VRJournalAction {
+    VRJOURNAL_ADDED,    // entry was created; erase it
+    VRJOURNAL_MODIFIED, // datum was changed; copy the saved value back in
+    VRJOURNAL_REPLACED  // entry was pointed at another datum; point it back
+  };
+  struct VRJournalEntry {
+    VRJournalAction action;
+    VRDataMap::iterator entry;
+    VRDatumPtr datum;  // The changed or the displaced datum.
+    VRDatumPtr saved;  // A copy of the old value, for VRJOURNAL_MODIFIED.
+    uint64_t savedFrame;  // The datum's journalFrame before, likewise.
+
+    VRJournalEntry(const VRJournalAction a, const VRDataMap::iterator e,
+                   const VRDatumPtr &d, const VRDatumPtr &s,
+                   const uint64_t f = 0) :
+      action(a), entry(e), datum(d), saved(s), savedFrame(f) {};
+  };
+  std::vector<VRJournalEntry> _journal;
+
+  // Each frame has an id, which is stamped on the datums whose values it
+  // has saved, or that it added, so that a datum is saved only once per
+  // frame without searching the journal.  The ids are unique across all
+  // indices, since a copy of an index starts with copies of its datums.
+  struct VRJournalFrame {
+    size_t start;
+    uint64_t id;
+  };
+  std::vector<VRJournalFrame> _journalFrames;
+  static std::atomic<uint64_t> _journalFrameSource;
+
+  // Datum objects used to hold saved values, recycled by type after a
+  // pop so that a steady stream of pushes and pops doesn't allocate.
+  std::vector<VRDatumPtr> _spareDatums[VRCORETYPE_NTYPES];
+
+  // Call these *before* changing an entry.  They do nothing when no
+  // state has been pushed.
+  void _journalModified(VRDataMap::iterator entry);
+  void _journalReplaced(VRDataMap::iterator entry);
+
+  // Drops any journal records about an entry that is about to be
+  // removed from the index for good.
+  void _forgetJournalEntry(VRDataMap::iterator entry);
+
+  // Looks up prefix + key, where prefixHash is the hash of the first
+  // prefixLength characters of prefix.
+  VRDataMap::iterator _findHashed(const uint64_t prefixHash,
+                                  const std::string &prefix,
+                                  const size_t prefixLength,
+                                  const std::string &key) const;
+
+  // Looks up a fully-qualified name.
+  VRDataMap::iterator _findEntry(const std::string &fullName) const;
+
+  // Returns the (cached) chain for a namespace.  Throws an error like
+  // validateNameSpace() does if there is no such namespace.
+  const VRNameSpaceChain &_getNameSpaceChain(const std::string &nameSpace);
+
   // This is the name of the data index itself.
   std::string _indexName;
 
@@ -1185,19 +1441,38 @@ private:
 
   // These functions read an XML-encoded string and produce the value
   // implied.  There is no deserializeContainer, since that's what
-  // _walkXML does.
+  // _parseXML does.
   VRInt _deserializeInt(const std::string valueString);
   VRFloat _deserializeFloat(const std::string valueString);
   VRString _deserializeString(const std::string valueString);
-  VRIntArray _deserializeIntArray(const std::string valueString, const char separator);
+  VRIntArray _deserializeIntArray(const std::string valueString, const char separator,
+                                  const VRNumberCodec::Format format);
   VRFloatArray _deserializeFloatArray(const std::string valueString,
-                                      const char separator);
+                                      const char separator,
+                                      const VRNumberCodec::Format format);
   VRStringArray _deserializeStringArray(const std::string valueString,
                                         const char separator);
+  // These two read into the value given, and complain if the text has
+  // the wrong number of elements.
+  void _deserializeFixed(const std::string &name, const std::string &valueString,
+                         const char separator, const VRNumberCodec::Format format,
+                         float *values, const size_t n);
 
   // Serializes the given VRDatum object, using the given name.
   std::string _serialize(const std::string &name, const VRDatumPtr &pdata) const;
 
+  // Reads the binary index encoding, starting after the magic tag and
+  // version, and returns the index name recorded there.
+  std::string _deserializeBinary(const char *binaryData, const size_t size);
+
+  // Adds one entry read from the binary encoding.  With bulk set (the
+  // index was empty to begin with) the entry goes straight in, otherwise
+  // it goes through addData() like any other.
+  template <typename T, const VRCORETYPE_ID TID>
+  std::string _addDeserialized(const std::string &name, T &value,
+                               const VRDatum::VRAttributeList &attrs,
+                               const bool bulk);
+
 
   // Just a utility to return the tail end of the fully qualified name.
   // i.e. trimName("cora/flora", "/bob/nora") is "flora".  This does not
@@ -1211,14 +1486,29 @@ private:
   // Returns the namespace, derived from a long, fully-qualified, name.
   static std::string _getNameSpace(const std::string &fullName);
 
-  // Start from the root node of an XML document and process the
-  // results into entries in the data index.
-  std::string _walkXML(element* node, std::string nameSpace);
-  // A functional part of the walkXML apparatus.
+  // Reads XML into the index, entering each element as the parser
+  // reaches it.  If skipRoot is true, the document's root element names
+  // the index, and its children go in the given namespace.  Otherwise
+  // the top-level elements themselves go there.  Returns the name of the
+  // last top-level element entered.
+  std::string _parseXML(const std::string &xml, const std::string &nameSpace,
+                        const bool skipRoot);
+
+  // The parser's handler for _parseXML().
+  class XMLLoader;
+
+  // Enters one element into the index, given its text and attributes.
+  // This is where the type is worked out and the value deserialized.
+  std::string _addXMLElement(const std::string &qualifiedName,
+                             const VRXMLAttributeList &attributes,
+                             const VRXMLSpan &value,
+                             const bool hasChild);
+  // A functional part of the _addXMLElement apparatus.
   std::string _processValue(const std::string &name,
                            VRCORETYPE_ID &type,
                            std::string valueString,
-                           const char separator);
+                           const char separator,
+                           const VRNumberCodec::Format format);
 
   /// \brief Finds an entry in the data index.
   ///
@@ -1253,7 +1543,7 @@ private:
   /// Otherwise, it will search in parent nameSpaces for the matching
   /// key.  (Default: true)
   VRDataMap::iterator _getEntry(const std::string &key,
-                                const std::string nameSpace = "",
+                                const std::string &nameSpace = "",
                                 const bool inherit = true);
 
   // Returns a pointer to the value with a given name (and namespace)
@@ -1265,7 +1555,7 @@ private:
   /// Otherwise, it will search in parent nameSpaces for the matching
   /// key.  (Default: true)
   VRDatumPtr _getDatum(const std::string &key,
-                       const std::string nameSpace = "",
+                       const std::string &nameSpace = "",
                        const bool inherit = true);
 
   // Returns a pointer to the value with a given name (and namespace)
@@ -1277,7 +1567,7 @@ private:
   /// Otherwise, it will search in parent nameSpaces for the matching
   /// key.  (Default: true)
   const VRDatumPtr _getDatum(const std::string &key,
-                             const std::string nameSpace = "",
+                             const std::string &nameSpace = "",
                              const bool inherit = true) const;
 
   // These are specialized set methods.  They seem a little unhip, but
@@ -1299,8 +1589,36 @@ private:
     p.intArrayVal()->setValue(value);
   }
 
+  // A matrix or vector can be stored in an existing float array, and
+  // an array of the right size in an existing matrix or vector.
   void _setValueSpecialized(VRDatumPtr p, VRFloatArray value) {
-    p.floatArrayVal()->setValue(value);
+    if ((p->getType() == VRCORETYPE_MATRIX4) && (value.size() == 16)) {
+      VRFloatMatrix4 m;
+      std::copy(value.begin(), value.end(), m.data());
+      p.matrix4Val()->setValue(m);
+    } else if ((p->getType() == VRCORETYPE_VEC3) && (value.size() == 3)) {
+      VRFloatVec3 v;
+      std::copy(value.begin(), value.end(), v.data());
+      p.vec3Val()->setValue(v);
+    } else {
+      p.floatArrayVal()->setValue(value);
+    }
+  }
+
+  void _setValueSpecialized(VRDatumPtr p, const VRFloatMatrix4 &value) {
+    if (p->getType() == VRCORETYPE_FLOATARRAY) {
+      p.floatArrayVal()->setValue(VRFloatArray(value.data(), value.data() + value.size()));
+    } else {
+      p.matrix4Val()->setValue(value);
+    }
+  }
+
+  void _setValueSpecialized(VRDatumPtr p, const VRFloatVec3 &value) {
+    if (p->getType() == VRCORETYPE_FLOATARRAY) {
+      p.floatArrayVal()->setValue(VRFloatArray(value.data(), value.data() + value.size()));
+    } else {
+      p.vec3Val()->setValue(value);
+    }
   }
 
   void _setValueSpecialized(VRDatumPtr p, VRStringArray value) {
@@ -1310,19 +1628,22 @@ private:
   template <typename T, const VRCORETYPE_ID TID>
   std::string addDataSpecialized(const std::string key, T value) {
 
+    _detach();
+
     // All names must be in some namespace. If there is no namespace,
     // put this into the root namespace.
     std::string fixedValName = key;
     if (key[0] != '/') fixedValName = std::string("/") + key;
 
     std::pair<VRDataMap::iterator, bool>res =
-      _theIndex.insert(VRDataMap::value_type(fixedValName, (VRDatumPtr)NULL));
+      _insertEntry(fixedValName, (VRDatumPtr)NULL);
 
     // Was it already used?
     if (res.second) {
 
       VRDatumPtr obj = _factory.CreateVRDatum(TID, &value);
       res.first->second = obj;
+      _selectIndexAdd(res.first);
 
       // Add this value to the parent container, if any.
       VRContainer cValue;
@@ -1336,6 +1657,7 @@ private:
       // Entry already exists. Decide whether to modify or throw an exception.
       if (_overwrite > 0) {
 
+        _journalModified(res.first);
         _setValueSpecialized(res.first->second, (T)value);
 
       } else if (_overwrite == 0) {
@@ -1358,10 +1680,6 @@ private:
   // from the specified container.
   bool _linkContent();
 
-  // We need this to keep track of links so we can make a deep copy that
-  // includes any links that might exist.
-  std::map<std::string, std::string> _linkRegister;
-
   // If this is false, we don't need to do linkNodes() or linkContent().
   bool _linkNeeded;
 
@@ -1370,6 +1688,43 @@ private:
   }
 };
 
+/// \brief Pushes the state of a data index for the life of a block.
+///
+/// Construct one of these at the top of a block to call pushState() on the
+/// index, and the matching popState() happens when it goes out of scope,
+/// however the block is left.  This is meant for the display nodes, which
+/// add values to the render state for their children to use:
+///
+/// ~~~
+///   void VRSomeNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler) {
+///     VRDataIndexScope scope(renderState);
+///     renderState->addData("SomeValue", 42);
+///     VRDisplayNode::render(renderState, renderHandler);
+///   }
+/// ~~~
+///
+/// If the state was already popped by then, that is a warning rather than
+/// an error, since a destructor can't throw while an exception is on its way
+/// out of the block.
+class VRDataIndexScope {
+public:
+  VRDataIndexScope(VRDataIndex *index) : _index(index) { _index->pushState(); };
+  ~VRDataIndexScope() {
+    try {
+      _index->popState();
+    } catch (VRError &e) {
+      VRWARNING(e.what(), "Don't pop the state pushed by a VRDataIndexScope.");
+    }
+  };
+
+private:
+  VRDataIndex *_index;
+
+  // Not copyable; that would pop twice.
+  VRDataIndexScope(const VRDataIndexScope&);
+  VRDataIndexScope& operator=(const VRDataIndexScope&);
+};
+
 /// \brief A class to hold an arbitrary event.
 ///
 /// An event in MinVR is just a VRDataIndex object.
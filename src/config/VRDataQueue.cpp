@@ -1,5 +1,10 @@
 #include "VRDataQueue.h"
+#include "VRBinaryCodec.h"
 #include <main/VRError.h>
+#include <atomic>
+#ifndef WIN32
+#include <time.h>
+#endif
 
 
 namespace MinVR {
@@ -7,8 +12,13 @@ namespace MinVR {
 // Use this when the client has no new data to offer.
 const VRDataQueue::serialData VRDataQueue::noData = "";
 
+// The binary encoding starts with this tag, followed by the version byte.
+static const char binaryQueueMagic[] = { 'M', 'V', 'R', 'Q' };
+const unsigned char VRDataQueue::binaryVersion = 1;
+
 
-VRDataQueue::VRDataQueue(const VRDataQueue::serialData serializedQueue) {
+VRDataQueue::VRDataQueue(const VRDataQueue::serialData serializedQueue) :
+  _head(0), _count(0) {
 
   addSerializedQueue(serializedQueue);
 
@@ -21,6 +31,37 @@ VRDataQueue::VRDataQueue(const VRDataQueue::serialData serializedQueue) {
 // to another, even if it more or less honors the look and feel of XML.
 void VRDataQueue::addSerializedQueue(const VRDataQueue::serialData serializedQueue) {
 
+  // Combining with events already here means merging by time.  Read the
+  // new events into a queue of their own first, so they can be merged in
+  // one pass instead of one at a time.
+  if (notEmpty()) {
+    VRDataQueue newQueue(serializedQueue);
+    _merge(newQueue);
+    return;
+  }
+
+  // The binary encoding is much simpler to read.
+  if (isBinary(serializedQueue)) {
+
+    VRBinaryReader in(serializedQueue, sizeof(binaryQueueMagic));
+
+    unsigned char version = in.getByte();
+    if (version > binaryVersion) {
+      VRERRORNOADV("Serialized queue uses a newer binary encoding than this code understands.");
+    }
+
+    uint32_t numIncluded = in.getUInt32();
+    for (uint32_t i = 0; i < numIncluded; i++) {
+      long long timeStamp = (long long)in.getInt64();
+      push(timeStamp, in.getString());
+    }
+
+    if (!in.atEnd()) {
+      VRERRORNOADV("Serialized queue appears corrupted.");
+    }
+    return;
+  }
+
   // Looking for the number in <VRDataQueue num="X">
   if (serializedQueue.size() < 18) return;
 
@@ -62,33 +103,79 @@ void VRDataQueue::addSerializedQueue(const VRDataQueue::serialData serializedQue
 
 void VRDataQueue::addQueue(const VRDataQueue newQueue) {
 
-  if (newQueue.notEmpty()) {
+  if (newQueue.notEmpty()) _merge(newQueue);
+}
+
+void VRDataQueue::_reserve(const size_t n) {
+
+  if (n <= _ring.size()) return;
+
+  size_t newSize = _ring.empty() ? 16 : _ring.size();
+  while (newSize < n) newSize *= 2;
+
+  // Unwrap the items into the new buffer, starting at zero.
+  std::vector<VRDataListItem> newRing(newSize);
+  for (size_t i = 0; i < _count; i++) {
+    std::swap(newRing[i], _at(i));
+  }
+  _ring.swap(newRing);
+  _head = 0;
+}
 
-    for (VRDataQueue::const_iterator it = newQueue.begin();
-         it != newQueue.end(); it++) {
-      // We only want the time value of the timestamp, not the disambiguation
-      // value.
-      push(it->first.first, it->second);
+// Both queues are already in time order, so this is the merge step of a
+// merge sort.  Where times are equal, the items already in this queue
+// come first.
+void VRDataQueue::_merge(const VRDataQueue &other) {
+
+  std::vector<VRDataListItem> merged;
+  size_t newSize = _ring.empty() ? 16 : _ring.size();
+  while (newSize < _count + other._count) newSize *= 2;
+  merged.resize(newSize);
+
+  size_t i = 0, j = 0, k = 0;
+  while ((i < _count) || (j < other._count)) {
+    if ((j == other._count) ||
+        ((i < _count) && (_at(i).first.first <= other._at(j).first.first))) {
+      std::swap(merged[k], _at(i++));
+    } else {
+      merged[k] = other._at(j++);
     }
+    merged[k].first.second =
+      _nextSequence(k ? &merged[k - 1] : NULL, merged[k].first.first);
+    k++;
   }
+
+  _ring.swap(merged);
+  _head = 0;
+  _count = k;
 }
 
-VRDataIndex VRDataQueue::getFirst() const {
-  if (_dataMap.empty()) {
+const VRDataIndex &VRDataQueue::getFirst() const {
+  if (_count == 0) {
 
-    return VRDataIndex();
+    static const VRDataIndex emptyIndex;
+    return emptyIndex;
   } else {
 
-    return _dataMap.begin()->second.getData();
+    return _at(0).second.getData();
   }
 }
 
 void VRDataQueue::pop() {
-  _dataMap.erase(_dataMap.begin());
+
+  if (_count == 0) return;
+
+  // Let go of the event, but keep the slot.
+  _at(0).second = VRDataQueueItem();
+  _head = (_head + 1) & (_ring.size() - 1);
+  _count--;
 }
 
 void VRDataQueue::clear() {
-  _dataMap.clear();
+
+  for (size_t i = 0; i < _count; i++) _at(i).second = VRDataQueueItem();
+  _head = 0;
+  _count = 0;
 }
 
 // Suggested on Stackoverflow:
@@ -112,7 +199,25 @@ void VRDataQueue::clear() {
 // makes lots of events have the same time stamp.
 
 
-long long VRDataQueue::makeTimeStamp() {
+// Microseconds from a clock that only goes forward.
+static long long monotonicMicroseconds() {
+
+#ifdef WIN32
+  LARGE_INTEGER count, frequency;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&frequency);
+  return (long long)((count.QuadPart / frequency.QuadPart) * 1000000LL +
+                     ((count.QuadPart % frequency.QuadPart) * 1000000LL) /
+                     frequency.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+#endif
+}
+
+// Microseconds since 1970 by the system clock.
+static long long wallClockMicroseconds() {
 
 #ifdef WIN32
 	LARGE_INTEGER t1;
@@ -133,31 +238,48 @@ long long VRDataQueue::makeTimeStamp() {
 		GetSystemTimeAsFileTime(&ft);
 	}
 
-	
 	t1.LowPart = ft.dwLowDateTime;
 	t1.HighPart = ft.dwHighDateTime;
 
-	long long timeStamp = t1.QuadPart;
+  // FILETIME counts 100ns intervals since 1601.
+  return (t1.QuadPart - 116444736000000000LL) / 10;
 #else
 
   struct timeval tp;
   gettimeofday(&tp, NULL);
 
-  // Get current timestamp in milliseconds.
-  long long timeStamp = (long long) tp.tv_sec * 1000000L + tp.tv_usec;
+  return (long long) tp.tv_sec * 1000000L + tp.tv_usec;
 
 #endif
+}
+
+long long VRDataQueue::makeTimeStamp() {
+
+  // Measured once, the first time through.
+  static const long long wallClockOffset =
+    wallClockMicroseconds() - monotonicMicroseconds();
 
-  return timeStamp;
+  // No two stamps made in this process are the same, so events made
+  // within a microsecond of each other keep the order they were made in
+  // when their queues are merged.
+  static std::atomic<long long> lastStamp(0);
+
+  long long now = monotonicMicroseconds() + wallClockOffset;
+  long long last = lastStamp.load();
+  long long stamp;
+  do {
+    stamp = (now > last) ? now : last + 1;
+  } while (!lastStamp.compare_exchange_weak(last, stamp));
+
+  return stamp;
 }
 
 void VRDataQueue::push(const VRDataQueue::serialData serializedData) {
   push(makeTimeStamp(), serializedData);
 }
 
-void VRDataQueue::push(const VRDataIndex event) {
-  VRDataIndex* eventPtr = new VRDataIndex(event);
-  push(makeTimeStamp(), VRDataQueueItem(eventPtr));
+void VRDataQueue::push(const VRDataIndex &event) {
+  push(makeTimeStamp(), VRDataQueueItem(event));
 }
 
 void VRDataQueue::push(const long long timeStamp,
@@ -168,24 +290,33 @@ void VRDataQueue::push(const long long timeStamp,
 void VRDataQueue::push(const long long timeStamp,
                        const VRDataQueueItem queueItem) {
 
-  VRTimeStamp testStamp = VRTimeStamp(timeStamp, 0);
-  while (_dataMap.find(testStamp) != _dataMap.end()) {
-    testStamp = VRTimeStamp(timeStamp, testStamp.second + 1);
+  _reserve(_count + 1);
+
+  // Find the spot.  Usually this is the end, but a timestamp supplied by
+  // the caller might be out of order, so move later items up to make room.
+  size_t pos = _count;
+  while ((pos > 0) && (_at(pos - 1).first.first > timeStamp)) {
+    std::swap(_at(pos), _at(pos - 1));
+    pos--;
   }
 
-  _dataMap.insert(VRDataListItem(testStamp, queueItem));
+  VRDataListItem &slot = _at(pos);
+  slot.first = VRTimeStamp(timeStamp,
+                           _nextSequence(pos ? &_at(pos - 1) : NULL, timeStamp));
+  slot.second = queueItem;
+  _count++;
 }
 
 
 VRDataQueue::serialData VRDataQueue::serialize() {
 
   std::ostringstream lenStr;
-  lenStr << _dataMap.size();
+  lenStr << _count;
 
   VRDataQueue::serialData out;
 
   out = "<VRDataQueue num=\"" + lenStr.str() + "\">";
-  for (VRDataList::iterator it = _dataMap.begin(); it != _dataMap.end(); ++it) {
+  for (VRDataQueue::const_iterator it = begin(); it != end(); ++it) {
     std::ostringstream timeStamp;
     timeStamp << it->first.first << "-" << std::setfill('0') << std::setw(3) << it->first.second;
     out += "<VRDataQueueItem timeStamp=\"" + timeStamp.str() + "\">" +
@@ -196,6 +327,34 @@ VRDataQueue::serialData VRDataQueue::serialize() {
   return out;
 }
 
+// The binary form is:
+//
+//   "MVRQ" version:u8 numItems:u32 { timeStamp:i64 item:str }*
+//
+// where str is a u32 length followed by that many bytes.  As with the XML
+// form, only the time value of each timestamp is sent; the receiver
+// assigns its own disambiguation values.
+VRDataQueue::serialData VRDataQueue::serializeBinary() {
+
+  VRBinaryWriter out;
+
+  out.putRaw(binaryQueueMagic, sizeof(binaryQueueMagic));
+  out.putByte(binaryVersion);
+  out.putUInt32((uint32_t)_count);
+  for (VRDataQueue::const_iterator it = begin(); it != end(); ++it) {
+    out.putInt64(it->first.first);
+    out.putString(it->second.serializeBinary());
+  }
+
+  return out.str();
+}
+
+bool VRDataQueue::isBinary(const VRDataQueue::serialData &serializedQueue) {
+  return (serializedQueue.size() > sizeof(binaryQueueMagic)) &&
+    (serializedQueue.compare(0, sizeof(binaryQueueMagic), binaryQueueMagic,
+                             sizeof(binaryQueueMagic)) == 0);
+}
+
 // DEBUG only
 std::string VRDataQueue::printQueue() const {
 
@@ -203,8 +362,7 @@ std::string VRDataQueue::printQueue() const {
 
   char buf[6];  // No queues more than a million entries long.
   int i = 0;
-  for (VRDataList::const_iterator it = _dataMap.begin();
-       it != _dataMap.end(); ++it) {
+  for (VRDataQueue::const_iterator it = begin(); it != end(); ++it) {
     sprintf(buf, "%d", ++i);
     std::string identifier = "element";
     if (it->second.isSerialized()) {
@@ -14,6 +14,8 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <iterator>
 #include <sstream>
 #include <iostream>
 #include <iomanip>
@@ -36,6 +38,7 @@
 #endif
 #include <stdio.h>
 #include <stdexcept>
+#include <memory>
 
 #include <config/VRDataIndex.h>
 
@@ -53,37 +56,76 @@ namespace MinVR {
 /// the data all the time.
 class VRDataQueueItem {
 private:
-  VRDataIndex* _dataIndex;
+  // The event as a data index.  This may belong to someone else, or it
+  // may point into _ownIndex.  For an item that arrived serialized, it
+  // stays NULL until somebody asks for the data.
+  mutable VRDataIndex* _dataIndex;
+  mutable std::shared_ptr<VRDataIndex> _ownIndex;
   std::string _serialData;
 
 public:
   VRDataQueueItem() : _dataIndex(NULL), _serialData("") {};
+
+  /// \brief Wraps a data index owned by the caller.
+  ///
+  /// The index is not copied, so it must outlive the queue item.
   VRDataQueueItem(VRDataIndex* index) :
     _dataIndex(index), _serialData("") {};
+
+  /// \brief Wraps a copy of a data index.
+  ///
+  /// The copy is shared by all copies of this queue item, and deleted when
+  /// the last of them goes.
+  VRDataQueueItem(const VRDataIndex &index) :
+    _ownIndex(new VRDataIndex(index)), _serialData("") {
+    _dataIndex = _ownIndex.get();
+  };
+
   VRDataQueueItem(std::string str) : _dataIndex(NULL), _serialData(str) {};
 
   /// \brief Flag to say whether the entry is serialized or not.
   ///
   /// This is mostly for debugging, perhaps just for the curious.
-  bool isSerialized() const { return (_dataIndex == NULL); };
+  bool isSerialized() const { return (_dataIndex == NULL) || !_serialData.empty(); };
 
   /// \brief Return the serialized version of this queue item.
+  ///
+  /// This is always XML, even if the item arrived in the binary format.
   std::string serialize() const {
-    if (_dataIndex) {
-      return _dataIndex->serialize();
+    if (_serialData.empty()) {
+      return _dataIndex ? _dataIndex->serialize() : _serialData;
+    } else if (VRDataIndex::isBinary(_serialData)) {
+      return getData().serialize();
     } else {
       return _serialData;
     }
   }
 
-  /// \brief Return the data index version of this queue item.
-  VRDataIndex getData() const {
-    if (_dataIndex) {
-      return *_dataIndex;
+  /// \brief Return this queue item in a form for the binary queue format.
+  ///
+  /// Items that are already serialized are passed along as they are,
+  /// whichever format they are in, since the VRDataIndex constructor can
+  /// read either.
+  std::string serializeBinary() const {
+    if (_serialData.empty() && _dataIndex) {
+      return _dataIndex->serializeBinary();
     } else {
-      return VRDataIndex(_serialData);
+      return _serialData;
     }
   }
+
+  /// \brief Return the data index version of this queue item.
+  ///
+  /// Serialized data is parsed the first time this is called, and the
+  /// result kept for later calls, so an event delivered to several
+  /// handlers is only parsed once.
+  const VRDataIndex &getData() const {
+    if (_dataIndex == NULL) {
+      _ownIndex.reset(new VRDataIndex(_serialData));
+      _dataIndex = _ownIndex.get();
+    }
+    return *_dataIndex;
+  }
 };
 
 
@@ -100,10 +142,18 @@ public:
 /// The system is meant to support network operations -- where the entire
 /// queue is sent across a network and therefore must be serialized -- as
 /// well as threaded operation, where no network and no serialization are
-/// necessary.  Thus the queue is a map between timestamps and objects that
-/// can contain either a std::string of serialized data or a pointer to a
+/// necessary.  Thus the queue holds, in timestamp order, objects that can
+/// contain either a std::string of serialized data or a pointer to a
 /// VRDataIndex object.
 ///
+/// The items are kept in a ring buffer whose slots are reused as items are
+/// popped and pushed, so a queue that is filled and emptied every frame
+/// stops allocating once it has grown to its working size.  Events pushed
+/// in time order go on the end without any searching, and events with the
+/// same time come out in the order they were pushed.  A full merge by
+/// timestamp only happens when two non-empty queues are combined, as when
+/// the events from several network nodes are gathered together.
+///
 /// Use this queue for sending data to some other process, or receiving
 /// it.  The transmission format is the same XML format as in the
 /// VRDataIndex description.
@@ -127,8 +177,32 @@ private:
   /// same time step.
   typedef std::pair<long long,int> VRTimeStamp;
   typedef std::pair<VRTimeStamp,VRDataQueueItem> VRDataListItem;
-  typedef std::map<VRTimeStamp,VRDataQueueItem> VRDataList;
-  VRDataList _dataMap;
+
+  // The ring buffer.  Its size is always zero or a power of two, and the
+  // items run from _head for _count slots, wrapping around the end.
+  std::vector<VRDataListItem> _ring;
+  size_t _head;
+  size_t _count;
+
+  VRDataListItem &_at(const size_t i) {
+    return _ring[(_head + i) & (_ring.size() - 1)];
+  }
+  const VRDataListItem &_at(const size_t i) const {
+    return _ring[(_head + i) & (_ring.size() - 1)];
+  }
+
+  // Makes room for at least n items.
+  void _reserve(const size_t n);
+
+  // Merges a queue, already in time order, into this one.
+  void _merge(const VRDataQueue &other);
+
+  // The disambiguation value for an item going in after prev: the items
+  // with the same time value are numbered 0, 1, 2, ... in the order they
+  // were pushed.
+  static int _nextSequence(const VRDataListItem *prev, const long long timeStamp) {
+    return (prev && (prev->first.first == timeStamp)) ? prev->first.second + 1 : 0;
+  }
 
   friend std::ostream & operator<<(std::ostream &os, const VRDataQueue& dq) {
     return os << dq.printQueue();
@@ -138,29 +212,74 @@ private:
 public:
 
   /// \brief Create an empty queue.
-  VRDataQueue() {};
+  VRDataQueue() : _head(0), _count(0) {};
 
   /// \brief Create a queue from serialized data.
   VRDataQueue(const serialData serializedQueue);
 
   static const serialData noData;
 
+  /// \brief Steps through the queue in time order.
+  ///
+  /// Dereferencing one of these gives a pair whose `first` is the
+  /// timestamp, and whose `second` is the VRDataQueueItem.  Like an
+  /// iterator into a std::deque, it is invalidated by a push or a pop.
+  template <class Q, class V>
+  class VRDataQueueIterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef V value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef V* pointer;
+    typedef V& reference;
+
+    VRDataQueueIterator() : _queue(NULL), _i(0) {};
+    VRDataQueueIterator(Q *queue, const size_t i) : _queue(queue), _i(i) {};
+
+    // So that an iterator can become a const_iterator.
+    template <class Q2, class V2>
+    VRDataQueueIterator(const VRDataQueueIterator<Q2, V2> &other) :
+      _queue(other._queue), _i(other._i) {};
+
+    V &operator*() const { return _queue->_at(_i); };
+    V *operator->() const { return &(_queue->_at(_i)); };
+
+    VRDataQueueIterator &operator++() { _i++; return *this; };
+    VRDataQueueIterator operator++(int) {
+      VRDataQueueIterator out = *this;
+      _i++;
+      return out;
+    };
+
+    bool operator==(const VRDataQueueIterator &other) const {
+      return (_queue == other._queue) && (_i == other._i);
+    };
+    bool operator!=(const VRDataQueueIterator &other) const {
+      return !(*this == other);
+    };
+
+  private:
+    template <class Q2, class V2> friend class VRDataQueueIterator;
+    Q *_queue;
+    size_t _i;
+  };
+
   /// The easiest way to create an iterator to the queue.
-  typedef VRDataList::iterator iterator;
+  typedef VRDataQueueIterator<VRDataQueue, VRDataListItem> iterator;
   /// The easiest way to create an iterator to the queue.
-  typedef VRDataList::const_iterator const_iterator;
+  typedef VRDataQueueIterator<const VRDataQueue, const VRDataListItem> const_iterator;
 
   /// \brief Returns an iterator to the first item in the queue.
-  iterator begin() { return _dataMap.begin(); }
+  iterator begin() { return iterator(this, 0); }
   /// \brief Returns an iterator to the first item in the queue.
-  const_iterator begin() const { return _dataMap.begin(); }
+  const_iterator begin() const { return const_iterator(this, 0); }
   /// \brief Returns an iterator past the last item in the queue.
-  iterator end() { return _dataMap.end(); }
+  iterator end() { return iterator(this, _count); }
   /// \brief Returns an iterator past the last item in the queue.
-  const_iterator end() const { return _dataMap.end(); }
+  const_iterator end() const { return const_iterator(this, _count); }
 
-  /// Process a chunk of XML into queue items and add them to the
-  /// existing queue.
+  /// Process a chunk of XML (or the binary encoding) into queue items and
+  /// add them to the existing queue.
   void addSerializedQueue(const serialData serializedQueue);
 
   /// \brief Add another queue's data to this one.
@@ -175,20 +294,23 @@ public:
   /// This one is more efficient than returning the negation so that
   /// the user can negate it. There is also an empty() for those who
   /// want something more traditional.
-  bool notEmpty() const { return (bool)_dataMap.size(); }
+  bool notEmpty() const { return _count > 0; }
 
   /// \brief A boolean to determine whether there is anything in the queue.
   ///
   /// A more traditional test.
-  bool empty() const { return !(bool)_dataMap.size(); }
+  bool empty() const { return _count == 0; }
 
   /// \brief Returns the event at the head of the queue.
   ///
-  /// Does not remove the item.
-  VRDataIndex getFirst() const;
+  /// Does not remove the item.  The reference is good until the item is
+  /// popped, so it can be handed to any number of event handlers without
+  /// copying or re-parsing the event.  For an empty queue, this returns an
+  /// empty index.
+  const VRDataIndex &getFirst() const;
 
   /// \brief Return the first item in the queue with its timestamp.
-  VRDataListItem getFirstItem() const { return *_dataMap.begin(); };
+  VRDataListItem getFirstItem() const { return _at(0); };
 
   /// \brief Removes the object at the front of the queue.
   ///
@@ -199,10 +321,18 @@ public:
   void clear();
 
   /// \brief Makes a timestamp from system facilities.
+  ///
+  /// The value is in microseconds.  It comes from a monotonic clock
+  /// (CLOCK_MONOTONIC, or the performance counter on Windows), so it never
+  /// runs backward if the system clock is adjusted.  It is offset to match
+  /// the wall clock as it read the first time this was called, so that
+  /// timestamps from different machines with synchronized clocks can still
+  /// be compared when their queues are merged.  Each call returns a
+  /// later stamp than the one before, even within a microsecond.
   long long makeTimeStamp();
 
   /// \brief Adds an event to the queue.
-  void push(const VRDataIndex event);
+  void push(const VRDataIndex &event);
   /// \brief Adds a serialized event to the queue.
   void push(const serialData eventString);
 
@@ -223,6 +353,20 @@ public:
   /// \brief Serialize the whole queue into a piece of XML.
   serialData serialize();
 
+  /// \brief Serialize the whole queue into the binary format.
+  ///
+  /// This is the versioned, length-prefixed encoding used for network
+  /// transmission when both ends support it.  See
+  /// VRDataIndex::serializeBinary() for the item encoding.
+  /// addSerializedQueue() and the constructor accept either format.
+  serialData serializeBinary();
+
+  /// \brief Returns true if the input looks like the output of serializeBinary().
+  static bool isBinary(const serialData &serializedQueue);
+
+  /// The version of the binary encoding written by serializeBinary().
+  static const unsigned char binaryVersion;
+
   /// \brief An output function.
   ///
   /// Mostly for debugging, prints a list of the queue elements.  An asterisk
@@ -231,7 +375,7 @@ public:
   std::string printQueue() const;
 
   /// \brief How big is the queue?
-  int size() { return (int)_dataMap.size(); };
+  int size() const { return (int)_count; };
 
 };
 
@@ -1,7 +1,13 @@
 #include "VRDatum.h"
+#include "VRNumberCodec.h"
 
 namespace MinVR {
 
+void VRDatumPtr::destroy() {
+  delete pData;
+  delete reference;
+}
+
 // This is the canonical list of how to spell the types given here.
 // The strings here will appear in the XML serialization, in the
 // 'type="XX"' part.  So you can change them here, and these changes
@@ -18,6 +24,8 @@ VRDatum::VRTypeMap VRDatum::initializeTypeMap() {
   newTypeMap["floatarray"] = VRCORETYPE_FLOATARRAY;
   newTypeMap["stringarray"] = VRCORETYPE_STRINGARRAY;
   newTypeMap["container"] = VRCORETYPE_CONTAINER;
+  newTypeMap["matrix4"] = VRCORETYPE_MATRIX4;
+  newTypeMap["vec3"] = VRCORETYPE_VEC3;
 
   return newTypeMap;
 };
@@ -25,7 +33,7 @@ VRDatum::VRTypeMap VRDatum::initializeTypeMap() {
 VRDatum::VRTypeMap VRDatum::typeMap = VRDatum::initializeTypeMap();
 
   // The constructor for the native storage form.
-VRDatum::VRDatum(const VRCORETYPE_ID inType) : type(inType) {
+VRDatum::VRDatum(const VRCORETYPE_ID inType) : type(inType), journalFrame(0) {
 
   // Store an empty attribute list.
   attrList.push_front(VRAttributeList());
@@ -54,9 +62,8 @@ std::string VRDatum::getAttributeListAsString() const {
 /// Step 4 in the adding a type instructions.
 //////////////////////////////////////////// VRInt
 std::string VRDatumInt::getValueString() const {
-  char buffer[20];
-  sprintf(buffer, "%d", value.front());
-  return std::string(buffer);
+  char buffer[VRNumberCodec::bufferSize];
+  return std::string(buffer, VRNumberCodec::formatInt(value, buffer));
 }
 
 VRDatumPtr CreateVRDatumInt(void *pData) {
@@ -66,9 +73,10 @@ VRDatumPtr CreateVRDatumInt(void *pData) {
 
 //////////////////////////////////////////// VRFloat
 std::string VRDatumFloat::getValueString() const {
-  char buffer[20];
-  sprintf(buffer, "%f", value.front());
-  return std::string(buffer);
+  char buffer[VRNumberCodec::bufferSize];
+  bool exact = VRNumberCodec::getFormat(getAttributeValue("format")) ==
+    VRNumberCodec::FORMAT_EXACT;
+  return std::string(buffer, VRNumberCodec::formatFloat(value, buffer, exact));
 }
 
 VRDatumPtr CreateVRDatumFloat(void *pData) {
@@ -86,7 +94,6 @@ VRDatumPtr CreateVRDatumString(void *pData) {
 std::string VRDatumIntArray::getValueString() const {
 
   std::string out;
-  char buffer[20];
   char separator;
 
   VRAttributeList::const_iterator it = attrList.front().find("separator");
@@ -96,15 +103,9 @@ std::string VRDatumIntArray::getValueString() const {
     separator = static_cast<char>(it->second[0]);
   }
 
-  for (VRIntArray::const_iterator it = value.front().begin();
-       it != value.front().end(); ++it) {
-    sprintf(buffer, "%d%c", *it, separator);
-
-    out += std::string(buffer);
-  }
-
-  // Remove trailing separator.
-  return out.substr(0, out.size() - 1);
+  VRNumberCodec::appendIntArray(out, value, separator,
+                                VRNumberCodec::getFormat(getAttributeValue("format")));
+  return out;
 }
 
 VRDatumPtr CreateVRDatumIntArray(void *pData) {
@@ -117,7 +118,6 @@ VRDatumPtr CreateVRDatumIntArray(void *pData) {
 std::string VRDatumFloatArray::getValueString() const {
 
   std::string out;
-  char buffer[20];
   char separator;
 
   VRAttributeList::const_iterator it = attrList.front().find("separator");
@@ -127,14 +127,9 @@ std::string VRDatumFloatArray::getValueString() const {
     separator = static_cast<char>(it->second[0]);
   }
 
-  for (VRFloatArray::const_iterator it = value.front().begin();
-       it != value.front().end(); ++it) {
-    sprintf(buffer, "%f%c", *it, separator);
-    out += std::string(buffer);
-  }
-
-  // Remove trailing separator.
-  return out.substr(0, out.size() - 1);
+  VRNumberCodec::appendFloatArray(out, value, separator,
+                                  VRNumberCodec::getFormat(getAttributeValue("format")));
+  return out;
 }
 
 VRDatumPtr CreateVRDatumFloatArray(void *pData) {
@@ -143,6 +138,28 @@ VRDatumPtr CreateVRDatumFloatArray(void *pData) {
   return VRDatumPtr(obj);
 }
 
+VRFloatMatrix4 VRDatumFloatArray::getValueMatrix4() const {
+  if (value.size() < 16) {
+    std::stringstream ss;
+    ss << "This VRFloatArray has " << value.size() << " elements, too few for a VRFloatMatrix4.";
+    VRERRORNOADV(ss.str());
+  }
+  VRFloatMatrix4 out;
+  std::copy(value.begin(), value.begin() + out.size(), out.data());
+  return out;
+}
+
+VRFloatVec3 VRDatumFloatArray::getValueVec3() const {
+  if (value.size() < 3) {
+    std::stringstream ss;
+    ss << "This VRFloatArray has " << value.size() << " elements, too few for a VRFloatVec3.";
+    VRERRORNOADV(ss.str());
+  }
+  VRFloatVec3 out;
+  std::copy(value.begin(), value.begin() + out.size(), out.data());
+  return out;
+}
+
 //////////////////////////////////////////// VRStringArray
 std::string VRDatumStringArray::getValueString() const {
   std::string out;
@@ -155,8 +172,8 @@ std::string VRDatumStringArray::getValueString() const {
     separator = static_cast<char>(it->second[0]);
   }
 
-  for (VRStringArray::const_iterator it = value.front().begin();
-       it != value.front().end(); ++it) {
+  for (VRStringArray::const_iterator it = value.begin();
+       it != value.end(); ++it) {
     out += *it + std::string(1,separator);
   }
 
@@ -187,8 +204,8 @@ std::string VRDatumContainer::getValueString() const {
     separator = static_cast<char>(it->second[0]);
   }
 
-  for (VRContainer::const_iterator it = value.front().begin();
-       it != value.front().end(); ++it) {
+  for (VRContainer::const_iterator it = value.begin();
+       it != value.end(); ++it) {
     out += *it + std::string(1,separator);
   }
 
@@ -201,20 +218,20 @@ bool VRDatumContainer::addToValue(const VRContainer inVal) {
 
   // If we need to push a new container onto the stack, do it here.
   if (needPush) {
-    value.push_front( value.front() );
+    pushedValues.push_front( value );
     attrList.push_front( attrList.front() );
     needPush = false;
     pushed = true;
   }
 
   // Remove all duplicates from the input list.
-  for (VRContainer::const_iterator it = value.front().begin();
-       it != value.front().end(); ++it) {
+  for (VRContainer::const_iterator it = value.begin();
+       it != value.end(); ++it) {
 
     inCopy.remove(*it);
   }
 
-  value.front().splice(value.front().end(), inCopy);
+  value.splice(value.end(), inCopy);
   return true;
 }
 
@@ -234,6 +251,39 @@ VRDatumPtr CreateVRDatumContainer(void *pData) {
 }
 
 
+//////////////////////////////////////////// VRFloatMatrix4
+// These are written the same way as a VRFloatArray, so a matrix read
+// back without its type= attribute is just an array.
+static std::string fixedFloatArrayString(const float *values, const size_t n,
+                                         const VRDatum &datum) {
+  std::string separator = datum.getAttributeValue("separator");
+  std::string out;
+  VRNumberCodec::appendFloats(out, values, n,
+                              separator.empty() ? MINVRSEPARATOR : separator[0],
+                              VRNumberCodec::getFormat(datum.getAttributeValue("format")));
+  return out;
+}
+
+std::string VRDatumMatrix4::getValueString() const {
+  return fixedFloatArrayString(value.data(), value.size(), *this);
+}
+
+VRDatumPtr CreateVRDatumMatrix4(void *pData) {
+  VRDatumMatrix4 *obj = new VRDatumMatrix4(*static_cast<VRFloatMatrix4 *>(pData));
+  return VRDatumPtr(obj);
+}
+
+//////////////////////////////////////////// VRFloatVec3
+std::string VRDatumVec3::getValueString() const {
+  return fixedFloatArrayString(value.data(), value.size(), *this);
+}
+
+VRDatumPtr CreateVRDatumVec3(void *pData) {
+  VRDatumVec3 *obj = new VRDatumVec3(*static_cast<VRFloatVec3 *>(pData));
+  return VRDatumPtr(obj);
+}
+
+
 //  Implemented for completeness sake.
 std::ostream & operator<<(std::ostream &os, const VRDatum& p) {
   return os << p.getValueString();
@@ -13,6 +13,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <cstdlib>
+#include <stdint.h>
 #include <sstream>
 
 namespace MinVR {
@@ -61,6 +62,8 @@ public:
   operator VRFloatArray() const { return datum->getValueFloatArray(); }
   operator VRStringArray() const { return datum->getValueStringArray(); }
   operator VRContainer() const { return datum->getValueContainer(); }
+  operator VRFloatMatrix4() const { return datum->getValueMatrix4(); }
+  operator VRFloatVec3() const { return datum->getValueVec3(); }
 
   operator const VRInt*() {return datum->getPointerInt(); }
   operator const VRFloat*() const { return datum->getPointerFloat(); }
@@ -69,6 +72,8 @@ public:
   operator const VRFloatArray*() const { return datum->getPointerFloatArray(); }
   operator const VRStringArray*() const { return datum->getPointerStringArray(); }
   operator const VRContainer*() const { return datum->getPointerContainer(); }
+  operator const VRFloatMatrix4*() const { return datum->getPointerMatrix4(); }
+  operator const VRFloatVec3*() const { return datum->getPointerVec3(); }
 };
 
 
@@ -172,6 +177,10 @@ protected:
 public:
   VRDatum(const VRCORETYPE_ID inType);
 
+  // The pushed state of a VRDataIndex that last saved this datum's value,
+  // or added it.  See VRDataIndex::_journalModified().
+  uint64_t journalFrame;
+
   // virtual destructor allows concrete types to implement their own
   // destruction mechanisms.  Specifically, types that involve
   // pointers should be careful to delete their objects.
@@ -184,7 +193,7 @@ public:
   // There is also a 'separator=' attribute that indicates a character
   // to use in the serialized version of an array.
   VRAttributeList getAttributeList() { return attrList.front(); };
-  const VRAttributeList getAttributeList() const { return attrList.front(); };
+  const VRAttributeList &getAttributeList() const { return attrList.front(); };
   void setAttributeList(VRAttributeList newList) { attrList.front() = newList; };
   std::string getAttributeValue(const std::string attributeName) const {
     VRAttributeList::const_iterator attr = attrList.front().find(attributeName);
@@ -237,6 +246,10 @@ public:
   virtual void push() = 0;
   virtual bool pop() = 0;
 
+  // Overwrites the current value and attributes of this datum with
+  // those of another datum of the same type.
+  virtual void copyValueFrom(const VRDatum &other) = 0;
+
   // Less generic getValue methods.  One of these is to be overridden
   // in each specialization of this class.  The others are here to
   // prevent bad behavior, and throw an error if the programmer
@@ -283,6 +296,18 @@ public:
   virtual const VRContainer* getPointerContainer() const {
     VRERROR("This datum is not a VRContainer.", "It is a " + description + ".");
   }
+  virtual VRFloatMatrix4 getValueMatrix4() const {
+    VRERROR("This datum is not a VRFloatMatrix4.", "It is a " + description + ".");
+  }
+  virtual const VRFloatMatrix4* getPointerMatrix4() const {
+    VRERROR("This datum is not a VRFloatMatrix4.", "It is a " + description + ".");
+  }
+  virtual VRFloatVec3 getValueVec3() const {
+    VRERROR("This datum is not a VRFloatVec3.", "It is a " + description + ".");
+  }
+  virtual const VRFloatVec3* getPointerVec3() const {
+    VRERROR("This datum is not a VRFloatVec3.", "It is a " + description + ".");
+  }
 };
 
 typedef VRDatumConverter<VRDatum> VRAnyCoreType;
@@ -299,29 +324,30 @@ typedef VRDatumConverter<VRDatum> VRAnyCoreType;
 template <class T, const VRCORETYPE_ID TID>
 class VRDatumSpecialized : public VRDatum {
 protected:
-  // The actual data is stored here.  It is stored as a std::list, so
-  // that we can push context frames onto the stack.
-  std::list<T> value;
+  // The actual data is stored here.  The values it had before a push()
+  // are kept on a stack of their own, so the current one needs no more
+  // space than T itself, and a datum that is never pushed holds only
+  // that.
+  T value;
+  std::list<T> pushedValues;
 
   bool needPush, pushed;
   int stackFrame;
 
 public:
   VRDatumSpecialized(const T inVal):
-    VRDatum(TID), needPush(false), pushed(false), stackFrame(1) {
-    value.push_front(inVal);
-  };
+    VRDatum(TID), value(inVal), needPush(false), pushed(false), stackFrame(1) {};
 
   bool setValue(const T inVal) {
     // This is a little optimization.  You only need to push things
     // onto the stack if the value actually changes.
     if (needPush) {
-      value.push_front( value.front() );
+      pushedValues.push_front( value );
       attrList.push_front( attrList.front() );
       needPush = false;
       pushed = true;
     }
-    value.front() = inVal;
+    value = inVal;
     return true;
   }
 
@@ -342,7 +368,8 @@ public:
   bool pop() {
     stackFrame--;
     if (pushed && (stackFrame > 0)) {
-      value.pop_front();
+      std::swap(value, pushedValues.front());
+      pushedValues.pop_front();
       attrList.pop_front();
       pushed = false;
     };
@@ -352,6 +379,21 @@ public:
     // indicate a datum should be cleaned up.
     return (stackFrame <= 0);
   };
+
+  // The data index uses this to save a value and put it back later.
+  // The copy is made into an existing datum, so the space allocated for
+  // an array or a string can be reused, and it is restored into the
+  // original datum, so anything linked to it sees the restored value.
+  void copyValueFrom(const VRDatum &other) {
+    if (other.getType() != TID) {
+      VRERRORNOADV("Cannot copy a " + other.getDescription() +
+                   " value into a " + description + ".");
+    }
+    const VRDatumSpecialized<T, TID> &src =
+      static_cast<const VRDatumSpecialized<T, TID>&>(other);
+    value = src.value;
+    attrList.front() = src.attrList.front();
+  };
 };
 
 // This is the specialization for an integer.
@@ -360,11 +402,11 @@ public:
   VRDatumInt(const VRInt inVal) :
     VRDatumSpecialized<VRInt, VRCORETYPE_INT>(inVal) {};
   std::string getValueString() const;
-  VRInt getValueInt() const { return value.front(); };
-  const VRInt* getPointerInt() const { return &(value.front()); };
+  VRInt getValueInt() const { return value; };
+  const VRInt* getPointerInt() const { return &(value); };
   VRIntArray getValueIntArray() const {
-    VRIntArray out;  out.push_back(value.front());  return out; };
-  VRFloat getValueFloat() const { return (float)value.front(); };
+    VRIntArray out;  out.push_back(value);  return out; };
+  VRFloat getValueFloat() const { return (float)value; };
 };
 
 // The specialization for a float.
@@ -373,11 +415,11 @@ public:
   VRDatumFloat(const VRFloat inVal) :
     VRDatumSpecialized<VRFloat, VRCORETYPE_FLOAT>(inVal) {};
   std::string getValueString() const;
-  VRFloat getValueFloat() const { return value.front(); };
-  const VRFloat* getPointerFloat() const { return &(value.front()); };
+  VRFloat getValueFloat() const { return value; };
+  const VRFloat* getPointerFloat() const { return &(value); };
   VRFloatArray getValueFloatArray() const {
-    VRFloatArray out;  out.push_back(value.front());  return out; };
-  VRInt getValueInt() const { return (int)value.front(); };
+    VRFloatArray out;  out.push_back(value);  return out; };
+  VRInt getValueInt() const { return (int)value; };
 };
 
 // Specialization for a string
@@ -385,10 +427,10 @@ class VRDatumString : public VRDatumSpecialized<VRString, VRCORETYPE_STRING> {
 public:
   VRDatumString(const VRString inVal) :
     VRDatumSpecialized<VRString, VRCORETYPE_STRING>(inVal) {};
-  VRString getValueString() const { return value.front(); };
-  const VRString* getPointerString() const { return &(value.front()); };
+  VRString getValueString() const { return value; };
+  const VRString* getPointerString() const { return &(value); };
   VRStringArray getValueStringArray() const {
-    VRStringArray out;  out.push_back(value.front());  return out; };
+    VRStringArray out;  out.push_back(value);  return out; };
 };
 
 // Specialization for a vector of ints
@@ -397,8 +439,8 @@ public:
   VRDatumIntArray(const VRIntArray inVal) :
     VRDatumSpecialized<VRIntArray, VRCORETYPE_INTARRAY>(inVal) {};
   std::string getValueString() const;
-  VRIntArray getValueIntArray() const { return value.front(); };
-  const VRIntArray* getPointerIntArray() const { return &(value.front()); };
+  VRIntArray getValueIntArray() const { return value; };
+  const VRIntArray* getPointerIntArray() const { return &(value); };
 };
 
 // Specialization for a vector of floats
@@ -407,8 +449,13 @@ public:
   VRDatumFloatArray(const VRFloatArray inVal) :
     VRDatumSpecialized<VRFloatArray, VRCORETYPE_FLOATARRAY>(inVal) {};
   std::string getValueString() const;
-  VRFloatArray getValueFloatArray() const { return value.front(); };
-  const VRFloatArray* getPointerFloatArray() const { return &(value.front()); };
+  VRFloatArray getValueFloatArray() const { return value; };
+  const VRFloatArray* getPointerFloatArray() const { return &(value); };
+  // An array can be read as a matrix or a vector, since that is how
+  // they are written in configuration files.  These use the first 16 or
+  // 3 elements, like the VRMath constructors that take an array.
+  VRFloatMatrix4 getValueMatrix4() const;
+  VRFloatVec3 getValueVec3() const;
 };
 
 // Specialization for a vector of strings
@@ -417,8 +464,8 @@ public:
   VRDatumStringArray(const VRStringArray inVal) :
     VRDatumSpecialized<VRStringArray, VRCORETYPE_STRINGARRAY>(inVal) {};
   std::string getValueString() const;
-  VRStringArray getValueStringArray() const { return value.front(); };
-  const VRStringArray* getPointerStringArray() const { return &(value.front()); };
+  VRStringArray getValueStringArray() const { return value; };
+  const VRStringArray* getPointerStringArray() const { return &(value); };
 };
 
 // Specialization for a container
@@ -427,13 +474,38 @@ public:
   VRDatumContainer(const VRContainer inVal) :
     VRDatumSpecialized<VRContainer, VRCORETYPE_CONTAINER>(inVal) {};
   std::string getValueString() const;
-  VRContainer getValueContainer() const { return value.front(); };
-  const VRContainer* getPointerContainer() const { return &(value.front()); };
+  VRContainer getValueContainer() const { return value; };
+  const VRContainer* getPointerContainer() const { return &(value); };
 
   bool addToValue(const VRContainer inVal);
 
 };
 
+// Specialization for a 4x4 matrix, held in the datum itself.  It can be
+// read as a VRFloatArray, too, for code that expects one.
+class VRDatumMatrix4 : public VRDatumSpecialized<VRFloatMatrix4, VRCORETYPE_MATRIX4> {
+public:
+  VRDatumMatrix4(const VRFloatMatrix4 inVal) :
+    VRDatumSpecialized<VRFloatMatrix4, VRCORETYPE_MATRIX4>(inVal) {};
+  std::string getValueString() const;
+  VRFloatMatrix4 getValueMatrix4() const { return value; };
+  const VRFloatMatrix4* getPointerMatrix4() const { return &(value); };
+  VRFloatArray getValueFloatArray() const {
+    return VRFloatArray(value.data(), value.data() + value.size()); };
+};
+
+// Specialization for a three-element vector, the same way.
+class VRDatumVec3 : public VRDatumSpecialized<VRFloatVec3, VRCORETYPE_VEC3> {
+public:
+  VRDatumVec3(const VRFloatVec3 inVal) :
+    VRDatumSpecialized<VRFloatVec3, VRCORETYPE_VEC3>(inVal) {};
+  std::string getValueString() const;
+  VRFloatVec3 getValueVec3() const { return value; };
+  const VRFloatVec3* getPointerVec3() const { return &(value); };
+  VRFloatArray getValueFloatArray() const {
+    return VRFloatArray(value.data(), value.data() + value.size()); };
+};
+
 
 // A convenient reference counter for the smart pointer for the VRDatum type.
 class VRDatumPtrRC {
@@ -449,11 +521,12 @@ public:
     count++;
   }
 
-  int release()
+  bool release()
   {
-    // Decrement the reference count and
-    // return the reference count.
-    return --count;
+    // Decrement the reference count, and say whether that was the
+    // last reference.  The caller deletes this counter if so, so it
+    // is not read again afterwards.
+    return (--count == 0);
   }
 };
 
@@ -486,6 +559,12 @@ private:
 
   friend std::ostream & operator<<(std::ostream &os, VRDatumPtr& p);
 
+  // Deletes the data and the reference count, once the last reference
+  // is gone.  This is in VRDatum.cpp rather than inline, so the compiler
+  // doesn't see the deletes next to other pointers' reads of the same
+  // count, which it can't tell are always before them.
+  void destroy();
+
 public:
   VRDatumPtr() : pData(0) { reference = new VRDatumPtrRC(1); }
   VRDatumPtr(VRDatum* pValue) : pData(pValue) {
@@ -535,6 +614,14 @@ public:
       out = VRDatumPtr(new VRDatumContainer(*containerVal()));
       break;
 
+    case VRCORETYPE_MATRIX4:
+      out = VRDatumPtr(new VRDatumMatrix4(*matrix4Val()));
+      break;
+
+    case VRCORETYPE_VEC3:
+      out = VRDatumPtr(new VRDatumVec3(*vec3Val()));
+      break;
+
     case VRCORETYPE_NONE:
       VRERRORNOADV("can't copy unknown data type");
       break;
@@ -548,11 +635,7 @@ public:
   {
     // Destructor: Decrement the reference count.  If reference becomes
     // zero, delete the data
-    if(reference->release() == 0)
-      {
-        delete pData;
-        delete reference;
-      }
+    if(reference->release()) destroy();
   }
 
   VRDatum& operator* ()
@@ -560,6 +643,11 @@ public:
     return *pData;
   }
 
+  const VRDatum& operator* () const
+  {
+    return *pData;
+  }
+
   VRDatum* operator-> ()
   {
     return pData;
@@ -569,6 +657,9 @@ public:
   {
     return pData;
   }
+
+  /// True if this points at nothing yet.
+  bool isNull() const { return pData == 0; }
     
   VRDatumPtr& operator = (const VRDatumPtr& sp)
   {
@@ -577,11 +668,7 @@ public:
       {
         // Decrement the old reference count.  If references become
         // zero, delete the data.
-        if(reference->release() == 0)
-          {
-            delete pData;
-            delete reference;
-          }
+        if(reference->release()) destroy();
 
         // Copy the data and reference pointer and increment the
         // reference count
@@ -664,6 +751,24 @@ public:
     }
   }
 
+  VRDatumMatrix4* matrix4Val()
+  {
+    if (pData->getType() == VRCORETYPE_MATRIX4) {
+      return static_cast<VRDatumMatrix4*>(pData);
+    } else {
+      VRERRORNOADV("This datum is not a VRFloatMatrix4.");
+    }
+  }
+
+  VRDatumVec3* vec3Val()
+  {
+    if (pData->getType() == VRCORETYPE_VEC3) {
+      return static_cast<VRDatumVec3*>(pData);
+    } else {
+      VRERRORNOADV("This datum is not a VRFloatVec3.");
+    }
+  }
+
 };
 
 // Each specialization needs a callback of the following form, to be
@@ -675,6 +780,8 @@ VRDatumPtr CreateVRDatumIntArray(void *pData);
 VRDatumPtr CreateVRDatumFloatArray(void *pData);
 VRDatumPtr CreateVRDatumStringArray(void *pData);
 VRDatumPtr CreateVRDatumContainer(void *pData);
+VRDatumPtr CreateVRDatumMatrix4(void *pData);
+VRDatumPtr CreateVRDatumVec3(void *pData);
 
 } // end namespace MinVR
 
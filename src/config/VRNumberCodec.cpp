@@ -0,0 +1,460 @@
+#include "VRNumberCodec.h"
+#include "base64/base64.h"
+
+#include <main/VRError.h>
+
+#include <cfloat>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "stdint.h"
+
+namespace MinVR {
+
+static const uint64_t powersOfTen[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+  1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+  1000000000000000000ULL
+};
+
+// These are all exact as floats.
+static const float floatPowersOfTen[] = {
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+static inline bool isSpace(const char c) {
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') ||
+    (c == '\v') || (c == '\f');
+}
+
+static inline bool isDigit(const char c) {
+  return (c >= '0') && (c <= '9');
+}
+
+// Writes the digits of n, and returns how many.
+static size_t writeUnsigned(uint64_t n, char *buffer) {
+  char digits[20];
+  size_t len = 0;
+  do {
+    digits[len++] = (char)('0' + (n % 10));
+    n /= 10;
+  } while (n > 0);
+  for (size_t i = 0; i < len; i++) buffer[i] = digits[len - 1 - i];
+  return len;
+}
+
+// Returns m / 2^shift, rounded to the nearest integer, with ties going
+// to the even one.  This is how printf rounds.
+static inline uint64_t shiftRound(const uint64_t m, const int shift) {
+  if (shift >= 64) return 0;   // m is always well under 2^63 here.
+  uint64_t q = m >> shift;
+  uint64_t rem = m & ((1ULL << shift) - 1);
+  uint64_t half = 1ULL << (shift - 1);
+  if ((rem > half) || ((rem == half) && (q & 1))) q++;
+  return q;
+}
+
+// Writes q / 10^decimals with the given number of decimal places.
+static size_t writeFixed(const uint64_t q, const int decimals, char *buffer) {
+  char digits[24];
+  size_t len = writeUnsigned(q, digits);
+
+  size_t n = 0;
+  if ((int)len <= decimals) {
+    buffer[n++] = '0';
+    buffer[n++] = '.';
+    for (int i = (int)len; i < decimals; i++) buffer[n++] = '0';
+    memcpy(buffer + n, digits, len);
+    return n + len;
+  }
+
+  size_t intLen = len - decimals;
+  memcpy(buffer, digits, intLen);
+  n = intLen;
+  if (decimals > 0) {
+    buffer[n++] = '.';
+    memcpy(buffer + n, digits + intLen, decimals);
+    n += decimals;
+  }
+  return n;
+}
+
+VRNumberCodec::Format VRNumberCodec::getFormat(const std::string &formatName) {
+  if (formatName == "exact") return FORMAT_EXACT;
+  if (formatName == "base64") return FORMAT_BASE64;
+  return FORMAT_DEFAULT;
+}
+
+size_t VRNumberCodec::formatInt(const VRInt value, char *buffer) {
+  if (value < 0) {
+    buffer[0] = '-';
+    return 1 + writeUnsigned((uint64_t)(-(int64_t)value), buffer + 1);
+  }
+  return writeUnsigned((uint64_t)value, buffer);
+}
+
+// A float is m * 2^e, so the value times a power of ten can be worked out
+// exactly in integers, as long as it fits.  That covers the numbers we
+// usually see.  Anything else goes to snprintf(), which gets the same
+// answer more slowly.
+size_t VRNumberCodec::formatFloat(const VRFloat value, char *buffer, const bool exact) {
+
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bool negative = (bits >> 31) != 0;
+  int biasedExponent = (int)((bits >> 23) & 0xff);
+  uint64_t m = bits & 0x7fffff;
+
+  if (biasedExponent == 0xff) {
+    // Infinity or NaN.
+    return snprintf(buffer, bufferSize, exact ? "%.9g" : "%f", value);
+  }
+
+  int e;
+  if (biasedExponent == 0) {
+    e = -149;
+  } else {
+    m |= 0x800000;
+    e = biasedExponent - 150;
+  }
+
+  size_t n = 0;
+  if (negative) buffer[n++] = '-';
+
+  if (m == 0) {
+    if (exact) {
+      buffer[n++] = '0';
+      return n;
+    }
+    return n + writeFixed(0, 6, buffer + n);
+  }
+
+  if (e >= 0) {
+    // A whole number.  m is under 2^24, so this fits if e <= 39.
+    if (e > 39) {
+      return snprintf(buffer, bufferSize, exact ? "%.9g" : "%f", value);
+    }
+    n += writeUnsigned(m << e, buffer + n);
+    if (!exact) {
+      memcpy(buffer + n, ".000000", 7);
+      n += 7;
+    }
+    return n;
+  }
+
+  if (!exact) {
+    // Like "%f".  m * 10^6 is under 2^44.
+    return n + writeFixed(shiftRound(m * powersOfTen[6], -e), 6, buffer + n);
+  }
+
+  // Nine significant digits are always enough to read a float back
+  // exactly.  Find the number of decimal places that gives at least that
+  // many, as long as the scaled value stays under 2^63.
+  int decimals = -1;
+  uint64_t q = 0;
+  uint64_t wholePart = (-e < 64) ? (m >> -e) : 0;
+  if (wholePart > 0) {
+    // The value is under 2^24, so there are at most 8 digits here.
+    decimals = 9 - (int)writeUnsigned(wholePart, buffer + n);
+    q = shiftRound(m * powersOfTen[decimals], -e);
+  } else if (-e < 64) {
+    for (int d = 9; d <= 11; d++) {
+      if (((m * powersOfTen[d]) >> -e) >= powersOfTen[8]) {
+        decimals = d;
+        q = shiftRound(m * powersOfTen[d], -e);
+        break;
+      }
+    }
+  }
+  if (decimals < 0) {
+    return snprintf(buffer, bufferSize, "%.9g", value);
+  }
+
+  // Trailing zeros don't add anything.
+  while ((decimals > 0) && (q % 10 == 0)) {
+    q /= 10;
+    decimals--;
+  }
+  return n + writeFixed(q, decimals, buffer + n);
+}
+
+const char *VRNumberCodec::parseInt(const char *p, const char *end, VRInt &value) {
+
+  while ((p < end) && isSpace(*p)) p++;
+
+  bool negative = false;
+  if ((p < end) && ((*p == '-') || (*p == '+'))) {
+    negative = (*p == '-');
+    p++;
+  }
+
+  // Out of range values are clamped, as with istringstream.
+  int64_t n = 0;
+  while ((p < end) && isDigit(*p)) {
+    if (n <= (int64_t)INT_MAX + 1) n = n * 10 + (*p - '0');
+    p++;
+  }
+  if (negative) n = -n;
+  if (n > INT_MAX) n = INT_MAX;
+  if (n < INT_MIN) n = INT_MIN;
+
+  value = (VRInt)n;
+  return p;
+}
+
+const char *VRNumberCodec::parseFloat(const char *p, const char *end, VRFloat &value) {
+
+  while ((p < end) && isSpace(*p)) p++;
+  const char *start = p;
+
+  bool negative = false;
+  if ((p < end) && ((*p == '-') || (*p == '+'))) {
+    negative = (*p == '-');
+    p++;
+  }
+
+  // Collect the digits as an integer and a power of ten.
+  uint64_t m = 0;
+  int exponent = 0;
+  bool anyDigits = false;
+  bool truncated = false;
+  while ((p < end) && isDigit(*p)) {
+    anyDigits = true;
+    if (m < powersOfTen[18]) {
+      m = m * 10 + (*p - '0');
+    } else {
+      exponent++;
+      if (*p != '0') truncated = true;
+    }
+    p++;
+  }
+  if ((p < end) && (*p == '.')) {
+    p++;
+    while ((p < end) && isDigit(*p)) {
+      anyDigits = true;
+      if (m < powersOfTen[18]) {
+        m = m * 10 + (*p - '0');
+        exponent--;
+      } else if (*p != '0') {
+        truncated = true;
+      }
+      p++;
+    }
+  }
+  if (anyDigits && (p < end) && ((*p == 'e') || (*p == 'E'))) {
+    const char *q = p + 1;
+    bool negativeExponent = false;
+    if ((q < end) && ((*q == '-') || (*q == '+'))) {
+      negativeExponent = (*q == '-');
+      q++;
+    }
+    if ((q < end) && isDigit(*q)) {
+      int x = 0;
+      while ((q < end) && isDigit(*q)) {
+        if (x < 10000) x = x * 10 + (*q - '0');
+        q++;
+      }
+      exponent += negativeExponent ? -x : x;
+      p = q;
+    }
+  }
+
+  if (anyDigits && !truncated) {
+    while ((m != 0) && (m % 10 == 0)) {
+      m /= 10;
+      exponent++;
+    }
+
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+    // If the digits and the power of ten are both exact as floats, one
+    // multiply or divide gives the correctly rounded answer.
+    if ((m <= (1 << 24)) && (exponent >= -10) && (exponent <= 10)) {
+      float f = (float)m;
+      if (exponent < 0) {
+        f /= floatPowersOfTen[-exponent];
+      } else {
+        f *= floatPowersOfTen[exponent];
+      }
+      value = negative ? -f : f;
+      return p;
+    }
+#endif
+  }
+
+  // The hard cases, plus "inf" and "nan", go to strtof().  The text is
+  // copied out first because it is not terminated where we stop.
+  char text[bufferSize];
+  std::string longText;
+  const char *cText;
+  const char *textEnd = anyDigits ? p : end;
+  size_t len = textEnd - start;
+  if (len < bufferSize) {
+    memcpy(text, start, len);
+    text[len] = '\0';
+    cText = text;
+  } else {
+    longText.assign(start, len);
+    cText = longText.c_str();
+  }
+  char *stop;
+  value = strtof(cText, &stop);
+  return start + (stop - cText);
+}
+
+void VRNumberCodec::appendIntArray(std::string &out, const VRIntArray &value,
+                                   const char separator, const Format format) {
+
+  if (format == FORMAT_BASE64) {
+    std::string bytes(4 * value.size(), '\0');
+    for (size_t i = 0; i < value.size(); i++) {
+      uint32_t u = (uint32_t)value[i];
+      for (int j = 0; j < 4; j++) bytes[4 * i + j] = (char)((u >> (8 * j)) & 0xff);
+    }
+    out += base64_encode((const unsigned char *)bytes.data(), (unsigned int)bytes.size());
+    return;
+  }
+
+  char buffer[bufferSize];
+  out.reserve(out.size() + 8 * value.size());
+  for (size_t i = 0; i < value.size(); i++) {
+    if (i > 0) out += separator;
+    out.append(buffer, formatInt(value[i], buffer));
+  }
+}
+
+void VRNumberCodec::appendFloatArray(std::string &out, const VRFloatArray &value,
+                                     const char separator, const Format format) {
+  appendFloats(out, value.empty() ? NULL : &value[0], value.size(), separator, format);
+}
+
+void VRNumberCodec::appendFloats(std::string &out, const float *values, const size_t n,
+                                 const char separator, const Format format) {
+
+  if (format == FORMAT_BASE64) {
+    std::string bytes(4 * n, '\0');
+    for (size_t i = 0; i < n; i++) {
+      uint32_t u;
+      memcpy(&u, &values[i], sizeof(u));
+      for (int j = 0; j < 4; j++) bytes[4 * i + j] = (char)((u >> (8 * j)) & 0xff);
+    }
+    out += base64_encode((const unsigned char *)bytes.data(), (unsigned int)bytes.size());
+    return;
+  }
+
+  char buffer[bufferSize];
+  out.reserve(out.size() + 12 * n);
+  for (size_t i = 0; i < n; i++) {
+    if (i > 0) out += separator;
+    out.append(buffer, formatFloat(values[i], buffer, format == FORMAT_EXACT));
+  }
+}
+
+// Undoes the base64, and checks there are whole 4-byte values.  A long
+// value may have been broken into lines, so whitespace is dropped.
+static std::string decodeBase64Values(const std::string &text) {
+
+  std::string packed;
+  packed.reserve(text.size());
+  for (size_t i = 0; i < text.size(); i++) {
+    if (!isSpace(text[i])) packed += text[i];
+  }
+
+  std::string bytes = base64_decode(packed);
+  if (bytes.size() % 4 != 0) {
+    VRERRORNOADV("Base64 array data is not a whole number of 4-byte values.");
+  }
+  return bytes;
+}
+
+static inline uint32_t unpackUInt32(const std::string &bytes, const size_t i) {
+  uint32_t u = 0;
+  for (int j = 0; j < 4; j++) u |= (uint32_t)(unsigned char)bytes[i + j] << (8 * j);
+  return u;
+}
+
+// Elements are split the way std::getline() would, so "1,2," has two.
+VRIntArray VRNumberCodec::parseIntArray(const std::string &text, const char separator,
+                                        const Format format) {
+
+  VRIntArray out;
+
+  if (format == FORMAT_BASE64) {
+    std::string bytes = decodeBase64Values(text);
+    out.resize(bytes.size() / 4);
+    for (size_t i = 0; i < out.size(); i++) out[i] = (VRInt)unpackUInt32(bytes, 4 * i);
+    return out;
+  }
+
+  const char *p = text.data();
+  const char *end = p + text.size();
+  while (p < end) {
+    const char *elemEnd = (const char *)memchr(p, separator, end - p);
+    if (elemEnd == NULL) elemEnd = end;
+    VRInt v;
+    parseInt(p, elemEnd, v);
+    out.push_back(v);
+    p = elemEnd + 1;
+  }
+  return out;
+}
+
+VRFloatArray VRNumberCodec::parseFloatArray(const std::string &text, const char separator,
+                                            const Format format) {
+
+  VRFloatArray out;
+
+  if (format == FORMAT_BASE64) {
+    std::string bytes = decodeBase64Values(text);
+    out.resize(bytes.size() / 4);
+    for (size_t i = 0; i < out.size(); i++) {
+      uint32_t u = unpackUInt32(bytes, 4 * i);
+      memcpy(&out[i], &u, sizeof(u));
+    }
+    return out;
+  }
+
+  const char *p = text.data();
+  const char *end = p + text.size();
+  while (p < end) {
+    const char *elemEnd = (const char *)memchr(p, separator, end - p);
+    if (elemEnd == NULL) elemEnd = end;
+    VRFloat v;
+    parseFloat(p, elemEnd, v);
+    out.push_back(v);
+    p = elemEnd + 1;
+  }
+  return out;
+}
+
+size_t VRNumberCodec::parseFloats(const std::string &text, const char separator,
+                                  const Format format, float *values, const size_t n) {
+
+  if (format == FORMAT_BASE64) {
+    std::string bytes = decodeBase64Values(text);
+    size_t count = bytes.size() / 4;
+    for (size_t i = 0; (i < count) && (i < n); i++) {
+      uint32_t u = unpackUInt32(bytes, 4 * i);
+      memcpy(&values[i], &u, sizeof(u));
+    }
+    return count;
+  }
+
+  size_t count = 0;
+  const char *p = text.data();
+  const char *end = p + text.size();
+  while (p < end) {
+    const char *elemEnd = (const char *)memchr(p, separator, end - p);
+    if (elemEnd == NULL) elemEnd = end;
+    VRFloat v;
+    parseFloat(p, elemEnd, v);
+    if (count < n) values[count] = v;
+    count++;
+    p = elemEnd + 1;
+  }
+  return count;
+}
+
+} // end namespace MinVR
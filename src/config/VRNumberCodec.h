@@ -0,0 +1,94 @@
+// -*-c++-*-
+#ifndef MINVR_NUMBERCODEC_H
+#define MINVR_NUMBERCODEC_H
+
+//
+// Copyright Brown University, 2017.  This software is released under the
+// following license: http://opensource.org/licenses/
+// Source code originally developed at the Brown University Center for
+// Computation and Visualization (ccv.brown.edu).
+//
+
+#include <string>
+
+#include "VRCoreTypes.h"
+
+namespace MinVR {
+
+/// \brief Converts numbers and numeric arrays to and from text.
+///
+/// Tracker matrices and other arrays go through the XML encoding many
+/// times a second, so this does the conversions without streams, and
+/// without copying each element into a string of its own.
+///
+/// Floats can be written three ways, chosen by a 'format' attribute on
+/// the datum:
+///
+///  - With no format attribute, the way they always have been: like
+///    printf's "%f", with six decimal places.  This loses precision, so
+///    3.1415926 comes back as 3.141593.
+///  - format="exact" writes enough digits that the text reads back to
+///    the same float, bit for bit.
+///  - format="base64" (arrays only) packs the raw little-endian values
+///    and base64-encodes them.  That is exact, and much more compact for
+///    big arrays like meshes or calibration tables.
+///
+/// Reading is the same for the first two.  Either way it gives the same
+/// answer istringstream would.
+class VRNumberCodec {
+public:
+
+  enum Format {
+    FORMAT_DEFAULT = 0,
+    FORMAT_EXACT,
+    FORMAT_BASE64
+  };
+
+  /// \brief Translates the value of a 'format' attribute.
+  ///
+  /// Anything not understood is FORMAT_DEFAULT.
+  static Format getFormat(const std::string &formatName);
+
+  /// Big enough for any number this writes.
+  static const size_t bufferSize = 64;
+
+  /// \brief Writes an int, and returns the number of characters written.
+  static size_t formatInt(const VRInt value, char *buffer);
+
+  /// \brief Writes a float, and returns the number of characters written.
+  static size_t formatFloat(const VRFloat value, char *buffer, const bool exact);
+
+  /// \brief Reads an int from the text at p, not going past end.
+  ///
+  /// Leading whitespace is skipped, and anything that can't be read is
+  /// zero.  Returns a pointer to the first character not used.
+  static const char *parseInt(const char *p, const char *end, VRInt &value);
+
+  /// \brief Reads a float from the text at p, not going past end.
+  static const char *parseFloat(const char *p, const char *end, VRFloat &value);
+
+  /// \brief Appends an array, with the elements separated by separator.
+  static void appendIntArray(std::string &out, const VRIntArray &value,
+                             const char separator, const Format format);
+  static void appendFloatArray(std::string &out, const VRFloatArray &value,
+                               const char separator, const Format format);
+  static void appendFloats(std::string &out, const float *values, const size_t n,
+                           const char separator, const Format format);
+
+  /// \brief Reads an array written by the methods above.
+  static VRIntArray parseIntArray(const std::string &text, const char separator,
+                                  const Format format);
+  static VRFloatArray parseFloatArray(const std::string &text, const char separator,
+                                      const Format format);
+
+  /// \brief Reads an array into n floats that are already there.
+  ///
+  /// Returns the number of elements in the text, which may be more or
+  /// fewer than n.  Only the first n are kept.
+  static size_t parseFloats(const std::string &text, const char separator,
+                            const Format format, float *values, const size_t n);
+};
+
+} // end namespace MinVR
+
+#endif
@@ -0,0 +1,180 @@
+#include "VRXMLParser.h"
+
+#include <main/VRError.h>
+
+#include <sstream>
+
+namespace MinVR {
+
+static inline bool isSpace(const char c) {
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+// Characters that end a tag or attribute name.
+static inline bool isNameEnd(const char c) {
+  return isSpace(c) || (c == '/') || (c == '>') || (c == '=');
+}
+
+static inline const char *skipSpace(const char *p, const char *end) {
+  while ((p < end) && isSpace(*p)) p++;
+  return p;
+}
+
+// Returns a pointer to the first occurrence of s at or after p, or end.
+static const char *findString(const char *p, const char *end, const char *s) {
+  size_t n = strlen(s);
+  while ((size_t)(end - p) >= n) {
+    p = (const char *)memchr(p, s[0], (end - p) - n + 1);
+    if (p == NULL) return end;
+    if (memcmp(p, s, n) == 0) return p;
+    p++;
+  }
+  return end;
+}
+
+static inline bool startsWith(const char *p, const char *end, const char *s) {
+  size_t n = strlen(s);
+  return ((size_t)(end - p) >= n) && (memcmp(p, s, n) == 0);
+}
+
+void VRXMLParser::_error(const std::string &what, const char *xml, const char *where) {
+  int line = 1;
+  for (const char *p = xml; p < where; p++) {
+    if (*p == '\n') line++;
+  }
+  std::stringstream msg;
+  msg << "XML parse error at line " << line << ": " << what;
+  VRERRORNOADV(msg.str());
+}
+
+void VRXMLParser::parse(const std::string &xml, VRXMLHandler *handler) {
+  parse(xml.data(), xml.size(), handler);
+}
+
+void VRXMLParser::parse(const char *xml, const size_t size, VRXMLHandler *handler) {
+
+  const char *p = xml;
+  const char *end = xml + size;
+
+  _openElements.clear();
+
+  while (p < end) {
+
+    // Everything up to the next '<' is text.
+    const char *open = (const char *)memchr(p, '<', end - p);
+    if (open == NULL) open = end;
+    if (open > p) handler->text(VRXMLSpan(p, open - p));
+    if (open == end) break;
+    p = open + 1;
+
+    if (startsWith(p, end, "!--")) {
+
+      const char *close = findString(p + 3, end, "-->");
+      if (close == end) _error("unterminated comment", xml, open);
+      p = close + 3;
+
+    } else if (startsWith(p, end, "![CDATA[")) {
+
+      const char *close = findString(p + 8, end, "]]>");
+      if (close == end) _error("unterminated CDATA section", xml, open);
+      handler->text(VRXMLSpan(p + 8, close - p - 8));
+      p = close + 3;
+
+    } else if ((p < end) && ((*p == '?') || (*p == '!'))) {
+
+      // A processing instruction or a DOCTYPE.  Neither means anything
+      // to us.
+      const char *close = (const char *)memchr(p, '>', end - p);
+      if (close == NULL) _error("unterminated declaration", xml, open);
+      p = close + 1;
+
+    } else if ((p < end) && (*p == '/')) {
+
+      // A close tag.
+      const char *nameBegin = ++p;
+      while ((p < end) && !isNameEnd(*p)) p++;
+      VRXMLSpan name(nameBegin, p - nameBegin);
+      p = skipSpace(p, end);
+      if ((p == end) || (*p != '>')) _error("unterminated close tag", xml, open);
+      p++;
+
+      if (_openElements.empty()) {
+        _error("close tag </" + name.str() + "> with nothing open", xml, open);
+      }
+      if (_openElements.back() != name) {
+        _error("close tag </" + name.str() + "> does not match <" +
+               _openElements.back().str() + ">", xml, open);
+      }
+      _openElements.pop_back();
+      handler->endElement(name);
+
+    } else {
+
+      // A start tag.
+      const char *nameBegin = p;
+      while ((p < end) && !isNameEnd(*p)) p++;
+      VRXMLSpan name(nameBegin, p - nameBegin);
+      if (name.empty()) _error("a '<' that does not start a tag", xml, open);
+
+      _attributes.clear();
+      bool singleton = false;
+      while (true) {
+        p = skipSpace(p, end);
+        if (p == end) _error("unterminated tag <" + name.str() + ">", xml, open);
+
+        if (*p == '>') {
+          p++;
+          break;
+        }
+        if (*p == '/') {
+          p = skipSpace(p + 1, end);
+          if ((p == end) || (*p != '>')) {
+            _error("unterminated tag <" + name.str() + ">", xml, open);
+          }
+          p++;
+          singleton = true;
+          break;
+        }
+
+        VRXMLAttribute attribute;
+        const char *attrBegin = p;
+        while ((p < end) && !isNameEnd(*p)) p++;
+        attribute.name = VRXMLSpan(attrBegin, p - attrBegin);
+        p = skipSpace(p, end);
+        if (attribute.name.empty() || (p == end) || (*p != '=')) {
+          _error("badly formed attribute in <" + name.str() + ">", xml, open);
+        }
+        p = skipSpace(p + 1, end);
+        if (p == end) _error("unterminated tag <" + name.str() + ">", xml, open);
+
+        if ((*p == '"') || (*p == '\'')) {
+          const char *close = (const char *)memchr(p + 1, *p, end - p - 1);
+          if (close == NULL) {
+            _error("unterminated attribute value in <" + name.str() + ">", xml, open);
+          }
+          attribute.value = VRXMLSpan(p + 1, close - p - 1);
+          p = close + 1;
+        } else {
+          // Not proper XML, but easy enough to read.
+          const char *valueBegin = p;
+          while ((p < end) && !isSpace(*p) && (*p != '>') && (*p != '/')) p++;
+          attribute.value = VRXMLSpan(valueBegin, p - valueBegin);
+        }
+        _attributes.push_back(attribute);
+      }
+
+      handler->startElement(name, _attributes);
+      if (singleton) {
+        handler->endElement(name);
+      } else {
+        _openElements.push_back(name);
+      }
+    }
+  }
+
+  if (!_openElements.empty()) {
+    _error("no close tag for <" + _openElements.back().str() + ">", xml, end);
+  }
+}
+
+} // end namespace MinVR
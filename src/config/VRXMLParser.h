@@ -0,0 +1,107 @@
+// -*-c++-*-
+#ifndef MINVR_XMLPARSER_H
+#define MINVR_XMLPARSER_H
+
+//
+// Copyright Brown University, 2017.  This software is released under the
+// following license: http://opensource.org/licenses/
+// Source code originally developed at the Brown University Center for
+// Computation and Visualization (ccv.brown.edu).
+//
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace MinVR {
+
+/// \brief A piece of the text being parsed.
+///
+/// The parser does not copy names, values, or text out of its input.  It
+/// hands out these instead, which point into the input, so they are only
+/// good until the input string is changed or goes away.
+class VRXMLSpan {
+public:
+  VRXMLSpan() : _begin(NULL), _size(0) {};
+  VRXMLSpan(const char *begin, const size_t size) : _begin(begin), _size(size) {};
+
+  const char *begin() const { return _begin; };
+  const char *end() const { return _begin + _size; };
+  size_t size() const { return _size; };
+  bool empty() const { return _size == 0; };
+
+  bool operator==(const char *s) const {
+    return (strncmp(_begin, s, _size) == 0) && (s[_size] == '\0');
+  };
+  bool operator==(const VRXMLSpan &other) const {
+    return (_size == other._size) && (memcmp(_begin, other._begin, _size) == 0);
+  };
+  bool operator!=(const VRXMLSpan &other) const { return !(*this == other); };
+
+  std::string str() const { return std::string(_begin, _size); };
+
+private:
+  const char *_begin;
+  size_t _size;
+};
+
+/// \brief One name="value" pair from a start tag.
+struct VRXMLAttribute {
+  VRXMLSpan name;
+  VRXMLSpan value;
+};
+
+typedef std::vector<VRXMLAttribute> VRXMLAttributeList;
+
+/// \brief Receives the pieces of a document from VRXMLParser, in order.
+///
+/// A singleton element like <a/> produces a startElement() followed
+/// immediately by an endElement().  Text comes in runs: the text between
+/// two pieces of markup is one call, and a CDATA section is another.
+class VRXMLHandler {
+public:
+  virtual ~VRXMLHandler() {};
+
+  virtual void startElement(const VRXMLSpan &name,
+                            const VRXMLAttributeList &attributes) = 0;
+  virtual void text(const VRXMLSpan &text) = 0;
+  virtual void endElement(const VRXMLSpan &name) = 0;
+};
+
+/// \brief A streaming (SAX-style) parser for the XML used by MinVR.
+///
+/// This reads a document in one pass, straight out of the string it is
+/// given, and calls the handler for each element and each run of text as
+/// it goes.  It builds no tree and makes no copies, so its cost is about
+/// the cost of looking at each character once.  VRDataIndex uses it to
+/// read config files and events.
+///
+/// It handles elements, attributes in single or double quotes, comments,
+/// CDATA sections, and skips processing instructions (like the
+/// <?xml version="1.0"?> at the top of a file) and DOCTYPE declarations.
+/// Like the Cxml parser it replaces, it does not translate entities:
+/// "&amp;" comes through as five characters.  Unlike Cxml, it will not
+/// guess at a broken document; an unterminated tag or a close tag that
+/// does not match is an error, with the line number.
+class VRXMLParser {
+public:
+  VRXMLParser() {};
+
+  /// \brief Reads the whole document, calling the handler as it goes.
+  void parse(const std::string &xml, VRXMLHandler *handler);
+  void parse(const char *xml, const size_t size, VRXMLHandler *handler);
+
+private:
+  // Reused from one start tag to the next, to save allocations.
+  VRXMLAttributeList _attributes;
+
+  // The names of the elements that are open, innermost last.
+  std::vector<VRXMLSpan> _openElements;
+
+  // Throws an error that says where in the input things went wrong.
+  static void _error(const std::string &what, const char *xml, const char *where);
+};
+
+} // end namespace MinVR
+
+#endif
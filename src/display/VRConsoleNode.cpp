@@ -24,13 +24,11 @@ void VRConsoleNode::addChild(VRDisplayNode *child) {
   
 void VRConsoleNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler) {
 
-  renderState->pushState();
+  VRDataIndexScope scope(renderState);
 	renderState->addData("/IsConsole", 1);
 
 	renderHandler->onVRRenderContext(*renderState);
 	renderHandler->onVRRenderScene(*renderState);
-
-   renderState->popState();
 }
 
 void VRConsoleNode::displayFinishedRendering(VRDataIndex *renderState) {
@@ -31,7 +31,7 @@ VRGraphicsWindowNode::~VRGraphicsWindowNode() {
 
 void VRGraphicsWindowNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler) {
 
-  renderState->pushState();
+  VRDataIndexScope scope(renderState);
 
   // Is this the kind of state information we expect to pass from one node to the next?
   renderState->addData("IsGraphics", 1);
@@ -64,8 +64,6 @@ void VRGraphicsWindowNode::render(VRDataIndex *renderState, VRRenderHandler *ren
   VRDisplayNode::render(renderState, renderHandler);
 
   _gfxToolkit->flushGraphics();
-
-  renderState->popState();
 }
 
 void VRGraphicsWindowNode::waitForRenderToComplete(VRDataIndex *renderState) {
@@ -78,6 +76,12 @@ void VRGraphicsWindowNode::displayFinishedRendering(VRDataIndex *renderState) {
   VRDisplayNode::displayFinishedRendering(renderState);
   _winToolkit->makeWindowCurrent(_windowID);
   _winToolkit->swapBuffers(_windowID);
+
+  // A context can only be current in one thread, so if another thread
+  // might render this window next frame, let go of it.
+  if (renderState->exists("/ReleaseContext")) {
+    _winToolkit->makeWindowCurrent(-1);
+  }
 }
 
 
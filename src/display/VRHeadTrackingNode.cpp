@@ -1,11 +1,13 @@
 
 #include <display/VRHeadTrackingNode.h>
+#include <main/VRSystem.h>
 
 namespace MinVR {
 
 
 VRHeadTrackingNode::VRHeadTrackingNode(const std::string &name, const std::string &headTrackingEventName, VRMatrix4 initialHeadMatrix) :
-    VRDisplayNode(name), _headMatrix(initialHeadMatrix), _trackingEvent(headTrackingEventName)
+    VRDisplayNode(name), _headMatrix(initialHeadMatrix), _trackingEvent(headTrackingEventName),
+    _poseSlot(NULL), _predictionTime(0.0)
 {
   _valuesAdded.push_back("HeadMatrix");
   _valuesAdded.push_back("CameraMatrix");
@@ -19,25 +21,41 @@ VRHeadTrackingNode::~VRHeadTrackingNode()
 void
 VRHeadTrackingNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler)
 {
-	renderState->pushState();
+	VRDataIndexScope scope(renderState);
+
+	VRMatrix4 headMatrix = _headMatrix;
+	if (_poseSlot != NULL) {
+		// Leaves the matrix alone if the device hasn't published anything.
+		_poseSlot->predict(VRSystem::getTime() + _predictionTime, &headMatrix);
+		renderState->addData("HeadPoseSlot", _trackingEvent);
+		renderState->addData("PosePredictionTime", (float)_predictionTime);
+	}
 
-	renderState->addData("HeadMatrix", _headMatrix);
+	renderState->addData("HeadMatrix", headMatrix);
 
   // We copy the head matrix into "CameraMatrix" in case this is only a mono
   // configuration and the two are the same thing.  We don't use a link because
   // a stereo configuration will overwrite the camera matrix.
-	renderState->addData("CameraMatrix", _headMatrix);
+	renderState->addData("CameraMatrix", headMatrix);
 	VRDisplayNode::render(renderState, renderHandler);
+}
 
-	renderState->popState();
+void
+VRHeadTrackingNode::setLateLatching(double predictionTime)
+{
+	if (_poseSlot == NULL) {
+		_valuesAdded.push_back("HeadPoseSlot");
+		_valuesAdded.push_back("PosePredictionTime");
+	}
+	_poseSlot = VRPoseSlot::get(_trackingEvent);
+	_predictionTime = predictionTime;
 }
 
 void
 VRHeadTrackingNode::onVREvent(const VRDataIndex &e)
 {
-	if (e.getName() == _trackingEvent) {
-        _headMatrix = e.getValue("Transform");
-    }
+	// Only the tracking event comes here; see create().
+	_headMatrix = e.getValue("Transform");
 }
 
 VRDisplayNode* VRHeadTrackingNode::create(VRMainInterface *vrMain, VRDataIndex *config, const std::string &nameSpace) {
@@ -82,7 +100,11 @@ VRDisplayNode* VRHeadTrackingNode::create(VRMainInterface *vrMain, VRDataIndex *
 
 	VRHeadTrackingNode *node = new VRHeadTrackingNode(nameSpace, trackingEvent, headMatrix);
 
-	vrMain->addEventHandler(node);
+	if ((int)config->getValueWithDefault("LateLatching", 0, nameSpace)) {
+		node->setLateLatching(config->getValueWithDefault("PosePredictionTime", 0.0f, nameSpace));
+	}
+
+	vrMain->addEventHandler(node, trackingEvent);
 
 	return node;
 }
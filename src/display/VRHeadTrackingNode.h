@@ -15,12 +15,28 @@
 #include <main/VREventHandler.h>
 #include <main/VRFactory.h>
 #include <math/VRMath.h>
+#include <input/VRPoseSlot.h>
 
 namespace MinVR {
 
 
 /** Adds a HeadMatrix to the RenderState that gets updated repeatedly based
     upon head tracking events.
+
+    Late latching: with LateLatching set to 1, the node doesn't wait for the
+    tracking event to be handled at the start of the frame.  It reads the
+    newest pose the input device has published to the VRPoseSlot for the
+    event, when it renders.  It also adds HeadPoseSlot (the event name) to
+    the RenderState, so that a VRStereoNode further down can read the pose
+    once more, just before the scene is drawn.  PosePredictionTime (in
+    seconds, 0 by default) extrapolates the pose that far ahead, using the
+    tracker's velocity.  It should be about the time from rendering to the
+    frame reaching the display, e.g., one frame.
+
+    Each node of a cluster latches its own pose, so late latching is for
+    setups where the head tracker is attached to every node that renders
+    it, like a head-mounted display.  The walls of a cluster CAVE would not
+    line up.  Until the device publishes a pose, the events are used.
  */
 class VRHeadTrackingNode : public VRDisplayNode, public VREventHandler {
 public:
@@ -34,6 +50,10 @@ public:
 	virtual void render(VRDataIndex *renderState, VRRenderHandler *renderHandler);
 
     virtual void onVREvent(const VRDataIndex &eventData);
+
+	/// Reads the pose from the tracking event's VRPoseSlot when rendering,
+	/// extrapolated predictionTime seconds ahead.
+	void setLateLatching(double predictionTime);
   
 	static VRDisplayNode* create(VRMainInterface *vrMain, VRDataIndex *config, const std::string &nameSpace);
 
@@ -41,6 +61,8 @@ protected:
 
 	VRMatrix4 _headMatrix;
 	std::string _trackingEvent;
+	VRPoseSlot *_poseSlot;
+	double _predictionTime;
 };
 
 } // end namespace
@@ -19,7 +19,7 @@ VRLookAtNode::~VRLookAtNode()
 void
 VRLookAtNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler)
 {
-	renderState->pushState();
+	VRDataIndexScope scope(renderState);
 
 	renderState->addData("HeadMatrix", _headMatrix);
 
@@ -28,8 +28,6 @@ VRLookAtNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler)
   // a stereo configuration will overwrite the camera matrix.
 	renderState->addData("CameraMatrix", _headMatrix);
 	VRDisplayNode::render(renderState, renderHandler);
-
-	renderState->popState();
 }
 
 VRDisplayNode* VRLookAtNode::create(VRMainInterface *vrMain, VRDataIndex *config, const std::string &nameSpace) {
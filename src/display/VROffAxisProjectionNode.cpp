@@ -5,7 +5,8 @@ namespace MinVR {
 
 
 	VROffAxisProjectionNode::VROffAxisProjectionNode(const std::string &name, VRPoint3 topLeft, VRPoint3 botLeft, VRPoint3 topRight, VRPoint3 botRight, float nearClip, float farClip) :
-	VRDisplayNode(name), _topLeft(topLeft), _botLeft(botLeft), _topRight(topRight), _botRight(botRight),  _nearClip(nearClip), _farClip(farClip)
+	VRDisplayNode(name), _topLeft(topLeft), _botLeft(botLeft), _topRight(topRight), _botRight(botRight),  _nearClip(nearClip), _farClip(farClip),
+	_cameraMatrix("CameraMatrix")
 {
   // in:
   _addValueNeeded("CameraMatrix");
@@ -22,7 +23,7 @@ VROffAxisProjectionNode::~VROffAxisProjectionNode()
 void
 VROffAxisProjectionNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler)
 {
-	renderState->pushState();
+	VRDataIndexScope scope(renderState);
 
 	// This projection code follows the math described in this paper:
 	// http://csc.lsu.edu/~kooima/pdfs/gen-perspective.pdf
@@ -30,7 +31,11 @@ VROffAxisProjectionNode::render(VRDataIndex *renderState, VRRenderHandler *rende
 	VRPoint3 pa = _botLeft;
 	VRPoint3 pb = _botRight;
 	VRPoint3 pc = _topLeft;
-  VRMatrix4 cameraMatrix = renderState->getValue("CameraMatrix");
+  const float *camera = _cameraMatrix.getPointerFloats(*renderState);
+  if (camera == NULL) {
+    VRERRORNOADV("VROffAxisProjectionNode cannot find CameraMatrix in the current RenderState.");
+  }
+  VRMatrix4 cameraMatrix(camera);
   VRPoint3 pe = VRPoint3(0,0,0) + cameraMatrix.getColumn(3);
 
 	// Compute an orthonormal basis for the screen
@@ -70,8 +75,6 @@ VROffAxisProjectionNode::render(VRDataIndex *renderState, VRRenderHandler *rende
 	renderState->addData("ViewMatrix", viewMat);
 
 	VRDisplayNode::render(renderState, renderHandler);
-
-	renderState->popState();
 }
 
 
@@ -14,6 +14,7 @@
 #include <display/VRDisplayNode.h>
 #include <main/VRFactory.h>
 #include <math/VRMath.h>
+#include <config/VRDataHandle.h>
 
 namespace MinVR {
 
@@ -44,6 +45,8 @@ protected:
 	VRPoint3 _botRight;
 	float _nearClip;
 	float _farClip;
+
+	VRDataHandle _cameraMatrix;
 };
 
 } // end namespace
@@ -38,7 +38,7 @@ VRProjectionNode::~VRProjectionNode()
 
 void VRProjectionNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler)
 {
-  renderState->pushState();
+  VRDataIndexScope scope(renderState);
 
   renderState->addData("ProjectionMatrix", _projectionMatrix);
   renderState->addData("ProjectionHorizontalClip", _horizontalClip);
@@ -56,8 +56,6 @@ void VRProjectionNode::render(VRDataIndex *renderState, VRRenderHandler *renderH
 
   VRDisplayNode::render(renderState, renderHandler);
 
-  renderState->popState();
-
 }
 
 VRDisplayNode* VRProjectionNode::create(VRMainInterface *vrMain, VRDataIndex *config, const std::string &nameSpace){
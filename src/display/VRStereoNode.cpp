@@ -9,11 +9,18 @@
 #include <display/VRStereoNode.h>
 #include <display/VRGroupNode.h>
 #include <math/VRMath.h>
+#include <main/VRSystem.h>
 
 namespace MinVR {
 
 VRStereoNode::VRStereoNode(const std::string &name, float interOcularDist, VRGraphicsToolkit *gfxToolkit, VRStereoFormat format) :
-  VRDisplayNode(name), _gfxToolkit(gfxToolkit), _format(format), _iod(interOcularDist) {
+  VRDisplayNode(name), _gfxToolkit(gfxToolkit), _format(format), _iod(interOcularDist),
+  _headMatrix("HeadMatrix"),
+  _headPoseSlotName("HeadPoseSlot"), _posePredictionTime("PosePredictionTime"),
+  _latchedSlot(NULL),
+  _viewportX("ViewportX"), _viewportY("ViewportY"),
+  _viewportWidth("ViewportWidth"), _viewportHeight("ViewportHeight"),
+  _windowWidth("WindowWidth"), _windowHeight("WindowHeight") {
 
   // in:
   _addValueNeeded("HeadMatrix");
@@ -32,7 +39,9 @@ VRStereoNode::~VRStereoNode() {
 
 
 void VRStereoNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler) {
-  renderState->pushState();
+  VRDataIndexScope scope(renderState);
+
+  latchHeadMatrix(renderState);
 
 	if (_format == VRSTEREOFORMAT_MONO) {
 		renderState->addData("StereoFormat", "Mono");
@@ -53,23 +62,23 @@ void VRStereoNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandl
 		renderState->addData("StereoFormat", "SideBySide");
 
 		int x,y,w,h;
-		if (renderState->exists("ViewportX")) {
-      x = renderState->getValue("ViewportX");
-      y = renderState->getValue("ViewportY");
-			w = renderState->getValue("ViewportWidth");
-			h = renderState->getValue("ViewportHeight");
+		if (_viewportX.exists(*renderState)) {
+      x = _viewportX.getValueInt(*renderState);
+      y = _viewportY.getValueInt(*renderState);
+			w = _viewportWidth.getValueInt(*renderState);
+			h = _viewportHeight.getValueInt(*renderState);
 		}
 		else {
       x = 0;
       y = 0;
-      if (renderState->exists("WindowWidth")) {
-        w = renderState->getValue();
+      if (_windowWidth.exists(*renderState)) {
+        w = _windowWidth.getValueInt(*renderState);
       } else {
         VRERRORNOADV("VRStereoNode needs a window width.");
       }
 
-      if (renderState->exists("WindowHeight")) {
-        h = renderState->getValue();
+      if (_windowHeight.exists(*renderState)) {
+        h = _windowHeight.getValueInt(*renderState);
       } else {
         VRERRORNOADV("VRStereoNode needs a window height.");
       }
@@ -92,8 +101,28 @@ void VRStereoNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandl
 
 		_gfxToolkit->enableDrawingOnAllColumns();
 	}
+}
 
-	renderState->popState();
+void VRStereoNode::latchHeadMatrix(VRDataIndex *renderState)
+{
+  const VRString *slotName = _headPoseSlotName.getPointerString(*renderState);
+  if (slotName == NULL) return;
+
+  // Finding the slot takes a lock, so only do it when the name changes.
+  if ((_latchedSlot == NULL) || (*slotName != _latchedSlotName)) {
+    _latchedSlotName = *slotName;
+    _latchedSlot = VRPoseSlot::get(_latchedSlotName);
+  }
+
+  double predictionTime = 0.0;
+  if (_posePredictionTime.exists(*renderState)) {
+    predictionTime = _posePredictionTime.getValueFloat(*renderState);
+  }
+
+  VRMatrix4 headMatrix;
+  if (_latchedSlot->predict(VRSystem::getTime() + predictionTime, &headMatrix)) {
+    renderState->addData("HeadMatrix", headMatrix);
+  }
 }
 
 void VRStereoNode::setCameraMatrix(VRDataIndex *renderState, VREyePosition eye)
@@ -102,8 +131,9 @@ void VRStereoNode::setCameraMatrix(VRDataIndex *renderState, VREyePosition eye)
     // This should be set by a HeadTrackingNode or a LookAtNode before reaching
     // this StereoNode
 	VRMatrix4 headMatrix;
-	if (renderState->exists("HeadMatrix")) {
-		headMatrix = renderState->getValue("HeadMatrix");
+	const float *head = _headMatrix.getPointerFloats(*renderState);
+	if (head != NULL) {
+		headMatrix = VRMatrix4(head);
 
 	} else {
     VRERROR("VRStereoNode cannot find HeadMatrix in the current RenderState",
@@ -124,7 +154,7 @@ void VRStereoNode::setCameraMatrix(VRDataIndex *renderState, VREyePosition eye)
 
 void VRStereoNode::renderOneEye(VRDataIndex *renderState, VRRenderHandler *renderHandler, VREyePosition eye)
 {
-	renderState->pushState();
+	VRDataIndexScope scope(renderState);
 		setCameraMatrix(renderState, eye);
 		if (_children.size() > 0) {
 			if (eye == Cyclops)
@@ -146,7 +176,6 @@ void VRStereoNode::renderOneEye(VRDataIndex *renderState, VRRenderHandler *rende
 		{
 			renderHandler->onVRRenderScene(*renderState);
 		}
-	renderState->popState();
 }
 
 void VRStereoNode::createChildren(VRMainInterface *vrMain, VRDataIndex *config, const std::string &nameSpace) {
@@ -161,13 +190,12 @@ void VRStereoNode::createChildren(VRMainInterface *vrMain, VRDataIndex *config,
 			if (config->exists(*it, validatedNameSpace))
 			{
 				if (config->hasAttribute(validatedNameSpace + *it, "displaynodeType")){
-					config->pushState();
+					VRDataIndexScope scope(config);
 					config->addData(validatedNameSpace + *it + "Eye", "Left");
 					VRDisplayNode *child = vrMain->getFactory()->create<VRDisplayNode>(vrMain, config, config->validateNameSpace(validatedNameSpace) + *it);
 					if (child != NULL) {
 						child_left->addChild(child);
 					}
-					config->popState();
 				}
 			}
 		}
@@ -177,13 +205,12 @@ void VRStereoNode::createChildren(VRMainInterface *vrMain, VRDataIndex *config,
 			if (config->exists(*it, validatedNameSpace))
 			{
 				if (config->hasAttribute(validatedNameSpace + *it, "displaynodeType")){
-					config->pushState();
+					VRDataIndexScope scope(config);
 					config->addData(validatedNameSpace + *it + "Eye", "Left");
 					VRDisplayNode *child = vrMain->getFactory()->create<VRDisplayNode>(vrMain, config, config->validateNameSpace(validatedNameSpace) + *it);
 					if (child != NULL) {
 						child_right->addChild(child);
 					}
-					config->popState();
 				}
 			}
 		}
@@ -193,13 +220,12 @@ void VRStereoNode::createChildren(VRMainInterface *vrMain, VRDataIndex *config,
 		for (std::list<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
 			if (config->exists(*it, validatedNameSpace)){
 				if (config->hasAttribute(validatedNameSpace + *it, "displaynodeType")){
-					config->pushState();
+					VRDataIndexScope scope(config);
 					config->addData(validatedNameSpace + *it + "Eye", "Cyclops");
 					VRDisplayNode *child = vrMain->getFactory()->create<VRDisplayNode>(vrMain, config, config->validateNameSpace(validatedNameSpace) + *it);
 					if (child != NULL) {
 						addChild(child);
 					}
-					config->popState();
 				}
 			}
 		}
@@ -12,6 +12,8 @@
 #include <display/VRDisplayNode.h>
 #include <display/VRGraphicsToolkit.h>
 #include <main/VRFactory.h>
+#include <config/VRDataHandle.h>
+#include <input/VRPoseSlot.h>
 
 namespace MinVR {
 
@@ -20,6 +22,10 @@ namespace MinVR {
     based on the current stereo format and value for EyeSeparation.  Then, calls
     the rest of the display graph one or two times (if stereo is enabled).  Also 
     sets an entry in the RenderState for the current Eye being rendered.
+
+    If the RenderState has a HeadPoseSlot (see VRHeadTrackingNode), the
+    HeadMatrix is read from it again before either eye is rendered, so both
+    eyes see the same, latest, pose.
  */
 class VRStereoNode : public VRDisplayNode {
 public:
@@ -53,10 +59,19 @@ public:
 protected:
 	void renderOneEye(VRDataIndex *renderState, VRRenderHandler *renderHandler, VREyePosition eye);
 	void setCameraMatrix(VRDataIndex *renderState, VREyePosition eye);
+	void latchHeadMatrix(VRDataIndex *renderState);
 
 	VRGraphicsToolkit *_gfxToolkit;
 	VRStereoFormat _format;
 	float     _iod;
+
+	// The render state values read on every frame.
+	VRDataHandle _headMatrix;
+	VRDataHandle _headPoseSlotName, _posePredictionTime;
+	std::string _latchedSlotName;
+	VRPoseSlot *_latchedSlot;
+	VRDataHandle _viewportX, _viewportY, _viewportWidth, _viewportHeight;
+	VRDataHandle _windowWidth, _windowHeight;
 };
 
 
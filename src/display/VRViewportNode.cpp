@@ -23,7 +23,7 @@ VRViewportNode::~VRViewportNode() {
 }
 
 void VRViewportNode::render(VRDataIndex *renderState, VRRenderHandler *renderHandler) {
-  renderState->pushState();
+  VRDataIndexScope scope(renderState);
 
 	// Is this the kind of state information we expect to pass from one node to the next?
 	renderState->addData("ViewportX", (int)_rect.getX());
@@ -34,8 +34,6 @@ void VRViewportNode::render(VRDataIndex *renderState, VRRenderHandler *renderHan
 	_gfxToolkit->setSubWindow(_rect);
 
 	VRDisplayNode::render(renderState, renderHandler);
-
-    renderState->popState();
 }
 
 
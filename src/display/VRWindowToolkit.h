@@ -78,6 +78,8 @@ public:
 		std::cerr << "destroyWindow() not enabled in this VRWindowToolkit." << std::endl;
 	}
 
+	/// Makes the window's context current in the calling thread.  A windowID of -1 means
+	/// the thread lets go of whatever context it has current.
 	virtual void makeWindowCurrent(int windowID) {
 		std::cerr << "makeWindowCurrent() not enabled in this VRWindowToolkit." << std::endl;
 	}
@@ -0,0 +1,79 @@
+#ifndef VRBUFFEREDINPUTDEVICE_H
+#define VRBUFFEREDINPUTDEVICE_H
+
+#include <input/VRInputDevice.h>
+#include <input/VRSampleRing.h>
+
+namespace MinVR {
+
+/// \brief A base class for input devices that read samples on a thread
+/// of their own.
+///
+/// The device's thread hands each raw sample (a pose matrix, a button
+/// number, whatever the device reads) to pushSample(), which puts it in
+/// a VRSampleRing without taking a lock or making an event.  When VRMain
+/// asks for the frame's events, the samples waiting are turned into
+/// events with appendSampleEvents(), so the cost of building events is
+/// paid once a frame, on VRMain's thread, and only for the samples that
+/// are actually used.
+///
+/// A device that has nothing else to do in
+/// appendNewInputEventsSinceLastCall() only has to write
+/// appendSampleEvents().  One that does can override it, and call
+/// appendSamples() from there.
+///
+///   ~~~
+///   class MyTracker : public VRBufferedInputDevice<VRMatrix4> {
+///     void readerThread() { while (running) pushSample(readPose()); }
+///     void appendSampleEvents(const VRMatrix4 &pose, VRDataQueue *queue) {
+///       queue->push(VRTrackerEvent::createValidDataIndex("Wand_Move", pose.toVRFloatArray()));
+///     }
+///   };
+///   ~~~
+template <typename Sample>
+class VRBufferedInputDevice : public VRInputDevice {
+public:
+
+  virtual ~VRBufferedInputDevice() {}
+
+  virtual void appendNewInputEventsSinceLastCall(VRDataQueue *queue) {
+    appendSamples(queue);
+  }
+
+  /// \brief The number of samples dropped because VRMain didn't take them
+  /// fast enough to leave room for more.
+  long getNumDroppedSamples() const { return _samples.getNumDropped(); }
+
+protected:
+
+  /// \param capacity The number of samples that can wait between frames.
+  explicit VRBufferedInputDevice(const size_t capacity = 1024) : _samples(capacity) {}
+
+  /// \brief Hands over a sample, from the device's thread.
+  ///
+  /// Only one thread may push samples.  Returns false if the sample was
+  /// dropped because there was no room for it.
+  bool pushSample(const Sample &sample) { return _samples.push(sample); }
+
+  /// \brief Turns one sample into events, on VRMain's thread.
+  virtual void appendSampleEvents(const Sample &sample, VRDataQueue *queue) = 0;
+
+  /// \brief Turns the samples that are waiting into events, oldest first.
+  ///
+  /// Samples that arrive meanwhile wait for the next call, so a fast
+  /// device can't keep this from returning.
+  void appendSamples(VRDataQueue *queue) {
+    size_t numSamples = _samples.size();
+    Sample sample;
+    for (size_t i = 0; (i < numSamples) && _samples.pop(&sample); i++) {
+      appendSampleEvents(sample, queue);
+    }
+  }
+
+private:
+  VRSampleRing<Sample> _samples;
+};
+
+} // end namespace MinVR
+
+#endif
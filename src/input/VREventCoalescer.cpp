@@ -0,0 +1,173 @@
+#include "VREventCoalescer.h"
+
+#include <main/VRError.h>
+
+#include <vector>
+#include <cmath>
+
+namespace MinVR {
+
+VREventCoalescer::Mode VREventCoalescer::parseMode(const std::string &mode) {
+
+  if (mode == "KeepAll") return KEEP_ALL;
+  if (mode == "Latest") return LATEST;
+  if (mode == "Average") return AVERAGE;
+
+  VRERROR("Unknown event coalescing mode: " + mode,
+          "Use KeepAll, Latest or Average.");
+}
+
+void VREventCoalescer::setEventMode(const std::string &eventName, const Mode mode) {
+  _eventModes[eventName] = mode;
+}
+
+void VREventCoalescer::setDeviceMode(const VRInputDevice *device, const Mode mode) {
+  _deviceModes[device] = mode;
+}
+
+VREventCoalescer::Mode VREventCoalescer::getDeviceMode(const VRInputDevice *device) const {
+  std::map<const VRInputDevice*, Mode>::const_iterator it = _deviceModes.find(device);
+  return (it == _deviceModes.end()) ? KEEP_ALL : it->second;
+}
+
+// The length of a column of a column-major 4x4 matrix.
+static float columnLength(const float *m, const int col) {
+  return sqrtf(m[4 * col] * m[4 * col] + m[4 * col + 1] * m[4 * col + 1] +
+               m[4 * col + 2] * m[4 * col + 2]);
+}
+
+// Squares up the rotation part of an averaged transform.  Averaging
+// shortens the axes, so each is given the length it has in the latest
+// transform, in case the transforms have a scale.
+static void orthonormalize(VRFloatArray *transform, const VRFloatArray &latest) {
+
+  float *m = &(*transform)[0];
+  float *x = m, *y = m + 4, *z = m + 8;
+
+  float xLength = columnLength(m, 0);
+  if ((xLength < 1.0e-6f) || (columnLength(m, 1) < 1.0e-6f)) return;
+
+  float u[3], v[3], w[3];
+  for (int i = 0; i < 3; i++) u[i] = x[i] / xLength;
+  float dot = (y[0] * u[0] + y[1] * u[1] + y[2] * u[2]);
+  for (int i = 0; i < 3; i++) v[i] = y[i] - dot * u[i];
+  float vLength = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  if (vLength < 1.0e-6f) return;
+  for (int i = 0; i < 3; i++) v[i] /= vLength;
+  w[0] = u[1] * v[2] - u[2] * v[1];
+  w[1] = u[2] * v[0] - u[0] * v[2];
+  w[2] = u[0] * v[1] - u[1] * v[0];
+  // Keep the handedness the transform came with.
+  if (w[0] * z[0] + w[1] * z[1] + w[2] * z[2] < 0.0f) {
+    for (int i = 0; i < 3; i++) w[i] = -w[i];
+  }
+
+  float xScale = columnLength(&latest[0], 0);
+  float yScale = columnLength(&latest[0], 1);
+  float zScale = columnLength(&latest[0], 2);
+  for (int i = 0; i < 3; i++) {
+    x[i] = u[i] * xScale;
+    y[i] = v[i] * yScale;
+    z[i] = w[i] * zScale;
+  }
+}
+
+void VREventCoalescer::coalesce(VRDataQueue *queue, const Mode deviceMode,
+                                std::map<std::string, long> *dropped) {
+
+  if ((deviceMode == KEEP_ALL) && _eventModes.empty()) return;
+  if (queue->size() < 2) return;
+
+  typedef std::pair<long long, VRDataQueueItem> Item;
+  std::vector<Item> items;
+  items.reserve(queue->size());
+  for (VRDataQueue::iterator it = queue->begin(); it != queue->end(); it++) {
+    items.push_back(Item(it->first.first, it->second));
+  }
+
+  // The events to coalesce, by name, and their modes.
+  std::map<std::string, std::vector<size_t> > groups;
+  std::map<std::string, Mode> groupModes;
+  for (size_t i = 0; i < items.size(); i++) {
+
+    const VRDataIndex &event = items[i].second.getData();
+    const std::string name = event.getName();
+
+    Mode mode = KEEP_ALL;
+    std::map<std::string, Mode>::const_iterator it = _eventModes.find(name);
+    if (it != _eventModes.end()) {
+      mode = it->second;
+    } else if ((deviceMode != KEEP_ALL) && event.exists("EventType")) {
+      std::string type = event.getValue("EventType");
+      if ((type == "TrackerMove") || (type == "AnalogUpdate")) mode = deviceMode;
+    }
+    if (mode == KEEP_ALL) continue;
+
+    groups[name].push_back(i);
+    groupModes[name] = mode;
+  }
+
+  std::vector<bool> keep(items.size(), true);
+  bool changed = false;
+  for (std::map<std::string, std::vector<size_t> >::iterator group = groups.begin();
+       group != groups.end(); group++) {
+
+    const std::vector<size_t> &members = group->second;
+    if (members.size() < 2) continue;
+    changed = true;
+
+    size_t latest = members.back();
+    for (size_t i = 0; i + 1 < members.size(); i++) keep[members[i]] = false;
+    if (dropped != NULL) (*dropped)[group->first] += (long)(members.size() - 1);
+    _numDropped += (long)(members.size() - 1);
+
+    if (groupModes[group->first] != AVERAGE) continue;
+
+    VRDataIndex average = items[latest].second.getData();
+    if (average.exists("Transform") &&
+        (average.getType("Transform") == VRCORETYPE_FLOATARRAY)) {
+
+      VRFloatArray latestTransform = average.getValue("Transform");
+      VRFloatArray sum = latestTransform;
+      size_t count = 1;
+      for (size_t i = 0; i + 1 < members.size(); i++) {
+        const VRDataIndex &event = items[members[i]].second.getData();
+        if (!event.exists("Transform")) continue;
+        VRFloatArray transform = event.getValue("Transform");
+        if (transform.size() != sum.size()) continue;
+        for (size_t j = 0; j < sum.size(); j++) sum[j] += transform[j];
+        count++;
+      }
+      for (size_t j = 0; j < sum.size(); j++) sum[j] /= (float)count;
+      if (sum.size() == 16) orthonormalize(&sum, latestTransform);
+      average.addData("Transform", sum);
+
+    } else if (average.exists("AnalogValue") &&
+               (average.getType("AnalogValue") == VRCORETYPE_FLOAT)) {
+
+      double sum = 0.0;
+      size_t count = 0;
+      for (size_t i = 0; i < members.size(); i++) {
+        const VRDataIndex &event = items[members[i]].second.getData();
+        if (!event.exists("AnalogValue") ||
+            (event.getType("AnalogValue") != VRCORETYPE_FLOAT)) continue;
+        sum += (VRFloat)event.getValue("AnalogValue");
+        count++;
+      }
+      average.addData("AnalogValue", (VRFloat)(sum / count));
+
+    } else {
+      continue;
+    }
+    items[latest].second = VRDataQueueItem(average);
+  }
+
+  if (!changed) return;
+
+  queue->clear();
+  for (size_t i = 0; i < items.size(); i++) {
+    if (keep[i]) queue->push(items[i].first, items[i].second);
+  }
+}
+
+} // end namespace MinVR
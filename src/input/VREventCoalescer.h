@@ -0,0 +1,91 @@
+#ifndef VREVENTCOALESCER_H
+#define VREVENTCOALESCER_H
+
+#include <string>
+#include <map>
+#include <config/VRDataQueue.h>
+#include <input/VRInputDevice.h>
+
+namespace MinVR {
+
+/// \brief Cuts a frame's tracker and analog samples down to the ones
+/// the program needs.
+///
+/// A tracker read at 240 Hz can put four or more samples of the same
+/// tracker into each frame's event queue, and every one of them is then
+/// sent to the other nodes of a cluster and handed to every event
+/// handler, though most programs only look at the last one.  VRMain runs
+/// the events gathered each frame through one of these before they are
+/// synchronized, which, for each event name, can:
+///
+/// - KEEP_ALL of them (the default);
+/// - keep only the LATEST one; or
+/// - replace them with their AVERAGE, which is the latest event with the
+///   Transform (of a TrackerMove event) or AnalogValue (of an
+///   AnalogUpdate event) averaged over all of them.  The averaged
+///   rotation is squared up again, so it is still a rotation.  Other
+///   kinds of events have nothing to average, so only the latest is
+///   kept.
+///
+/// The surviving event keeps its place in time.  The rest are dropped,
+/// and counted in the frame stats (as "droppedSamples", with the event
+/// name as the detail; see VRFrameProfiler) and in getNumDropped().
+///
+/// To coalesce everything a device reports, give the device a Coalesce
+/// setting.  This only applies to its TrackerMove and AnalogUpdate
+/// events, so no button press is ever lost.  (Such a device gathers its
+/// events into a queue of its own, so it doesn't see the events the
+/// devices before it gathered.)  For particular events, use a
+/// CoalesceEvents container in the VRSetup, which applies to events of
+/// any kind:
+/// \verbatim
+/// <Tracker inputdeviceType="VRVRPNTrackerDevice">
+///   <Coalesce>Latest</Coalesce>
+///   ...
+/// </Tracker>
+/// <CoalesceEvents>
+///   <Wand_Move>Average</Wand_Move>
+///   <Mouse_Move>Latest</Mouse_Move>
+/// </CoalesceEvents>
+/// \endverbatim
+class VREventCoalescer {
+public:
+  enum Mode { KEEP_ALL, LATEST, AVERAGE };
+
+  VREventCoalescer() : _numDropped(0) {}
+
+  /// \brief Reads a mode from a config value: KeepAll, Latest or Average.
+  static Mode parseMode(const std::string &mode);
+
+  /// \brief Sets the mode for the events with this name, from any device.
+  void setEventMode(const std::string &eventName, const Mode mode);
+
+  /// \brief Sets the mode for a device's tracker and analog events.
+  void setDeviceMode(const VRInputDevice *device, const Mode mode);
+
+  /// \brief The device's mode, KEEP_ALL if it hasn't been given one.
+  Mode getDeviceMode(const VRInputDevice *device) const;
+
+  /// \brief True if any events have a mode other than KEEP_ALL.
+  bool hasEventModes() const { return !_eventModes.empty(); }
+
+  /// \brief Coalesces the events in the queue.
+  ///
+  /// The deviceMode applies to the tracker and analog events without a
+  /// mode of their own.  The number dropped for each event name is added
+  /// to dropped, if it isn't NULL.
+  void coalesce(VRDataQueue *queue, const Mode deviceMode = KEEP_ALL,
+                std::map<std::string, long> *dropped = NULL);
+
+  /// \brief The number of events dropped so far.
+  long getNumDropped() const { return _numDropped; }
+
+private:
+  std::map<std::string, Mode> _eventModes;
+  std::map<const VRInputDevice*, Mode> _deviceModes;
+  long _numDropped;
+};
+
+} // end namespace MinVR
+
+#endif
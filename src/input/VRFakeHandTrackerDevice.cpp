@@ -16,6 +16,7 @@ VRFakeHandTrackerDevice::VRFakeHandTrackerDevice(const std::string &trackerName,
                                          std::vector<std::string> rotKeys)
 {
     _eventName = trackerName + "_Move";
+    _poseSlot = VRPoseSlot::get(_eventName);
     _toggleEvent = toggleOnOffEventName;
     _xyScale = xyScale;
     _zScale = zScale;
@@ -87,6 +88,7 @@ void VRFakeHandTrackerDevice::onVREvent(const VRDataIndex &event)
 
                 VRDataIndex di = VRTrackerEvent::createValidDataIndex(_eventName, xform.toVRFloatArray());
                 _pendingEvents.push(di);
+                _poseSlot->publish(xform);
             }
             
             _lastMouseX = mousex;
@@ -124,7 +126,17 @@ VRFakeHandTrackerDevice::create(VRMainInterface *vrMain, VRDataIndex *config, co
     
     
     VRFakeHandTrackerDevice *dev = new VRFakeHandTrackerDevice(trackerName, toggleEvent, xyScale, zScale, rScale, zKeys, rotKeys);
-    vrMain->addEventHandler(dev);
+
+    // Only ask for the events onVREvent() looks at.
+    vrMain->addEventHandler(dev, toggleEvent);
+    vrMain->addEventHandler(dev, "Mouse_Move");
+    std::vector<std::string> *keys[] = { &zKeys, &rotKeys };
+    for (int k = 0; k < 2; k++) {
+        for (std::vector<std::string>::iterator it = keys[k]->begin(); it < keys[k]->end(); ++it) {
+            vrMain->addEventHandler(dev, *it + "_Down");
+            vrMain->addEventHandler(dev, *it + "_Up");
+        }
+    }
 
     return dev;
 }
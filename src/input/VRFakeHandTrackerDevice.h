@@ -19,6 +19,7 @@
 #include <config/VRDataIndex.h>
 #include <config/VRDataQueue.h>
 #include <input/VRInputDevice.h>
+#include <input/VRPoseSlot.h>
 #include <main/VRFactory.h>
 #include <math/VRMath.h>
 
@@ -68,6 +69,7 @@ public:
 private:
     
     std::string _eventName;
+    VRPoseSlot *_poseSlot;
     std::string _toggleEvent;
     float _xyScale;
     float _zScale;
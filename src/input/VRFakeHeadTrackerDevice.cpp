@@ -19,6 +19,7 @@ VRFakeHeadTrackerDevice::VRFakeHeadTrackerDevice(const std::string &trackerName,
                                          std::vector<std::string> mouseRotKeys)
 {
     _eventName = trackerName + "_Move";
+    _poseSlot = VRPoseSlot::get(_eventName);
     _toggleEvent = toggleOnOffEventName;
     _tScale = tScale;
     _rScale = rScale;
@@ -126,6 +127,7 @@ void VRFakeHeadTrackerDevice::onVREvent(const VRDataIndex &event)
             VRMatrix4 M = _baseHead * _addedRot;
             VRDataIndex di = VRTrackerEvent::createValidDataIndex(_eventName, M.toVRFloatArray());
             _pendingEvents.push(di);
+            _poseSlot->publish(M);
         }
     }
 }
@@ -209,7 +211,21 @@ VRFakeHeadTrackerDevice::create(VRMainInterface *vrMain, VRDataIndex *config, co
     
     VRFakeHeadTrackerDevice *dev = new VRFakeHeadTrackerDevice(trackerName, toggleEvent, tScale, rScale,
         headMatrix, forwardKeys, backKeys, leftKeys, rightKeys, mouseRotKeys);
-    vrMain->addEventHandler(dev);
+
+    // Only ask for the events onVREvent() looks at.
+    vrMain->addEventHandler(dev, toggleEvent);
+    vrMain->addEventHandler(dev, "Mouse_Move");
+    std::vector<std::string> *moveKeys[] = { &forwardKeys, &backKeys, &leftKeys, &rightKeys };
+    for (int k = 0; k < 4; k++) {
+        for (std::vector<std::string>::iterator it = moveKeys[k]->begin(); it < moveKeys[k]->end(); ++it) {
+            vrMain->addEventHandler(dev, *it + "_Down");
+            vrMain->addEventHandler(dev, *it + "_Repeat");
+        }
+    }
+    for (std::vector<std::string>::iterator it = mouseRotKeys.begin(); it < mouseRotKeys.end(); ++it) {
+        vrMain->addEventHandler(dev, *it + "_Down");
+        vrMain->addEventHandler(dev, *it + "_Up");
+    }
 
     return dev;
 }
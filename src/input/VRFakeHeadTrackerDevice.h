@@ -19,6 +19,7 @@
 #include <config/VRDataIndex.h>
 #include <config/VRDataQueue.h>
 #include <input/VRInputDevice.h>
+#include <input/VRPoseSlot.h>
 #include <main/VRFactory.h>
 #include <math/VRMath.h>
 
@@ -70,6 +71,7 @@ private:
     
     bool _tracking;
     std::string _eventName;
+    VRPoseSlot *_poseSlot;
     std::string _toggleEvent;
     float _tScale;
     float _rScale;
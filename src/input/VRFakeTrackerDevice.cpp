@@ -22,6 +22,7 @@ VRFakeTrackerDevice::VRFakeTrackerDevice(const std::string &trackerName,
 {
     _trackerName = trackerName;
     _eventName = trackerName + "_Move";
+    _poseSlot = VRPoseSlot::get(_eventName);
     _toggleEvent = toggleOnOffEventName;
     _rotateOnEvent = rotateEventName + "_Down";
     _rotateOffEvent = rotateEventName + "_Up";
@@ -53,8 +54,8 @@ VRFakeTrackerDevice::VRFakeTrackerDevice(const std::string &trackerName,
                                                  0, 0, 0, 1);
     _transform = VRMatrix4::translation(_statePos) * _stateRot;
 
-    VRDataIndex di = VRTrackerEvent::createValidDataIndex(_eventName, _transform.toVRFloatArray());
-    _pendingEvents.push(di);
+    pushSample(_transform);
+    _poseSlot->publish(_transform);
 
     // Explain how to use it, if we're logging.
     VRLOG_H2("Initializing fake tracker: " + trackerName);
@@ -178,8 +179,8 @@ void VRFakeTrackerDevice::onVREvent(const VRDataIndex &eventData)
 
         _transform = VRMatrix4::translation(_statePos) * _stateRot;
 
-        VRDataIndex di = VRTrackerEvent::createValidDataIndex(_eventName, _transform.toVRFloatArray());
-        _pendingEvents.push(di);
+        pushSample(_transform);
+        _poseSlot->publish(_transform);
       }
 
       _lastMouseX = mousex;
@@ -189,10 +190,9 @@ void VRFakeTrackerDevice::onVREvent(const VRDataIndex &eventData)
 }
 
 
-void VRFakeTrackerDevice::appendNewInputEventsSinceLastCall(VRDataQueue* inputEvents)
+void VRFakeTrackerDevice::appendSampleEvents(const VRMatrix4 &transform, VRDataQueue* inputEvents)
 {
-  inputEvents->addQueue(_pendingEvents);
-  _pendingEvents.clear();
+  inputEvents->push(VRTrackerEvent::createValidDataIndex(_eventName, transform.toVRFloatArray()));
 }
 
 std::string VRFakeTrackerDevice::printInstructions() {
@@ -281,7 +281,15 @@ VRFakeTrackerDevice::create(VRMainInterface *vrMain, VRDataIndex *config, const
                                                        startPos,
                                                        startCtr,
                                                        startUp);
-    vrMain->addEventHandler(dev);
+
+    // Only ask for the events onVREvent() looks at.
+    vrMain->addEventHandler(dev, toggleEvent);
+    vrMain->addEventHandler(dev, "Mouse_Move");
+    std::string keys[] = { rotateEvent, rollEvent, translateEvent, translateZEvent };
+    for (int k = 0; k < 4; k++) {
+      vrMain->addEventHandler(dev, keys[k] + "_Down");
+      vrMain->addEventHandler(dev, keys[k] + "_Up");
+    }
 
     return dev;
 }
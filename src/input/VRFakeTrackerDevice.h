@@ -19,7 +19,8 @@
 
 #include <config/VRDataIndex.h>
 #include <config/VRDataQueue.h>
-#include <input/VRInputDevice.h>
+#include <input/VRBufferedInputDevice.h>
+#include <input/VRPoseSlot.h>
 #include <main/VRFactory.h>
 #include <math/VRMath.h>
 
@@ -78,7 +79,7 @@ namespace MinVR {
     See the output of printInstruction() for the values in use.
 
   */
-class VRFakeTrackerDevice : public VRInputDevice, public VREventHandler {
+class VRFakeTrackerDevice : public VRBufferedInputDevice<VRMatrix4>, public VREventHandler {
 public:
 
     VRFakeTrackerDevice(const std::string &trackerName,
@@ -104,8 +105,6 @@ public:
     /// whoever is listening to them.  The input is an event string.
     void onVREvent(const VRDataIndex &eventData);
 
-    void appendNewInputEventsSinceLastCall(VRDataQueue* inputEvents);
-
     /// Produces a string of instructions about how to use this tracker, given
     /// all the input options.
     std::string printInstructions();
@@ -121,6 +120,8 @@ private:
     std::string _trackerName;
     /// The actual name of the event the tracker will produce.
     std::string _eventName;
+    /// Where the poses are published, for late latching.
+    VRPoseSlot *_poseSlot;
 
     /// The key name of the event that will toggle on and off the production
     /// of events by the fake tracker device.
@@ -185,8 +186,8 @@ private:
     /// keep track of the last measured location.
     float _lastMouseX, _lastMouseY;
 
-    /// The queue of events we are planning to send.
-    VRDataQueue _pendingEvents;
+    /// Makes the tracker event for each pose sent since the last frame.
+    void appendSampleEvents(const VRMatrix4 &transform, VRDataQueue* inputEvents);
 };
 
 } // end namespace
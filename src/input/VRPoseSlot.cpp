@@ -0,0 +1,195 @@
+#include "VRPoseSlot.h"
+
+#include <main/VRSystem.h>
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <cmath>
+
+namespace MinVR {
+
+// Element (row, col) of a column-major 4x4 matrix.
+#define POSE(a, row, col) (a)[(col) * 4 + (row)]
+
+VRPoseSlot* VRPoseSlot::get(const std::string &eventName) {
+
+  // The slots are never deleted, since a device thread could still be
+  // publishing to one while the program exits.
+  static std::mutex registryMutex;
+  static std::map<std::string, VRPoseSlot*> *registry = new std::map<std::string, VRPoseSlot*>();
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+  std::map<std::string, VRPoseSlot*>::iterator it = registry->find(eventName);
+  if (it != registry->end()) return it->second;
+
+  VRPoseSlot *slot = new VRPoseSlot();
+  (*registry)[eventName] = slot;
+  return slot;
+}
+
+VRPoseSlot::VRPoseSlot() : _sequence(0), _numPublished(0), _time(-1.0), _hasVelocity(false) {
+
+  for (int i = 0; i < 16; i++) {
+    _pose[i].store((i % 5 == 0) ? 1.0f : 0.0f, std::memory_order_relaxed);
+    _last.pose[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+  }
+  for (int i = 0; i < 3; i++) {
+    _velocity[i].store(0.0f, std::memory_order_relaxed);
+    _angularVelocity[i].store(0.0f, std::memory_order_relaxed);
+    _last.velocity[i] = 0.0f;
+    _last.angularVelocity[i] = 0.0f;
+  }
+  _last.time = 0.0;
+}
+
+void VRPoseSlot::publish(const VRMatrix4 &pose, double time) {
+
+  if (time < 0.0) time = VRSystem::getTime();
+
+  // Take our turn: make the sequence odd.
+  unsigned long sequence = _sequence.load(std::memory_order_relaxed);
+  while (true) {
+    if (((sequence & 1) == 0) &&
+        _sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) break;
+    std::this_thread::yield();
+    sequence = _sequence.load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  State next;
+  for (int row = 0; row < 4; row++) {
+    for (int col = 0; col < 4; col++) POSE(next.pose, row, col) = pose(row, col);
+  }
+  next.time = time;
+
+  // The velocities since the last pose, smoothed a little, since
+  // trackers jitter and differences make that worse.
+  double dt = time - _last.time;
+  if ((_numPublished.load(std::memory_order_relaxed) > 0) && (dt > 0.0) &&
+      (dt <= getMaxPrediction())) {
+
+    float velocity[3], angularVelocity[3];
+    for (int i = 0; i < 3; i++) {
+      velocity[i] = (float)((POSE(next.pose, i, 3) - POSE(_last.pose, i, 3)) / dt);
+    }
+
+    // The rotation from the last orientation to this one is
+    // D = R1 * R0^T.  Its axis and angle come from its skew-symmetric
+    // part and its trace.
+    float D[3][3];
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        D[i][j] = 0.0f;
+        for (int k = 0; k < 3; k++) D[i][j] += POSE(next.pose, i, k) * POSE(_last.pose, j, k);
+      }
+    }
+    float axis[3] = { D[2][1] - D[1][2], D[0][2] - D[2][0], D[1][0] - D[0][1] };
+    float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    float angle = atan2f(0.5f * length, 0.5f * (D[0][0] + D[1][1] + D[2][2] - 1.0f));
+    for (int i = 0; i < 3; i++) {
+      angularVelocity[i] = (length > 1.0e-6f) ? (float)(axis[i] / length * angle / dt) : 0.0f;
+    }
+
+    const float weight = _hasVelocity ? 0.5f : 1.0f;
+    for (int i = 0; i < 3; i++) {
+      next.velocity[i] = weight * velocity[i] + (1.0f - weight) * _last.velocity[i];
+      next.angularVelocity[i] = weight * angularVelocity[i] + (1.0f - weight) * _last.angularVelocity[i];
+    }
+    _hasVelocity = true;
+
+  } else {
+    for (int i = 0; i < 3; i++) {
+      next.velocity[i] = 0.0f;
+      next.angularVelocity[i] = 0.0f;
+    }
+    _hasVelocity = false;
+  }
+
+  for (int i = 0; i < 16; i++) _pose[i].store(next.pose[i], std::memory_order_relaxed);
+  for (int i = 0; i < 3; i++) {
+    _velocity[i].store(next.velocity[i], std::memory_order_relaxed);
+    _angularVelocity[i].store(next.angularVelocity[i], std::memory_order_relaxed);
+  }
+  _time.store(time, std::memory_order_relaxed);
+  _last = next;
+  _numPublished.fetch_add(1, std::memory_order_relaxed);
+
+  _sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void VRPoseSlot::_read(State *state) const {
+
+  while (true) {
+    unsigned long before = _sequence.load(std::memory_order_acquire);
+    if ((before & 1) == 0) {
+      for (int i = 0; i < 16; i++) state->pose[i] = _pose[i].load(std::memory_order_relaxed);
+      for (int i = 0; i < 3; i++) {
+        state->velocity[i] = _velocity[i].load(std::memory_order_relaxed);
+        state->angularVelocity[i] = _angularVelocity[i].load(std::memory_order_relaxed);
+      }
+      state->time = _time.load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_sequence.load(std::memory_order_relaxed) == before) return;
+    }
+    std::this_thread::yield();
+  }
+}
+
+bool VRPoseSlot::read(VRMatrix4 *pose, double *time) const {
+
+  State state;
+  _read(&state);
+  if (state.time < 0.0) return false;
+  *pose = VRMatrix4(state.pose);
+  if (time != NULL) *time = state.time;
+  return true;
+}
+
+bool VRPoseSlot::predict(const double displayTime, VRMatrix4 *pose) const {
+
+  State state;
+  _read(&state);
+  if (state.time < 0.0) return false;
+
+  // A tracker that has stopped publishing (a fake one whose mouse has
+  // stopped, say) has stopped moving, as far as we know.
+  double dt = displayTime - state.time;
+  if ((dt < 0.0) || (dt > getMaxPrediction())) dt = 0.0;
+
+  float out[16];
+  for (int i = 0; i < 16; i++) out[i] = state.pose[i];
+
+  // Position.
+  for (int i = 0; i < 3; i++) POSE(out, i, 3) += (float)(state.velocity[i] * dt);
+
+  // Orientation: turn by the angle the angular velocity covers in dt,
+  // about its axis, with Rodrigues' formula, R = I + sin(a) K + (1 - cos(a)) K^2.
+  const float *w = state.angularVelocity;
+  float speed = sqrtf(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+  float angle = (float)(speed * dt);
+  if (angle > 1.0e-7f) {
+    float x = w[0] / speed, y = w[1] / speed, z = w[2] / speed;
+    float s = sinf(angle), c = 1.0f - cosf(angle);
+    float R[3][3] = {
+      { 1.0f - c * (y * y + z * z), -s * z + c * x * y,          s * y + c * x * z },
+      { s * z + c * x * y,           1.0f - c * (x * x + z * z), -s * x + c * y * z },
+      { -s * y + c * x * z,          s * x + c * y * z,          1.0f - c * (x * x + y * y) }
+    };
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        float sum = 0.0f;
+        for (int k = 0; k < 3; k++) sum += R[i][k] * POSE(state.pose, k, j);
+        POSE(out, i, j) = sum;
+      }
+    }
+  }
+
+  *pose = VRMatrix4(out);
+  return true;
+}
+
+#undef POSE
+
+} // end namespace MinVR
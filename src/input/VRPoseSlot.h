@@ -0,0 +1,95 @@
+#ifndef VRPOSESLOT_H
+#define VRPOSESLOT_H
+
+#include <string>
+#include <atomic>
+#include <math/VRMath.h>
+
+namespace MinVR {
+
+/// \brief The latest pose of a tracker, for reading just before rendering.
+///
+/// Tracker events reach the display graph when they are handled at the
+/// start of the frame, and by the time the frame is on the screen, the
+/// head has moved on.  An input device can also publish each pose it
+/// gets here, as soon as it gets it, and the display nodes can read the
+/// newest one at the last moment ("late latching").  See
+/// VRHeadTrackingNode for how it is used.
+///
+/// There is one slot per tracker event name, made by get().  Publishing
+/// and reading never wait for a lock: the pose is guarded by a sequence
+/// number (a "seqlock"), which a reader checks before and after copying
+/// the pose, trying again in the unlikely case that it changed in
+/// between.  Any number of threads can read.  Publishers take turns.
+///
+/// Each slot also keeps the tracker's linear and angular velocity,
+/// worked out from the last two poses, so that predict() can extrapolate
+/// the pose to the time the frame will be displayed.
+class VRPoseSlot {
+public:
+
+  /// \brief Returns the slot for tracker events with this name, making
+  /// it if need be.
+  ///
+  /// The slot lasts as long as the program, so the pointer can be kept.
+  static VRPoseSlot* get(const std::string &eventName);
+
+  VRPoseSlot();
+
+  /// \brief Publishes a new pose, measured at the given time (in seconds,
+  /// from VRSystem::getTime()), or now if the time is negative.
+  void publish(const VRMatrix4 &pose, double time = -1.0);
+
+  /// \brief Copies the latest pose, and the time it was measured.
+  ///
+  /// Returns false, and leaves them alone, if nothing has been published.
+  bool read(VRMatrix4 *pose, double *time = NULL) const;
+
+  /// \brief Extrapolates the latest pose to the given time.
+  ///
+  /// The position moves along with the velocity, and the orientation
+  /// turns with the angular velocity.  If the latest pose is more than
+  /// getMaxPrediction() seconds old, or newer than the given time, it is
+  /// returned as it is.  Returns false if nothing has been published.
+  bool predict(const double displayTime, VRMatrix4 *pose) const;
+
+  /// \brief The number of poses published so far.
+  long getNumPublished() const { return _numPublished.load(std::memory_order_relaxed); }
+
+  /// \brief A pose older than this, in seconds, is not extrapolated at
+  /// all, so one that stops coming isn't sent off into the distance.
+  /// Poses further apart than this don't give a velocity either.
+  static double getMaxPrediction() { return 0.1; }
+
+private:
+  struct State {
+    float pose[16];
+    float velocity[3];
+    float angularVelocity[3];
+    double time;
+  };
+
+  // Copies the published state, consistently.
+  void _read(State *state) const;
+
+  // Odd while a publisher is writing.
+  std::atomic<unsigned long> _sequence;
+  std::atomic<long> _numPublished;
+
+  // The published state.  These are atomics only so that reading them
+  // while they are written is allowed; the sequence is what makes a
+  // copy consistent.
+  std::atomic<float> _pose[16];
+  std::atomic<float> _velocity[3];
+  std::atomic<float> _angularVelocity[3];
+  // Negative until something is published.
+  std::atomic<double> _time;
+
+  // Only used by whoever is publishing.
+  State _last;
+  bool _hasVelocity;
+};
+
+} // end namespace MinVR
+
+#endif
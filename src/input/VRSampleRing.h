@@ -0,0 +1,89 @@
+#ifndef VRSAMPLERING_H
+#define VRSAMPLERING_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+namespace MinVR {
+
+/// \brief A fixed-size queue for passing samples from one thread to
+/// another without locking.
+///
+/// One thread (a device's reading thread, say) calls push(), and one
+/// other thread (the one running VRMain) calls pop().  Neither ever
+/// waits for the other: each index is written by only one of them, and
+/// a slot belongs to whichever side the indices say it does.  If the
+/// queue is full, push() drops the sample and counts it, rather than
+/// waiting for room.
+///
+/// The capacity is rounded up to a power of two.
+template <typename T>
+class VRSampleRing {
+public:
+
+  explicit VRSampleRing(const size_t capacity = 1024) : _head(0), _tail(0), _numDropped(0) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    _slots.resize(size);
+    _mask = size - 1;
+  }
+
+  /// \brief Adds a sample.  Only the producing thread may call this.
+  ///
+  /// Returns false, and drops the sample, if the queue is full.
+  bool push(const T &sample) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) > _mask) {
+      _numDropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    _slots[tail & _mask] = sample;
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// \brief Takes the oldest sample.  Only the consuming thread may call
+  /// this.
+  ///
+  /// Returns false, and leaves the sample alone, if the queue is empty.
+  bool pop(T *sample) {
+    size_t head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire)) return false;
+    *sample = _slots[head & _mask];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// \brief The number of samples waiting.  Only exact from the consuming
+  /// thread, and then only a lower bound, since more can arrive.
+  size_t size() const {
+    return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return _slots.size(); }
+
+  /// \brief The number of samples push() has dropped because the queue
+  /// was full.
+  long getNumDropped() const { return _numDropped.load(std::memory_order_relaxed); }
+
+private:
+  VRSampleRing(const VRSampleRing &);
+  VRSampleRing& operator=(const VRSampleRing &);
+
+  std::vector<T> _slots;
+  size_t _mask;
+
+  // The next slot to read, written only by the consumer, and the next
+  // to write, written only by the producer.  They are kept on separate
+  // cache lines, so the two threads don't slow each other down.
+  std::atomic<size_t> _head;
+  char _padding[64];
+  std::atomic<size_t> _tail;
+
+  std::atomic<long> _numDropped;
+};
+
+} // end namespace MinVR
+
+#endif
@@ -0,0 +1,45 @@
+/** 
+This file is part of the MinVR Open Source Project, which is developed and 
+maintained collaboratively by the University of Minnesota and Brown University.
+
+Copyright (c) 2016 Regents of the University of Minnesota and Brown University.
+This software is distributed under the BSD-3 Clause license, which can be found
+at: MinVR/LICENSE.txt.
+
+Original Author(s) of this File: 
+	Dan Keefe, 2017, University of Minnesota
+	
+Author(s) of Significant Updates/Modifications to the File:
+	... 
+*/
+
+
+// The file VRConfig.h.in is processed by cmake to produce VRConfig.h.  This
+// replaces  with the values setup in the cmake build process.
+
+
+#define MINVR_VERSION_MAJOR 2
+#define MINVR_VERSION_MINOR 0
+#define MINVR_VERSION_PATCH 0
+#define MINVR_VERSION_STR "-2.0"
+
+
+#define MINVR_INSTALL_PREFIX "/root/repo/_gate_build/install"
+#define MINVR_INSTALL_CONFIG_DIR "/root/repo/_gate_build/install/share/MinVR-2.0/config"
+#ifdef WIN32
+  #define MINVR_INSTALL_PLUGIN_DIR "/root/repo/_gate_build/install/bin/MinVR-2.0"
+#else
+  #define MINVR_INSTALL_PLUGIN_DIR "/root/repo/_gate_build/install/lib/MinVR-2.0"
+#endif
+
+
+#define MINVR_BUILD_PREFIX "/root/repo"
+#define MINVR_BUILD_CONFIG_DIR "/root/repo/config"
+#ifdef WIN32
+  #define MINVR_BUILD_PLUGIN_DIR "/root/repo/_gate_build/bin"
+#else
+  #define MINVR_BUILD_PLUGIN_DIR "/root/repo/_gate_build/lib"
+#endif
+
+
+
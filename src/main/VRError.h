@@ -5,6 +5,7 @@
 #include <string.h>
 #include <sstream>
 #include <iostream>
+#include <main/VRLog.h>
 
 // When multiple processes are writing to the same terminal, their
 // output gets mixed up if you just use std::cout or std::cerr.  Using
@@ -80,6 +81,9 @@ public:
 
     // Convert the line number to a string.
     std::stringstream ss; ss << whereLine; _whereLine = ss.str();
+
+    // Anything logged before this should appear before it.
+    VRLog::flush();
 	std::cerr << _errorMessage() << std::endl;
   };
 
@@ -144,6 +148,7 @@ public:
       out += "\n" + adviceMsg;
     }
 
+    VRLog::flush();
     std::cerr << out << std::endl;
   }
 
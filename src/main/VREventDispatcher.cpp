@@ -0,0 +1,144 @@
+#include "VREventDispatcher.h"
+
+#include <algorithm>
+
+namespace MinVR {
+
+// Programs that make up new event names all the time (with a counter in
+// them, say) would otherwise grow the table without end.
+static const size_t maxTableSize = 4096;
+
+VREventDispatcher::VREventDispatcher() : _generation(0) {}
+
+size_t VREventDispatcher::_indexOf(VREventHandler *handler) {
+
+  std::vector<VREventHandler*>::iterator it =
+    std::find(_handlers.begin(), _handlers.end(), handler);
+  if (it != _handlers.end()) return (size_t)(it - _handlers.begin());
+
+  _handlers.push_back(handler);
+  _getsEverything.push_back(false);
+  return _handlers.size() - 1;
+}
+
+void VREventDispatcher::_clearTable() {
+  _table.clear();
+  _generation++;
+}
+
+void VREventDispatcher::addHandler(VREventHandler *handler) {
+
+  _getsEverything[_indexOf(handler)] = true;
+  _clearTable();
+}
+
+void VREventDispatcher::addHandler(VREventHandler *handler,
+                                   const std::string &eventNamePattern) {
+
+  size_t i = _indexOf(handler);
+
+  size_t wild = eventNamePattern.find_first_of("*?");
+  if (wild == std::string::npos) {
+    _exact[eventNamePattern].push_back(i);
+  } else if ((wild == eventNamePattern.size() - 1) && (eventNamePattern[wild] == '*')) {
+    _prefixes.push_back(std::make_pair(eventNamePattern.substr(0, wild), i));
+  } else {
+    _globs.push_back(std::make_pair(eventNamePattern, i));
+  }
+  _clearTable();
+}
+
+std::vector<size_t> VREventDispatcher::_findHandlersFor(const std::string &eventName) const {
+
+  std::vector<bool> wanted(_getsEverything);
+
+  std::unordered_map<std::string, std::vector<size_t> >::const_iterator e = _exact.find(eventName);
+  if (e != _exact.end()) {
+    for (size_t j = 0; j < e->second.size(); j++) wanted[e->second[j]] = true;
+  }
+
+  for (size_t j = 0; j < _prefixes.size(); j++) {
+    const std::string &prefix = _prefixes[j].first;
+    if ((eventName.size() >= prefix.size()) &&
+        (eventName.compare(0, prefix.size(), prefix) == 0)) {
+      wanted[_prefixes[j].second] = true;
+    }
+  }
+
+  for (size_t j = 0; j < _globs.size(); j++) {
+    if (matches(_globs[j].first, eventName)) wanted[_globs[j].second] = true;
+  }
+
+  std::vector<size_t> out;
+  for (size_t i = 0; i < wanted.size(); i++) {
+    if (wanted[i]) out.push_back(i);
+  }
+  return out;
+}
+
+const std::vector<size_t> &VREventDispatcher::getHandlersFor(const std::string &eventName) {
+
+  std::unordered_map<std::string, std::vector<size_t> >::iterator it = _table.find(eventName);
+  if (it != _table.end()) return it->second;
+
+  if (_table.size() >= maxTableSize) _clearTable();
+  return _table[eventName] = _findHandlersFor(eventName);
+}
+
+void VREventDispatcher::dispatch(const VRDataIndex &event, VRFrameProfiler *profiler) {
+
+  const std::string name = event.getName();
+  const size_t numHandlers = _handlers.size();
+
+  const std::vector<size_t> *indices = &getHandlersFor(name);
+  unsigned long generation = _generation;
+  size_t j = 0;
+  while (j < indices->size()) {
+    size_t h = (*indices)[j++];
+    if (h >= numHandlers) break;
+
+    if (profiler != NULL) {
+      // There may be many events, so each handler gets a total for the
+      // frame, not a span for each call.
+      double start = VRFrameProfiler::now();
+      _handlers[h]->onVREvent(event);
+      profiler->addTime("eventHandler", (int)h, VRFrameProfiler::now() - start);
+    } else {
+      _handlers[h]->onVREvent(event);
+    }
+
+    // A handler that added another has emptied the table, and the list
+    // with it.  The new one is in the same order, so carry on after h.
+    if (_generation != generation) {
+      indices = &getHandlersFor(name);
+      generation = _generation;
+      j = std::upper_bound(indices->begin(), indices->end(), h) - indices->begin();
+    }
+  }
+}
+
+bool VREventDispatcher::matches(const std::string &pattern, const std::string &name) {
+
+  // The usual wildcard match: on a mismatch, go back to the last '*' and
+  // let it take one more character.
+  size_t p = 0, n = 0;
+  size_t star = std::string::npos, starN = 0;
+  while (n < name.size()) {
+    if ((p < pattern.size()) && ((pattern[p] == '?') || (pattern[p] == name[n]))) {
+      p++;
+      n++;
+    } else if ((p < pattern.size()) && (pattern[p] == '*')) {
+      star = p++;
+      starN = n;
+    } else if (star != std::string::npos) {
+      p = star + 1;
+      n = ++starN;
+    } else {
+      return false;
+    }
+  }
+  while ((p < pattern.size()) && (pattern[p] == '*')) p++;
+  return p == pattern.size();
+}
+
+} // end namespace MinVR
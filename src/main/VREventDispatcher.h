@@ -0,0 +1,95 @@
+#ifndef VREVENTDISPATCHER_H
+#define VREVENTDISPATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <main/VREventHandler.h>
+#include <main/VRFrameProfiler.h>
+
+namespace MinVR {
+
+/// \brief Decides which event handlers get which events.
+///
+/// A handler added with addHandler(handler) gets every event, the way
+/// they always have.  A handler added with one or more patterns only gets
+/// the events whose names match one of them.  A pattern can be
+///
+///      "Kbd1_Down"       an exact event name,
+///      "Wand_*"          a prefix: a '*' at the end and nowhere else, or
+///      "Kbd?_Down"       a glob: '*' matches any run of characters, and
+///                        '?' matches any one character.
+///
+/// Handlers are called in the order they were first added, and once per
+/// event no matter how many of their patterns match it.  A handler that
+/// was ever added without a pattern gets everything.
+///
+/// The patterns are only matched against an event name the first time
+/// it is seen; the list of handlers for that name goes in a hash table,
+/// so after that an event costs one lookup, and only the handlers that
+/// want it are called.  Adding a handler empties the table.  VRMain keeps
+/// one of these for its event handlers.
+class VREventDispatcher {
+public:
+
+  VREventDispatcher();
+
+  /// \brief Adds a handler that gets every event.
+  void addHandler(VREventHandler *handler);
+
+  /// \brief Adds a handler that gets the events whose names match the
+  /// pattern.
+  ///
+  /// Can be called several times for the same handler, with different
+  /// patterns.
+  void addHandler(VREventHandler *handler, const std::string &eventNamePattern);
+
+  size_t getNumHandlers() const { return _handlers.size(); }
+  VREventHandler *getHandler(const size_t i) const { return _handlers[i]; }
+
+  /// \brief The positions (for getHandler()) of the handlers that get
+  /// events with this name, in order.
+  ///
+  /// The reference is good until the next call to addHandler() or
+  /// getHandlersFor().
+  const std::vector<size_t> &getHandlersFor(const std::string &eventName);
+
+  /// \brief Calls onVREvent() on each handler that wants the event.
+  ///
+  /// Handlers added while the event is being dispatched don't get it.
+  /// If a profiler is given, the time each handler takes is added to its
+  /// "eventHandler" total.
+  void dispatch(const VRDataIndex &event, VRFrameProfiler *profiler = NULL);
+
+  /// \brief Returns true if the name matches the pattern, as above.
+  static bool matches(const std::string &pattern, const std::string &name);
+
+private:
+
+  // Where the handler is in _handlers, adding it if need be.
+  size_t _indexOf(VREventHandler *handler);
+
+  std::vector<size_t> _findHandlersFor(const std::string &eventName) const;
+
+  // Empties the table, which spoils any references into it.
+  void _clearTable();
+
+  std::vector<VREventHandler*> _handlers;
+  std::vector<bool> _getsEverything;
+
+  // The patterns, sorted by kind, with the handlers that gave them.
+  std::unordered_map<std::string, std::vector<size_t> > _exact;
+  std::vector<std::pair<std::string, size_t> > _prefixes;
+  std::vector<std::pair<std::string, size_t> > _globs;
+
+  // The handlers for each event name seen so far.
+  std::unordered_map<std::string, std::vector<size_t> > _table;
+  // Goes up each time the table is emptied, so dispatch() can tell when
+  // a handler has done that.
+  unsigned long _generation;
+};
+
+} // end namespace
+
+#endif
@@ -18,7 +18,9 @@ typedef VRDataIndex VREvent;
 class VREventHandler {
 public:
   /// Called from within VRMain::synchronizeAndProcessEvents() once for each
-  /// event generated since the last call to synchronizeAndProcessEvents().
+  /// event generated since the last call to synchronizeAndProcessEvents(),
+  /// or, if the handler was registered with event name patterns, for each
+  /// of those events whose name matches one.
   virtual void onVREvent(const VRDataIndex &eventData) = 0;
 };
 
@@ -0,0 +1,350 @@
+#include "VRFrameProfiler.h"
+
+#include <main/VRError.h>
+#include <main/VRLog.h>
+#include <main/VRSystem.h>
+
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+
+#ifdef WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace MinVR {
+
+// Makes a string safe to put between quotes in JSON.
+static std::string jsonEscape(const std::string &s) {
+  std::string out;
+  for (std::string::const_iterator it = s.begin(); it != s.end(); it++) {
+    if ((*it == '"') || (*it == '\\')) {
+      out += '\\';
+      out += *it;
+    } else if ((unsigned char)*it < 0x20) {
+      out += ' ';
+    } else {
+      out += *it;
+    }
+  }
+  return out;
+}
+
+double VRFrameStats::getTime(const std::string &label) const {
+  double out = 0.0;
+  for (std::vector<VRProfileSample>::const_iterator it = samples.begin();
+       it != samples.end(); it++) {
+    if (it->getLabel() == label) out += it->duration;
+  }
+  return out;
+}
+
+long VRFrameStats::getCount(const std::string &label) const {
+  long out = 0;
+  for (std::vector<VRProfileCount>::const_iterator it = counts.begin();
+       it != counts.end(); it++) {
+    if ((it->name == label) || (it->getLabel() == label)) out += it->count;
+  }
+  return out;
+}
+
+VRFrameProfiler::VRFrameProfiler() :
+  _enabled(false), _inFrame(false), _next(0), _numFrames(0),
+  _firstTraceEvent(true), _processID(0) {}
+
+VRFrameProfiler::~VRFrameProfiler() {
+  if (_trace.is_open()) {
+    _trace << "\n]\n";
+    _trace.close();
+  }
+}
+
+double VRFrameProfiler::now() {
+  return VRSystem::getTime(true);
+}
+
+void VRFrameProfiler::enable(const int historyLength) {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _frames.assign((historyLength > 0) ? historyLength : 1, VRFrameStats());
+  _next = 0;
+  _numFrames = 0;
+  _inFrame = false;
+  _enabled = true;
+}
+
+bool VRFrameProfiler::writeTrace(const std::string &fileName,
+                                 const std::string &processName) {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _trace.open(fileName.c_str(), std::ios::out | std::ios::trunc);
+  if (!_trace.is_open()) return false;
+
+  _processID = getpid();
+  _trace << "[";
+  _firstTraceEvent = true;
+
+  std::stringstream event;
+  event << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << _processID
+        << ",\"args\":{\"name\":\"" << jsonEscape(processName) << "\"}}";
+  _writeEvent(event.str());
+  return true;
+}
+
+std::string VRFrameProfiler::getTraceFileName(const std::string &fileName,
+                                              const std::string &nodeName) {
+  return VRLog::getNodeFileName(fileName, nodeName, ".json");
+}
+
+int VRFrameProfiler::_getThread() {
+
+  std::thread::id id = std::this_thread::get_id();
+  std::map<std::thread::id, int>::iterator it = _threads.find(id);
+  if (it != _threads.end()) return it->second;
+
+  int thread = (int)_threads.size();
+  _threads[id] = thread;
+  return thread;
+}
+
+void VRFrameProfiler::beginFrame(const int frame) {
+
+  if (!_enabled) return;
+  if (_inFrame) endFrame();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  VRFrameStats &stats = _frames[_next];
+  stats.frame = frame;
+  stats.start = now();
+  stats.duration = 0.0;
+  stats.samples.clear();
+  stats.counts.clear();
+  _inFrame = true;
+}
+
+void VRFrameProfiler::endFrame() {
+
+  if (!_enabled) return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_inFrame) return;
+
+  VRFrameStats &stats = _frames[_next];
+  stats.duration = now() - stats.start;
+  _inFrame = false;
+
+  if (_trace.is_open()) _writeFrame(stats);
+
+  _next = (_next + 1) % _frames.size();
+  if (_numFrames < (int)_frames.size()) _numFrames++;
+}
+
+void VRFrameProfiler::addSample(const char *name, const std::string &detail,
+                                const double start, const double end) {
+
+  if (!_enabled) return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_inFrame) return;
+
+  VRProfileSample sample;
+  sample.name = name;
+  sample.detail = detail;
+  sample.start = start;
+  sample.duration = end - start;
+  sample.calls = 1;
+  sample.isTotal = false;
+  sample.thread = _getThread();
+  _frames[_next].samples.push_back(sample);
+}
+
+void VRFrameProfiler::addTime(const char *name, const int index,
+                              const double seconds) {
+
+  if (!_enabled) return;
+
+  char detail[16] = "";
+  if (index >= 0) snprintf(detail, sizeof(detail), "%d", index);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_inFrame) return;
+
+  std::vector<VRProfileSample> &samples = _frames[_next].samples;
+  for (std::vector<VRProfileSample>::iterator it = samples.begin();
+       it != samples.end(); it++) {
+    if (it->isTotal && (it->name == name) && (it->detail == detail)) {
+      it->duration += seconds;
+      it->calls++;
+      return;
+    }
+  }
+
+  VRProfileSample sample;
+  sample.name = name;
+  sample.detail = detail;
+  sample.start = now() - seconds;
+  sample.duration = seconds;
+  sample.calls = 1;
+  sample.isTotal = true;
+  sample.thread = _getThread();
+  samples.push_back(sample);
+}
+
+void VRFrameProfiler::addCount(const char *name, const std::string &detail,
+                               const long count) {
+
+  if (!_enabled) return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_inFrame) return;
+
+  std::vector<VRProfileCount> &counts = _frames[_next].counts;
+  for (std::vector<VRProfileCount>::iterator it = counts.begin();
+       it != counts.end(); it++) {
+    if ((it->name == name) && (it->detail == detail)) {
+      it->count += count;
+      return;
+    }
+  }
+
+  VRProfileCount entry;
+  entry.name = name;
+  entry.detail = detail;
+  entry.count = count;
+  counts.push_back(entry);
+}
+
+int VRFrameProfiler::getNumFrames() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _numFrames;
+}
+
+const VRFrameStats &VRFrameProfiler::getFrameStats(const int framesAgo) const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if ((framesAgo < 0) || (framesAgo >= _numFrames)) {
+    VRERRORNOADV("No frame stats for that many frames ago.");
+  }
+  int size = (int)_frames.size();
+  return _frames[(_next - 1 - framesAgo + 2 * size) % size];
+}
+
+double VRFrameProfiler::getAverageTime(const std::string &label) const {
+
+  int n = getNumFrames();
+  if (n == 0) return 0.0;
+
+  double total = 0.0;
+  for (int i = 0; i < n; i++) {
+    const VRFrameStats &stats = getFrameStats(i);
+    total += (label == "frame") ? stats.duration : stats.getTime(label);
+  }
+  return total / n;
+}
+
+double VRFrameProfiler::getAverageCount(const std::string &label) const {
+
+  int n = getNumFrames();
+  if (n == 0) return 0.0;
+
+  double total = 0.0;
+  for (int i = 0; i < n; i++) total += getFrameStats(i).getCount(label);
+  return total / n;
+}
+
+std::string VRFrameProfiler::getSummary() const {
+
+  int n = getNumFrames();
+  if (n == 0) return "no frames profiled";
+
+  // Labels in the order they appear in the latest frame.
+  std::vector<std::string> labels;
+  labels.push_back("frame");
+  const VRFrameStats &latest = getFrameStats(0);
+  for (std::vector<VRProfileSample>::const_iterator it = latest.samples.begin();
+       it != latest.samples.end(); it++) {
+    std::string label = it->getLabel();
+    if (std::find(labels.begin(), labels.end(), label) == labels.end()) {
+      labels.push_back(label);
+    }
+  }
+
+  std::stringstream out;
+  out << "Average over " << n << " frames:";
+  char ms[32];
+  for (std::vector<std::string>::iterator it = labels.begin();
+       it != labels.end(); it++) {
+    snprintf(ms, sizeof(ms), "%.3f", 1000.0 * getAverageTime(*it));
+    out << "\n  " << *it << ": " << ms << " ms";
+  }
+
+  std::vector<std::string> countLabels;
+  for (std::vector<VRProfileCount>::const_iterator it = latest.counts.begin();
+       it != latest.counts.end(); it++) {
+    std::string label = it->getLabel();
+    if (std::find(countLabels.begin(), countLabels.end(), label) == countLabels.end()) {
+      countLabels.push_back(label);
+    }
+  }
+  char count[32];
+  for (std::vector<std::string>::iterator it = countLabels.begin();
+       it != countLabels.end(); it++) {
+    snprintf(count, sizeof(count), "%.1f", getAverageCount(*it));
+    out << "\n  " << *it << ": " << count << " per frame";
+  }
+  return out.str();
+}
+
+void VRFrameProfiler::_writeEvent(const std::string &event) {
+  _trace << (_firstTraceEvent ? "\n" : ",\n") << event;
+  _firstTraceEvent = false;
+}
+
+void VRFrameProfiler::_writeFrame(const VRFrameStats &stats) {
+
+  // Times are in microseconds.
+  char buffer[256];
+  snprintf(buffer, sizeof(buffer),
+           "{\"name\":\"frame\",\"cat\":\"MinVR\",\"ph\":\"X\",\"ts\":%.3f,"
+           "\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"frame\":%d}}",
+           1.0e6 * stats.start, 1.0e6 * stats.duration, _processID, _getThread(),
+           stats.frame);
+  _writeEvent(buffer);
+
+  for (std::vector<VRProfileSample>::const_iterator it = stats.samples.begin();
+       it != stats.samples.end(); it++) {
+
+    std::string label = jsonEscape(it->getLabel());
+    if (it->isTotal) {
+      // A total is not a span of time, so it goes in as a counter, at
+      // the end of the frame.
+      snprintf(buffer, sizeof(buffer),
+               "\",\"cat\":\"MinVR\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,"
+               "\"args\":{\"ms\":%.3f}}",
+               1.0e6 * (stats.start + stats.duration), _processID,
+               1.0e3 * it->duration);
+    } else {
+      snprintf(buffer, sizeof(buffer),
+               "\",\"cat\":\"MinVR\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+               "\"pid\":%d,\"tid\":%d,\"args\":{\"frame\":%d}}",
+               1.0e6 * it->start, 1.0e6 * it->duration, _processID,
+               it->thread, stats.frame);
+    }
+    _writeEvent("{\"name\":\"" + label + buffer);
+  }
+
+  for (std::vector<VRProfileCount>::const_iterator it = stats.counts.begin();
+       it != stats.counts.end(); it++) {
+    snprintf(buffer, sizeof(buffer),
+             "\",\"cat\":\"MinVR\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,"
+             "\"args\":{\"count\":%ld}}",
+             1.0e6 * (stats.start + stats.duration), _processID, it->count);
+    _writeEvent("{\"name\":\"" + jsonEscape(it->getLabel()) + buffer);
+  }
+  _trace.flush();
+}
+
+} // end namespace MinVR
@@ -0,0 +1,221 @@
+#ifndef VRFRAMEPROFILER_H
+#define VRFRAMEPROFILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <fstream>
+
+namespace MinVR {
+
+/// \brief One timed piece of a frame.
+///
+/// Most samples are spans: something that started at a given time and
+/// took a given time.  Others are totals, for things that happen many
+/// times a frame (like calls to an event handler), where only the sum
+/// is kept.
+struct VRProfileSample {
+  /// What was timed, e.g. "render".
+  std::string name;
+  /// Which one, e.g. the name of a display node, or the index of an
+  /// input device.  Often empty.
+  std::string detail;
+  /// In seconds, from VRSystem::getTime(true).
+  double start;
+  double duration;
+  /// How many calls the duration covers.  Always 1 for a span.
+  int calls;
+  bool isTotal;
+  /// Small numbers, in the order the threads were first seen.
+  int thread;
+
+  /// The name and detail together, e.g. "render Window1".
+  std::string getLabel() const {
+    return detail.empty() ? name : name + " " + detail;
+  }
+};
+
+/// \brief A number of things counted during a frame, like the tracker
+/// samples dropped by VREventCoalescer.
+struct VRProfileCount {
+  std::string name;
+  std::string detail;
+  long count;
+
+  std::string getLabel() const {
+    return detail.empty() ? name : name + " " + detail;
+  }
+};
+
+/// \brief The samples recorded during one frame.
+struct VRFrameStats {
+  int frame;
+  double start;
+  double duration;
+  std::vector<VRProfileSample> samples;
+  std::vector<VRProfileCount> counts;
+
+  /// The time taken by all the samples with this label, or zero.
+  double getTime(const std::string &label) const;
+
+  /// The counts with this label, or, given just a name, all the counts
+  /// with that name, added up.
+  long getCount(const std::string &label) const;
+};
+
+/// \brief Times the phases of each frame.
+///
+/// VRMain uses one of these to record how long each part of a frame
+/// takes: gathering input from each device, the network syncs, the
+/// event handlers, the model update, and rendering, waiting for, and
+/// displaying each display graph.  It is off unless the VRSetup has
+/// FrameProfile set to 1, and costs next to nothing when it is off.
+///
+/// The samples for the last FrameProfileHistory frames (120 by default)
+/// are kept in a ring buffer, available through
+/// VRMain::getFrameProfiler()->getFrameStats().  With FrameProfileTrace
+/// set to a file name, each frame is also written out in the Chrome
+/// trace-event JSON format, which chrome://tracing and Perfetto can
+/// display.  Each node in a cluster writes its own file, with its name
+/// added to the one given, and every span carries the frame number in
+/// its args.  (Totals, like the time in each event handler, go in as
+/// counters at the end of their frame, and so do counts.)  The nodes run
+/// their frames in lock step, so the frame numbers agree from file to
+/// file, and are the way to match the nodes' spans up.  Each file is a
+/// JSON array of its own; to view them together, take the brackets off
+/// each and join them with commas inside one pair.  The time stamps come
+/// from each node's own clock, though, so the nodes' spans only line up
+/// as well as their clocks do.
+///
+/// Samples may be added from any thread.
+class VRFrameProfiler {
+public:
+  VRFrameProfiler();
+  /// Finishes the trace file, if there is one.
+  ~VRFrameProfiler();
+
+  /// \brief Turns on the profiler, keeping the given number of frames.
+  void enable(const int historyLength);
+  bool isEnabled() const { return _enabled; }
+
+  /// \brief Writes a trace to the given file, as well.
+  ///
+  /// The process name appears in the trace viewer.  Returns false if the
+  /// file cannot be opened.
+  bool writeTrace(const std::string &fileName, const std::string &processName);
+
+  /// \brief Works out a trace file name for one node of a cluster.
+  ///
+  /// "trace.json" for node "/MinVR/VRSetups/Left" becomes
+  /// "trace-Left.json".
+  static std::string getTraceFileName(const std::string &fileName,
+                                      const std::string &nodeName);
+
+  /// \brief Starts and finishes the record for a frame.
+  ///
+  /// Samples added outside a frame are ignored.
+  void beginFrame(const int frame);
+  void endFrame();
+
+  /// \brief Records a span, with times from now().
+  void addSample(const char *name, const std::string &detail,
+                 const double start, const double end);
+
+  /// \brief Adds to a total kept for this frame.
+  ///
+  /// The index is used as the detail; use -1 for none.
+  void addTime(const char *name, const int index, const double seconds);
+
+  /// \brief Adds to a count kept for this frame.
+  void addCount(const char *name, const std::string &detail, const long count);
+
+  /// \brief The number of frames available from getFrameStats().
+  int getNumFrames() const;
+
+  /// \brief Returns a finished frame: 0 is the latest, 1 the one before.
+  const VRFrameStats &getFrameStats(const int framesAgo = 0) const;
+
+  /// \brief The average time per frame for this label, over the frames
+  /// kept.
+  double getAverageTime(const std::string &label) const;
+
+  /// \brief The average count per frame for this label, over the frames
+  /// kept.
+  double getAverageCount(const std::string &label) const;
+
+  /// \brief One line for each label, with its average time or count.
+  std::string getSummary() const;
+
+  /// The clock the samples use.
+  static double now();
+
+private:
+  bool _enabled;
+  bool _inFrame;
+
+  // The ring buffer.  _next is the slot the next frame goes in, and
+  // the frame in progress, if any, is there.
+  std::vector<VRFrameStats> _frames;
+  int _next;
+  int _numFrames;
+
+  mutable std::mutex _mutex;
+  std::map<std::thread::id, int> _threads;
+  int _getThread();
+
+  std::ofstream _trace;
+  bool _firstTraceEvent;
+  int _processID;
+  void _writeFrame(const VRFrameStats &stats);
+  void _writeEvent(const std::string &event);
+};
+
+/// \brief Times the block it is declared in.
+///
+/// For example:
+///
+///     {
+///       VRProfileScope scope(profiler, "render", node->getName());
+///       node->render(...);
+///     }
+class VRProfileScope {
+public:
+  VRProfileScope(VRFrameProfiler *profiler, const char *name) :
+    _profiler(profiler), _name(name), _active(profiler->isEnabled()), _start(0.0) {
+    if (_active) _start = VRFrameProfiler::now();
+  }
+
+  VRProfileScope(VRFrameProfiler *profiler, const char *name,
+                 const std::string &detail) :
+    _profiler(profiler), _name(name), _active(profiler->isEnabled()), _start(0.0) {
+    if (_active) {
+      _detail = detail;
+      _start = VRFrameProfiler::now();
+    }
+  }
+
+  VRProfileScope(VRFrameProfiler *profiler, const char *name, const int index) :
+    _profiler(profiler), _name(name), _active(profiler->isEnabled()), _start(0.0) {
+    if (_active) {
+      _detail = std::to_string(index);
+      _start = VRFrameProfiler::now();
+    }
+  }
+
+  ~VRProfileScope() {
+    if (_active) _profiler->addSample(_name, _detail, _start, VRFrameProfiler::now());
+  }
+
+private:
+  VRFrameProfiler *_profiler;
+  const char *_name;
+  bool _active;
+  std::string _detail;
+  double _start;
+};
+
+} // end namespace MinVR
+
+#endif
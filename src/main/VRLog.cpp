@@ -0,0 +1,358 @@
+#include "VRLog.h"
+
+#include <main/VRSystem.h>
+
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+namespace MinVR {
+
+std::atomic<int> VRLog::_level(VRLOG_LEVEL_STATUS);
+
+// The ring buffer and the thread that empties it.
+//
+// The ring is the bounded queue described by Dmitry Vyukov: each slot
+// has a sequence number that says whether it is free for the producer
+// whose turn it is, or full and ready for the consumer.  Producers claim
+// a slot with a compare-and-swap on the enqueue position, fill it, and
+// publish it by advancing its sequence number.  There is only ever one
+// consumer at a time (the background thread, or a thread calling
+// flush()), which the drain mutex sees to.  Producers only touch it to
+// wake the background thread, when it has emptied the ring and gone to
+// sleep, so a burst of messages wakes it once, and a quiet process never.
+class VRLogRing {
+public:
+  VRLogRing();
+  ~VRLogRing();
+
+  static VRLogRing &instance();
+
+  bool push(const int level, const VRLog::Style style, std::string &message);
+  void flush();
+  bool setFile(const std::string &fileName);
+
+  std::atomic<long> dropped;
+
+private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    double time;
+    int level;
+    VRLog::Style style;
+    std::string text;
+  };
+
+  static const size_t _size = 4096;  // a power of two
+  Slot *_slots;
+  std::atomic<size_t> _enqueuePos;
+
+  // The rest belongs to the consumer, and is guarded by _drainMutex.
+  std::mutex _drainMutex;
+  size_t _dequeuePos;
+  long _droppedReported;
+  std::string _buffer;
+  std::ofstream _file;
+
+  std::thread *_thread;
+  std::atomic<bool> _threadStarted;
+  bool _stop;
+  std::condition_variable _wakeUp;
+  // Set by the background thread before it waits, and cleared by the
+  // producer that wakes it.
+  std::atomic<bool> _asleep;
+
+  void _startThread();
+  void _threadLoop();
+  void _drainLocked();
+  void _format(const Slot &slot);
+
+#ifndef WIN32
+  // A forked child has none of its parent's threads, so it has to start
+  // its own.  Before the fork, everything logged so far is written, so
+  // the child doesn't write it again.
+  static void _beforeFork();
+  static void _afterForkParent();
+  static void _afterForkChild();
+#endif
+};
+
+VRLogRing::VRLogRing() :
+  dropped(0), _enqueuePos(0), _dequeuePos(0), _droppedReported(0),
+  _thread(NULL), _threadStarted(false), _stop(false), _asleep(false) {
+
+  _slots = new Slot[_size];
+  for (size_t i = 0; i < _size; i++) {
+    _slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+#ifndef WIN32
+  pthread_atfork(_beforeFork, _afterForkParent, _afterForkChild);
+#endif
+}
+
+VRLogRing::~VRLogRing() {
+
+  if (_thread != NULL) {
+    {
+      std::lock_guard<std::mutex> lock(_drainMutex);
+      _stop = true;
+    }
+    _wakeUp.notify_all();
+    _thread->join();
+    delete _thread;
+    _thread = NULL;
+  }
+  flush();
+  delete[] _slots;
+}
+
+VRLogRing &VRLogRing::instance() {
+  static VRLogRing ring;
+  return ring;
+}
+
+bool VRLogRing::push(const int level, const VRLog::Style style,
+                     std::string &message) {
+
+  if (!_threadStarted.load(std::memory_order_acquire)) _startThread();
+
+  double time = VRSystem::getTime();
+
+  Slot *slot;
+  size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+  while (true) {
+    slot = &_slots[pos & (_size - 1)];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if (diff == 0) {
+      if (_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      // Full.
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = _enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->time = time;
+  slot->level = level;
+  slot->style = style;
+  slot->text.swap(message);
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  // The fence pairs with the one in _threadLoop(): either the thread sees
+  // this message before it sleeps, or we see that it is asleep.  Taking
+  // the mutex makes sure it is waiting before it is told to wake.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (_asleep.load(std::memory_order_relaxed) &&
+      _asleep.exchange(false, std::memory_order_relaxed)) {
+    { std::lock_guard<std::mutex> lock(_drainMutex); }
+    _wakeUp.notify_one();
+  }
+  return true;
+}
+
+void VRLogRing::_startThread() {
+
+  std::lock_guard<std::mutex> lock(_drainMutex);
+  if (_threadStarted.load(std::memory_order_relaxed)) return;
+  _stop = false;
+  _thread = new std::thread(&VRLogRing::_threadLoop, this);
+  _threadStarted.store(true, std::memory_order_release);
+}
+
+void VRLogRing::_threadLoop() {
+
+  std::unique_lock<std::mutex> lock(_drainMutex);
+  while (!_stop) {
+    _drainLocked();
+
+    // Sleep until a message comes, unless one came while we were
+    // writing, and hadn't been seen yet.
+    _asleep.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const Slot &next = _slots[_dequeuePos & (_size - 1)];
+    if (next.sequence.load(std::memory_order_acquire) == _dequeuePos + 1) {
+      _asleep.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    while (!_stop && _asleep.load(std::memory_order_relaxed)) _wakeUp.wait(lock);
+  }
+}
+
+void VRLogRing::flush() {
+  std::lock_guard<std::mutex> lock(_drainMutex);
+  _drainLocked();
+}
+
+void VRLogRing::_format(const Slot &slot) {
+
+  char stamp[32];
+  snprintf(stamp, sizeof(stamp), "[%10.6f] ", slot.time);
+
+  switch (slot.style) {
+  case VRLog::HEADING1:
+    _buffer += "\n\n";
+    _buffer += stamp;
+    _buffer += "==== " + slot.text + " ====\n";
+    return;
+  case VRLog::HEADING2:
+    _buffer += "\n";
+    _buffer += stamp;
+    _buffer += "* " + slot.text + "\n";
+    return;
+  case VRLog::PLAIN:
+    break;
+  }
+
+  _buffer += stamp;
+  switch (slot.level) {
+  case VRLOG_LEVEL_DEBUG:   _buffer += "debug: ";   break;
+  case VRLOG_LEVEL_WARNING: _buffer += "warning: "; break;
+  case VRLOG_LEVEL_ERROR:   _buffer += "error: ";   break;
+  default:                  _buffer += "- ";        break;
+  }
+  _buffer += slot.text + "\n";
+}
+
+void VRLogRing::_drainLocked() {
+
+  _buffer.clear();
+  while (true) {
+    Slot &slot = _slots[_dequeuePos & (_size - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != _dequeuePos + 1) break;
+
+    _format(slot);
+    slot.text.clear();
+    slot.sequence.store(_dequeuePos + _size, std::memory_order_release);
+    _dequeuePos++;
+  }
+
+  long n = dropped.load(std::memory_order_relaxed);
+  if (n != _droppedReported) {
+    char note[64];
+    snprintf(note, sizeof(note), "(%ld log messages dropped)\n", n - _droppedReported);
+    _buffer += note;
+    _droppedReported = n;
+  }
+
+  if (_buffer.empty()) return;
+
+  // Written in one piece, which keeps it from being mixed up with the
+  // output of other processes on the same terminal.
+  if (_file.is_open()) {
+    _file.write(_buffer.data(), _buffer.size());
+    _file.flush();
+  } else {
+    std::cout.write(_buffer.data(), _buffer.size());
+    std::cout.flush();
+  }
+}
+
+bool VRLogRing::setFile(const std::string &fileName) {
+
+  std::lock_guard<std::mutex> lock(_drainMutex);
+
+  // What was logged so far goes where it was meant to.
+  _drainLocked();
+
+  if (fileName.empty()) {
+    if (_file.is_open()) _file.close();
+    return true;
+  }
+
+  std::ofstream file(fileName.c_str(), std::ios::out | std::ios::trunc);
+  if (!file.is_open()) return false;
+  if (_file.is_open()) _file.close();
+  _file.swap(file);
+  return true;
+}
+
+#ifndef WIN32
+void VRLogRing::_beforeFork() {
+  VRLogRing &ring = instance();
+  ring._drainMutex.lock();
+  ring._drainLocked();
+}
+
+void VRLogRing::_afterForkParent() {
+  instance()._drainMutex.unlock();
+}
+
+void VRLogRing::_afterForkChild() {
+  VRLogRing &ring = instance();
+  ring._drainMutex.unlock();
+
+  // The thread object refers to the parent's thread, which doesn't
+  // exist here, so it can't be joined or deleted.  It is left alone,
+  // and the next message starts a new one.
+  ring._thread = NULL;
+  ring._asleep.store(false, std::memory_order_relaxed);
+  ring._threadStarted.store(false, std::memory_order_release);
+}
+#endif
+
+void VRLog::setLevel(const int level) {
+  _level.store(level, std::memory_order_relaxed);
+}
+
+int VRLog::getLevelFromName(const std::string &name) {
+  if (name == "DEBUG") return VRLOG_LEVEL_DEBUG;
+  if (name == "WARNING") return VRLOG_LEVEL_WARNING;
+  if (name == "ERROR") return VRLOG_LEVEL_ERROR;
+  if (name == "NONE") return VRLOG_LEVEL_NONE;
+  return VRLOG_LEVEL_STATUS;
+}
+
+void VRLog::write(const int level, const Style style, std::string message) {
+
+  VRLogRing &ring = VRLogRing::instance();
+  ring.push(level, style, message);
+
+  // Warnings and errors are often followed by a crash.
+  if (level >= VRLOG_LEVEL_WARNING) ring.flush();
+}
+
+void VRLog::flush() {
+  VRLogRing::instance().flush();
+}
+
+bool VRLog::setFile(const std::string &fileName) {
+  return VRLogRing::instance().setFile(fileName);
+}
+
+std::string VRLog::getNodeFileName(const std::string &fileName,
+                                   const std::string &nodeName,
+                                   const std::string &defaultExtension) {
+
+  std::string node = nodeName;
+  size_t slash = node.find_last_of('/');
+  if (slash != std::string::npos) node = node.substr(slash + 1);
+
+  std::string base = fileName;
+  std::string extension = defaultExtension;
+  size_t dot = base.find_last_of('.');
+  slash = base.find_last_of('/');
+  if ((dot != std::string::npos) &&
+      ((slash == std::string::npos) || (dot > slash))) {
+    extension = base.substr(dot);
+    base = base.substr(0, dot);
+  }
+  return base + "-" + node + extension;
+}
+
+long VRLog::getNumDropped() {
+  return VRLogRing::instance().dropped.load(std::memory_order_relaxed);
+}
+
+} // end namespace
@@ -1,16 +1,16 @@
-/** 
-This file is part of the MinVR Open Source Project, which is developed and 
+/**
+This file is part of the MinVR Open Source Project, which is developed and
 maintained collaboratively by the University of Minnesota and Brown University.
 
 Copyright (c) 2016 Regents of the University of Minnesota and Brown University.
 This software is distributed under the BSD-3 Clause license, which can be found
 at: MinVR/LICENSE.txt.
 
-Original Author(s) of this File: 
+Original Author(s) of this File:
   Dan Keefe, 2017, University of Minnesota
-  
+
 Author(s) of Significant Updates/Modifications to the File:
-  ... 
+  ...
 */
 
 
@@ -19,30 +19,126 @@ Author(s) of Significant Updates/Modifications to the File:
 
 #include <string>
 #include <iostream>
+#include <atomic>
 
-namespace MinVR {
+// Log messages have one of these levels.  The headings and VRLOG_STATUS
+// messages are at the STATUS level.
+#define VRLOG_LEVEL_DEBUG   0
+#define VRLOG_LEVEL_STATUS  1
+#define VRLOG_LEVEL_WARNING 2
+#define VRLOG_LEVEL_ERROR   3
+#define VRLOG_LEVEL_NONE    4
 
-// TODO: Eventually, we'll want to update this to (at least optionally) write to 
-// a file rather than stdout.  We might also need to have multiple log files for
-// multiple processes and threads.  So, this likely needs to get a bit more
-// complex.  For now, we need to start getting some log messages into the code 
-// ASAP, and it's fine if these print to stdout as we are developing.
+// Messages below this level are not compiled in at all: the macros turn
+// into nothing, and their arguments are never evaluated.  Define it on the
+// compiler command line to change it.  Above it, the level can also be
+// raised at run time with VRLog::setLevel(), or LogLevel in the config,
+// and a message below that level costs one load and a compare.
+#ifndef VRLOG_MIN_LEVEL
+#ifdef MinVR_DEBUG
+#define VRLOG_MIN_LEVEL VRLOG_LEVEL_DEBUG
+#else
+#define VRLOG_MIN_LEVEL VRLOG_LEVEL_STATUS
+#endif
+#endif
 
-#define VRLOG_H1(heading1) { \
-    std::string str = std::string("\n\n==== ") + std::string(heading1) + std::string(" ====\n");   \
-    std::cout.write(str.c_str(), str.size()); \
+#define VRLOG_MESSAGE(level, style, message) { \
+    if (MinVR::VRLog::isEnabled(level)) { \
+      MinVR::VRLog::write(level, MinVR::VRLog::style, std::string(message)); \
+    } \
 }
 
-#define VRLOG_H2(heading2) { \
-    std::string str = std::string("\n* ") + std::string(heading2) + std::string("\n");   \
-    std::cout.write(str.c_str(), str.size()); \
-}
+#if VRLOG_MIN_LEVEL <= VRLOG_LEVEL_DEBUG
+#define VRLOG_DEBUG(message) VRLOG_MESSAGE(VRLOG_LEVEL_DEBUG, PLAIN, message)
+#else
+#define VRLOG_DEBUG(message) {}
+#endif
 
-#define VRLOG_STATUS(message) { \
-    std::string str = std::string("- ") + std::string(message) + std::string("\n");   \
-    std::cout.write(str.c_str(), str.size()); \
-}
+#if VRLOG_MIN_LEVEL <= VRLOG_LEVEL_STATUS
+#define VRLOG_H1(heading1) VRLOG_MESSAGE(VRLOG_LEVEL_STATUS, HEADING1, heading1)
+#define VRLOG_H2(heading2) VRLOG_MESSAGE(VRLOG_LEVEL_STATUS, HEADING2, heading2)
+#define VRLOG_STATUS(message) VRLOG_MESSAGE(VRLOG_LEVEL_STATUS, PLAIN, message)
+#else
+#define VRLOG_H1(heading1) {}
+#define VRLOG_H2(heading2) {}
+#define VRLOG_STATUS(message) {}
+#endif
+
+#if VRLOG_MIN_LEVEL <= VRLOG_LEVEL_WARNING
+#define VRLOG_WARNING(message) VRLOG_MESSAGE(VRLOG_LEVEL_WARNING, PLAIN, message)
+#else
+#define VRLOG_WARNING(message) {}
+#endif
+
+#if VRLOG_MIN_LEVEL <= VRLOG_LEVEL_ERROR
+#define VRLOG_ERROR(message) VRLOG_MESSAGE(VRLOG_LEVEL_ERROR, PLAIN, message)
+#else
+#define VRLOG_ERROR(message) {}
+#endif
+
+namespace MinVR {
+
+/// \brief Where the VRLOG_* macros send their messages.
+///
+/// A message is put in a ring buffer, and a background thread writes it
+/// out, so the thread that logs it (which might be a render thread) never
+/// waits on the console or a file.  Any number of threads can log at once
+/// without taking a lock.  If the ring fills up, messages are dropped
+/// rather than holding anyone up, and a note says how many.  Warnings and
+/// errors are written out before the call returns, along with everything
+/// logged before them, so they are never lost to a crash.
+///
+/// Each message is stamped with VRSystem::getTime().  The messages go to
+/// standard output until setFile() is called; VRMain does that when the
+/// VRSetup has a LogFile, adding the node name to the file name so that
+/// each node in a cluster, and each process on a machine, gets its own.
+class VRLog {
+public:
+
+  enum Style { PLAIN, HEADING1, HEADING2 };
+
+  /// \brief Is a message at this level going to be written?
+  static bool isEnabled(const int level) {
+    return level >= _level.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Sets the lowest level that is written.  The default is
+  /// VRLOG_LEVEL_STATUS.
+  static void setLevel(const int level);
+  static int getLevel() { return _level.load(std::memory_order_relaxed); }
+
+  /// \brief Translates "DEBUG", "STATUS", "WARNING", "ERROR", or "NONE"
+  /// into a level.  Anything else is VRLOG_LEVEL_STATUS.
+  static int getLevelFromName(const std::string &name);
+
+  /// \brief Queues a message.  Use the macros instead.
+  static void write(const int level, const Style style, std::string message);
+
+  /// \brief Writes out everything logged so far, and returns when it's done.
+  static void flush();
+
+  /// \brief Sends the messages to a file from now on, or back to the
+  /// console if the name is empty.
+  ///
+  /// Returns false if the file cannot be opened, in which case messages
+  /// keep going where they were going.
+  static bool setFile(const std::string &fileName);
+
+  /// \brief Works out a file name for one node of a cluster.
+  ///
+  /// "minvr.log" for node "/MinVR/VRSetups/Left" becomes
+  /// "minvr-Left.log".  If the name has no extension, the default one
+  /// is used.
+  static std::string getNodeFileName(const std::string &fileName,
+                                     const std::string &nodeName,
+                                     const std::string &defaultExtension);
+
+  /// \brief The number of messages dropped because the ring was full.
+  static long getNumDropped();
 
+private:
+  static std::atomic<int> _level;
+};
 
 } // end namespace
 
@@ -10,6 +10,7 @@
 #endif
 
 #include <api/VRAnalogEvent.h>
+#include <config/VRConfigCache.h>
 #include <display/VRConsoleNode.h>
 #include <display/VRGraphicsWindowNode.h>
 #include <display/VRGroupNode.h>
@@ -266,7 +267,8 @@ std::string getCurrentWorkingDir()
 }
 
 
-VRMain::VRMain() : _initialized(false), _config(NULL), _net(NULL), _factory(NULL), _pluginMgr(NULL), _frame(0), _shutdown(false)
+VRMain::VRMain() : _initialized(false), _config(NULL), _net(NULL), _factory(NULL), _pluginMgr(NULL), _frame(0), _shutdown(false),
+  _displayThreads(NULL), _pipelinedSync(false), _netSyncState(NETSYNC_IDLE)
 {
   _config = new VRDataIndex();
   _factory = new VRFactory();
@@ -291,6 +293,8 @@ VRMain::VRMain() : _initialized(false), _config(NULL), _net(NULL), _factory(NULL
 
 VRMain::~VRMain()
 {
+  // The network thread may be using _net.
+  _stopNetSyncThread();
 
 	if (_config) {
 		delete _config;
@@ -300,6 +304,11 @@ VRMain::~VRMain()
 		for (std::vector<VRInputDevice*>::iterator it = _inputDevices.begin(); it != _inputDevices.end(); ++it) delete *it;
 	}
 
+	// The render threads go before the display graphs they render.
+	if (_displayThreads) {
+		delete _displayThreads;
+	}
+
 	if (!_displayGraphs.empty()) {
 		for (std::vector<VRDisplayNode*>::iterator it = _displayGraphs.begin(); it != _displayGraphs.end(); ++it) delete *it;
 	}
@@ -336,13 +345,47 @@ void VRMain::loadConfig(const std::string &configName) {
             "Checked: " + _configPath.getPath());
   } else {
 
-    VRLOG_STATUS("Loading configuration file: " + fileName);
+    // A compiled configuration saves parsing the XML, which matters when
+    // a whole cluster is reading the same files at once.  It is only used
+    // if the files it was made from haven't changed.
+    std::vector<std::string> sourceFiles(1, fileName);
+    std::string cacheFile = VRConfigCache::getCacheFileName(fileName);
+    if (VRConfigCache::isCache(fileName)) {
+      cacheFile = fileName;
+      sourceFiles = VRConfigCache::getSourceFiles(fileName);
+    }
 
-    bool success = _config->processXMLFile(fileName, "/");
+    std::string whyNot;
+    if (VRConfigCache::isCache(cacheFile)) {
+      // The cache that goes with a file has to have been made from that
+      // file alone, or it has more in it than was asked for.
+      if ((cacheFile != fileName) &&
+          (VRConfigCache::getSourceFiles(cacheFile).size() != 1)) {
+        whyNot = cacheFile + " was made from more than " + fileName + ".";
+      } else if (VRConfigCache::load(cacheFile, _config, &whyNot)) {
+        VRLOG_STATUS("Loaded compiled configuration file: " + cacheFile);
+        return;
+      }
+      VRWARNING("Not using the compiled configuration " + cacheFile + ".",
+                whyNot + "  Run MVRCompile again to bring it up to date.");
+    }
 
-    if (!success) {
-      VRERROR("Could not process XML file " + fileName,
-              "Something may be wrong with the file.");
+    if (sourceFiles.empty()) {
+      VRERROR("Could not process the compiled configuration " + fileName,
+              whyNot);
+    }
+
+    for (std::vector<std::string>::iterator it = sourceFiles.begin();
+         it != sourceFiles.end(); it++) {
+
+      VRLOG_STATUS("Loading configuration file: " + *it);
+
+      bool success = _config->processXMLFile(*it, "/");
+
+      if (!success) {
+        VRERROR("Could not process XML file " + *it,
+                "Something may be wrong with the file.");
+      }
     }
   }
 }
@@ -387,6 +430,16 @@ void VRMain::_startSSHProcess(const std::string &setupName,
     " " + getSetConfigValueLong() + " VRSetupsToStart=" + setupName +
     " " + getSetConfigValueLong() + " StartedSSH=1";
 
+  // A client that gets its configuration from the server doesn't need
+  // the configuration files on its command line.
+  std::string commandLine = getOriginalCommandLine();
+  std::string configServer = _getConfigServerFor(setupName);
+  if (!configServer.empty()) {
+    commandLine = getLeftoverCommandLine();
+    processSpecificArgs +=
+      " " + getSetConfigValueLong() + " ConfigFromServer=" + configServer;
+  }
+
   std::string logFile = "";
   if (_config->exists("LogToFile", setupName)) {
     logFile = " >" + (VRString)_config->getValue("LogToFile",setupName) + " 2>&1 ";
@@ -396,7 +449,7 @@ void VRMain::_startSSHProcess(const std::string &setupName,
 
   std::string sshcmd;
   sshcmd = "ssh " + nodeIP +
-    " '" + command + getOriginalCommandLine() + processSpecificArgs + logFile +
+    " '" + command + commandLine + processSpecificArgs + logFile +
     " &' &";
 
   // Start the client, at least if the noSSH flag tells us to.
@@ -437,6 +490,11 @@ bool VRMain::_startLocalProcess(const std::string &setupName) {
   std::string processSpecificArgs =
     " " + getSetConfigValueLong() + " VRSetupsToStart=" + setupName;
   std::string cmdLine = getOriginalCommandLine() + processSpecificArgs;
+  std::string configServer = _getConfigServerFor(setupName);
+  if (!configServer.empty()) {
+    cmdLine = getLeftoverCommandLine() + processSpecificArgs +
+      " " + getSetConfigValueLong() + " ConfigFromServer=" + configServer;
+  }
 
   VRLOG_STATUS("Using command line: " + cmdLine);
 
@@ -482,6 +540,49 @@ bool VRMain::_startLocalProcess(const std::string &setupName) {
 }
 
 
+std::string VRMain::_getConfigServerFor(const std::string &setupName) {
+
+  // Setting DistributeConfig, for the whole configuration or for some of
+  // the setups, has the server send the clients its configuration.
+  if (!_config->exists("DistributeConfig", setupName) ||
+      ((int)_config->getValue("DistributeConfig", setupName) == 0)) return "";
+
+  if (!_config->hasAttribute(setupName, "hostType") ||
+      (_config->getAttributeValue(setupName, "hostType") != "VRClient") ||
+      !_config->exists("ServerIP", setupName) || !_config->exists("Port", setupName)) {
+    return "";
+  }
+
+  std::string ipAddress = _config->getValue("ServerIP", setupName);
+  std::string port = _config->getValue("Port", setupName);
+  return ipAddress + ":" + port;
+}
+
+void VRMain::_receiveConfigFromServer() {
+
+  std::string server = _config->getValue("ConfigFromServer", "/");
+  size_t colon = server.rfind(':');
+  if (colon == std::string::npos) {
+    VRERROR("Cannot make sense of ConfigFromServer=" + server + ".",
+            "It should be the server's address and port, as in 10.0.0.1:3490.");
+  }
+
+  VRLOG_STATUS("Getting the configuration from the server at " + server + ".");
+
+  VRDataIndex serverConfig;
+  VRNetClient *client =
+    new VRNetClient(server.substr(0, colon), server.substr(colon + 1), &serverConfig);
+
+  // The settings from our own command line still win.
+  serverConfig.addSerializedBinary(_config->serializeBinary());
+  *_config = serverConfig;
+
+  // The connection is kept, and finished once the configuration says
+  // which wire format to use.
+  _net = client;
+}
+
+
 void VRMain::initialize(int argc, char **argv) {
 
   VRLOG_H1("INITIALIZING MINVR");
@@ -495,6 +596,12 @@ void VRMain::initialize(int argc, char **argv) {
             "Something is wrong with your configuration file specification.");
   }
 
+  // A client started by a server that shares its configuration gets all
+  // of it from the server, instead of reading the files again.
+  if (_config->exists("ConfigFromServer", "/")) {
+    _receiveConfigFromServer();
+  }
+
   // Create an empty list of VRSetups that need starting.
 	VRStringArray vrSetupsToStartArray;
 
@@ -590,6 +697,22 @@ void VRMain::initialize(int argc, char **argv) {
     VRLOG_STATUS("Starting VRSetup: " + _name);
   }
 
+  // From here on, this process might log to a file of its own.  See
+  // VRLog.h.
+  if (_config->exists("LogLevel", _name)) {
+    VRLog::setLevel(VRLog::getLevelFromName(_config->getValue("LogLevel", _name)));
+  }
+  if (_config->exists("LogFile", _name)) {
+    std::string logFile =
+      VRLog::getNodeFileName(_config->getValue("LogFile", _name), _name, ".log");
+    if (VRLog::setFile(logFile)) {
+      VRLOG_H1("MINVR LOG FOR " + _name);
+    } else {
+      VRWARNING("Could not open the log file " + logFile + ".",
+                "Check the LogFile setting.");
+    }
+  }
+
   // STEP 4:  Sanity check to make sure the vrSetup we are continuing with is
   // actually defined in the config settings that have been loaded.
 	if (!_config->exists(_name)) {
@@ -658,13 +781,29 @@ void VRMain::initialize(int argc, char **argv) {
 	// "VRClient", or "VRStandAlone"
   if(_config->hasAttribute(_name, "hostType")){
     std::string type = _config->getAttributeValue(_name, "hostType");
+
+    // Event data goes over the network in a binary format unless the
+    // setup asks for XML, which is handy for debugging.  "Delta" is the
+    // binary format, but the server only sends each client the events
+    // from the other nodes, which saves a lot when the clients have busy
+    // trackers.  Both ends must ask for it.
+    unsigned char wireFormat = VRNetInterface::WIRE_FORMAT_BINARY;
+    if (_config->exists("WireFormat", _name)) {
+      VRString format = _config->getValue("WireFormat", _name);
+      if (format == "XML") {
+        wireFormat = VRNetInterface::WIRE_FORMAT_XML;
+      } else if (format == "Delta") {
+        wireFormat = VRNetInterface::WIRE_FORMAT_BINARY_DELTA;
+      }
+    }
+
 		if (type == "VRServer") {
 			std::string port = _config->getValue("Port", _name);
 			int numClients = _config->getValue("NumClients", _name);
       std::stringstream s;
       s << "This VRSetup is a SERVER running on Port " << port << " and expecting " << numClients << " clients.";
       VRLOG_STATUS(s.str());
-			_net = new VRNetServer(port, numClients);
+			_net = new VRNetServer(port, numClients, wireFormat, _config);
 		}
 		else if (type == "VRClient") {
 			std::string port = _config->getValue("Port", _name);
@@ -672,14 +811,76 @@ void VRMain::initialize(int argc, char **argv) {
       std::stringstream s;
       s << "This VRSetup is a CLIENT that will connect to " << ipAddress << ":" << port << ".";
       VRLOG_STATUS(s.str());
-      _net = new VRNetClient(ipAddress, port);
+      if (_net == NULL) {
+        _net = new VRNetClient(ipAddress, port, wireFormat);
+      } else {
+        // Already connected, to get the configuration.
+        static_cast<VRNetClient*>(_net)->negotiateWireFormat(wireFormat);
+      }
+		}
+		else if (_net != NULL) {
+      VRERROR("The VRSetup " + _name + " got its configuration from a server, but is not a VRClient.",
+              "Only VRClient setups can use DistributeConfig.");
 		}
 		else { // type == "VRStandAlone"
       VRLOG_STATUS("This VRSetup is running in stand alone mode -- no networking.")
 			// no networking, leave _net=NULL
 		}
+
+    // Optionally release the swap buffers barrier with one UDP datagram,
+    // so that all the clients swap at the same moment.  The port defaults
+    // to the same number as the TCP one.
+    if ((_net != NULL) && _config->exists("SwapBarrierAddress", _name)) {
+      std::string address = _config->getValue("SwapBarrierAddress", _name);
+      std::string port = _config->exists("SwapBarrierPort", _name) ?
+        (VRString)_config->getValue("SwapBarrierPort", _name) :
+        (VRString)_config->getValue("Port", _name);
+      std::string interfaceAddress = _config->exists("SwapBarrierInterface", _name) ?
+        (VRString)_config->getValue("SwapBarrierInterface", _name) : "";
+      _net->useDatagramSwapBarrier(address, port, interfaceAddress);
+    }
+
+    // Optionally exchange each frame's events while the frame renders.
+    // See the notes on synchronizeAndProcessEvents() in VRMain.h.
+    if ((_net != NULL) && _config->exists("PipelinedFrameSync", _name) &&
+        ((int)_config->getValue("PipelinedFrameSync", _name) != 0)) {
+      VRLOG_STATUS("Using pipelined frame sync: events are handled one frame after they happen.");
+      _pipelinedSync = true;
+      _netSyncThread = std::thread(&VRMain::_netSyncThreadLoop, this);
+    }
 	}
 
+  // Optionally time the parts of each frame, and write them to a trace
+  // file.  See VRFrameProfiler.h.
+  if (_config->exists("FrameProfile", _name) &&
+      ((int)_config->getValue("FrameProfile", _name) != 0)) {
+    int history = _config->exists("FrameProfileHistory", _name) ?
+      (int)_config->getValue("FrameProfileHistory", _name) : 120;
+    _profiler.enable(history);
+
+    if (_config->exists("FrameProfileTrace", _name)) {
+      std::string fileName =
+        VRFrameProfiler::getTraceFileName(_config->getValue("FrameProfileTrace", _name), _name);
+      if (_profiler.writeTrace(fileName, _name)) {
+        VRLOG_STATUS("Writing a trace of each frame to " + fileName + ".");
+      } else {
+        VRWARNING("Could not open the frame trace file " + fileName + ".",
+                  "Check the FrameProfileTrace setting.");
+      }
+    }
+  }
+
+  // Optionally keep only some of each frame's samples of particular
+  // events.  See VREventCoalescer.h.
+  if (_config->exists("CoalesceEvents", _name)) {
+    std::string coalesceName = _config->getFullKey("CoalesceEvents", _name);
+    VRContainer eventNames = _config->getValue(coalesceName);
+    for (VRContainer::const_iterator it = eventNames.begin(); it != eventNames.end(); ++it) {
+      std::string mode = _config->getValue(*it, coalesceName);
+      _coalescer.setEventMode(*it, VREventCoalescer::parseMode(mode));
+    }
+  }
+
 	// STEP 7: CONFIGURE INPUT DEVICES:
 	{
     VRLOG_H2("Create Input Devices");
@@ -690,6 +891,10 @@ void VRMain::initialize(int argc, char **argv) {
 			if (dev) {
         VRLOG_STATUS("Creating input device: " + (*it));
 				_inputDevices.push_back(dev);
+        if (_config->exists("Coalesce", *it)) {
+          std::string mode = _config->getValue("Coalesce", *it);
+          _coalescer.setDeviceMode(dev, VREventCoalescer::parseMode(mode));
+        }
 			}
 			else{
 
@@ -827,6 +1032,21 @@ void VRMain::initialize(int argc, char **argv) {
      VRLOG_STATUS(s.str());
   }
 
+  // Optionally render the display graphs in parallel.  See the notes on
+  // renderOnAllDisplays() in VRMain.h.
+  if ((_displayGraphs.size() > 1) && _config->exists("ParallelDisplayGraphs", _name) &&
+      ((int)_config->getValue("ParallelDisplayGraphs", _name) != 0)) {
+    int numThreads = _config->exists("ParallelDisplayThreads", _name) ?
+      (int)_config->getValue("ParallelDisplayThreads", _name) : (int)_displayGraphs.size();
+    if ((numThreads <= 0) || (numThreads > (int)_displayGraphs.size())) {
+      numThreads = (int)_displayGraphs.size();
+    }
+    _displayThreads = new VRThreadPool(numThreads);
+    std::stringstream s;
+    s << "Rendering the display graphs on " << numThreads << " threads.";
+    VRLOG_STATUS(s.str());
+  }
+
 	_initialized = true;
   _shutdown = false;
 
@@ -846,6 +1066,8 @@ VRMain::synchronizeAndProcessEvents() {
 		throw std::runtime_error("VRMain not initialized.");
 	}
 
+  _profiler.beginFrame(_frame);
+
   VRDataQueue eventQueue;
 
   // Add a standard "FrameStart" event at the beginning of each frame
@@ -861,24 +1083,56 @@ VRMain::synchronizeAndProcessEvents() {
   frameStartEvent.linkNode("AnalogValue", "ElapsedSeconds");
   eventQueue.push(frameStartEvent);
 
-  for (int f = 0; f < _inputDevices.size(); f++) {
-    _inputDevices[f]->appendNewInputEventsSinceLastCall(&eventQueue);
+  {
+    VRProfileScope scope(&_profiler, "gatherEvents");
+    std::map<std::string, long> dropped;
+    for (int f = 0; f < _inputDevices.size(); f++) {
+      VRProfileScope deviceScope(&_profiler, "input", f);
+      VREventCoalescer::Mode mode = _coalescer.getDeviceMode(_inputDevices[f]);
+      if (mode == VREventCoalescer::KEEP_ALL) {
+        _inputDevices[f]->appendNewInputEventsSinceLastCall(&eventQueue);
+      } else {
+        VRDataQueue deviceQueue;
+        _inputDevices[f]->appendNewInputEventsSinceLastCall(&deviceQueue);
+        _coalescer.coalesce(&deviceQueue, mode, &dropped);
+        eventQueue.addQueue(deviceQueue);
+      }
+    }
+    if (_coalescer.hasEventModes()) {
+      _coalescer.coalesce(&eventQueue, VREventCoalescer::KEEP_ALL, &dropped);
+    }
+    for (std::map<std::string, long>::iterator it = dropped.begin(); it != dropped.end(); it++) {
+      _profiler.addCount("droppedSamples", it->first, it->second);
+    }
   }
 
 	// SYNCHRONIZATION POINT #1: When this function returns, we know
 	// that all MinVR nodes have the same list of input events generated
 	// since the last call to synchronizeAndProcessEvents(..).  So,
 	// every node will process the same set of input events this frame.
-  if (_net != NULL) {
+  if (_pipelinedSync) {
+    // Send this frame's events off to be exchanged while we render, and
+    // handle the ones exchanged last frame.  Every node does the same, so
+    // they still all handle the same events in the same frame.
+    VRProfileScope scope(&_profiler, "netSyncEvents");
+    _finishNetSync();
+    _startNetSync(eventQueue);
+    eventQueue = _netSyncResult;
+    _netSyncResult.clear();
+  } else if (_net != NULL) {
+    VRProfileScope scope(&_profiler, "netSyncEvents");
     eventQueue = _net->syncEventDataAcrossAllNodes(eventQueue);
   }
 
+  VRProfileScope handlerScope(&_profiler, "eventHandlers");
+  bool profiling = _profiler.isEnabled();
   while (eventQueue.notEmpty()) {
     // Unpack the next item from the queue and invoke the user's
-    // callback on it.
-    for (int f = 0; f < _eventHandlers.size(); f++) {
-      _eventHandlers[f]->onVREvent(eventQueue.getFirst());
-    }
+    // callback on it.  The item is unpacked once and every handler
+    // sees the same copy.
+    // Only the handlers that subscribed to the event's name (or to
+    // everything) get it; see VREventDispatcher.h.
+    _eventDispatcher.dispatch(eventQueue.getFirst(), profiling ? &_profiler : NULL);
 
     // Remove the item from the queue.
     eventQueue.pop();
@@ -889,9 +1143,80 @@ VRMain::synchronizeAndProcessEvents() {
   // safely get out.
 }
 
+void VRMain::_netSyncThreadLoop() {
+
+  std::unique_lock<std::mutex> lock(_netSyncMutex);
+  while (true) {
+    while ((_netSyncState != NETSYNC_REQUESTED) && (_netSyncState != NETSYNC_QUIT)) {
+      _netSyncCondition.wait(lock);
+    }
+    if (_netSyncState == NETSYNC_QUIT) return;
+
+    VRDataQueue eventQueue = _netSyncQueue;
+    lock.unlock();
+    try {
+      VRProfileScope scope(&_profiler, "netSyncEventsBackground");
+      eventQueue = _net->syncEventDataAcrossAllNodes(eventQueue);
+    } catch (...) {
+      _netSyncError = std::current_exception();
+    }
+    lock.lock();
+
+    _netSyncQueue = eventQueue;
+    _netSyncState = NETSYNC_DONE;
+    _netSyncCondition.notify_all();
+  }
+}
+
+void VRMain::_startNetSync(const VRDataQueue &eventQueue) {
+
+  std::unique_lock<std::mutex> lock(_netSyncMutex);
+  _netSyncQueue = eventQueue;
+  _netSyncState = NETSYNC_REQUESTED;
+  _netSyncCondition.notify_all();
+}
+
+void VRMain::_finishNetSync() {
+
+  std::unique_lock<std::mutex> lock(_netSyncMutex);
+  if (_netSyncState == NETSYNC_IDLE) return;
+
+  while (_netSyncState != NETSYNC_DONE) {
+    _netSyncCondition.wait(lock);
+  }
+  _netSyncResult.addQueue(_netSyncQueue);
+  _netSyncQueue.clear();
+  _netSyncState = NETSYNC_IDLE;
+
+  if (_netSyncError) {
+    std::exception_ptr error = _netSyncError;
+    _netSyncError = std::exception_ptr();
+    std::rethrow_exception(error);
+  }
+}
+
+void VRMain::_stopNetSyncThread() {
+
+  if (!_netSyncThread.joinable()) return;
+
+  // Let an exchange under way finish, so the other nodes are not left
+  // waiting for our half of it.  It is too late to report its errors.
+  try {
+    _finishNetSync();
+  } catch (...) {
+  }
+  {
+    std::unique_lock<std::mutex> lock(_netSyncMutex);
+    _netSyncState = NETSYNC_QUIT;
+    _netSyncCondition.notify_all();
+  }
+  _netSyncThread.join();
+}
+
 void
 VRMain::updateAllModels() {
 
+  VRProfileScope scope(&_profiler, "updateAllModels");
   for (std::vector<VRModelHandler*>::iterator it = _modelHandlers.begin();
        it != _modelHandlers.end(); it++) {
     (*it)->updateWorld(VRSystem::getTime());
@@ -910,31 +1235,68 @@ void VRMain::renderOnAllDisplays() {
 
 	if (!_displayGraphs.empty()) {
 		VRCompositeRenderHandler compositeHandler(_renderHandlers);
-		for (std::vector<VRDisplayNode*>::iterator it = _displayGraphs.begin(); it != _displayGraphs.end(); ++it) (*it)->render(&renderState, &compositeHandler);
+		_runOnAllDisplays("render", &renderState,
+		                  [&compositeHandler](VRDisplayNode *graph, VRDataIndex *state) {
+		                    graph->render(state, &compositeHandler);
+		                  });
 
 		// TODO: Advanced: if you are really trying to optimize performance, this
 		// is where you might want to add an idle callback.  Here, it's
 		// possible that the CPU is idle, but the GPU is still processing
 		// graphics comamnds.
 
-		for (std::vector<VRDisplayNode*>::iterator it = _displayGraphs.begin(); it != _displayGraphs.end(); ++it) (*it)->waitForRenderToComplete(&renderState);
+		_runOnAllDisplays("waitForRenderToComplete", &renderState,
+		                  [](VRDisplayNode *graph, VRDataIndex *state) {
+		                    graph->waitForRenderToComplete(state);
+		                  });
 	}
 
 	// SYNCHRONIZATION POINT #2: When this function returns we know that
 	// all nodes have finished rendering on all their attached display
 	// devices.  So, after this, we will be ready to "swap buffers",
-	// simultaneously displaying these new renderings on all nodes.
+	// simultaneously displaying these new renderings on all nodes.  The
+	// event exchange, if it is running in the background, must be done
+	// first, since it uses the same connection.
+	if (_pipelinedSync) {
+		VRProfileScope scope(&_profiler, "netSyncEventsWait");
+		_finishNetSync();
+	}
 	if (_net != NULL) {
+		VRProfileScope scope(&_profiler, "swapBarrier");
 		_net->syncSwapBuffersAcrossAllNodes();
 	}
 
 	if (!_displayGraphs.empty()) {
-		for (std::vector<VRDisplayNode*>::iterator it = _displayGraphs.begin(); it != _displayGraphs.end(); ++it) (*it)->displayFinishedRendering(&renderState);
+		_runOnAllDisplays("displayFinishedRendering", &renderState,
+		                  [](VRDisplayNode *graph, VRDataIndex *state) {
+		                    graph->displayFinishedRendering(state);
+		                  });
 	}
 
+	_profiler.endFrame();
 	_frame++;
 }
 
+void VRMain::_runOnAllDisplays(const char *name, VRDataIndex *renderState,
+                               const std::function<void(VRDisplayNode*, VRDataIndex*)> &phase) {
+
+  if (_displayThreads == NULL) {
+    for (std::vector<VRDisplayNode*>::iterator it = _displayGraphs.begin(); it != _displayGraphs.end(); ++it) {
+      VRProfileScope scope(&_profiler, name, (*it)->getName());
+      phase(*it, renderState);
+    }
+    return;
+  }
+
+  // The nodes add to the render state as they go, so each graph needs
+  // its own.  The copies share their data until they are changed.
+  _displayRenderStates.assign(_displayGraphs.size(), *renderState);
+  _displayThreads->run((int)_displayGraphs.size(), [this, name, &phase](int i) {
+      VRProfileScope scope(&_profiler, name, _displayGraphs[i]->getName());
+      phase(_displayGraphs[i], &_displayRenderStates[i]);
+    });
+}
+
 
 void VRMain::auditValuesFromAllDisplays()
 {
@@ -955,6 +1317,9 @@ void
 VRMain::shutdown()
 {
     VRLOG_H1("SHUTTING DOWN MINVR");
+    if (_profiler.isEnabled()) {
+      VRLOG_STATUS("Frame timings: " + _profiler.getSummary());
+    }
     _shutdown = true;
 }
 
@@ -962,7 +1327,13 @@ VRMain::shutdown()
 void
 VRMain::addEventHandler(VREventHandler* eventHandler)
 {
-	_eventHandlers.push_back(eventHandler);
+	_eventDispatcher.addHandler(eventHandler);
+}
+
+void
+VRMain::addEventHandler(VREventHandler* eventHandler, const std::string &eventNamePattern)
+{
+	_eventDispatcher.addHandler(eventHandler, eventNamePattern);
 }
 
 void
@@ -2,6 +2,10 @@
 #define VRMAIN_H
 
 #include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 #include <plugin/VRPluginManager.h>
 
 #include <config/VRDataIndex.h>
@@ -10,6 +14,8 @@
 #include <display/VRGraphicsToolkit.h>
 #include <display/VRWindowToolkit.h>
 #include <input/VRInputDevice.h>
+#include <input/VREventCoalescer.h>
+#include <main/VREventDispatcher.h>
 #include <main/VRFactory.h>
 #include <main/VRMainInterface.h>
 #include <net/VRNetInterface.h>
@@ -19,6 +25,8 @@
 #include <main/VRModelHandler.h>
 #include <main/VRError.h>
 #include <main/VRSearchPath.h>
+#include <main/VRFrameProfiler.h>
+#include <main/VRThreadPool.h>
 
 namespace MinVR {
 
@@ -331,6 +339,15 @@ public:
      */
     void addEventHandler(VREventHandler *eHandler);
 
+    /** Register an event handler that only wants some of the events: the
+        ones whose names match the pattern, which can be an exact name
+        ("Kbd1_Down"), a prefix ("Wand_*"), or a glob ("Kbd?_Down").  Call
+        this once for each pattern.  Events the handler doesn't want are
+        never passed to it, which saves a lot of calls when there are many
+        handlers and many events.  See VREventDispatcher.h.
+     */
+    void addEventHandler(VREventHandler *eHandler, const std::string &eventNamePattern);
+
     // TODO: Add function:  void removeEventHandler();
 
     /** Register your own class that implements the VRModelHandler interface
@@ -413,7 +430,10 @@ public:
 
     /** For use before calling initialize().  This will either load a given file
         name, or it will search for a file according to the VRSearchConfig
-        rules.
+        rules.  If the file has been compiled with MVRCompile, and hasn't
+        changed since, the compiled version is loaded instead (see
+        VRConfigCache).  The name of a compiled configuration can also be
+        given here.
      */
     void loadConfig(const std::string &pathAndFilename);
 
@@ -460,6 +480,19 @@ public:
     /** STEP 3 (option 2, part a):  If you need more control, you can call
         synchronizeAndProcessEvents() then renderingOnAllDisplays() yourself
         rather than calling mainloop().
+
+        Pipelined frame sync: on a cluster, exchanging events with the other
+        nodes costs a network round trip every frame, and normally nothing
+        else happens while it is under way.  Setting PipelinedFrameSync to 1
+        in the config for every node hides that round trip.  Each frame's
+        input events are sent on a background thread while the frame
+        renders, and they are handed to the event handlers at the start of
+        the next frame.  This trades latency for throughput: every event
+        reaches your handlers one frame later than it would otherwise,
+        which you will feel in head tracking at low frame rates, but the
+        frame time no longer includes the round trip.  All the nodes still
+        see the same events in the same frame.  The setting must be the
+        same on every node, and it has no effect without networking.
      */
     void synchronizeAndProcessEvents();
 
@@ -471,6 +504,17 @@ public:
     /** STEP 3 (option 2, part b):  If you need more control, you can call
         synchronizeAndProcessEvents() then renderingOnAllDisplays() yourself
         rather than calling mainloop().
+
+        Parallel display graphs: with ParallelDisplayGraphs set to 1 in the
+        VRSetup, the top-level display graphs (usually one per window) are
+        rendered at the same time on a pool of threads, ParallelDisplayThreads
+        of them (by default, one per graph).  Each graph gets a copy of the
+        render state, and always runs on the same thread, the first one on
+        the thread that called renderOnAllDisplays().  Everything still
+        happens in the same order: all the graphs render, then all wait for
+        rendering to complete, then the nodes meet at the swap barrier, then
+        all display.  Your render callbacks are called from several threads
+        at once, though, so they must be safe to call that way.
      */
     void renderOnAllDisplays();
 
@@ -504,6 +548,11 @@ public:
     /// to all rendering callbacks.
     VRDisplayNode* getDisplayNode(int nodeID);
 
+    /// Returns the timings of recent frames.  The profiler is off unless
+    /// FrameProfile is set to 1 in the VRSetup; see VRFrameProfiler.h for
+    /// that, and for writing a trace of each frame to a file.
+    VRFrameProfiler* getFrameProfiler() { return &_profiler; }
+
     /// Returns whether the application is currently in shutdown mode. This
     /// function returns the same value as the _shutdown member variable and
     /// can be used by customized implementations of the mainloop function
@@ -608,6 +657,14 @@ public:
 
  private:
 
+    // If the server is to send the given setup its configuration, the
+    // server's address and port, as "address:port".  Otherwise empty.
+    std::string _getConfigServerFor(const std::string &setupName);
+
+    // Connects to the server named by ConfigFromServer, and replaces the
+    // configuration with the server's.
+    void _receiveConfigFromServer();
+
     VRSearchConfig _configPath;
 
     bool _initialized;
@@ -621,11 +678,13 @@ public:
     VRFactory*       _factory;
     VRPluginManager* _pluginMgr;
 
-    std::vector<VREventHandler*>    _eventHandlers;
+    VREventDispatcher               _eventDispatcher;
     std::vector<VRModelHandler*>    _modelHandlers;
     std::vector<VRRenderHandler*>   _renderHandlers;
 
     std::vector<VRInputDevice*>     _inputDevices;
+    // Thins out each frame's tracker samples; see VREventCoalescer.h.
+    VREventCoalescer                _coalescer;
     std::vector<VRGraphicsToolkit*> _gfxToolkits;
     std::vector<VRWindowToolkit*>   _winToolkits;
     std::vector<VRDisplayNode*>     _displayGraphs;
@@ -635,6 +694,38 @@ public:
     int _frame;
      
     bool _shutdown;
+
+    VRFrameProfiler _profiler;
+
+    // For rendering the display graphs in parallel, or NULL.
+    VRThreadPool* _displayThreads;
+    std::vector<VRDataIndex> _displayRenderStates;
+    // Calls phase() on each display graph, in parallel if there are
+    // _displayThreads, and times each call under the given name.
+    void _runOnAllDisplays(const char *name, VRDataIndex *renderState,
+                           const std::function<void(VRDisplayNode*, VRDataIndex*)> &phase);
+
+    // For pipelined frame sync.  The network thread exchanges one frame's
+    // events (_netSyncQueue) while the main thread renders, and the result
+    // comes back in the same queue.  _netSyncState says whose turn it is.
+    enum NetSyncState { NETSYNC_IDLE, NETSYNC_REQUESTED, NETSYNC_DONE, NETSYNC_QUIT };
+    bool _pipelinedSync;
+    std::thread _netSyncThread;
+    std::mutex _netSyncMutex;
+    std::condition_variable _netSyncCondition;
+    NetSyncState _netSyncState;
+    VRDataQueue _netSyncQueue;
+    std::exception_ptr _netSyncError;
+    // the exchanged events, waiting for the next frame
+    VRDataQueue _netSyncResult;
+
+    void _netSyncThreadLoop();
+    // Hands the queue to the network thread to exchange.
+    void _startNetSync(const VRDataQueue &eventQueue);
+    // Waits for the exchange under way, if any, and adds its result to
+    // _netSyncResult.  The network connection is free after this.
+    void _finishNetSync();
+    void _stopNetSyncThread();
 };
 
 
@@ -24,6 +24,7 @@ class VRFactory;
 class VRMainInterface {
 public:
   virtual void addEventHandler(VREventHandler *eHandler) = 0;
+  virtual void addEventHandler(VREventHandler *eHandler, const std::string &eventNamePattern) = 0;
   virtual void addRenderHandler(VRRenderHandler *rHandler) = 0;
   virtual void addModelHandler(VRModelHandler* modelHandler) = 0;
   virtual void addInputDevice(VRInputDevice *dev) = 0;
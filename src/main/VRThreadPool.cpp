@@ -0,0 +1,131 @@
+#include "VRThreadPool.h"
+
+#include <chrono>
+
+namespace MinVR {
+
+// Spins until done() or the time is up, and says which.
+template <typename Done>
+static bool spinUntil(Done done, const double seconds) {
+
+  if (done()) return true;
+  if (seconds <= 0.0) return false;
+
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+  while (true) {
+    // Reading the clock costs more than checking, so check a few times
+    // in between.
+    for (int i = 0; i < 64; i++) {
+      if (done()) return true;
+#if defined(__i386__) || defined(__x86_64__)
+      __builtin_ia32_pause();
+#else
+      std::this_thread::yield();
+#endif
+    }
+    if (std::chrono::steady_clock::now() >= end) return done();
+  }
+}
+
+VRThreadPool::VRThreadPool(const int numThreads, const double spinTime,
+                           const bool callerRunsJobs) :
+  _numThreads((numThreads > 1) ? numThreads : 1),
+  _callerRunsJobs(callerRunsJobs), _spinTime(spinTime), _numJobs(0), _job(NULL), _generation(0), _stop(false),
+  _numSleeping(0), _pending(0) {
+
+  _errors.resize(_numThreads);
+  for (int thread = callerRunsJobs ? 1 : 0; thread < _numThreads; thread++) {
+    _workers.push_back(new std::thread(&VRThreadPool::_workerLoop, this, thread));
+  }
+}
+
+VRThreadPool::~VRThreadPool() {
+
+  {
+    std::lock_guard<std::mutex> lock(_wakeMutex);
+    _stop.store(true, std::memory_order_relaxed);
+    _generation.fetch_add(1, std::memory_order_release);
+  }
+  _wakeCondition.notify_all();
+
+  for (std::vector<std::thread*>::iterator it = _workers.begin();
+       it != _workers.end(); it++) {
+    (*it)->join();
+    delete *it;
+  }
+}
+
+void VRThreadPool::run(const int numJobs, const std::function<void(int)> &job) {
+
+  _numJobs = numJobs;
+  _job = &job;
+
+  // Wake the workers, if there is anything for them to do.
+  bool wake = numJobs > (_callerRunsJobs ? 1 : 0);
+  if (wake) {
+    _pending.store((int)_workers.size(), std::memory_order_relaxed);
+    int sleeping;
+    {
+      std::lock_guard<std::mutex> lock(_wakeMutex);
+      _generation.fetch_add(1, std::memory_order_release);
+      sleeping = _numSleeping;
+    }
+    if (sleeping > 0) _wakeCondition.notify_all();
+  }
+
+  if (_callerRunsJobs) _runJobs(0);
+
+  if (wake) {
+    if (!spinUntil([this]() { return _pending.load(std::memory_order_acquire) == 0; }, _spinTime)) {
+      std::unique_lock<std::mutex> lock(_doneMutex);
+      while (_pending.load(std::memory_order_acquire) != 0) _doneCondition.wait(lock);
+    }
+  }
+
+  _job = NULL;
+  for (std::vector<std::exception_ptr>::iterator it = _errors.begin();
+       it != _errors.end(); it++) {
+    if (*it) {
+      std::exception_ptr error = *it;
+      for (size_t i = 0; i < _errors.size(); i++) _errors[i] = std::exception_ptr();
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void VRThreadPool::_runJobs(const int thread) {
+
+  int numThreads = getNumThreads();
+  for (int i = thread; i < _numJobs; i += numThreads) {
+    try {
+      (*_job)(i);
+    } catch (...) {
+      if (!_errors[thread]) _errors[thread] = std::current_exception();
+    }
+  }
+}
+
+void VRThreadPool::_workerLoop(const int thread) {
+
+  unsigned long seen = 0;
+  while (true) {
+    if (!spinUntil([this, seen]() { return _generation.load(std::memory_order_acquire) != seen; }, _spinTime)) {
+      std::unique_lock<std::mutex> lock(_wakeMutex);
+      _numSleeping++;
+      while (_generation.load(std::memory_order_acquire) == seen) _wakeCondition.wait(lock);
+      _numSleeping--;
+    }
+    seen = _generation.load(std::memory_order_acquire);
+    if (_stop.load(std::memory_order_relaxed)) return;
+
+    _runJobs(thread);
+
+    if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lock(_doneMutex);
+      _doneCondition.notify_all();
+    }
+  }
+}
+
+} // end namespace MinVR
@@ -0,0 +1,81 @@
+#ifndef VRTHREADPOOL_H
+#define VRTHREADPOOL_H
+
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+
+namespace MinVR {
+
+/// \brief A fixed set of threads that run numbered jobs.
+///
+/// run(n, job) calls job(0) ... job(n-1), and returns when they are all
+/// done.  Job i always runs on thread i % getNumThreads(), and thread 0
+/// is the one that called run(), so a job that needs to stay on one
+/// thread from call to call (a display graph with a graphics context
+/// current, say) does.  If a job throws, run() throws the same thing
+/// once all the jobs have finished.
+///
+/// VRMain uses one to render its display graphs in parallel when the
+/// VRSetup has ParallelDisplayGraphs set.  A run() goes through in a few
+/// microseconds: the threads that are waiting for jobs, and the caller
+/// waiting for them to finish, spin for a short time before they go to
+/// sleep, and sleeping threads are only woken if there are any.
+///
+/// A pool can also be made so that the caller only waits, and all of its
+/// threads are started for it, as the Threading plugin's VRRenderPool
+/// does.  Then job i runs on started thread i % getNumThreads().
+class VRThreadPool {
+public:
+
+  /// \brief Starts numThreads - 1 threads, since the caller is one.
+  ///
+  /// \param spinTime How long, in seconds, to spin before sleeping.
+  /// \param callerRunsJobs If false, starts numThreads threads, and the
+  /// caller of run() only waits for them.
+  VRThreadPool(const int numThreads, const double spinTime = 200.0e-6,
+               const bool callerRunsJobs = true);
+  ~VRThreadPool();
+
+  int getNumThreads() const { return _numThreads; }
+
+  /// \brief Runs the jobs, and returns when they are all done.
+  ///
+  /// Only one thread should call this at a time.
+  void run(const int numJobs, const std::function<void(int)> &job);
+
+private:
+  // Runs the jobs for one thread, and keeps the first exception.
+  void _runJobs(const int thread);
+  void _workerLoop(const int thread);
+
+  std::vector<std::thread*> _workers;
+  int _numThreads;
+  bool _callerRunsJobs;
+  double _spinTime;
+
+  // What run() was called with.  Written before the generation is
+  // advanced, and read after it is seen.
+  int _numJobs;
+  const std::function<void(int)> *_job;
+  std::vector<std::exception_ptr> _errors;
+
+  std::atomic<unsigned long> _generation;
+  std::atomic<bool> _stop;
+  std::mutex _wakeMutex;
+  std::condition_variable _wakeCondition;
+  int _numSleeping;
+
+  // The number of workers that haven't finished this generation.
+  std::atomic<int> _pending;
+  std::mutex _doneMutex;
+  std::condition_variable _doneCondition;
+};
+
+} // end namespace MinVR
+
+#endif
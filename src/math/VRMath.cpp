@@ -21,9 +21,13 @@ VRPoint3::VRPoint3(VRFloatArray da) {
   x = da[0]; y = da[1]; z = da[2];
 }
 
+VRPoint3::VRPoint3(const VRFloatVec3 &v) {
+  x = v[0]; y = v[1]; z = v[2];
+}
+
 VRPoint3::VRPoint3(VRAnyCoreType t) {
-  VRFloatArray da = t;
-  x = da[0]; y = da[1]; z = da[2];
+  VRFloatVec3 v = t;
+  x = v[0]; y = v[1]; z = v[2];
 }
 
 VRPoint3::VRPoint3(const VRPoint3& p) { 
@@ -71,6 +75,12 @@ VRFloatArray VRPoint3::toVRFloatArray() const {
   return a;
 }
 
+VRFloatVec3 VRPoint3::toVRFloatVec3() const {
+  VRFloatVec3 v;
+  v[0] = x; v[1] = y; v[2] = z;
+  return v;
+}
+
 
 
 
@@ -90,9 +100,13 @@ VRVector3::VRVector3(VRFloatArray da) {
   x = da[0]; y = da[1]; z = da[2];
 }
 
+VRVector3::VRVector3(const VRFloatVec3 &v) {
+  x = v[0]; y = v[1]; z = v[2];
+}
+
 VRVector3::VRVector3(VRAnyCoreType t) {
-  VRFloatArray da = t;
-  x = da[0]; y = da[1]; z = da[2];
+  VRFloatVec3 v = t;
+  x = v[0]; y = v[1]; z = v[2];
 }
 
 VRVector3::VRVector3(const VRVector3& v) {
@@ -164,6 +178,12 @@ VRFloatArray VRVector3::toVRFloatArray() const {
   return a;
 }
 
+VRFloatVec3 VRVector3::toVRFloatVec3() const {
+  VRFloatVec3 v;
+  v[0] = x; v[1] = y; v[2] = z;
+  return v;
+}
+
 
 
 
@@ -183,9 +203,13 @@ VRMatrix4::VRMatrix4(VRFloatArray da) {
     memcpy(m,&da[0],16*sizeof(float));
 }
 
+VRMatrix4::VRMatrix4(const VRFloatMatrix4 &fm) {
+  memcpy(m,fm.data(),16*sizeof(float));
+}
+
 VRMatrix4::VRMatrix4(VRAnyCoreType t) {
-  VRFloatArray da = t;
-  memcpy(m,&da[0],16*sizeof(float));
+  VRFloatMatrix4 fm = t;
+  memcpy(m,fm.data(),16*sizeof(float));
 }
 
   
@@ -450,6 +474,12 @@ VRFloatArray VRMatrix4::toVRFloatArray() const {
   return a;
 }
 
+VRFloatMatrix4 VRMatrix4::toVRFloatMatrix4() const {
+  VRFloatMatrix4 fm;
+  memcpy(fm.data(),m,16*sizeof(float));
+  return fm;
+}
+
 
 
 
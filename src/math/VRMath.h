@@ -21,7 +21,7 @@ namespace MinVR {
 /** @class VRPoint3 
   * @brief 3D Point with floating point coordinates.
   */
-class VRPoint3 : public VRFloatArrayConvertible {
+class VRPoint3 : public VRFloatVec3Convertible {
 public:  
   /// Default point at the origin
   VRPoint3();
@@ -36,8 +36,13 @@ public:
   /// being [x,y,z]
   VRPoint3(VRFloatArray da);
   
+  /// Constructs a point from a VRFloatVec3, the way it is kept in a
+  /// VRDataIndex
+  VRPoint3(const VRFloatVec3 &v);
+  
   /// Constructs a point from the VRAnyCoreType wrapper class. The argument
-  /// must be able to be interpreted as a VRFloatArray core type.
+  /// must be able to be interpreted as a VRFloatVec3 core type, which a
+  /// VRFloatArray of at least three elements can.
   VRPoint3(VRAnyCoreType t);
   
   /// Copy constructor for point
@@ -64,6 +69,9 @@ public:
   /// Converts the point to a VRFloatArray for data in a VRDataIndex
   VRFloatArray toVRFloatArray() const;
 
+  /// Converts the point to a VRFloatVec3 for data in a VRDataIndex
+  VRFloatVec3 toVRFloatVec3() const;
+
 public:
   float x,y,z; 
 };
@@ -74,7 +82,7 @@ public:
 /** @class VRVector3 
   * @brief 3D vector (magnitude and direction).
   */
-class VRVector3 : public VRFloatArrayConvertible {
+class VRVector3 : public VRFloatVec3Convertible {
 public:
   /// Default constructor to create zero vector
   VRVector3();
@@ -89,8 +97,13 @@ public:
   /// being [x,y,z]
   VRVector3(VRFloatArray da);
   
+  /// Constructs a vector from a VRFloatVec3, the way it is kept in a
+  /// VRDataIndex
+  VRVector3(const VRFloatVec3 &v);
+  
   /// Constructs a vector from the VRAnyCoreType wrapper class. The argument
-  /// must be able to be interpreted as a VRFloatArray core type.
+  /// must be able to be interpreted as a VRFloatVec3 core type, which a
+  /// VRFloatArray of at least three elements can.
   VRVector3(VRAnyCoreType t);
 
   /// Copy constructor for vector
@@ -131,6 +144,9 @@ public:
   /// Converts the point to a VRFloatArray for data in a VRDataIndex
   VRFloatArray toVRFloatArray() const;
 
+  /// Converts the vector to a VRFloatVec3 for data in a VRDataIndex
+  VRFloatVec3 toVRFloatVec3() const;
+
 public:
   float x,y,z; 
 };
@@ -140,7 +156,7 @@ public:
 /** @class VRMatrix4
   * @brief A 4x4 transformation matrix
   */
-class VRMatrix4 : public VRFloatArrayConvertible {
+class VRMatrix4 : public VRFloatMatrix4Convertible {
 public: 
   /// Default constructor creates an identity matrix:
   VRMatrix4();
@@ -153,8 +169,13 @@ public:
   ///  matrix format (i.e., column major order).
   VRMatrix4(VRFloatArray da);
   
+  /// Constructs a matrix from a VRFloatMatrix4, the way it is kept in a
+  /// VRDataIndex
+  VRMatrix4(const VRFloatMatrix4 &fm);
+
   /// Constructs a matrix from the VRAnyCoreType wrapper class. The argument
-  /// must be able to be interpreted as a VRFloatArray core type.
+  /// must be able to be interpreted as a VRFloatMatrix4 core type, which a
+  /// VRFloatArray of at least 16 elements can.
   VRMatrix4(VRAnyCoreType t);
 
   /// Copy constructor
@@ -253,6 +274,9 @@ public:
     
   /// Converts the point to a VRFloatArray for storage in a VRDataIndex
   VRFloatArray toVRFloatArray() const;
+
+  /// Converts the matrix to a VRFloatMatrix4 for storage in a VRDataIndex
+  VRFloatMatrix4 toVRFloatMatrix4() const;
     
     
 private:
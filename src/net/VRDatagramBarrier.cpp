@@ -0,0 +1,126 @@
+#include <net/VRDatagramBarrier.h>
+
+#include <main/VRLog.h>
+#include <main/VRError.h>
+
+#include <sstream>
+
+namespace MinVR {
+
+// the datagram is this tag followed by the frame number
+const char VRDatagramBarrier::RELEASE_MAGIC[4] = { 'M', 'V', 'R', 'B' };
+
+VRDatagramBarrier::VRDatagramBarrier(const std::string &address,
+                                     const std::string &port,
+                                     const std::string &interfaceAddress,
+                                     bool sender)
+{
+  _socketFD = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef WIN32
+  if (_socketFD == INVALID_SOCKET) {
+#else
+  if (_socketFD == -1) {
+#endif
+    VRERROR("VRDatagramBarrier: cannot create a socket", "socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP) failed");
+    exit(1);
+  }
+
+  memset(&_destAddr, 0, sizeof(_destAddr));
+  _destAddr.sin_family = AF_INET;
+  _destAddr.sin_port = htons(stoi(port));
+  if (inet_pton(AF_INET, address.c_str(), &_destAddr.sin_addr) != 1) {
+    VRERROR("VRDatagramBarrier: cannot use the address " + address + ".",
+            "Give a multicast group or broadcast address in dotted form.");
+    exit(1);
+  }
+
+  struct in_addr iface;
+  iface.s_addr = htonl(INADDR_ANY);
+  if (!interfaceAddress.empty() &&
+      (inet_pton(AF_INET, interfaceAddress.c_str(), &iface) != 1)) {
+    VRERROR("VRDatagramBarrier: cannot use the interface " + interfaceAddress + ".",
+            "Give the address of a local interface in dotted form.");
+    exit(1);
+  }
+
+  // 224.0.0.0 to 239.255.255.255
+  bool multicast = (ntohl(_destAddr.sin_addr.s_addr) >> 28) == 14;
+
+#ifdef WIN32
+  const char yes = 1;
+#else
+  int yes = 1;
+#endif
+
+  if (sender) {
+    if (multicast) {
+      // Let clients on this machine hear it, too.
+      unsigned char loop = 1;
+      setsockopt(_socketFD, IPPROTO_IP, IP_MULTICAST_LOOP, (const char*)&loop, sizeof(loop));
+      if (!interfaceAddress.empty() &&
+          (setsockopt(_socketFD, IPPROTO_IP, IP_MULTICAST_IF, (const char*)&iface, sizeof(iface)) == -1)) {
+        VRERROR("VRDatagramBarrier: setsockopt(IP_MULTICAST_IF) failed.", "Check for a problem with networking.");
+        exit(1);
+      }
+    } else {
+      setsockopt(_socketFD, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+    }
+    VRLOG_STATUS("Releasing the swap buffers barrier with datagrams to " + address + ":" + port + ".");
+    return;
+  }
+
+  // Several clients on one machine all listen on the same port.
+  setsockopt(_socketFD, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+#ifdef SO_REUSEPORT
+  setsockopt(_socketFD, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+#endif
+
+  struct sockaddr_in bindAddr;
+  memset(&bindAddr, 0, sizeof(bindAddr));
+  bindAddr.sin_family = AF_INET;
+  bindAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+  bindAddr.sin_port = _destAddr.sin_port;
+  if (::bind(_socketFD, (struct sockaddr *) &bindAddr, sizeof(bindAddr)) == -1) {
+    VRERROR("VRDatagramBarrier: bind() failed.", "Check that the port " + port + " is free.");
+    exit(1);
+  }
+
+  if (multicast) {
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr = _destAddr.sin_addr;
+    mreq.imr_interface = iface;
+    if (setsockopt(_socketFD, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char*)&mreq, sizeof(mreq)) == -1) {
+      VRERROR("VRDatagramBarrier: cannot join the multicast group " + address + ".",
+              "Check that the network interface supports multicast.");
+      exit(1);
+    }
+  }
+  VRLOG_STATUS("Listening for swap buffers barrier datagrams on " + address + ":" + port + ".");
+}
+
+VRDatagramBarrier::~VRDatagramBarrier()
+{
+#ifdef WIN32
+  closesocket(_socketFD);
+#else
+  close(_socketFD);
+#endif
+}
+
+void VRDatagramBarrier::release(uint32_t frame) {
+  unsigned char buf[8];
+  memcpy(buf, RELEASE_MAGIC, 4);
+  VRNetInterface::packInt(&buf[4], (int32_t)frame);
+  // A failed send is not fatal; the clients still get the TCP release.
+  sendto(_socketFD, (const char*)buf, sizeof(buf), 0,
+         (struct sockaddr *) &_destAddr, sizeof(_destAddr));
+}
+
+bool VRDatagramBarrier::receiveRelease(uint32_t frame) {
+  unsigned char buf[16];
+  int n = recv(_socketFD, (char *)buf, sizeof(buf), 0);
+  return (n == 8) && (memcmp(buf, RELEASE_MAGIC, 4) == 0) &&
+    ((uint32_t)VRNetInterface::unpackInt(&buf[4]) == frame);
+}
+
+} // end namespace MinVR
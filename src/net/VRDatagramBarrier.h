@@ -0,0 +1,63 @@
+#ifndef VRDATAGRAMBARRIER_H
+#define VRDATAGRAMBARRIER_H
+
+#include "VRNetInterface.h"
+
+#include <string>
+
+#ifndef WIN32
+  #include <arpa/inet.h>
+#endif
+
+namespace MinVR {
+
+/// \brief Releases the swap buffers barrier with one UDP datagram.
+///
+/// Over TCP, the server releases the barrier by writing to each client
+/// in turn, so the last client in the list goes later than the first.
+/// With one of these, the server also sends a single datagram to a
+/// multicast group (or a broadcast address) that all the clients are
+/// listening to, so they are all released at once.
+///
+/// Datagrams can be lost, so the TCP release is still sent after the
+/// datagram, and a client goes on whichever it sees first.  That also
+/// means the two ends do not need to agree on using this: a client
+/// without it just waits for the TCP message.
+///
+/// Each datagram carries the number of the frame it releases, so a late
+/// one is never taken for the next frame's release.  Clusters sharing a
+/// network should use different addresses or ports.
+class VRDatagramBarrier {
+public:
+  /// \param address A multicast group, like 239.255.42.99, or a
+  ///   broadcast address.
+  /// \param port The UDP port for the datagrams.
+  /// \param interfaceAddress The address of the local interface to send
+  ///   and receive multicast datagrams on, or "" to let the system pick.
+  ///   Use 127.0.0.1 to keep a test on one machine.
+  /// \param sender True for the server, false for a client.
+  VRDatagramBarrier(const std::string &address, const std::string &port,
+                    const std::string &interfaceAddress, bool sender);
+  ~VRDatagramBarrier();
+
+  /// \brief Server: sends the release for the given frame.
+  void release(uint32_t frame);
+
+  /// \brief Client: reads one datagram, which should be waiting.
+  ///
+  /// Returns true if it is the release for the given frame.
+  bool receiveRelease(uint32_t frame);
+
+  /// \brief The socket, for a client to wait on along with the server's.
+  SOCKET getSocket() const { return _socketFD; };
+
+private:
+  SOCKET _socketFD;
+  struct sockaddr_in _destAddr;
+
+  static const char RELEASE_MAGIC[4];
+};
+
+} // end namespace MinVR
+
+#endif
@@ -1,6 +1,7 @@
 #include <net/VRNetClient.h>
 #include <main/VRLog.h>
 #include <main/VRError.h>
+#include <config/VRBinaryCodec.h>
 
 #include <iostream>
 #include <sstream>
@@ -17,8 +18,33 @@ void *get_in_addr2(struct sockaddr *sa) {
 
 
 
-VRNetClient::VRNetClient(const std::string &serverIP, const std::string &serverPort)
+VRNetClient::VRNetClient(const std::string &serverIP, const std::string &serverPort,
+                         unsigned char maxWireFormat) :
+  _wireFormat(WIRE_FORMAT_XML), _swapBarrier(NULL), _swapFrame(0),
+  _swapNowPending(0)
 {
+  connectToServer(serverIP, serverPort);
+  negotiateWireFormat(maxWireFormat);
+}
+
+VRNetClient::VRNetClient(const std::string &serverIP, const std::string &serverPort,
+                         VRDataIndex *serverConfig) :
+  _wireFormat(WIRE_FORMAT_XML), _swapBarrier(NULL), _swapFrame(0),
+  _swapNowPending(0)
+{
+  connectToServer(serverIP, serverPort);
+
+  sendConfigRequest(_socketFD);
+  std::string config = waitForAndReceiveConfig(_socketFD);
+  serverConfig->addSerializedBinary(config);
+
+  std::stringstream s;
+  s << "VRNetClient received the configuration (" << config.size() << " bytes) from the server.";
+  VRLOG_STATUS(s.str());
+}
+
+void VRNetClient::connectToServer(const std::string &serverIP, const std::string &serverPort) {
+
   VRLOG_STATUS("VRNetClient connecting...");
 
 #ifdef WIN32  // WinSock implementation
@@ -151,12 +177,26 @@ VRNetClient::VRNetClient(const std::string &serverIP, const std::string &serverP
   _socketFD = sockfd;
 
 #endif
+}
 
+void VRNetClient::negotiateWireFormat(unsigned char maxWireFormat) {
+
+  // Agree with the server on a format for the event data.
+  sendWireFormat(_socketFD, maxWireFormat);
+  _wireFormat = waitForAndReceiveWireFormat(_socketFD);
+  if (_wireFormat == WIRE_FORMAT_BINARY_DELTA) {
+    VRLOG_STATUS("VRNetClient using the binary wire format, receiving only other nodes' events.");
+  } else if (_wireFormat == WIRE_FORMAT_BINARY) {
+    VRLOG_STATUS("VRNetClient using the binary wire format.");
+  } else {
+    VRLOG_STATUS("VRNetClient using the XML wire format.");
+  }
 }
 
 VRNetClient::~VRNetClient()
 {
   VRLOG_STATUS("VRNetClient closing socket.");
+  delete _swapBarrier;
 #ifdef WIN32
   closesocket(_socketFD);
   WSACleanup();
@@ -169,14 +209,67 @@ VRNetClient::~VRNetClient()
 VRDataQueue VRNetClient::syncEventDataAcrossAllNodes(VRDataQueue eventQueue) {
 
   // 1. send inputEvents to server
-  sendEventData(_socketFD, eventQueue.serialize());
+  sendEventData(_socketFD, serializeQueue(eventQueue, _wireFormat));
 
-  // 2. receive all events from the server
+  // 2. receive all events from the server, which come after any
+  // swap_buffers_now we have not read yet
+  receivePendingSwapBuffersNow();
   VRDataQueue::serialData allEventData = waitForAndReceiveEventData(_socketFD);
 
+  if (_wireFormat == WIRE_FORMAT_BINARY_DELTA) {
+    return applyDelta(eventQueue, allEventData);
+  }
   return VRDataQueue(allEventData);
 }
 
+// Puts the other nodes' events from the server together with our own, in
+// the order given by the merge order token.  Pushing them in that order
+// assigns the same timestamps the server's queue has.
+VRDataQueue VRNetClient::applyDelta(const VRDataQueue &ownEvents,
+                                    const VRDataQueue::serialData &delta) {
+
+  VRBinaryReader in(delta);
+  if (!in.expectRaw(DELTA_MAGIC, sizeof(DELTA_MAGIC))) {
+    VRERRORNOADV("Event data from the server is not in the delta format.");
+  }
+  if (in.getByte() > DELTA_VERSION) {
+    VRERRORNOADV("Event data from the server uses a newer delta format than this code understands.");
+  }
+
+  uint32_t numRuns = in.getUInt32();
+  std::vector<uint32_t> runs(numRuns);
+  for (uint32_t r = 0; r < numRuns; r++) {
+    runs[r] = in.getUInt32();
+  }
+  uint32_t numOthers = in.getUInt32();
+
+  VRDataQueue out;
+  VRDataQueue::const_iterator own = ownEvents.begin();
+  uint32_t numRead = 0;
+  for (uint32_t r = 0; r < numRuns; r++) {
+    for (uint32_t k = 0; k < runs[r]; k++) {
+      if (r % 2 == 0) {
+        if (numRead++ == numOthers) {
+          VRERRORNOADV("Event data from the server appears corrupted.");
+        }
+        long long timeStamp = (long long)in.getInt64();
+        out.push(timeStamp, in.getString());
+      } else {
+        if (own == ownEvents.end()) {
+          VRERRORNOADV("Event data from the server does not match the events sent.");
+        }
+        out.push(own->first.first, own->second);
+        ++own;
+      }
+    }
+  }
+
+  if ((numRead != numOthers) || !in.atEnd() || (own != ownEvents.end())) {
+    VRERRORNOADV("Event data from the server does not match the events sent.");
+  }
+  return out;
+}
+
 void
 VRNetClient::syncSwapBuffersAcrossAllNodes()
 {
@@ -184,7 +277,54 @@ VRNetClient::syncSwapBuffersAcrossAllNodes()
   sendSwapBuffersRequest(_socketFD);
 
   // 2. wait for and receive a swap_buffers_now message from the server
-  waitForAndReceiveSwapBuffersNow(_socketFD);
+  receivePendingSwapBuffersNow();
+  uint32_t frame = _swapFrame++;
+  if (_swapBarrier == NULL) {
+    waitForAndReceiveSwapBuffersNow(_socketFD);
+    return;
+  }
+
+  // ... or the datagram, whichever comes first
+  VRPollFD fds[2];
+  fds[0].fd = _socketFD;
+  fds[1].fd = _swapBarrier->getSocket();
+  while (true) {
+    fds[0].events = fds[1].events = POLLIN;
+    fds[0].revents = fds[1].revents = 0;
+    if (VRNET_POLL(fds, 2, -1) < 0) {
+#ifndef WIN32
+      if (errno == EINTR) continue;
+#endif
+      VRERROR("VRNetClient: poll() failed.", "Check for a problem with networking.");
+      exit(1);
+    }
+    // The datagram goes first, so check for it first.
+    if (fds[1].revents != 0) {
+      if (_swapBarrier->receiveRelease(frame)) {
+        _swapNowPending++;
+        return;
+      }
+      // an old one, from a frame the TCP message released
+    }
+    if (fds[0].revents != 0) {
+      waitForAndReceiveSwapBuffersNow(_socketFD);
+      return;
+    }
+  }
+}
+
+void VRNetClient::receivePendingSwapBuffersNow() {
+  while (_swapNowPending > 0) {
+    waitForAndReceiveSwapBuffersNow(_socketFD);
+    _swapNowPending--;
+  }
+}
+
+void VRNetClient::useDatagramSwapBarrier(const std::string &address,
+                                         const std::string &port,
+                                         const std::string &interfaceAddress) {
+  delete _swapBarrier;
+  _swapBarrier = new VRDatagramBarrier(address, port, interfaceAddress, false);
 }
 
 } // end namespace MinVR
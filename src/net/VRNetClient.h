@@ -2,6 +2,7 @@
 #define VRNETCLIENT_H
 
 #include "VRNetInterface.h"
+#include "VRDatagramBarrier.h"
 
 #ifndef WIN32
   #include <netinet/tcp.h>
@@ -13,17 +14,61 @@ namespace MinVR {
 class VRNetClient : public VRNetInterface {
  public:
 
-  VRNetClient(const std::string &serverIP, const std::string &serverPort);
+  /// The client offers the server the best wire format it is willing to
+  /// use for event data, and the server picks one both can handle.  Pass
+  /// WIRE_FORMAT_XML to force the XML format.
+  VRNetClient(const std::string &serverIP, const std::string &serverPort,
+              unsigned char maxWireFormat = WIRE_FORMAT_BINARY);
+
+  /// Connects, and asks the server for its configuration, which is
+  /// added to serverConfig.  A client started this way needn't read any
+  /// configuration files, and has the same configuration as the server.
+  /// Since the wire format is normally set in the configuration, it is
+  /// agreed on afterwards: call negotiateWireFormat() before anything
+  /// else.
+  VRNetClient(const std::string &serverIP, const std::string &serverPort,
+              VRDataIndex *serverConfig);
   ~VRNetClient();
 
+  /// Agrees with the server on the format for the event data.  Only for
+  /// clients that asked for the configuration; the other constructor
+  /// does this itself.
+  void negotiateWireFormat(unsigned char maxWireFormat);
+
   VRDataQueue syncEventDataAcrossAllNodes(VRDataQueue eventQueue);
 
   void syncSwapBuffersAcrossAllNodes();
 
+  void useDatagramSwapBarrier(const std::string &address,
+                              const std::string &port,
+                              const std::string &interfaceAddress = "");
+
  private:
 
+  // Connects to the server, trying until it is listening.
+  void connectToServer(const std::string &serverIP, const std::string &serverPort);
+
   SOCKET _socketFD;
 
+  // the format agreed on with the server
+  unsigned char _wireFormat;
+
+  // NULL unless the server may release the barrier with a datagram.
+  VRDatagramBarrier *_swapBarrier;
+  // counts the swap buffers syncs, to match the server's datagrams
+  uint32_t _swapFrame;
+  // swap_buffers_now messages still on their way from the server, for
+  // frames that a datagram released first
+  int _swapNowPending;
+
+  // Reads any swap_buffers_now messages we were released without.
+  void receivePendingSwapBuffersNow();
+
+  // Rebuilds the whole event queue from the events this client sent and
+  // a WIRE_FORMAT_BINARY_DELTA message from the server.
+  static VRDataQueue applyDelta(const VRDataQueue &ownEvents,
+                                const VRDataQueue::serialData &delta);
+
 };
 
 
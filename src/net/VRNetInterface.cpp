@@ -6,6 +6,18 @@ namespace MinVR {
 const unsigned char VRNetInterface::EVENTS_MSG = 1;
 const unsigned char VRNetInterface::SWAP_BUFFERS_REQUEST_MSG = 2;
 const unsigned char VRNetInterface::SWAP_BUFFERS_NOW_MSG = 3;
+const unsigned char VRNetInterface::WIRE_FORMAT_MSG = 4;
+const unsigned char VRNetInterface::CONFIG_REQUEST_MSG = 5;
+const unsigned char VRNetInterface::CONFIG_MSG = 6;
+
+// wire formats, in order of preference; the higher one wins if both ends
+// support it
+const unsigned char VRNetInterface::WIRE_FORMAT_XML = 0;
+const unsigned char VRNetInterface::WIRE_FORMAT_BINARY = 1;
+const unsigned char VRNetInterface::WIRE_FORMAT_BINARY_DELTA = 2;
+
+const char VRNetInterface::DELTA_MAGIC[4] = { 'M', 'V', 'R', 'D' };
+const unsigned char VRNetInterface::DELTA_VERSION = 1;
 
 // assuming 32-bit ints, note that VRNetInterface::pack/unpackint()
 // use the int32_t type
@@ -26,22 +38,56 @@ void VRNetInterface::sendSwapBuffersNow(SOCKET socketID) {
 void VRNetInterface::sendEventData(SOCKET socketID,
                                    VRDataQueue::serialData eventData) {
     // std::cerr << "sendEventData" << std::endl;
+	sendSizedMessage(socketID, EVENTS_MSG, eventData);
+}
+
+void VRNetInterface::sendSizedMessage(SOCKET socketID, unsigned char messageID,
+                                      const std::string &data) {
 
-	int dataSize =  (int)eventData.size() + 1 + VRNET_SIZEOFINT;
+	int dataSize =  (int)data.size() + 1 + VRNET_SIZEOFINT;
 	unsigned char *buf = new unsigned char[dataSize+1];
 	//1. add 1-byte message header
-	buf[0] = EVENTS_MSG;
+	buf[0] = messageID;
 	// 2. add the size of the message data so receive will know how
 	// many bytes to expect.
-	packInt(&buf[1], (int)eventData.size());
-	// 3. send the chars that make up the eventData.
-	memcpy(&buf[1 + VRNET_SIZEOFINT], (const unsigned char*)eventData.c_str(), eventData.size());
+	packInt(&buf[1], (int)data.size());
+	// 3. send the chars that make up the data.
+	memcpy(&buf[1 + VRNET_SIZEOFINT], (const unsigned char*)data.c_str(), data.size());
 	//4. send package
 	sendall(socketID,buf,dataSize);
 	//5. delete buffer
 	delete[] buf;
 }
 
+void VRNetInterface::sendConfigRequest(SOCKET socketID) {
+  // this message consists only of a 1-byte header
+  sendall(socketID, &CONFIG_REQUEST_MSG, 1);
+}
+
+void VRNetInterface::sendConfig(SOCKET socketID,
+                                const std::string &serializedConfig) {
+  sendSizedMessage(socketID, CONFIG_MSG, serializedConfig);
+}
+
+void VRNetInterface::sendWireFormat(SOCKET socketID,
+                                    unsigned char wireFormat) {
+  // this message is a 1-byte header followed by the 1-byte format
+  unsigned char buf[2];
+  buf[0] = WIRE_FORMAT_MSG;
+  buf[1] = wireFormat;
+  sendall(socketID, buf, 2);
+}
+
+VRDataQueue::serialData
+VRNetInterface::serializeQueue(VRDataQueue &eventQueue,
+                               unsigned char wireFormat) {
+  // Clients using the delta format still send their own events in full.
+  if (wireFormat >= WIRE_FORMAT_BINARY) {
+    return eventQueue.serializeBinary();
+  }
+  return eventQueue.serialize();
+}
+
 int VRNetInterface::sendall(SOCKET s, const unsigned char *buf, int len) {
   int total = 0;        // how many bytes we've sent
   int bytesleft = len;  // how many we have left to send
@@ -94,34 +140,59 @@ VRNetInterface::waitForAndReceiveSwapBuffersNow(SOCKET socketID) {
 VRDataQueue::serialData
 VRNetInterface::waitForAndReceiveEventData(SOCKET socketID) {
   // std::cerr << "waitForAndReceiveEventData" << std::endl;
+  return waitForAndReceiveSizedMessage(socketID, EVENTS_MSG);
+}
+
+std::string VRNetInterface::waitForAndReceiveConfig(SOCKET socketID) {
+  return waitForAndReceiveSizedMessage(socketID, CONFIG_MSG);
+}
+
+std::string
+VRNetInterface::waitForAndReceiveSizedMessage(SOCKET socketID,
+                                              unsigned char messageID) {
 
   // 1. receive 1-byte message header
-  waitForAndReceiveOneByte(socketID, EVENTS_MSG);
+  waitForAndReceiveOneByte(socketID, messageID);
 
   // 2. receive int that tells us the size of the data portion of the
   // message in bytes
   unsigned char buf1[VRNET_SIZEOFINT];
   int status = receiveall(socketID, buf1, VRNET_SIZEOFINT);
   if (status == -1) {
-    std::cerr << "NetInterface error: receiveall failed receiving event header." << std::endl;
+    std::cerr << "NetInterface error: receiveall failed receiving message header." << std::endl;
     exit(1);
   }
   int dataSize = unpackInt(buf1);
 
-  // 3. receive dataSize bytes, then decode these as InputEvents
+  // 3. receive dataSize bytes
   unsigned char *buf2 = new unsigned char[dataSize+1];
   status = receiveall(socketID, buf2, dataSize);
   if ((status == -1) || (status != dataSize)) {
-    std::cerr << "NetInterface error: receiveall failed receiving event data." << std::endl;
+    std::cerr << "NetInterface error: receiveall failed receiving message data." << std::endl;
     exit(1);
   }
 
-  buf2[dataSize] = '\0';
-  std::string data(reinterpret_cast<const char*>(buf2));
+  // The binary wire format can contain zero bytes, so use the size.
+  std::string data(reinterpret_cast<const char*>(buf2), dataSize);
   delete[] buf2;
   return data;
 }
 
+unsigned char
+VRNetInterface::waitForAndReceiveWireFormat(SOCKET socketID) {
+  // 1. receive 1-byte message header
+  waitForAndReceiveOneByte(socketID, WIRE_FORMAT_MSG);
+
+  // 2. receive the 1-byte format
+  unsigned char wireFormat = WIRE_FORMAT_XML;
+  int status = receiveall(socketID, &wireFormat, 1);
+  if (status != 1) {
+    std::cerr << "NetInterface error: receiveall failed receiving wire format." << std::endl;
+    exit(1);
+  }
+  return wireFormat;
+}
+
 int VRNetInterface::receiveall(SOCKET s, unsigned char *buf, int len) {
   int total = 0;        // how many bytes we've received
   int bytesleft = len; // how many we have left to receive
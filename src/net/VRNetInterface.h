@@ -16,6 +16,8 @@
 #pragma comment (lib, "Ws2_32.lib")
 #pragma comment (lib, "Mswsock.lib")
 #pragma comment (lib, "AdvApi32.lib")
+typedef WSAPOLLFD VRPollFD;
+#define VRNET_POLL WSAPoll
 #else
 #define SOCKET int
 #include "stdint.h"
@@ -26,6 +28,9 @@
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <poll.h>
+typedef struct pollfd VRPollFD;
+#define VRNET_POLL poll
 #endif
 
 namespace MinVR {
@@ -35,19 +40,59 @@ public:
   virtual VRDataQueue syncEventDataAcrossAllNodes(VRDataQueue eventQueue) = 0;
 	virtual void syncSwapBuffersAcrossAllNodes() = 0;
 
+	/// Also release the swap buffers barrier with a UDP datagram sent to
+	/// the given multicast group or broadcast address.  The events still
+	/// go over TCP.  See VRDatagramBarrier.
+	virtual void useDatagramSwapBarrier(const std::string &address,
+	                                    const std::string &port,
+	                                    const std::string &interfaceAddress = "") = 0;
+
 	virtual ~VRNetInterface() {};
+
+	// encodings for the event data, agreed on by client and server when
+	// the connection is made.  XML is always supported as a fallback.
+	static const unsigned char WIRE_FORMAT_XML;
+	static const unsigned char WIRE_FORMAT_BINARY;
+	// The binary encoding, but the server sends each client only the
+	// events from the other nodes, with a merge order token that says
+	// how to interleave them with the client's own events.  The client
+	// rebuilds the same queue every other node gets.  The message is:
+	//
+	//   "MVRD" version:u8 numRuns:u32 run:u32* numItems:u32
+	//          { timeStamp:i64 item:str }*
+	//
+	// where the runs alternate between a number of items from the message
+	// and a number of the client's own items, starting with the former.
+	static const unsigned char WIRE_FORMAT_BINARY_DELTA;
+
 protected:
 	// unique identifiers for different network messages sent as a
 	// 1-byte header for each msg
 	static const unsigned char EVENTS_MSG;
 	static const unsigned char SWAP_BUFFERS_REQUEST_MSG;
 	static const unsigned char SWAP_BUFFERS_NOW_MSG;
+	static const unsigned char WIRE_FORMAT_MSG;
+	// A client that wants the server's configuration sends a request
+	// before its wire format offer, and the server answers with the
+	// whole data index in its binary encoding.
+	static const unsigned char CONFIG_REQUEST_MSG;
+	static const unsigned char CONFIG_MSG;
 
 	static const unsigned char VRNET_SIZEOFINT;
 
+	// tag and version at the start of a WIRE_FORMAT_BINARY_DELTA message
+	static const char DELTA_MAGIC[4];
+	static const unsigned char DELTA_VERSION;
+
 	static void sendSwapBuffersRequest(SOCKET socketID);
 	static void sendSwapBuffersNow(SOCKET socketID);
 	static void sendEventData(SOCKET socketID, VRDataQueue::serialData eventData);
+	static void sendWireFormat(SOCKET socketID, unsigned char wireFormat);
+	static void sendConfigRequest(SOCKET socketID);
+	static void sendConfig(SOCKET socketID, const std::string &serializedConfig);
+	// a 1-byte header, the size of the data, and the data
+	static void sendSizedMessage(SOCKET socketID, unsigned char messageID,
+		const std::string &data);
 	static int sendall(SOCKET socketID, const unsigned char *buf, int len);
 
 	static void waitForAndReceiveOneByte(SOCKET socketID,
@@ -55,8 +100,16 @@ protected:
 	static void waitForAndReceiveSwapBuffersRequest(SOCKET socketID);
 	static void waitForAndReceiveSwapBuffersNow(SOCKET socketID);
 	static VRDataQueue::serialData waitForAndReceiveEventData(SOCKET socketID);
+	static unsigned char waitForAndReceiveWireFormat(SOCKET socketID);
+	static std::string waitForAndReceiveConfig(SOCKET socketID);
+	static std::string waitForAndReceiveSizedMessage(SOCKET socketID,
+		unsigned char messageID);
 	static int receiveall(SOCKET socketID, unsigned char *buf, int len);
 
+	// serializes the queue in the given wire format
+	static VRDataQueue::serialData serializeQueue(VRDataQueue &eventQueue,
+		unsigned char wireFormat);
+
 
 public:
 	/// return 0 for big endian, 1 for little endian.
@@ -2,7 +2,12 @@
 
 #include <main/VRLog.h>
 #include <main/VRError.h>
+#include <main/VRSystem.h>
+#include <config/VRBinaryCodec.h>
 
+#include <algorithm>
+
+#include <iomanip>
 
 
 using namespace std;
@@ -11,6 +16,9 @@ namespace MinVR {
 
 #define BACKLOG 100	 // how many pending connections queue will hold
 
+// marks a client whose wire format offer is still to come
+static const unsigned char WIRE_FORMAT_PENDING = 0xff;
+
     /**
 #ifndef WIN32
 void sigchld_handler(int s) {
@@ -28,7 +36,9 @@ void *get_in_addr(struct sockaddr *sa) {
 **/
 
 
-VRNetServer::VRNetServer(const std::string &listenPort, int numExpectedClients)
+VRNetServer::VRNetServer(const std::string &listenPort, int numExpectedClients,
+                         unsigned char maxWireFormat, const VRDataIndex *config) :
+  _config(config), _arrivalReportInterval(1000), _swapBarrier(NULL), _swapFrame(0)
 {
 
   VRLOG_STATUS("VRNetServer starting networking.");
@@ -123,6 +133,7 @@ VRNetServer::VRNetServer(const std::string &listenPort, int numExpectedClients)
         VRLOG_STATUS(s.str());
         
         _clientSocketFDs.push_back(client_fd);
+        startHandshake(client_fd, maxWireFormat);
     }
 
     /**
@@ -225,6 +236,9 @@ VRNetServer::VRNetServer(const std::string &listenPort, int numExpectedClients)
     _clientSocketFDs.push_back(new_fd);
   }
      */
+  // No more connections are expected, so stop listening.  Otherwise the
+  // port stays taken until this process exits.
+  closesocket(serv_fd);
   VRLOG_STATUS("Established all expected connections.");
 
 
@@ -287,8 +301,12 @@ VRNetServer::VRNetServer(const std::string &listenPort, int numExpectedClients)
         VRLOG_STATUS(s.str());
         
         _clientSocketFDs.push_back(client_fd);
+        startHandshake(client_fd, maxWireFormat);
     }
 
+    // No more connections are expected, so stop listening.  Otherwise
+    // the port stays taken until this process exits.
+    close(serv_fd);
     VRLOG_STATUS("Established all expected connections.");
 
     
@@ -397,12 +415,60 @@ VRNetServer::VRNetServer(const std::string &listenPort, int numExpectedClients)
 
      **/
      
+#endif
+
+  finishHandshakes(maxWireFormat);
+
+  _readStates.resize(_clientSocketFDs.size());
+  _eventArrivals.maxOffsets.assign(_clientSocketFDs.size(), 0.0);
+  _swapArrivals.maxOffsets.assign(_clientSocketFDs.size(), 0.0);
+
+#ifdef __linux__
+  // One epoll set for the life of the server, with the client index as
+  // the cookie, so a frame's wait costs nothing per idle client.
+  _epollFD = epoll_create1(0);
+  if (_epollFD == -1) {
+    VRERROR("VRServer: epoll_create1() failed.", "Check for a problem with networking.");
+    exit(1);
+  }
+  for (size_t i = 0; i < _clientSocketFDs.size(); i++) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.u64 = i;
+    if (epoll_ctl(_epollFD, EPOLL_CTL_ADD, _clientSocketFDs[i], &ev) == -1) {
+      VRERROR("VRServer: epoll_ctl() failed.", "Check for a problem with networking.");
+      exit(1);
+    }
+  }
 #endif
 }
 
+// Logs the arrival skew of some frames.
+static void logArrivals(const char *what, const char *frames, unsigned long numFrames,
+                        double meanSkew, double maxSkew) {
+  stringstream s;
+  s << std::fixed << std::setprecision(3)
+    << "Client " << what << " arrival skew over " << frames << numFrames
+    << " frames: mean " << 1000.0 * meanSkew << " ms, max " << 1000.0 * maxSkew << " ms.";
+  VRLOG_STATUS(s.str());
+}
+
 VRNetServer::~VRNetServer()
 {
+  if (_eventArrivals.numFrames > 0) {
+    logArrivals("event data", "", _eventArrivals.numFrames,
+                _eventArrivals.getMeanSkew(), _eventArrivals.maxSkew);
+  }
+  if (_swapArrivals.numFrames > 0) {
+    logArrivals("swap request", "", _swapArrivals.numFrames,
+                _swapArrivals.getMeanSkew(), _swapArrivals.maxSkew);
+  }
+
   VRLOG_STATUS("VRNetServer closing all sockets.");
+  delete _swapBarrier;
+#ifdef __linux__
+  close(_epollFD);
+#endif
   for (std::vector<SOCKET>::iterator i=_clientSocketFDs.begin(); i < _clientSocketFDs.end(); i++) {
 	#ifdef WIN32
       closesocket(*i);
@@ -417,47 +483,401 @@ VRNetServer::~VRNetServer()
 }
 
 
+void VRNetServer::startHandshake(SOCKET clientFD, unsigned char maxWireFormat) {
+
+  // The first message is either the wire format offer or a request for
+  // the configuration, which comes before it.
+  unsigned char messageID = 0;
+  if (receiveall(clientFD, &messageID, 1) != 1) {
+    VRERROR("VRNetServer: a client hung up while connecting.",
+            "Check for a problem with the client.");
+  }
+
+  if (messageID == CONFIG_REQUEST_MSG) {
+    if (_config == NULL) {
+      VRERROR("VRNetServer: a client asked for the configuration, and there is none to give.",
+              "The server must be given its configuration to share it.");
+    }
+    if (_serializedConfig.empty()) _serializedConfig = _config->serializeBinary();
+    sendConfig(clientFD, _serializedConfig);
+
+    std::stringstream s;
+    s << "Sent the configuration (" << _serializedConfig.size() << " bytes) to the client.";
+    VRLOG_STATUS(s.str());
+
+    // The client reads the configuration before it knows which wire
+    // format to offer.  Rather than wait for that here, accept the other
+    // clients, and pick up its offer when they are all connected.
+    _clientWireFormats.push_back(WIRE_FORMAT_PENDING);
+
+  } else if (messageID == WIRE_FORMAT_MSG) {
+    unsigned char wireFormat = WIRE_FORMAT_XML;
+    if (receiveall(clientFD, &wireFormat, 1) != 1) {
+      VRERROR("VRNetServer: a client hung up while connecting.",
+              "Check for a problem with the client.");
+    }
+    _clientWireFormats.push_back(answerWireFormat(clientFD, wireFormat, maxWireFormat));
+
+  } else {
+    std::stringstream s;
+    s << "VRNetServer: unexpected message " << (int)messageID << " from a connecting client.";
+    VRERROR(s.str(), "Check that the client and server are the same version of MinVR.");
+  }
+}
+
+void VRNetServer::finishHandshakes(unsigned char maxWireFormat) {
+
+  for (size_t i = 0; i < _clientSocketFDs.size(); i++) {
+    if (_clientWireFormats[i] == WIRE_FORMAT_PENDING) {
+      unsigned char wireFormat = waitForAndReceiveWireFormat(_clientSocketFDs[i]);
+      _clientWireFormats[i] = answerWireFormat(_clientSocketFDs[i], wireFormat, maxWireFormat);
+    }
+  }
+}
+
+unsigned char VRNetServer::answerWireFormat(SOCKET clientFD, unsigned char wireFormat,
+                                            unsigned char maxWireFormat) {
+  if (wireFormat > maxWireFormat) {
+    wireFormat = maxWireFormat;
+  }
+  sendWireFormat(clientFD, wireFormat);
+
+  if (wireFormat == WIRE_FORMAT_BINARY_DELTA) {
+    VRLOG_STATUS("Client will use the binary wire format, receiving only other nodes' events.");
+  } else if (wireFormat == WIRE_FORMAT_BINARY) {
+    VRLOG_STATUS("Client will use the binary wire format.");
+  } else {
+    VRLOG_STATUS("Client will use the XML wire format.");
+  }
+  return wireFormat;
+}
+
+
+bool VRNetServer::readAvailable(size_t client, unsigned char messageID) {
+  ReadState &state = _readStates[client];
+  SOCKET fd = _clientSocketFDs[client];
+
+  // The socket is known to be readable, so one recv() will not block.
+  // It may not bring the whole message, in which case we pick up where
+  // we left off next time.
+  unsigned char *dest;
+  int wanted;
+  if (state.headerSize == 0) {
+    dest = &state.header;
+    wanted = 1;
+  } else if (state.headerSize < 1 + VRNET_SIZEOFINT) {
+    dest = &state.sizeBytes[state.headerSize - 1];
+    wanted = 1 + VRNET_SIZEOFINT - state.headerSize;
+  } else {
+    dest = (unsigned char*)&state.data[state.data.size() - state.dataSize];
+    wanted = state.dataSize;
+  }
+
+#ifdef WIN32
+  int n = recv(fd, (char *)dest, wanted, 0);
+#else
+  int n = recv(fd, dest, wanted, 0);
+#endif
+  if (n == 0) {
+    stringstream s;
+    s << "VRNetServer: client " << client + 1 << " closed its connection.";
+    VRERROR(s.str(), "Check that all the client processes are still running.");
+    exit(1);
+  }
+  if (n < 0) {
+#ifndef WIN32
+    if (errno == EINTR || errno == EAGAIN) return false;
+#endif
+    VRERROR("VRNetServer: recv() failed.", "Check for a problem with networking.");
+    exit(1);
+  }
+
+  if (state.headerSize == 0) {
+    if (state.header != messageID) {
+      std::cerr << "NetInterface error, unexpected message.  Expected: " <<
+        (int)messageID << " Received: " << (int)state.header << std::endl;
+      return false;
+    }
+    state.headerSize = 1;
+    // Only event messages have a size and data after the id.
+    if (messageID != EVENTS_MSG) return true;
+
+  } else if (state.headerSize < 1 + VRNET_SIZEOFINT) {
+    state.headerSize += n;
+    if (state.headerSize == 1 + VRNET_SIZEOFINT) {
+      // dataSize counts down the bytes still to come.
+      state.dataSize = unpackInt(state.sizeBytes);
+      state.data.resize(state.dataSize);
+      return state.dataSize == 0;
+    }
+
+  } else {
+    state.dataSize -= n;
+    return state.dataSize == 0;
+  }
+  return false;
+}
+
+
+void VRNetServer::receiveFromAllClients(unsigned char messageID,
+                                        std::vector<VRDataQueue> *parsedQueues) {
+  size_t numClients = _clientSocketFDs.size();
+  for (size_t i = 0; i < numClients; i++) {
+    _readStates[i] = ReadState();
+  }
+
+  size_t numWaiting = numClients;
+
+#ifdef __linux__
+  std::vector<struct epoll_event> events(numClients);
+#else
+  std::vector<VRPollFD> fds(numClients);
+  std::vector<size_t> fdClients(numClients);
+#endif
+
+  while (numWaiting > 0) {
+
+#ifdef __linux__
+    int numReady = epoll_wait(_epollFD, &events[0], (int)numClients, -1);
+    if (numReady < 0) {
+      if (errno == EINTR) continue;
+      VRERROR("VRNetServer: epoll_wait() failed.", "Check for a problem with networking.");
+      exit(1);
+    }
+    for (int r = 0; r < numReady; r++) {
+      size_t client = (size_t)events[r].data.u64;
+#else
+    int numFDs = 0;
+    for (size_t i = 0; i < numClients; i++) {
+      if (!_readStates[i].complete) {
+        fds[numFDs].fd = _clientSocketFDs[i];
+        fds[numFDs].events = POLLIN;
+        fds[numFDs].revents = 0;
+        fdClients[numFDs] = i;
+        numFDs++;
+      }
+    }
+    int numReady = VRNET_POLL(&fds[0], numFDs, -1);
+    if (numReady < 0) {
+#ifndef WIN32
+      if (errno == EINTR) continue;
+#endif
+      VRERROR("VRNetServer: poll() failed.", "Check for a problem with networking.");
+      exit(1);
+    }
+    for (int r = 0; r < numFDs; r++) {
+      if (fds[r].revents == 0) continue;
+      size_t client = fdClients[r];
+#endif
+
+      // A client that hung up, or whose connection failed, while we
+      // wait for its message is reported by readAvailable(), once it has
+      // read whatever the client sent first.
+      ReadState &state = _readStates[client];
+      if (state.complete) {
+#ifdef __linux__
+        // Completed clients stay in the epoll set, but they will not send
+        // anything more until we answer, so the only thing that wakes us
+        // for one is a hangup.  It's an error now rather than later, since
+        // the set is level-triggered and would keep waking us for it.
+        if (events[r].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) {
+          stringstream s;
+          s << "VRNetServer: client " << client + 1 << " closed its connection.";
+          VRERROR(s.str(), "Check that all the client processes are still running.");
+          exit(1);
+        }
+#endif
+        continue;
+      }
+      if (readAvailable(client, messageID)) {
+        state.complete = true;
+        state.arrivalTime = VRSystem::getTime();
+        numWaiting--;
+
+        if (parsedQueues != NULL) {
+          (*parsedQueues)[client] = VRDataQueue(state.data);
+        }
+      }
+    }
+  }
+}
+
+
+void VRNetServer::recordArrivals(ArrivalStats &stats, const char *what) {
+  size_t numClients = _readStates.size();
+  if (numClients == 0) return;
+
+  double first = _readStates[0].arrivalTime;
+  double last = first;
+  for (size_t i = 1; i < numClients; i++) {
+    if (_readStates[i].arrivalTime < first) first = _readStates[i].arrivalTime;
+    if (_readStates[i].arrivalTime > last) last = _readStates[i].arrivalTime;
+  }
+
+  stats.offsets.resize(numClients);
+  for (size_t i = 0; i < numClients; i++) {
+    stats.offsets[i] = _readStates[i].arrivalTime - first;
+    if (stats.offsets[i] > stats.maxOffsets[i]) {
+      stats.maxOffsets[i] = stats.offsets[i];
+    }
+  }
+
+  stats.skew = last - first;
+  if (stats.skew > stats.maxSkew) stats.maxSkew = stats.skew;
+  stats.totalSkew += stats.skew;
+  stats.numFrames++;
+
+  if (stats.skew > stats.recentMaxSkew) stats.recentMaxSkew = stats.skew;
+  stats.recentTotalSkew += stats.skew;
+  stats.numRecentFrames++;
+  if ((_arrivalReportInterval > 0) && (stats.numRecentFrames >= _arrivalReportInterval)) {
+    logArrivals(what, "the last ", stats.numRecentFrames,
+                stats.recentTotalSkew / (double)stats.numRecentFrames, stats.recentMaxSkew);
+    stats.recentMaxSkew = 0.0;
+    stats.recentTotalSkew = 0.0;
+    stats.numRecentFrames = 0;
+  }
+}
+
+
 // Wait for and receive an eventData message from every client, add
 // them together and send them out again.
 VRDataQueue VRNetServer::syncEventDataAcrossAllNodes(VRDataQueue eventQueue) {
 
-  // TODO: rather than a for loop, could use a select() system call
-  // here (I think) to figure out which socket is ready for a read in
-  // the situation where one client is ready but other(s) are not
-  for (std::vector<SOCKET>::iterator itr=_clientSocketFDs.begin();
-       itr < _clientSocketFDs.end(); itr++) {
-    VRDataQueue::serialData eventData = waitForAndReceiveEventData(*itr);
+  // 1. receive from all the clients at once, so a slow client does
+  // not hold up the reading (and parsing) of the others' data
+  std::vector<VRDataQueue> clientQueues(_clientSocketFDs.size());
+  receiveFromAllClients(EVENTS_MSG, &clientQueues);
+  recordArrivals(_eventArrivals, "event data");
+
+  // Merge in client order, whatever order the data arrived in, so that
+  // events with the same time stamp always come out the same way.  This
+  // is the order VRDataQueue::addQueue() would give, adding the client
+  // queues one after the other, but we also note where each item came
+  // from, for the delta format.
+  std::vector<const VRDataQueue*> sources(1, &eventQueue);
+  for (size_t i = 0; i < clientQueues.size(); i++) {
+    sources.push_back(&clientQueues[i]);
+  }
+  std::vector<MergedItem> order;
+  mergeOrder(sources, order);
 
-    eventQueue.addQueue(eventData);
+  VRDataQueue allEvents;
+  for (size_t k = 0; k < order.size(); k++) {
+    allEvents.push(order[k].item->first.first, order[k].item->second);
   }
 
-  VRDataQueue::serialData serializedEventQueue = eventQueue.serialize();
-  // 2. send new combined inputEvents array out to all clients
-  for (std::vector<SOCKET>::iterator itr=_clientSocketFDs.begin();
-       itr < _clientSocketFDs.end(); itr++) {
-    sendEventData(*itr, serializedEventQueue);
+  // 2. send new combined inputEvents array out to all clients,
+  // serializing it at most once for each of the full formats in use, and
+  // each item at most once for the delta format
+  VRDataQueue::serialData serializedEventQueue[2];
+  bool serialized[2] = { false, false };
+  std::vector<VRDataQueue::serialData> serializedItems;
+  for (size_t i = 0; i < _clientSocketFDs.size(); i++) {
+    unsigned char wireFormat = _clientWireFormats[i];
+    if (wireFormat == WIRE_FORMAT_BINARY_DELTA) {
+      if (serializedItems.empty()) {
+        serializedItems.resize(order.size());
+        for (size_t k = 0; k < order.size(); k++) {
+          serializedItems[k] = order[k].item->second.serializeBinary();
+        }
+      }
+      // The client is source i + 1, after the server.
+      sendEventData(_clientSocketFDs[i],
+                    serializeDelta(order, serializedItems, i + 1));
+      continue;
+    }
+    if (!serialized[wireFormat]) {
+      serializedEventQueue[wireFormat] = serializeQueue(allEvents, wireFormat);
+      serialized[wireFormat] = true;
+    }
+    sendEventData(_clientSocketFDs[i], serializedEventQueue[wireFormat]);
   }
 
-  return eventQueue;
+  return allEvents;
 }
 
-void VRNetServer::syncSwapBuffersAcrossAllNodes() {
-  // 1. wait for, receive, and parse a swap_buffers_request message
-  // from every client
 
-  // TODO: rather than a for loop could use a select() system call
-  // here (I think) to figure out which socket is ready for a read in
-  // the situation where 1 is ready but other(s) are not
-  for (std::vector<SOCKET>::iterator itr=_clientSocketFDs.begin();
-       itr < _clientSocketFDs.end(); itr++) {
-    waitForAndReceiveSwapBuffersRequest(*itr);
+// Each source is in time order already.  Sorting by time, then source,
+// then place in the source gives the same order as merging the sources
+// one at a time, with the items already merged first on ties.
+void VRNetServer::mergeOrder(const std::vector<const VRDataQueue*> &sources,
+                             std::vector<MergedItem> &order) {
+  order.clear();
+  for (size_t s = 0; s < sources.size(); s++) {
+    size_t place = 0;
+    for (VRDataQueue::const_iterator it = sources[s]->begin();
+         it != sources[s]->end(); ++it) {
+      MergedItem m;
+      m.item = it;
+      m.timeStamp = it->first.first;
+      m.source = s;
+      m.place = place++;
+      order.push_back(m);
+    }
+  }
+  std::sort(order.begin(), order.end());
+}
+
+
+VRDataQueue::serialData
+VRNetServer::serializeDelta(const std::vector<MergedItem> &order,
+                            const std::vector<VRDataQueue::serialData> &serializedItems,
+                            size_t source) {
+
+  // The merge order token: alternating runs of other nodes' items and
+  // this client's own items, starting with the others.
+  std::vector<uint32_t> runs(1, 0);
+  uint32_t numOthers = 0;
+  for (size_t k = 0; k < order.size(); k++) {
+    bool own = (order[k].source == source);
+    if (own != (runs.size() % 2 == 0)) runs.push_back(0);
+    runs.back()++;
+    if (!own) numOthers++;
+  }
+
+  VRBinaryWriter out;
+  out.putRaw(DELTA_MAGIC, sizeof(DELTA_MAGIC));
+  out.putByte(DELTA_VERSION);
+  out.putUInt32((uint32_t)runs.size());
+  for (size_t r = 0; r < runs.size(); r++) {
+    out.putUInt32(runs[r]);
+  }
+  out.putUInt32(numOthers);
+  for (size_t k = 0; k < order.size(); k++) {
+    if (order[k].source == source) continue;
+    out.putInt64(order[k].timeStamp);
+    out.putString(serializedItems[k]);
   }
 
-  // 2. send a swap_buffers_now message to every client
+  return out.str();
+}
+
+void VRNetServer::syncSwapBuffersAcrossAllNodes() {
+  // 1. wait for and receive a swap_buffers_request message from every
+  // client, in whatever order they come
+  receiveFromAllClients(SWAP_BUFFERS_REQUEST_MSG, NULL);
+  recordArrivals(_swapArrivals, "swap request");
+
+  // 2. release everyone at once with a datagram, if we can...
+  if (_swapBarrier != NULL) {
+    _swapBarrier->release(_swapFrame);
+  }
+  _swapFrame++;
+
+  // ... and send a swap_buffers_now message to every client, in case
+  // the datagram goes astray
   for (std::vector<SOCKET>::iterator itr=_clientSocketFDs.begin();
        itr < _clientSocketFDs.end(); itr++) {
     sendSwapBuffersNow(*itr);
   }
 }
 
+void VRNetServer::useDatagramSwapBarrier(const std::string &address,
+                                         const std::string &port,
+                                         const std::string &interfaceAddress) {
+  delete _swapBarrier;
+  _swapBarrier = new VRDatagramBarrier(address, port, interfaceAddress, true);
+}
+
 } // end namespace MinVR
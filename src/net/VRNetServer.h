@@ -2,6 +2,7 @@
 #define VRNETSERVER_H
 
 #include "VRNetInterface.h"
+#include "VRDatagramBarrier.h"
 
 #ifndef WIN32
   #include <netinet/tcp.h>
@@ -9,6 +10,9 @@
   #include <arpa/inet.h>
   #include <sys/wait.h>
   #include <signal.h>
+  #ifdef __linux__
+    #include <sys/epoll.h>
+  #endif
 #endif
 
 #include <math/VRMath.h>
@@ -19,17 +23,162 @@ namespace MinVR {
 class VRNetServer : public VRNetInterface {
  public:
 
-  VRNetServer(const std::string &listenPort, int numExpectedClients);
+  /// Each client offers a wire format for event data when it connects,
+  /// and gets the better of that and maxWireFormat.  Pass WIRE_FORMAT_XML
+  /// to force the XML format.
+  ///
+  /// Clients may also ask for the server's configuration when they
+  /// connect (see VRNetClient), so they needn't read any files of their
+  /// own.  They get config, which must be given for that.
+  VRNetServer(const std::string &listenPort, int numExpectedClients,
+              unsigned char maxWireFormat = WIRE_FORMAT_BINARY,
+              const VRDataIndex *config = NULL);
   ~VRNetServer();
 
   VRDataQueue syncEventDataAcrossAllNodes(VRDataQueue eventQueue);
 
   void syncSwapBuffersAcrossAllNodes();
 
+  void useDatagramSwapBarrier(const std::string &address,
+                              const std::string &port,
+                              const std::string &interfaceAddress = "");
+
+  /// \brief How far apart the clients' messages arrived.
+  ///
+  /// The server reads from every client at once, and notes the time
+  /// at which each client's message was complete.  These are kept
+  /// separately for the event data and the swap buffers requests.
+  class ArrivalStats {
+  public:
+    ArrivalStats() : skew(0.0), maxSkew(0.0), totalSkew(0.0), numFrames(0),
+                     recentMaxSkew(0.0), recentTotalSkew(0.0), numRecentFrames(0) {};
+
+    /// For the last frame, the time in seconds between the first
+    /// client's message and each client's message, in client order.
+    std::vector<double> offsets;
+    /// The largest offset seen so far for each client.
+    std::vector<double> maxOffsets;
+    /// The time between the first and last message of the last frame.
+    double skew;
+    double maxSkew;
+    double totalSkew;
+    unsigned long numFrames;
+
+    double getMeanSkew() const {
+      return numFrames ? totalSkew / (double)numFrames : 0.0;
+    };
+
+    /// The same, since the last periodic report.
+    double recentMaxSkew;
+    double recentTotalSkew;
+    unsigned long numRecentFrames;
+  };
+
+  const ArrivalStats &getEventArrivalStats() const { return _eventArrivals; };
+  const ArrivalStats &getSwapArrivalStats() const { return _swapArrivals; };
+
+  /// \brief Logs the arrival skew every so many frames.
+  ///
+  /// The mean and max skew since the last report are logged for the
+  /// event data and the swap requests, every 1000 frames unless this
+  /// says otherwise.  Zero leaves only the summary logged at the end.
+  void setArrivalReportInterval(unsigned long numFrames) {
+    _arrivalReportInterval = numFrames;
+  };
+
  private:
 
   std::vector<SOCKET> _clientSocketFDs;
 
+  // the format agreed on with each client, parallel to _clientSocketFDs
+  std::vector<unsigned char> _clientWireFormats;
+
+  // Receives a newly connected client's first message.  That is either
+  // its wire format offer, which is answered right away, or a request for
+  // the configuration, which is sent.  The offer from a client that got
+  // the configuration is answered by finishHandshakes(), once all the
+  // clients are connected, so they can all read it at once.
+  void startHandshake(SOCKET clientFD, unsigned char maxWireFormat);
+  void finishHandshakes(unsigned char maxWireFormat);
+
+  // Replies to a wire format offer with the one to use, and returns it.
+  unsigned char answerWireFormat(SOCKET clientFD, unsigned char wireFormat,
+                                 unsigned char maxWireFormat);
+
+  // What the clients get if they ask for the configuration, encoded the
+  // first time one asks.
+  const VRDataIndex *_config;
+  std::string _serializedConfig;
+
+  // What has come in so far of the message we expect from one client.
+  // Partial messages stay here until the rest of them arrive.
+  struct ReadState {
+    ReadState() : header(0), headerSize(0), dataSize(0), complete(false),
+                  arrivalTime(0.0) {};
+    unsigned char header;
+    unsigned char sizeBytes[4];
+    int headerSize;  // bytes of message id and size received
+    int dataSize;
+    std::string data;
+    bool complete;
+    double arrivalTime;
+  };
+  std::vector<ReadState> _readStates;
+
+  ArrivalStats _eventArrivals;
+  ArrivalStats _swapArrivals;
+  unsigned long _arrivalReportInterval;
+
+  // NULL unless the barrier is also released with a datagram.
+  VRDatagramBarrier *_swapBarrier;
+  // counts the swap buffers syncs, to label the datagrams
+  uint32_t _swapFrame;
+
+#ifdef __linux__
+  int _epollFD;
+#endif
+
+  // Waits for the messageID message from every client, reading from
+  // whichever clients have something to say.  Returns with _readStates
+  // holding the messages.  If parsedQueues is given, each client's
+  // event data is parsed into it as soon as it is all here, while the
+  // others are still on their way.
+  void receiveFromAllClients(unsigned char messageID,
+                             std::vector<VRDataQueue> *parsedQueues);
+
+  // Reads what is available on one client's socket, without blocking.
+  // Returns true if that completes the message.
+  bool readAvailable(size_t client, unsigned char messageID);
+
+  // Adds the frame's arrival times to the stats, and logs them if it is
+  // time to.  what names the message in the log.
+  void recordArrivals(ArrivalStats &stats, const char *what);
+
+  // One item of the merged event queue, and where it came from: source 0
+  // is the server's own queue, and source i + 1 is client i.
+  struct MergedItem {
+    VRDataQueue::const_iterator item;
+    long long timeStamp;
+    size_t source;
+    size_t place;
+
+    bool operator<(const MergedItem &other) const {
+      if (timeStamp != other.timeStamp) return timeStamp < other.timeStamp;
+      if (source != other.source) return source < other.source;
+      return place < other.place;
+    };
+  };
+
+  static void mergeOrder(const std::vector<const VRDataQueue*> &sources,
+                         std::vector<MergedItem> &order);
+
+  // The WIRE_FORMAT_BINARY_DELTA message for the client that is the
+  // given source.  See VRNetInterface.h for the layout.
+  static VRDataQueue::serialData
+  serializeDelta(const std::vector<MergedItem> &order,
+                 const std::vector<VRDataQueue::serialData> &serializedItems,
+                 size_t source);
+
 };
 
 }
@@ -0,0 +1,235 @@
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include "config/VRDataIndex.h"
+#include "config/VRConfigCache.h"
+#include <main/VRConfig.h>
+#include <main/VRSystem.h>
+
+int testCacheRoundTrip();
+int testCacheOutOfDate();
+
+int cachetest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testCacheRoundTrip();
+    break;
+
+  case 2:
+    output = testCacheOutOfDate();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+static void writeFile(const std::string &fileName, const std::string &contents) {
+  std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  file << contents;
+}
+
+// A configuration with links, of about the size of a big cluster's.
+static std::string bigConfig(const int numSetups) {
+
+  std::stringstream config;
+  config << "<MinVR><Defaults><Window displaynodeType=\"VRGraphicsWindowNode\">"
+         << "<Width>640</Width><Height>480</Height>"
+         << "<Border type=\"int\">0</Border></Window></Defaults><VRSetups>";
+  for (int setup = 0; setup < numSetups; setup++) {
+    config << "<Node" << setup << " hostType=\"VRStandAlone\">"
+           << "<HostIP>10.0.0." << setup << "</HostIP>"
+           << "<Wall type=\"floatarray\">-1.0,1.0,-1.0,1.0,0.5,0.25</Wall>"
+           << "<Plugins type=\"stringarray\">MinVR_GLFW,MinVR_OpenGL</Plugins>"
+           << "<Left linkNode=\"/MinVR/Defaults/Window\"/>"
+           << "<Right linkNode=\"/MinVR/Defaults/Window\"/>"
+           << "</Node" << setup << ">";
+  }
+  config << "</VRSetups></MinVR>";
+  return config.str();
+}
+
+// A cache holds the same index as the configuration it was made from,
+// links and all.
+int testCacheRoundTrip() {
+
+  int out = 0;
+
+  const std::string configFile = "cachetest1.minvr";
+  const std::string cacheFile = MinVR::VRConfigCache::getCacheFileName(configFile);
+  writeFile(configFile, bigConfig(16));
+
+  MinVR::VRConfigCache::compile(std::vector<std::string>(1, configFile), cacheFile);
+  if (!MinVR::VRConfigCache::isCache(cacheFile)) out++;
+  if (MinVR::VRConfigCache::isCache(configFile)) out++;
+
+  std::vector<std::string> sources = MinVR::VRConfigCache::getSourceFiles(cacheFile);
+  if ((sources.size() != 1) || (sources[0].size() <= configFile.size()) ||
+      (sources[0].compare(sources[0].size() - configFile.size(), configFile.size(), configFile) != 0)) out++;
+
+  MinVR::VRDataIndex parsed;
+  parsed.processXMLFile(configFile, "/");
+
+  MinVR::VRDataIndex cached;
+  std::string whyNot;
+  if (!MinVR::VRConfigCache::load(cacheFile, &cached, &whyNot)) out++;
+  if (!whyNot.empty()) out++;
+
+  if (cached.serialize() != parsed.serialize()) out++;
+  if ((int)cached.getValue("/MinVR/VRSetups/Node3/Right/Width") != 640) out++;
+  if (cached.getAttributeValue("/MinVR/VRSetups/Node3/Left", "displaynodeType") !=
+      "VRGraphicsWindowNode") out++;
+  if (cached.selectByAttribute("hostType", "*").size() != 16) out++;
+
+  // Loading on top of something is like reading the XML on top of it.
+  MinVR::VRDataIndex parsedOver, cachedOver;
+  parsedOver.addData("/MinVR/VRSetups/Node3/HostIP", std::string("localhost"));
+  parsedOver.addData("/MinVR/Other", 7);
+  cachedOver = parsedOver;
+  parsedOver.processXMLFile(configFile, "/");
+  if (!MinVR::VRConfigCache::load(cacheFile, &cachedOver)) out++;
+  if (cachedOver.serialize() != parsedOver.serialize()) out++;
+
+  // Several files in one.
+  const std::string extraFile = "cachetest1-extra.minvr";
+  writeFile(extraFile, "<MinVR><VRSetups><Node3><HostIP>10.1.1.1</HostIP>"
+            "<Extra linkNode=\"/MinVR/Defaults/Window\"/></Node3></VRSetups></MinVR>");
+  std::vector<std::string> both;
+  both.push_back(configFile);
+  both.push_back(extraFile);
+  const std::string bothFile = "cachetest1-both.cache";
+  MinVR::VRConfigCache::compile(both, bothFile);
+  if (MinVR::VRConfigCache::getSourceFiles(bothFile).size() != 2) out++;
+
+  MinVR::VRDataIndex parsedBoth, cachedBoth;
+  parsedBoth.processXMLFile(configFile, "/");
+  parsedBoth.processXMLFile(extraFile, "/");
+  if (!MinVR::VRConfigCache::load(bothFile, &cachedBoth)) out++;
+  if (cachedBoth.serialize() != parsedBoth.serialize()) out++;
+  if ((std::string)cachedBoth.getValue("/MinVR/VRSetups/Node3/HostIP") != "10.1.1.1") out++;
+
+  // How long a big one takes each way.  This is only informational.
+  writeFile(configFile, bigConfig(500));
+  MinVR::VRConfigCache::compile(std::vector<std::string>(1, configFile), cacheFile);
+
+  double t0 = MinVR::VRSystem::getTime();
+  MinVR::VRDataIndex parsedBig;
+  parsedBig.processXMLFile(configFile, "/");
+  double t1 = MinVR::VRSystem::getTime();
+  MinVR::VRDataIndex cachedBig;
+  if (!MinVR::VRConfigCache::load(cacheFile, &cachedBig)) out++;
+  double t2 = MinVR::VRSystem::getTime();
+
+  if (cachedBig.serialize() != parsedBig.serialize()) out++;
+  std::cout << "Loading " << cachedBig.findAllNames().size() << " entries, XML: "
+            << (t1 - t0) << "s, cache: " << (t2 - t1) << "s" << std::endl;
+
+  std::remove(configFile.c_str());
+  std::remove(cacheFile.c_str());
+  std::remove(extraFile.c_str());
+  std::remove(bothFile.c_str());
+
+  return out;
+}
+
+// A cache is passed over once its configuration changes.
+int testCacheOutOfDate() {
+
+  int out = 0;
+
+  const std::string configFile = "cachetest2.minvr";
+  const std::string cacheFile = MinVR::VRConfigCache::getCacheFileName(configFile);
+  writeFile(configFile, "<MinVR><Port>3490</Port></MinVR>");
+  MinVR::VRConfigCache::compile(std::vector<std::string>(1, configFile), cacheFile);
+
+  MinVR::VRDataIndex index;
+  if (!MinVR::VRConfigCache::load(cacheFile, &index)) out++;
+  if ((int)index.getValue("/MinVR/Port") != 3490) out++;
+
+  // Same size, different contents.
+  writeFile(configFile, "<MinVR><Port>3491</Port></MinVR>");
+  MinVR::VRDataIndex stale;
+  std::string whyNot;
+  if (MinVR::VRConfigCache::load(cacheFile, &stale, &whyNot)) out++;
+  if (whyNot.find("has changed") == std::string::npos) out++;
+  if (stale.exists("/MinVR/Port")) out++;
+
+  // Gone altogether.
+  std::remove(configFile.c_str());
+  whyNot = "";
+  if (MinVR::VRConfigCache::load(cacheFile, &stale, &whyNot)) out++;
+  if (whyNot.find("Cannot find") == std::string::npos) out++;
+
+  // Put back the way it was, it's good again.
+  writeFile(configFile, "<MinVR><Port>3490</Port></MinVR>");
+  if (!MinVR::VRConfigCache::load(cacheFile, &stale)) out++;
+
+  // Something that isn't a cache at all.
+  whyNot = "";
+  if (MinVR::VRConfigCache::load(configFile, &stale, &whyNot)) out++;
+  if (whyNot.find("not a configuration cache") == std::string::npos) out++;
+  if (MinVR::VRConfigCache::load("no-such-file.cache", &stale)) out++;
+
+  // A cache that has been cut short is passed over, like any other that
+  // can't be used.
+  std::ifstream in(cacheFile.c_str(), std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  in.close();
+  writeFile(cacheFile, contents.str().substr(0, contents.str().size() - 3));
+  whyNot = "";
+  if (MinVR::VRConfigCache::load(cacheFile, &stale, &whyNot)) out++;
+  if (whyNot.find("truncated") == std::string::npos) out++;
+  writeFile(cacheFile, contents.str().substr(0, 10));
+  whyNot = "";
+  if (MinVR::VRConfigCache::load(cacheFile, &stale, &whyNot)) out++;
+  if (whyNot.find("truncated") == std::string::npos) out++;
+
+  // So is one holding an index in some other version of the encoding.
+  MinVR::VRDataIndex untouched;
+  std::string otherVersion = contents.str();
+  size_t indexStart = otherVersion.find("MVRI");
+  if (indexStart == std::string::npos) out++;
+  otherVersion[indexStart + 4] = (char)(MinVR::VRDataIndex::binaryVersion + 1);
+  writeFile(cacheFile, otherVersion);
+  whyNot = "";
+  if (MinVR::VRConfigCache::load(cacheFile, &untouched, &whyNot)) out++;
+  if (whyNot.find("different version") == std::string::npos) out++;
+  if (untouched.exists("/MinVR/Port")) out++;
+
+  // And one whose index is damaged.
+  std::string damaged = contents.str();
+  for (size_t i = indexStart + 5; i < damaged.size(); i++) damaged[i] = (char)0xff;
+  writeFile(cacheFile, damaged);
+  whyNot = "";
+  if (MinVR::VRConfigCache::load(cacheFile, &untouched, &whyNot)) out++;
+  if (untouched.exists("/MinVR/Port")) out++;
+
+  // Even when it had something in it already.
+  untouched.addData("/MinVR/Other", 7);
+  std::string before = untouched.serialize();
+  if (MinVR::VRConfigCache::load(cacheFile, &untouched, &whyNot)) out++;
+  if (untouched.serialize() != before) out++;
+
+  std::remove(configFile.c_str());
+  std::remove(cacheFile.c_str());
+
+  return out;
+}
@@ -17,6 +17,7 @@ int testDatumStringArray();
 int testDatumPushPop();
 int testDatumContainer();
 int testDatumArrayConversions();
+int testDatumFixedArrays();
 
 // Mucks around with the attribute lists.
 int testDatumAttributes();
@@ -87,6 +88,10 @@ int datumtest(int argc, char* argv[]) {
     output = testDatumArrayConversions();
     break;
 
+  case 11:
+    output = testDatumFixedArrays();
+    break;
+
     // Add case statements to handle values of 2-->10
   default:
     std::cout << "Test #" << choice << " does not exist!\n";
@@ -756,3 +761,70 @@ int testDatumPushPop() {
 
   return out;
 }
+
+// The matrix and vector types, which keep their values in place.
+int testDatumFixedArrays() {
+
+  int out = 0;
+
+  LOOP {
+
+    MinVR::VRFloatMatrix4 m;
+    for (int i = 0; i < 16; i++) m[i] = (float)i;
+
+    MinVR::VRDatumMatrix4 a = MinVR::VRDatumMatrix4(m);
+    out += (a.getType() == MinVR::VRCORETYPE_MATRIX4) ? 0 : 1;
+    out += a.getDescription().compare("matrix4");
+
+    MinVR::VRFloatMatrix4 b = a.getValue();
+    out += (b == m) ? 0 : 1;
+    out += (a.getPointerMatrix4()->data()[5] == 5.0f) ? 0 : 1;
+    out += a.getValueString().compare("0.000000,1.000000,2.000000,3.000000,4.000000,5.000000,6.000000,7.000000,"
+                                      "8.000000,9.000000,10.000000,11.000000,12.000000,13.000000,14.000000,15.000000");
+
+    // It can be read as a float array, too.
+    MinVR::VRFloatArray c = a.getValue();
+    out += (c.size() == 16) ? 0 : 1;
+    out += (c[15] == 15.0f) ? 0 : 1;
+
+    a.push();
+    MinVR::VRFloatMatrix4 n = m;
+    n[0] = 100.0f;
+    a.setValue(n);
+    out += (a.getPointerMatrix4()->data()[0] == 100.0f) ? 0 : 1;
+    a.pop();
+    out += (a.getPointerMatrix4()->data()[0] == 0.0f) ? 0 : 1;
+
+    MinVR::VRFloatVec3 v;
+    v[0] = 1.5f;
+    v[1] = -2.0f;
+    v[2] = 0.25f;
+
+    MinVR::VRDatumVec3 d = MinVR::VRDatumVec3(v);
+    out += (d.getType() == MinVR::VRCORETYPE_VEC3) ? 0 : 1;
+    out += d.getDescription().compare("vec3");
+    out += d.getValueString().compare("1.500000,-2.000000,0.250000");
+
+    MinVR::VRFloatVec3 e = d.getValue();
+    out += (e == v) ? 0 : 1;
+
+    // A float array that is long enough can be read as either one.
+    MinVR::VRDatumFloatArray f = MinVR::VRDatumFloatArray(MinVR::VRFloatArray(16, 2.0f));
+    MinVR::VRFloatMatrix4 g = f.getValue();
+    out += (g[15] == 2.0f) ? 0 : 1;
+    MinVR::VRFloatVec3 h = f.getValue();
+    out += (h[2] == 2.0f) ? 0 : 1;
+
+    bool caught = false;
+    try {
+      MinVR::VRDatumFloatArray s = MinVR::VRDatumFloatArray(MinVR::VRFloatArray(2, 1.0f));
+      MinVR::VRFloatVec3 t = s.getValue();
+      out += (t[0] == 1.0f) ? 0 : 1;
+    } catch (MinVR::VRError &err) {
+      caught = true;
+    }
+    out += caught ? 0 : 1;
+  }
+
+  return out;
+}
@@ -1,5 +1,11 @@
 #include "config/VRDataIndex.h"
+#include "config/VRDataHandle.h"
+#include "config/VRDataQueue.h"
+#include "config/Cxml/Cxml.h"
+#include "math/VRMath.h"
 #include <main/VRConfig.h>
+#include <main/VRSystem.h>
+#include <stdexcept>
 
 // IMPORTANT NOTE: These tests need a better comparison operator.
 // They are largely using simple string comparisons to judge whether a
@@ -25,6 +31,14 @@ int testLinkContent();
 int testDepthOfCopy();
 int testIsChild();
 int testGetPointers();
+int testLookupSpeed();
+int testJournaledState();
+int testDataHandle();
+int testXMLParseSpeed();
+int testNumberFormats();
+int testCopyOnWrite();
+int testSelectSpeed();
+int testFixedArrays();
 
 // Make this a large number to get decent timing data.
 #define LOOP for (int loopctr = 0; loopctr < 1; loopctr++)
@@ -109,6 +123,38 @@ int indextest(int argc, char* argv[]) {
     output = testGetPointers();
     break;
 
+  case 17:
+    output = testLookupSpeed();
+    break;
+
+  case 18:
+    output = testJournaledState();
+    break;
+
+  case 19:
+    output = testDataHandle();
+    break;
+
+  case 20:
+    output = testXMLParseSpeed();
+    break;
+
+  case 21:
+    output = testNumberFormats();
+    break;
+
+  case 22:
+    output = testCopyOnWrite();
+    break;
+
+  case 23:
+    output = testSelectSpeed();
+    break;
+
+  case 24:
+    output = testFixedArrays();
+    break;
+
   default:
     std::cout << "Test #" << choice << " does not exist!\n";
     output = -1;
@@ -978,3 +1024,838 @@ int testIsChild() {
 
 
 
+
+// This is the inherited lookup the way the index used to do it, with an
+// ordered map and a new candidate string for each senior namespace.  It's
+// here as a baseline for testLookupSpeed().
+static int referenceLookup(const std::map<std::string, int> &m,
+                           const std::string &key,
+                           const std::string &nameSpace) {
+
+  std::vector<std::string> elems;
+  std::string elem;
+  std::stringstream ss(nameSpace);
+  while (std::getline(ss, elem, '/')) elems.push_back(elem);
+
+  for (int N = (int)elems.size(); N >= 0; --N) {
+    std::string testSpace;
+    for (int i = 0; i < N; i++) testSpace += elems[i] + "/";
+
+    std::map<std::string, int>::const_iterator it = m.find(testSpace + key);
+    if (it != m.end()) return it->second;
+  }
+  return -1;
+}
+
+// A microbenchmark of inherited lookups, in the pattern the display
+// nodes use: a deep namespace, with most of the values found near the
+// root.  It only fails if the answers are wrong; the timing is
+// informational.
+int testLookupSpeed() {
+
+  int out = 0;
+
+  MinVR::VRDataIndex n;
+  std::map<std::string, int> m;
+
+  std::string nameSpace = "/MinVR/Desktop/RootNode/WindowNode/StereoNode/ProjectionNode/";
+  std::vector<std::string> keys;
+  keys.push_back("NearClip");
+  keys.push_back("HeadMatrix");
+  keys.push_back("ViewportWidth");
+  keys.push_back("EyeSeparation");
+
+  // Fill up the index with some clutter, and then put the keys at
+  // different levels of the hierarchy.
+  for (int i = 0; i < 500; i++) {
+    std::stringstream name;
+    name << "/MinVR/Desktop/Clutter" << i % 10 << "/entry" << i;
+    n.addData(name.str(), i);
+    m[name.str()] = i;
+  }
+  n.addData("/NearClip", 1);                          m["/NearClip"] = 1;
+  n.addData("/MinVR/HeadMatrix", 2);                  m["/MinVR/HeadMatrix"] = 2;
+  n.addData("/MinVR/Desktop/RootNode/WindowNode/ViewportWidth", 3);
+  m["/MinVR/Desktop/RootNode/WindowNode/ViewportWidth"] = 3;
+  n.addData(nameSpace + "EyeSeparation", 4);          m[nameSpace + "EyeSeparation"] = 4;
+  // The index adds the containers for us; the map needs them spelled out.
+  m["/MinVR"] = 0;
+
+  int N = 100000;
+  long sum = 0, refSum = 0;
+
+  double t0 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    sum += (int)n.getValue(keys[i % keys.size()], nameSpace);
+  }
+  double t1 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    refSum += referenceLookup(m, keys[i % keys.size()], nameSpace);
+  }
+  double t2 = MinVR::VRSystem::getTime();
+
+  std::cout << N << " inherited lookups, hashed index: " << (t1 - t0)
+            << "s, ordered map: " << (t2 - t1) << "s, speedup: "
+            << ((t1 > t0) ? (t2 - t1) / (t1 - t0) : 0.0) << "x" << std::endl;
+
+  if (sum != refSum) out++;
+  if (sum != (long)N * 10 / 4) out++;
+
+  return out;
+}
+
+// Nested states, linked values, attributes, and the scope guard.  The
+// timing at the end is informational: a push and pop around a few
+// changes should cost the same no matter how big the index is.
+int testJournaledState() {
+
+  int out = 0;
+
+  LOOP {
+    MinVR::VRDataIndex *n = setupIndex();
+    n->linkNode("/george/a0", "/george/alias");
+    std::string original = n->serialize("/");
+
+    n->pushState();
+    n->addData("/george/a0", 100);
+    n->setAttributeValue("/john/c0", "color", "red");
+
+    n->pushState();
+    n->addData("/george/alias", 200);
+    n->addData("/george/new", 1);
+    n->addData("/ringo/drums", "yes");
+    if ((int)n->getValue("/george/a0") != 200) out++;
+    n->popState();
+
+    // The inner changes are gone, the outer ones are not.
+    if ((int)n->getValue("/george/a0") != 100) out++;
+    if ((int)n->getValue("/george/alias") != 100) out++;
+    if (n->exists("/george/new")) out++;
+    if (n->exists("/ringo")) out++;
+    if (n->getAttributeValue("/john/c0", "color") != "red") out++;
+
+    n->popState();
+
+    if (n->serialize("/").compare(original) != 0) out++;
+    if (n->hasAttribute("/john/c0", "color")) out++;
+
+    // Repeated frames reuse their saved values.
+    for (int i = 0; i < 100; i++) {
+      MinVR::VRDataIndexScope scope(n);
+      n->addData("/george/a1", i);
+      n->addData("/donna/d0", MinVR::VRFloatArray(3, (float)i));
+      n->addData("/Eye", "Left");
+      if ((int)n->getValue("/george/a1") != i) out++;
+    }
+    if (n->serialize("/").compare(original) != 0) out++;
+
+    // A value saved by an outer frame is saved again by an inner one, and
+    // is still known to be saved when the outer frame changes it again.
+    n->pushState();
+    n->addData("/george/a0", 1);
+    n->addData("/paul/fresh", 1);
+    n->pushState();
+    n->addData("/george/a0", 2);
+    n->addData("/paul/fresh", 2);
+    n->addData("/george/a0", 3);
+    n->popState();
+    if ((int)n->getValue("/george/a0") != 1) out++;
+    if ((int)n->getValue("/paul/fresh") != 1) out++;
+    n->addData("/george/a0", 4);
+    n->addData("/paul/fresh", 4);
+    n->popState();
+    if (n->serialize("/").compare(original) != 0) out++;
+
+    // A copy's frames don't confuse the original's.
+    n->pushState();
+    n->addData("/george/a0", 5);
+    {
+      MinVR::VRDataIndex copy(*n);
+      MinVR::VRDataIndexScope scope(&copy);
+      copy.addData("/george/a0", 6);
+    }
+    n->addData("/george/a0", 7);
+    n->popState();
+    if (n->serialize("/").compare(original) != 0) out++;
+
+    // Too many pops is an error.
+    try {
+      n->popState();
+      out++;
+    } catch (...) {}
+
+    // Except at the end of a scope, which can't throw, even while another
+    // error is leaving the block.
+    try {
+      MinVR::VRDataIndexScope scope(n);
+      n->popState();
+      throw std::runtime_error("leaving the scope");
+    } catch (std::runtime_error &) {}
+    if (n->serialize("/").compare(original) != 0) out++;
+
+    delete n;
+  }
+
+  MinVR::VRDataIndex big;
+  for (int i = 0; i < 10000; i++) {
+    std::stringstream name;
+    name << "/Clutter" << i % 10 << "/entry" << i;
+    big.addData(name.str(), i);
+  }
+  big.addData("/HeadMatrix", MinVR::VRFloatArray(16, 0.0f));
+
+  int N = 10000;
+  double t0 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    MinVR::VRDataIndexScope scope(&big);
+    big.addData("/HeadMatrix", MinVR::VRFloatArray(16, (float)i));
+    big.addData("/Eye", "Right");
+  }
+  double t1 = MinVR::VRSystem::getTime();
+
+  std::cout << N << " push/pop frames on a " << big.findAllNames().size()
+            << "-entry index: " << (t1 - t0) << "s" << std::endl;
+
+  MinVR::VRFloatArray head = big.getValue("/HeadMatrix");
+  if (head[15] != 0.0f) out++;
+  if (big.exists("/Eye")) out++;
+
+  return out;
+}
+
+// Handles should follow the index as it changes shape, and give the same
+// answers as getValue().  The timing is informational.
+int testDataHandle() {
+
+  int out = 0;
+
+  MinVR::VRDataIndex n;
+  n.addData("/MinVR/HeadMatrix", MinVR::VRFloatArray(16, 1.0f));
+  n.addData("/MinVR/Desktop/Window/Width", 640);
+  n.addData("/Scale", 2.5f);
+
+  MinVR::VRDataHandle head("HeadMatrix", "/MinVR/Desktop/Window/");
+  MinVR::VRDataHandle width("Width", "/MinVR/Desktop/Window/");
+  MinVR::VRDataHandle scale("/Scale");
+  MinVR::VRDataHandle eye("Eye", "/MinVR/Desktop/Window/");
+
+  const MinVR::VRFloatArray *h = head.getPointerFloatArray(n);
+  if ((h == NULL) || ((*h)[0] != 1.0f)) out++;
+  if (width.getValueInt(n) != 640) out++;
+  if (scale.getValueFloat(n) != 2.5f) out++;
+  if (eye.exists(n)) out++;
+  if (eye.getPointerString(n) != NULL) out++;
+
+  // A value changed in place is seen through the handle.
+  n.addData("/MinVR/Desktop/Window/Width", 800);
+  if (width.getValueInt(n) != 800) out++;
+
+  // A closer definition hides the inherited one.
+  n.addData("/MinVR/Desktop/HeadMatrix", MinVR::VRFloatArray(16, 2.0f));
+  h = head.getPointerFloatArray(n);
+  if ((h == NULL) || ((*h)[0] != 2.0f)) out++;
+
+  // Entries that come and go with a pushed state.
+  {
+    MinVR::VRDataIndexScope scope(&n);
+    n.addData("/MinVR/Desktop/Window/Eye", "Left");
+    const MinVR::VRString *e = eye.getPointerString(n);
+    if ((e == NULL) || (*e != "Left")) out++;
+    n.addData("/MinVR/Desktop/Window/Width", 1024);
+    if (width.getValueInt(n) != 1024) out++;
+  }
+  if (eye.exists(n)) out++;
+  if (width.getValueInt(n) != 800) out++;
+
+  // A frame that adds other names and changes this one in place leaves
+  // the handle as it was, without another lookup.
+  h = head.getPointerFloatArray(n);
+  int lookups = head.getNumLookups();
+  for (int i = 0; i < 10; i++) {
+    MinVR::VRDataIndexScope scope(&n);
+    n.addData("/MinVR/Desktop/Window/Eye", "Right");
+    n.addData("/MinVR/Desktop/HeadMatrix", MinVR::VRFloatArray(16, (float)i));
+    const MinVR::VRFloatArray *hi = head.getPointerFloatArray(n);
+    if ((hi != h) || ((*hi)[0] != (float)i)) out++;
+  }
+  h = head.getPointerFloatArray(n);
+  if ((h == NULL) || ((*h)[0] != 2.0f)) out++;
+  if (head.getNumLookups() != lookups) {
+    std::cout << "The handle looked up its name " << head.getNumLookups() - lookups
+              << " times across the frames." << std::endl;
+    out++;
+  }
+
+  // A link points the name at a different datum.
+  n.linkNode("/Scale", "/MinVR/Desktop/Window/Width");
+  if (width.getValueFloat(n) != 2.5f) out++;
+
+  // Missing names throw when a value is required.
+  try {
+    eye.getValueInt(n);
+    out++;
+  } catch (...) {}
+
+  // The same handle works on another index.
+  MinVR::VRDataIndex m;
+  m.addData("/MinVR/Desktop/Window/Width", 3);
+  if (width.getValueInt(m) != 3) out++;
+  if (width.getValueFloat(n) != 2.5f) out++;
+
+  int N = 100000;
+  long sum = 0, refSum = 0;
+  MinVR::VRDataHandle w("Width", "/MinVR/Desktop/Window/");
+  double t0 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    sum += w.getValueInt(m);
+  }
+  double t1 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    refSum += (int)m.getValue("Width", "/MinVR/Desktop/Window/");
+  }
+  double t2 = MinVR::VRSystem::getTime();
+
+  std::cout << N << " reads, handle: " << (t1 - t0) << "s, getValue: "
+            << (t2 - t1) << "s" << std::endl;
+
+  if (sum != refSum) out++;
+
+  return out;
+}
+
+// Counts what the parser finds, and nothing else, to time the parser
+// alone.
+class CountingHandler : public MinVR::VRXMLHandler {
+public:
+  CountingHandler() : elements(0), attributes(0), textBytes(0) {};
+  void startElement(const MinVR::VRXMLSpan &name,
+                    const MinVR::VRXMLAttributeList &attrs) {
+    elements++;
+    attributes += attrs.size();
+  };
+  void text(const MinVR::VRXMLSpan &text) { textBytes += text.size(); };
+  void endElement(const MinVR::VRXMLSpan &name) {};
+
+  int elements, attributes;
+  size_t textBytes;
+};
+
+// Parses the same text with Cxml and with the streaming parser, and
+// reports the throughput of each.  Then the same for a whole index.
+static void timeXMLParse(const std::string &label, const std::string &xml, const int N) {
+
+  double t0 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    MinVR::Cxml cxml;
+    cxml.parse_string(xml);
+  }
+  double t1 = MinVR::VRSystem::getTime();
+  MinVR::VRXMLParser parser;
+  for (int i = 0; i < N; i++) {
+    CountingHandler counter;
+    parser.parse(xml, &counter);
+  }
+  double t2 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    MinVR::VRDataIndex index;
+    index.addSerializedValue(xml);
+  }
+  double t3 = MinVR::VRSystem::getTime();
+
+  double mb = (double)xml.size() * N / 1e6;
+  std::cout << label << ", " << N << " x " << xml.size() << " bytes: Cxml "
+            << ((t1 > t0) ? mb / (t1 - t0) : 0.0) << " MB/s, streaming parser "
+            << ((t2 > t1) ? mb / (t2 - t1) : 0.0) << " MB/s, into an index "
+            << ((t3 > t2) ? mb / (t3 - t2) : 0.0) << " MB/s" << std::endl;
+}
+
+// The streaming parser should read what Cxml read, plus a few things
+// Cxml could not.  The timing is informational.
+int testXMLParseSpeed() {
+
+  int out = 0;
+
+  std::ifstream file(MINVR_BUILD_PREFIX "/tests-batch/config/test.xml");
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string config = buffer.str();
+
+  CountingHandler counter;
+  MinVR::VRXMLParser parser;
+  parser.parse(config, &counter);
+  if (counter.elements != 72) out++;
+
+  // The <?xml ... ?> line is skipped, not entered as an element.
+  MinVR::VRDataIndex n;
+  n.addSerializedValue(config);
+  if (n.exists("/xml")) out++;
+  if ((int)n.getValue("/MVR/Server/NumClients") != 1) out++;
+  if (n.getType("/MVR/VRPlugins/MinVRDefaultPlugins/Names") !=
+      MinVR::VRCORETYPE_STRINGARRAY) out++;
+  if (n.getAttributeValue("/MVR/VRDisplayDevices/ThreadedDisplay/Display1/displayType",
+                          "val") != "heavy") out++;
+
+  // Comments, CDATA, and a singleton with attributes.
+  MinVR::VRDataIndex m("<MVR><!-- <a>1</a> --><b type=\"string\"><![CDATA[x<y>z]]></b>"
+                       "<c alpha='1' beta=\"two\"/></MVR>");
+  if (m.exists("/a")) out++;
+  if ((std::string)m.getValue("/b") != "x<y>z") out++;
+  if (m.getAttributeValue("/c", "beta") != "two") out++;
+
+  // A mismatched close tag is an error.
+  try {
+    MinVR::VRDataIndex bad("<MVR><a>1</b></MVR>");
+    out++;
+  } catch (MinVR::VRError &e) {}
+
+  // A queue of events like the ones trackers produce.
+  MinVR::VRDataQueue q;
+  for (int i = 0; i < 100; i++) {
+    std::stringstream name;
+    name << "Tracker" << i % 8 << "_Move";
+    MinVR::VRDataIndex e(name.str());
+    e.addData("EventType", "TrackerMove");
+    e.addData("Transform", MinVR::VRFloatArray(16, 0.5f * i));
+    e.addData("Buttons", i);
+    q.push(e);
+
+    // Each event comes back out the same.
+    std::string serialized = e.serialize();
+    if (MinVR::VRDataIndex(serialized).serialize() != serialized) out++;
+  }
+  std::string events = q.serialize();
+
+  timeXMLParse("test.xml", config, 2000);
+  timeXMLParse("event queue", events, 20);
+
+  return out;
+}
+
+// Floats written with format="exact" or format="base64" should come back
+// bit for bit.  The timing at the end is informational.
+int testNumberFormats() {
+
+  int out = 0;
+
+  MinVR::VRFloatArray m;
+  for (int i = 0; i < 16; i++) m.push_back(3.1415926f / (i + 1) - 0.0001f * i * i);
+  m.push_back(1.0e-7f);
+  m.push_back(-12345678.0f);
+  m.push_back(0.1f);
+  MinVR::VRIntArray ia;
+  ia.push_back(-2147483647 - 1);
+  ia.push_back(0);
+  ia.push_back(2147483647);
+
+  MinVR::VRDataIndex n;
+  n.addData("/plain", m);
+  n.addData("/exact", m);
+  n.setAttributeValue("/exact", "format", "exact");
+  n.addData("/packed", m);
+  n.setAttributeValue("/packed", "format", "base64");
+  n.addData("/packedInts", ia);
+  n.setAttributeValue("/packedInts", "format", "base64");
+  n.addData("/pi", 3.1415926f);
+  n.setAttributeValue("/pi", "format", "exact");
+
+  MinVR::VRDataIndex copy(n.serialize());
+
+  // The default is still six decimal places, so this one is close, but
+  // not the same.
+  MinVR::VRFloatArray plain = copy.getValue("/plain");
+  if (plain.size() != m.size()) out++;
+  if (plain[0] == m[0]) out++;
+  if ((plain[0] - m[0] > 0.000001f) || (m[0] - plain[0] > 0.000001f)) out++;
+
+  MinVR::VRFloatArray exact = copy.getValue("/exact");
+  MinVR::VRFloatArray packed = copy.getValue("/packed");
+  if ((exact != m) || (packed != m)) out++;
+  MinVR::VRIntArray packedInts = copy.getValue("/packedInts");
+  if (packedInts != ia) out++;
+  if ((float)copy.getValue("/pi") != 3.1415926f) out++;
+  if (copy.getAttributeValue("/packed", "format") != "base64") out++;
+
+  std::cout << n.serialize("/exact") << std::endl;
+  std::cout << n.serialize("/packed") << std::endl;
+
+  // Base64 data may be broken into lines.
+  MinVR::VRDatumFloatArray packedDatum(m);
+  packedDatum.setAttributeValue("format", "base64");
+  std::string packedValue = packedDatum.getValueString();
+  MinVR::VRDataIndex wrapped;
+  wrapped.addSerializedValue("<packed type=\"floatarray\" format=\"base64\">\n" +
+                             packedValue.substr(0, 20) + "\n  " + packedValue.substr(20) +
+                             "\n</packed>");
+  packed = wrapped.getValue("/packed");
+  if (packed != m) out++;
+
+  // A tracker event's worth of matrices, as text, compared to the
+  // streams this used to use.
+  MinVR::VRFloatArray head(16);
+  for (int i = 0; i < 16; i++) head[i] = 0.123456f * i - 0.5f;
+  std::string text = MinVR::VRDatumFloatArray(head).getValueString();
+
+  int N = 20000;
+  float sum = 0.0f, refSum = 0.0f;
+  double t0 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    MinVR::VRFloatArray f = MinVR::VRNumberCodec::parseFloatArray(text, MINVRSEPARATOR,
+                                                                  MinVR::VRNumberCodec::FORMAT_DEFAULT);
+    sum += f[i % 16];
+  }
+  double t1 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    MinVR::VRFloatArray f;
+    std::string elem;
+    std::stringstream ss(text);
+    while (std::getline(ss, elem, MINVRSEPARATOR)) {
+      float v;
+      std::istringstream stream(elem);
+      stream >> v;
+      f.push_back(v);
+    }
+    refSum += f[i % 16];
+  }
+  double t2 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    std::string s = MinVR::VRDatumFloatArray(head).getValueString();
+  }
+  double t3 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    std::string s;
+    char buffer[20];
+    for (int j = 0; j < 16; j++) {
+      sprintf(buffer, "%f%c", head[j], MINVRSEPARATOR);
+      s += std::string(buffer);
+    }
+  }
+  double t4 = MinVR::VRSystem::getTime();
+
+  std::cout << N << " 4x4 matrices, parse: " << (t1 - t0) << "s (streams: "
+            << (t2 - t1) << "s), format: " << (t3 - t2) << "s (sprintf: "
+            << (t4 - t3) << "s)" << std::endl;
+
+  if (sum != refSum) out++;
+
+  return out;
+}
+
+// Copies share their data until one of them changes something.  Check
+// that a change on either side is never seen on the other.
+int testCopyOnWrite() {
+
+  int out = 0;
+
+  MinVR::VRDataIndex event;
+  for (int i = 0; i < 48; i++) {
+    char name[32];
+    sprintf(name, "/Tracker/Value%02d", i);
+    event.addData(name, i);
+  }
+  event.addData("/Tracker/Pose", MinVR::VRFloatArray(16, 1.0f));
+  event.addData("/Tracker/Twin", 7);
+  event.linkNode("/Tracker/Twin", "/Tracker/Alias");
+
+  MinVR::VRDataIndex copy(event);
+  if (copy.serialize() != event.serialize()) out++;
+
+  // Change the copy, then look at the original.
+  copy.addData("/Tracker/Value00", 100);
+  copy.addData("/Tracker/New", 1);
+  copy.setAttributeValue("/Tracker/Pose", "format", "exact");
+  if ((int)event.getValue("/Tracker/Value00") != 0) out++;
+  if ((int)copy.getValue("/Tracker/Value00") != 100) out++;
+  if (event.exists("/Tracker/New")) out++;
+  if (event.getAttributeValue("/Tracker/Pose", "format") != "") out++;
+
+  // Links survive the copy: the two names are still one datum, in the
+  // copy and in the original, but not across them.
+  copy.addData("/Tracker/Twin", 8);
+  if ((int)copy.getValue("/Tracker/Alias") != 8) out++;
+  if ((int)event.getValue("/Tracker/Alias") != 7) out++;
+  event.addData("/Tracker/Alias", 9);
+  if ((int)event.getValue("/Tracker/Twin") != 9) out++;
+  if ((int)copy.getValue("/Tracker/Twin") != 8) out++;
+
+  // Now the other way around, with an assignment.
+  MinVR::VRDataIndex assigned;
+  assigned = event;
+  event.addData("/Tracker/Value01", 101);
+  event.linkNode("/Tracker/Pose", "/Tracker/OtherPose");
+  if ((int)assigned.getValue("/Tracker/Value01") != 1) out++;
+  if (assigned.exists("/Tracker/OtherPose")) out++;
+
+  // A handle that found something in the original finds the right
+  // thing after a copy, and after the copy goes its own way.
+  MinVR::VRDataHandle value("Value02", "/Tracker/");
+  if (value.getValueInt(event) != 2) out++;
+  MinVR::VRDataIndex another(event);
+  if (value.getValueInt(another) != 2) out++;
+  another.addData("/Tracker/Value02", 102);
+  if (value.getValueInt(another) != 102) out++;
+  if (value.getValueInt(event) != 2) out++;
+
+  // A copy made with pushed changes outstanding is not disturbed by
+  // popping them from the original.
+  event.pushState();
+  event.addData("/Tracker/Value03", 103);
+  event.addData("/Tracker/Pushed", 1);
+  MinVR::VRDataIndex pushed(event);
+  event.popState();
+  if ((int)event.getValue("/Tracker/Value03") != 3) out++;
+  if (event.exists("/Tracker/Pushed")) out++;
+  if ((int)pushed.getValue("/Tracker/Value03") != 103) out++;
+  if (!pushed.exists("/Tracker/Pushed")) out++;
+
+  // And a copy made after a push, with nothing changed yet.
+  event.pushState();
+  MinVR::VRDataIndex early(event);
+  event.addData("/Tracker/Value04", 104);
+  event.popState();
+  if ((int)early.getValue("/Tracker/Value04") != 4) out++;
+  if ((int)event.getValue("/Tracker/Value04") != 4) out++;
+
+  // Copying an event no longer depends on its size.
+  int N = 20000;
+  double t0 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    MinVR::VRDataIndex c(event);
+    if (c.empty()) out++;
+  }
+  double t1 = MinVR::VRSystem::getTime();
+  std::cout << "copy a " << event.findAllNames().size() << "-entry index: "
+            << 1.0e6 * (t1 - t0) / N << " us" << std::endl;
+
+  return out;
+}
+
+// This is the select the way the index used to do it, looking at every
+// entry.  It's here as a check on the select index, and a baseline for
+// testSelectSpeed().
+static MinVR::VRContainer referenceSelect(const MinVR::VRDataIndex &n,
+                                          const std::string &attrName,
+                                          const std::string &attrVal,
+                                          const std::string &nameSpace,
+                                          const bool childOnly) {
+
+  MinVR::VRContainer out;
+  std::list<std::string> names = n.findAllNames();
+  for (std::list<std::string>::iterator it = names.begin(); it != names.end(); it++) {
+    if ((it->compare(0, nameSpace.size(), nameSpace) != 0) ||
+        (it->size() == nameSpace.size())) continue;
+    if (childOnly && (it->find('/', nameSpace.size()) != std::string::npos)) continue;
+    if (attrName.empty()) {
+      if (n.getType(*it) == MinVR::VRCORETYPE_STRING) out.push_back(*it);
+    } else if (n.hasAttribute(*it, attrName) &&
+               ((attrVal == "*") || (n.getAttributeValue(*it, attrName) == attrVal))) {
+      out.push_back(*it);
+    }
+  }
+  return out;
+}
+
+// Counts the selections that don't agree with the reference.
+static int checkSelections(const MinVR::VRDataIndex &n) {
+
+  int out = 0;
+  if (n.selectByAttribute("hostType", "*") != referenceSelect(n, "hostType", "*", "/", false)) out++;
+  if (n.selectByAttribute("displaynodeType", "VRGraphicsWindowNode", "/MinVR/VRSetups/Setup7") !=
+      referenceSelect(n, "displaynodeType", "VRGraphicsWindowNode", "/MinVR/VRSetups/Setup7/", false)) out++;
+  if (n.selectByAttribute("displaynodeType", "*", "/MinVR/VRSetups/Setup7", true) !=
+      referenceSelect(n, "displaynodeType", "*", "/MinVR/VRSetups/Setup7/", true)) out++;
+  if (n.selectByAttribute("inputdeviceType", "*", "/MinVR/VRSetups/Setup1") !=
+      referenceSelect(n, "inputdeviceType", "*", "/MinVR/VRSetups/Setup1/", false)) out++;
+  if (n.selectByType(MinVR::VRCORETYPE_STRING, "/MinVR/VRSetups/Setup3") !=
+      referenceSelect(n, "", "", "/MinVR/VRSetups/Setup3/", false)) out++;
+  return out;
+}
+
+// The select methods answer from an index of attributes and types, which
+// has to keep up as the data index changes.  The timing is informational:
+// a select against a big configuration, through the index, and the old
+// way.
+int testSelectSpeed() {
+
+  int out = 0;
+
+  // A site configuration, with a lot of setups.
+  std::stringstream config;
+  config << "<MinVR><VRSetups>";
+  for (int setup = 0; setup < 200; setup++) {
+    config << "<Setup" << setup << " hostType=\"VRStandAlone\">"
+           << "<RootNode displaynodeType=\"VRGraphicsWindowNode\">";
+    for (int window = 0; window < 4; window++) {
+      config << "<Window" << window << " displaynodeType=\"VRGraphicsWindowNode\">"
+             << "<XPos>" << 100 * window << "</XPos><YPos>0</YPos>"
+             << "<Width>640</Width><Height>480</Height><Caption>Window</Caption>"
+             << "<Stereo displaynodeType=\"VRStereoNode\"><EyeSeparation>0.2</EyeSeparation>"
+             << "<StereoFormat>Mono</StereoFormat></Stereo>"
+             << "</Window" << window << ">";
+    }
+    config << "</RootNode><Wand inputdeviceType=\"VRFakeTrackerDevice\">"
+           << "<TrackerName>Wand</TrackerName></Wand>"
+           << "</Setup" << setup << ">";
+  }
+  config << "</VRSetups></MinVR>";
+
+  MinVR::VRDataIndex n;
+  n.addSerializedValue(config.str());
+  if (n.selectByAttribute("hostType", "*").size() != 200) out++;
+  if (n.selectByAttribute("displaynodeType", "VRStereoNode", "/MinVR/VRSetups/Setup9").size() != 4) out++;
+  out += checkSelections(n);
+
+  // Changes after the index is made.
+  n.addSerializedValue("<Setup7><Extra displaynodeType=\"VRStereoNode\">1</Extra>"
+                       "<Label>x</Label></Setup7>", "/MinVR/VRSetups");
+  n.setAttributeValue("/MinVR/VRSetups/Setup7/RootNode/Window1", "displaynodeType", "VRTileNode");
+  n.setAttributeValue("/MinVR/VRSetups/Setup1/RootNode/Window2/XPos", "inputdeviceType", "VRPN");
+  if (n.selectByAttribute("displaynodeType", "VRTileNode").size() != 1) out++;
+  out += checkSelections(n);
+
+  // Pushed and popped.
+  n.pushState();
+  n.addData("/MinVR/VRSetups/Setup3/Notes", std::string("pushed"));
+  n.setAttributeValue("/MinVR/VRSetups/Setup7/RootNode/Window3", "displaynodeType", "VRTileNode");
+  out += checkSelections(n);
+  n.popState();
+  if (n.exists("/MinVR/VRSetups/Setup3/Notes")) out++;
+  if (n.selectByAttribute("displaynodeType", "VRTileNode").size() != 1) out++;
+  out += checkSelections(n);
+
+  // Links share attributes.
+  n.linkNode("/MinVR/VRSetups/Setup1/Wand", "/MinVR/VRSetups/Setup7/Wand2");
+  out += checkSelections(n);
+  n.setAttributeValue("/MinVR/VRSetups/Setup1/Wand", "inputdeviceType", "VRVRPNTrackerDevice");
+  if (n.selectByAttribute("inputdeviceType", "VRVRPNTrackerDevice").size() != 2) out++;
+  out += checkSelections(n);
+
+  // And a copy has its own.
+  MinVR::VRDataIndex copy(n);
+  copy.addSerializedValue("<Setup7><More displaynodeType=\"VRStereoNode\">1</More></Setup7>",
+                          "/MinVR/VRSetups");
+  out += checkSelections(copy);
+  if (n.selectByAttribute("displaynodeType", "VRStereoNode", "/MinVR/VRSetups/Setup7").size() + 1 !=
+      copy.selectByAttribute("displaynodeType", "VRStereoNode", "/MinVR/VRSetups/Setup7").size()) out++;
+
+  // The way VRMain looks for things at startup.
+  int N = 50;
+  size_t found = 0, refFound = 0;
+  double t0 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    std::stringstream setup;
+    setup << "/MinVR/VRSetups/Setup" << i;
+    found += n.selectByAttribute("displaynodeType", "*", setup.str(), true).size();
+    found += n.selectByAttribute("inputdeviceType", "*", setup.str()).size();
+  }
+  double t1 = MinVR::VRSystem::getTime();
+  for (int i = 0; i < N; i++) {
+    std::stringstream setup;
+    setup << "/MinVR/VRSetups/Setup" << i << "/";
+    refFound += referenceSelect(n, "displaynodeType", "*", setup.str(), true).size();
+    refFound += referenceSelect(n, "inputdeviceType", "*", setup.str(), false).size();
+  }
+  double t2 = MinVR::VRSystem::getTime();
+
+  std::cout << 2 * N << " selects in a " << n.findAllNames().size()
+            << "-entry index, select index: " << (t1 - t0) << "s, scanning: "
+            << (t2 - t1) << "s, speedup: "
+            << ((t1 > t0) ? (t2 - t1) / (t1 - t0) : 0.0) << "x" << std::endl;
+  if (found != refFound) out++;
+
+  return out;
+}
+
+// Matrices and vectors go in and out of the index as themselves, and
+// still look like float arrays to anything that expects one.
+int testFixedArrays() {
+
+  int out = 0;
+
+  MinVR::VRMatrix4 pose = MinVR::VRMatrix4::translation(MinVR::VRVector3(1, 2, 3)) *
+    MinVR::VRMatrix4::rotationY(0.5f);
+  MinVR::VRVector3 heading(0.0f, 0.5f, -1.0f);
+  MinVR::VRPoint3 origin(4.0f, 5.0f, 6.0f);
+
+  MinVR::VRDataIndex n;
+  n.addData("/Tracker/Pose", pose);
+  n.addData("/Tracker/Heading", heading);
+  n.addData("/Tracker/Origin", origin);
+
+  if (n.getType("/Tracker/Pose") != MinVR::VRCORETYPE_MATRIX4) out++;
+  if (n.getType("/Tracker/Heading") != MinVR::VRCORETYPE_VEC3) out++;
+  if (n.getType("/Tracker/Origin") != MinVR::VRCORETYPE_VEC3) out++;
+
+  MinVR::VRMatrix4 pose2 = n.getValue("/Tracker/Pose");
+  if (pose2 != pose) out++;
+  MinVR::VRVector3 heading2 = n.getValue("/Tracker/Heading");
+  if (heading2 != heading) out++;
+  MinVR::VRPoint3 origin2 = n.getValue("/Tracker/Origin");
+  if (origin2 != origin) out++;
+
+  // Readers of float arrays see the same numbers.
+  MinVR::VRFloatArray poseArray = n.getValue("/Tracker/Pose");
+  if ((poseArray.size() != 16) || (poseArray[12] != pose.getArray()[12])) out++;
+
+  MinVR::VRDataHandle poseHandle("/Tracker/Pose");
+  int size = 0;
+  const float *floats = poseHandle.getPointerFloats(n, &size);
+  if ((floats == NULL) || (size != 16) || (floats[13] != pose.getArray()[13])) out++;
+  if (poseHandle.getPointerMatrix4(n) == NULL) out++;
+
+  // Both serializations keep the types.
+  MinVR::VRDataIndex fromText;
+  fromText.addSerializedValue(n.serialize("/Tracker"));
+  if (fromText.getType("/Tracker/Pose") != MinVR::VRCORETYPE_MATRIX4) out++;
+  if (fromText.serialize() != n.serialize()) out++;
+
+  MinVR::VRDataIndex fromBinary;
+  fromBinary.addSerializedBinary(n.serializeBinary());
+  if (fromBinary.getType("/Tracker/Heading") != MinVR::VRCORETYPE_VEC3) out++;
+  MinVR::VRMatrix4 pose3 = fromBinary.getValue("/Tracker/Pose");
+  if (pose3 != pose) out++;
+
+  // The state is journaled the same as anything else.
+  n.pushState();
+  n.addData("/Tracker/Pose", MinVR::VRMatrix4::scale(MinVR::VRVector3(2, 2, 2)));
+  MinVR::VRMatrix4 scaled = n.getValue("/Tracker/Pose");
+  if (scaled.getArray()[0] != 2.0f) out++;
+  n.popState();
+  MinVR::VRMatrix4 restored = n.getValue("/Tracker/Pose");
+  if (restored != pose) out++;
+
+  // In XML, the type has to be given; sixteen numbers alone are an array.
+  MinVR::VRDataIndex x;
+  x.addSerializedValue("<Config>"
+                       "<Typed type=\"matrix4\">1,0,0,0,0,1,0,0,0,0,1,0,7,8,9,1</Typed>"
+                       "<Untyped>1.0,0,0,0,0,1.0,0,0,0,0,1.0,0,7.0,8.0,9.0,1.0</Untyped>"
+                       "<Eye type=\"vec3\">0.0, 1.5, 0.0</Eye>"
+                       "</Config>");
+  if (x.getType("/Config/Typed") != MinVR::VRCORETYPE_MATRIX4) out++;
+  if (x.getType("/Config/Untyped") != MinVR::VRCORETYPE_FLOATARRAY) out++;
+  if (x.getType("/Config/Eye") != MinVR::VRCORETYPE_VEC3) out++;
+  MinVR::VRMatrix4 typed = x.getValue("/Config/Typed");
+  MinVR::VRMatrix4 untyped = x.getValue("/Config/Untyped");
+  if ((typed != untyped) || (typed.getArray()[12] != 7.0f)) out++;
+  MinVR::VRVector3 eye = x.getValue("/Config/Eye");
+  if (eye[1] != 1.5f) out++;
+
+  // A matrix stored over an array stays an array, and an array of the
+  // right size stored over a matrix becomes a matrix.
+  x.addData("/Config/Untyped", pose);
+  if (x.getType("/Config/Untyped") != MinVR::VRCORETYPE_FLOATARRAY) out++;
+  x.addData("/Config/Typed", MinVR::VRFloatArray(16, 3.0f));
+  if (x.getType("/Config/Typed") != MinVR::VRCORETYPE_MATRIX4) out++;
+  MinVR::VRMatrix4 threes = x.getValue("/Config/Typed");
+  if (threes.getArray()[10] != 3.0f) out++;
+
+  // The wrong number of values is an error.
+  bool caught = false;
+  try {
+    x.addSerializedValue("<Short type=\"vec3\">1.0, 2.0</Short>");
+  } catch (MinVR::VRError &e) {
+    caught = true;
+  }
+  if (!caught) out++;
+
+  return out;
+}
@@ -8,6 +8,8 @@ int TestQueueMultipleTimeStamps();
 int TestQueueIterator();
 int TestAddQueue();
 int TestAddQueueSerialized();
+int TestQueueBinaryRoundTrip();
+int TestQueueRingBuffer();
 
 int queuetest(int argc, char* argv[]) {
 
@@ -49,6 +51,14 @@ int queuetest(int argc, char* argv[]) {
     output = TestAddQueueSerialized();
     break;
 
+  case 7:
+    output = TestQueueBinaryRoundTrip();
+    break;
+
+  case 8:
+    output = TestQueueRingBuffer();
+    break;
+
     // Add case statements to handle other values.
   default:
     std::cout << "Test #" << choice << " does not exist!\n";
@@ -415,3 +425,130 @@ int TestQueueMultipleTimeStamps() {
 
   return out;
 }
+
+// Sends an index and a mixed queue through the binary encoding and back,
+// and checks that nothing changed along the way.
+int TestQueueBinaryRoundTrip() {
+
+  int out = 0;
+
+  MinVR::VRDataIndex *n = setupQIndex();
+
+  // A float that does not survive a trip through "%f".
+  MinVR::VRFloat odd = 1.0f / 3.0f;
+  n->addData("/donna/odd", odd);
+  n->setAttributeValue("/donna/odd", "units", "furlongs");
+
+  // The index by itself.
+  std::string binaryIndex = n->serializeBinary();
+  if (!MinVR::VRDataIndex::isBinary(binaryIndex)) out++;
+  MinVR::VRDataIndex m(binaryIndex);
+
+  out += n->serialize().compare(m.serialize());
+  out += n->getName().compare(m.getName());
+  if ((MinVR::VRFloat)m.getValue("/donna/odd") != odd) out++;
+  out += std::string("furlongs").compare(m.getAttributeValue("/donna/odd", "units"));
+
+  // A queue with a raw event, an XML-serialized event, and a
+  // binary-serialized event, some of them sharing a time stamp.
+  MinVR::VRDataQueue q;
+  MinVR::VRRawEvent e("ENAME");
+  e.addData("testInt", 7);
+  e.addData("testFloat", odd);
+
+  q.push((long long)1484015499734567, MinVR::VRDataQueueItem(&e));
+  q.push((long long)1484015499734567, n->serialize("/george"));
+  q.push((long long)1484015499734570, binaryIndex);
+
+  std::string binaryQueue = q.serializeBinary();
+  if (!MinVR::VRDataQueue::isBinary(binaryQueue)) out++;
+
+  MinVR::VRDataQueue r(binaryQueue);
+
+  std::cout << "queue:" << r.serialize() << std::endl;
+
+  // The XML versions should match exactly, time stamps and all.
+  out += q.serialize().compare(r.serialize());
+
+  // Binary and XML queues can be added to each other.
+  MinVR::VRDataQueue s(q.serialize());
+  s.addQueue(r);
+  if (s.size() != 6) out++;
+
+  if ((MinVR::VRFloat)r.getFirst().getValue("testFloat") != odd) out++;
+
+  delete n;
+
+  return out;
+}
+
+// Exercises the ring buffer: many frames of pushes and pops so the items
+// wrap around, out-of-order and tied time stamps, and merging.
+int TestQueueRingBuffer() {
+
+  int out = 0;
+
+  MinVR::VRDataQueue q;
+  long long t = 1000;
+  for (int frame = 0; frame < 50; frame++) {
+    for (int i = 0; i < 7; i++) {
+      MinVR::VRDataIndex e("E");
+      e.addData("n", i);
+      q.push(t + i, e);
+    }
+    // One that belongs in the middle.
+    MinVR::VRDataIndex late("E");
+    late.addData("n", 100);
+    q.push(t + 3, late);
+
+    // Drain most of the queue, leaving a couple behind, so the items
+    // wrap around the end of the buffer.  Those come out first next time.
+    int expected[] = { 5, 6, 0, 1, 2, 3, 100, 4 };
+    int j = (frame == 0) ? 2 : 0;
+    while (q.size() > 2) {
+      if ((int)q.getFirst().getValue("n") != expected[j++]) out++;
+      q.pop();
+    }
+    t += 10;
+  }
+  q.clear();
+  if (q.notEmpty()) out++;
+
+  // Equal time values are numbered in the order they were pushed.
+  q.push(5, "<a type=\"int\">1</a>");
+  q.push(5, "<b type=\"int\">2</b>");
+  q.push(7, "<c type=\"int\">3</c>");
+
+  MinVR::VRDataQueue r;
+  r.push(5, "<d type=\"int\">4</d>");
+  r.push(6, "<e type=\"int\">5</e>");
+
+  q.addQueue(r);
+
+  std::string expectedString = "<VRDataQueue num=\"5\">"
+    "<VRDataQueueItem timeStamp=\"5-000\"><a type=\"int\">1</a></VRDataQueueItem>"
+    "<VRDataQueueItem timeStamp=\"5-001\"><b type=\"int\">2</b></VRDataQueueItem>"
+    "<VRDataQueueItem timeStamp=\"5-002\"><d type=\"int\">4</d></VRDataQueueItem>"
+    "<VRDataQueueItem timeStamp=\"6-000\"><e type=\"int\">5</e></VRDataQueueItem>"
+    "<VRDataQueueItem timeStamp=\"7-000\"><c type=\"int\">3</c></VRDataQueueItem>"
+    "</VRDataQueue>";
+  out += expectedString.compare(q.serialize());
+
+  // Merging serialized data gives the same result.
+  MinVR::VRDataQueue s;
+  s.push(5, "<a type=\"int\">1</a>");
+  s.push(5, "<b type=\"int\">2</b>");
+  s.push(7, "<c type=\"int\">3</c>");
+  s.addSerializedQueue(r.serialize());
+  out += expectedString.compare(s.serialize());
+
+  // Local time stamps never go backward.
+  long long last = q.makeTimeStamp();
+  for (int i = 0; i < 1000; i++) {
+    long long now = q.makeTimeStamp();
+    if (now < last) out++;
+    last = now;
+  }
+
+  return out;
+}
@@ -0,0 +1,374 @@
+#include <sstream>
+#include "config/VRDataIndex.h"
+#include "config/VRDataQueue.h"
+#include <main/VREventHandler.h>
+#include <main/VREventDispatcher.h>
+#include <main/VRSystem.h>
+#include <main/VRConfig.h>
+
+// These exercise the event delivery loop in
+// VRMain::synchronizeAndProcessEvents(): one event at a time comes off the
+// front of a queue and is handed to every registered handler, or, with
+// VREventDispatcher, to the handlers that subscribed to its name.
+
+int testDispatchSharesEvent();
+int testDispatchSpeed();
+int testDispatchSubscriptions();
+int testSubscribedDispatchSpeed();
+
+int dispatchtest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testDispatchSharesEvent();
+    break;
+
+  case 2:
+    output = testDispatchSpeed();
+    break;
+
+  case 3:
+    output = testDispatchSubscriptions();
+    break;
+
+  case 4:
+    output = testSubscribedDispatchSpeed();
+    break;
+
+    // Add case statements to handle other values.
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+// Remembers what it saw.
+class CountingHandler : public MinVR::VREventHandler {
+public:
+  CountingHandler() : count(0), sum(0), last(NULL) {};
+
+  void onVREvent(const MinVR::VRDataIndex &eventData) {
+    count++;
+    sum += (int)eventData.getValue("Value");
+    last = &eventData;
+  };
+
+  int count;
+  long sum;
+  const MinVR::VRDataIndex *last;
+};
+
+// The same loop as VRMain uses.
+static void dispatch(MinVR::VRDataQueue *queue,
+                     std::vector<MinVR::VREventHandler*> &handlers) {
+  while (queue->notEmpty()) {
+    const MinVR::VRDataIndex &event = queue->getFirst();
+    for (size_t f = 0; f < handlers.size(); f++) {
+      handlers[f]->onVREvent(event);
+    }
+    queue->pop();
+  }
+}
+
+// What the loop used to cost: each handler got its own copy of the
+// event, parsed again from the serialized data.
+static void dispatchByCopy(MinVR::VRDataQueue *queue,
+                           std::vector<MinVR::VREventHandler*> &handlers) {
+  while (queue->notEmpty()) {
+    for (size_t f = 0; f < handlers.size(); f++) {
+      MinVR::VRDataIndex copy(queue->getFirstItem().second.serialize());
+      handlers[f]->onVREvent(copy);
+    }
+    queue->pop();
+  }
+}
+
+static MinVR::VRDataIndex makeEvent(int i) {
+  MinVR::VRDataIndex e("Event");
+  e.addData("EventType", "TrackerMove");
+  e.addData("Value", i);
+  e.addData("Transform", MinVR::VRFloatArray(16, (float)i));
+  return e;
+}
+
+// Fills a queue the way the network would: everything serialized.
+static MinVR::VRDataQueue makeQueue(int nEvents) {
+  MinVR::VRDataQueue q;
+  for (int i = 0; i < nEvents; i++) {
+    q.push(i, makeEvent(i));
+  }
+  return MinVR::VRDataQueue(q.serialize());
+}
+
+int testDispatchSharesEvent() {
+
+  int out = 0;
+
+  // A mix of raw events and serialized ones, in both formats.
+  MinVR::VRDataQueue q;
+  q.push(1, makeEvent(1));
+  q.push(2, makeEvent(2).serialize());
+  q.push(3, makeEvent(3).serializeBinary());
+
+  std::vector<CountingHandler> counters(4);
+  std::vector<MinVR::VREventHandler*> handlers;
+  for (size_t f = 0; f < counters.size(); f++) handlers.push_back(&counters[f]);
+
+  while (q.notEmpty()) {
+    const MinVR::VRDataIndex &event = q.getFirst();
+    for (size_t f = 0; f < handlers.size(); f++) {
+      handlers[f]->onVREvent(event);
+    }
+    // Every handler saw the very same index.
+    for (size_t f = 0; f < counters.size(); f++) {
+      if (counters[f].last != &event) out++;
+    }
+    // And asking again doesn't make a new one.
+    if (&q.getFirst() != &event) out++;
+    q.pop();
+  }
+
+  for (size_t f = 0; f < counters.size(); f++) {
+    if (counters[f].count != 3) out++;
+    if (counters[f].sum != 6) out++;
+  }
+
+  // An empty queue hands back an empty index.
+  if (!q.getFirst().empty()) out++;
+
+  return out;
+}
+
+// Events per second delivered to 1, 4, and 16 handlers.  The timing is
+// informational; this only fails if events go missing.
+int testDispatchSpeed() {
+
+  int out = 0;
+  int nEvents = 2000;
+  int nHandlerCounts[] = { 1, 4, 16 };
+
+  for (int n = 0; n < 3; n++) {
+
+    std::vector<CountingHandler> counters(nHandlerCounts[n]);
+    std::vector<MinVR::VREventHandler*> handlers;
+    for (size_t f = 0; f < counters.size(); f++) handlers.push_back(&counters[f]);
+
+    MinVR::VRDataQueue q = makeQueue(nEvents);
+    double t0 = MinVR::VRSystem::getTime();
+    dispatch(&q, handlers);
+    double t1 = MinVR::VRSystem::getTime();
+
+    MinVR::VRDataQueue qCopy = makeQueue(nEvents);
+    double t2 = MinVR::VRSystem::getTime();
+    dispatchByCopy(&qCopy, handlers);
+    double t3 = MinVR::VRSystem::getTime();
+
+    std::cout << nHandlerCounts[n] << " handler(s): "
+              << (int)(nEvents / (t1 - t0)) << " events/sec shared, "
+              << (int)(nEvents / (t3 - t2)) << " events/sec copied per handler"
+              << std::endl;
+
+    for (size_t f = 0; f < counters.size(); f++) {
+      if (counters[f].count != 2 * nEvents) out++;
+    }
+  }
+
+  return out;
+}
+
+// Remembers the names of the events it saw, and tells the others which
+// handler got each one, so the order can be checked.
+class NamingHandler : public MinVR::VREventHandler {
+public:
+  NamingHandler(int id, std::vector<int> *calls) : id(id), calls(calls) {};
+
+  void onVREvent(const MinVR::VRDataIndex &eventData) {
+    names.push_back(eventData.getName());
+    calls->push_back(id);
+  };
+
+  int id;
+  std::vector<int> *calls;
+  std::vector<std::string> names;
+};
+
+// Adds another handler the first time it gets an event.
+class AddingHandler : public MinVR::VREventHandler {
+public:
+  AddingHandler(MinVR::VREventDispatcher *dispatcher, MinVR::VREventHandler *other) :
+    dispatcher(dispatcher), other(other) {};
+
+  void onVREvent(const MinVR::VRDataIndex & /*eventData*/) {
+    if (other != NULL) dispatcher->addHandler(other);
+    other = NULL;
+  };
+
+  MinVR::VREventDispatcher *dispatcher;
+  MinVR::VREventHandler *other;
+};
+
+int testDispatchSubscriptions() {
+
+  int out = 0;
+
+  // The patterns themselves.
+  if (!MinVR::VREventDispatcher::matches("Kbd1_Down", "Kbd1_Down")) out++;
+  if (MinVR::VREventDispatcher::matches("Kbd1_Down", "Kbd1_Downs")) out++;
+  if (!MinVR::VREventDispatcher::matches("Wand_*", "Wand_Move")) out++;
+  if (!MinVR::VREventDispatcher::matches("Wand_*", "Wand_")) out++;
+  if (MinVR::VREventDispatcher::matches("Wand_*", "Wand")) out++;
+  if (!MinVR::VREventDispatcher::matches("Kbd?_Down", "KbdA_Down")) out++;
+  if (MinVR::VREventDispatcher::matches("Kbd?_Down", "KbdAB_Down")) out++;
+  if (!MinVR::VREventDispatcher::matches("*_Down", "MouseBtnLeft_Down")) out++;
+  if (MinVR::VREventDispatcher::matches("*_Down", "MouseBtnLeft_Up")) out++;
+  if (!MinVR::VREventDispatcher::matches("*Btn*_*", "MouseBtnLeft_Down")) out++;
+  if (!MinVR::VREventDispatcher::matches("*", "")) out++;
+  if (MinVR::VREventDispatcher::matches("?", "")) out++;
+
+  std::vector<int> calls;
+  NamingHandler everything(0, &calls), exact(1, &calls), prefix(2, &calls),
+    glob(3, &calls), several(4, &calls);
+
+  MinVR::VREventDispatcher dispatcher;
+  dispatcher.addHandler(&everything);
+  dispatcher.addHandler(&exact, "Kbd1_Down");
+  dispatcher.addHandler(&prefix, "Wand_*");
+  dispatcher.addHandler(&glob, "Kbd?_Up");
+  // This one matches some events more than once.
+  dispatcher.addHandler(&several, "Kbd1_Down");
+  dispatcher.addHandler(&several, "Kbd*");
+  dispatcher.addHandler(&several, "Kbd?_Down");
+  if (dispatcher.getNumHandlers() != 5) out++;
+
+  const char *names[] = { "Kbd1_Down", "Wand_Move", "Kbd1_Up", "KbdEsc_Up",
+                          "Head_Move", "Kbd1_Down", "Wand_Move" };
+  for (int i = 0; i < 7; i++) {
+    dispatcher.dispatch(MinVR::VRDataIndex(names[i]));
+  }
+
+  if (everything.names.size() != 7) out++;
+  if ((exact.names.size() != 2) || (exact.names[1] != "Kbd1_Down")) out++;
+  if ((prefix.names.size() != 2) || (prefix.names[0] != "Wand_Move")) out++;
+  if ((glob.names.size() != 1) || (glob.names[0] != "Kbd1_Up")) out++;
+  if (several.names.size() != 4) out++;
+
+  // In the order they were added, once each.
+  int expected[] = { 0, 1, 4,  0, 2,  0, 3, 4,  0, 4,  0,  0, 1, 4,  0, 2 };
+  if (calls != std::vector<int>(expected, expected + 16)) out++;
+
+  // Adding to a handler that's there already doesn't move it, and a
+  // handler added the old way still gets everything.
+  dispatcher.addHandler(&prefix, "Head_*");
+  dispatcher.addHandler(&glob);
+  calls.clear();
+  dispatcher.dispatch(MinVR::VRDataIndex("Head_Move"));
+  int expected2[] = { 0, 2, 3 };
+  if (calls != std::vector<int>(expected2, expected2 + 3)) out++;
+
+  const std::vector<size_t> &forWand = dispatcher.getHandlersFor("Wand_Move");
+  if ((forWand.size() != 3) || (dispatcher.getHandler(forWand[1]) != &prefix)) out++;
+
+  // A handler can add another while an event is being dispatched.  The
+  // rest still get the event, once each, and the new one gets the next.
+  NamingHandler late(5, &calls);
+  AddingHandler adding(&dispatcher, &late);
+  dispatcher.addHandler(&adding, "Head_*");
+  dispatcher.addHandler(&several, "Head_*");
+  calls.clear();
+  dispatcher.dispatch(MinVR::VRDataIndex("Head_Move"));
+  dispatcher.dispatch(MinVR::VRDataIndex("Head_Move"));
+  int expected3[] = { 0, 2, 3, 4,  0, 2, 3, 4, 5 };
+  if (calls != std::vector<int>(expected3, expected3 + 9)) out++;
+
+  return out;
+}
+
+// Does something with the events it wants, and, the way handlers that
+// get everything have to, passes over the others.
+class ChoosyHandler : public MinVR::VREventHandler {
+public:
+  ChoosyHandler(const std::string &wanted) : wanted(wanted), count(0) {};
+
+  void onVREvent(const MinVR::VRDataIndex &eventData) {
+    if (eventData.getName() == wanted) count++;
+  };
+
+  std::string wanted;
+  int count;
+};
+
+// Thirty handlers that each want one tracker's events, and four hundred
+// events a frame, dispatched to every handler and through subscriptions.
+// The timing is informational; this only fails if the handlers don't get
+// the same events either way.
+int testSubscribedDispatchSpeed() {
+
+  int out = 0;
+  const int nHandlers = 30;
+  const int nEvents = 400;
+  const int nFrames = 50;
+
+  std::vector<ChoosyHandler> all, subscribed;
+  for (int f = 0; f < nHandlers; f++) {
+    std::stringstream name;
+    name << "Tracker" << f << "_Move";
+    all.push_back(ChoosyHandler(name.str()));
+    subscribed.push_back(ChoosyHandler(name.str()));
+  }
+
+  MinVR::VREventDispatcher everything, bySubscription;
+  for (int f = 0; f < nHandlers; f++) {
+    everything.addHandler(&all[f]);
+    bySubscription.addHandler(&subscribed[f], subscribed[f].wanted);
+  }
+
+  // Some of the events are for nobody.
+  std::vector<MinVR::VRDataIndex> events;
+  for (int i = 0; i < nEvents; i++) {
+    std::stringstream name;
+    if (i % 5 == 0) {
+      name << "Kbd" << (char)('A' + i % 26) << "_Down";
+    } else {
+      name << "Tracker" << (i % (nHandlers + 5)) << "_Move";
+    }
+    events.push_back(MinVR::VRDataIndex(name.str()));
+  }
+
+  double t0 = MinVR::VRSystem::getTime();
+  for (int frame = 0; frame < nFrames; frame++) {
+    for (int i = 0; i < nEvents; i++) everything.dispatch(events[i]);
+  }
+  double t1 = MinVR::VRSystem::getTime();
+  for (int frame = 0; frame < nFrames; frame++) {
+    for (int i = 0; i < nEvents; i++) bySubscription.dispatch(events[i]);
+  }
+  double t2 = MinVR::VRSystem::getTime();
+
+  std::cout << nHandlers << " handlers, " << nEvents << " events/frame: "
+            << 1.0e6 * (t1 - t0) / nFrames << "us/frame to every handler, "
+            << 1.0e6 * (t2 - t1) / nFrames << "us/frame by subscription" << std::endl;
+
+  int total = 0;
+  for (int f = 0; f < nHandlers; f++) {
+    if (all[f].count != subscribed[f].count) out++;
+    total += subscribed[f].count;
+  }
+  if (total == 0) out++;
+
+  return out;
+}
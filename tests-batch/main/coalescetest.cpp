@@ -0,0 +1,209 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include "input/VREventCoalescer.h"
+#include "main/VRFrameProfiler.h"
+#include "math/VRMath.h"
+#include "api/VRTrackerEvent.h"
+#include "api/VRAnalogEvent.h"
+#include "api/VRButtonEvent.h"
+
+int testCoalesceLatest();
+int testCoalesceAverage();
+
+int coalescetest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testCoalesceLatest();
+    break;
+
+  case 2:
+    output = testCoalesceAverage();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+static MinVR::VRDataIndex tracker(const std::string &name, const MinVR::VRMatrix4 &pose) {
+  return MinVR::VRTrackerEvent::createValidDataIndex(name, pose.toVRFloatArray());
+}
+
+// Four frames' worth of a fast head tracker, with a button press and
+// a slower wand in among them.
+static MinVR::VRDataQueue makeQueue() {
+  MinVR::VRDataQueue queue;
+  for (int i = 0; i < 4; i++) {
+    queue.push(100 + 10 * i, MinVR::VRDataQueueItem(
+      tracker("Head_Move", MinVR::VRMatrix4::translation(MinVR::VRVector3((float)i, 0, 0)))));
+    if (i == 1) {
+      queue.push(105 + 10 * i, MinVR::VRDataQueueItem(
+        MinVR::VRButtonEvent::createValidDataIndex("Kbda_Down", 1)));
+      queue.push(106 + 10 * i, MinVR::VRDataQueueItem(
+        MinVR::VRButtonEvent::createValidDataIndex("Kbda_Down", 1)));
+    }
+  }
+  queue.push(200, MinVR::VRDataQueueItem(tracker("Wand_Move", MinVR::VRMatrix4())));
+  return queue;
+}
+
+static std::vector<std::string> names(MinVR::VRDataQueue &queue) {
+  std::vector<std::string> out;
+  for (MinVR::VRDataQueue::iterator it = queue.begin(); it != queue.end(); it++) {
+    out.push_back(it->second.getData().getName());
+  }
+  return out;
+}
+
+// Only the last of each coalesced event is kept, in its place, and the
+// rest are counted.
+int testCoalesceLatest() {
+
+  int out = 0;
+
+  MinVR::VREventCoalescer coalescer;
+  MinVR::VRDataQueue queue = makeQueue();
+
+  // Nothing happens without a mode.
+  coalescer.coalesce(&queue);
+  if (queue.size() != 7) out++;
+
+  // A device mode takes the tracker events only, never the buttons.
+  std::map<std::string, long> dropped;
+  coalescer.coalesce(&queue, MinVR::VREventCoalescer::LATEST, &dropped);
+  std::vector<std::string> left = names(queue);
+  if ((left.size() != 4) || (left[0] != "Kbda_Down") || (left[1] != "Kbda_Down") ||
+      (left[2] != "Head_Move") || (left[3] != "Wand_Move")) out++;
+  if ((dropped.size() != 1) || (dropped["Head_Move"] != 3)) out++;
+  if (coalescer.getNumDropped() != 3) out++;
+
+  // The latest one, with its own time stamp.
+  MinVR::VRDataQueue::iterator it = queue.begin();
+  it++;
+  it++;
+  if (it->first.first != 130) out++;
+  MinVR::VRFloatArray transform = it->second.getData().getValue("Transform");
+  if (transform[12] != 3.0f) out++;
+
+  // A mode for an event name takes any kind of event.
+  MinVR::VREventCoalescer byName;
+  byName.setEventMode("Kbda_Down", MinVR::VREventCoalescer::parseMode("Latest"));
+  if (!byName.hasEventModes()) out++;
+  queue = makeQueue();
+  byName.coalesce(&queue);
+  if ((queue.size() != 6) || (byName.getNumDropped() != 1)) out++;
+
+  // And overrides the device's.
+  byName.setEventMode("Head_Move", MinVR::VREventCoalescer::KEEP_ALL);
+  queue = makeQueue();
+  byName.coalesce(&queue, MinVR::VREventCoalescer::LATEST);
+  if (queue.size() != 6) out++;
+
+  // Devices without a mode keep everything.
+  MinVR::VRInputDevice *device = (MinVR::VRInputDevice*)&queue;
+  if (coalescer.getDeviceMode(device) != MinVR::VREventCoalescer::KEEP_ALL) out++;
+  coalescer.setDeviceMode(device, MinVR::VREventCoalescer::AVERAGE);
+  if (coalescer.getDeviceMode(device) != MinVR::VREventCoalescer::AVERAGE) out++;
+
+  bool caught = false;
+  try {
+    MinVR::VREventCoalescer::parseMode("Sometimes");
+  } catch (MinVR::VRError &e) {
+    caught = true;
+  }
+  if (!caught) out++;
+
+  return out;
+}
+
+// Averages are taken of poses and analog values, and the dropped samples
+// show up in the frame stats.
+int testCoalesceAverage() {
+
+  int out = 0;
+
+  MinVR::VREventCoalescer coalescer;
+  coalescer.setEventMode("Wand_Move", MinVR::VREventCoalescer::AVERAGE);
+  coalescer.setEventMode("Trigger", MinVR::VREventCoalescer::AVERAGE);
+
+  // Turning about y and moving along x.
+  MinVR::VRDataQueue queue;
+  for (int i = 0; i < 3; i++) {
+    float angle = 0.1f * i;
+    queue.push(100 + i, MinVR::VRDataQueueItem(
+      tracker("Wand_Move", MinVR::VRMatrix4::translation(MinVR::VRVector3(2.0f * i, 1, 0)) *
+              MinVR::VRMatrix4::rotationY(angle))));
+    queue.push(110 + i, MinVR::VRDataQueueItem(
+      MinVR::VRAnalogEvent::createValidDataIndex("Trigger", 0.25f * i)));
+  }
+
+  std::map<std::string, long> dropped;
+  coalescer.coalesce(&queue, MinVR::VREventCoalescer::KEEP_ALL, &dropped);
+  if (queue.size() != 2) out++;
+  if ((dropped["Wand_Move"] != 2) || (dropped["Trigger"] != 2)) out++;
+
+  const MinVR::VRDataIndex &wand = queue.getFirst();
+  MinVR::VRFloatArray transform = wand.getValue("Transform");
+  MinVR::VRMatrix4 pose(&transform[0]);
+  if ((fabs(pose(0, 3) - 2.0f) > 1.0e-5f) || (fabs(pose(1, 3) - 1.0f) > 1.0e-5f)) out++;
+
+  // The average of the rotations is close to the middle one, and is
+  // still a rotation.
+  MinVR::VRMatrix4 middle = MinVR::VRMatrix4::rotationY(0.1f);
+  for (int row = 0; row < 3; row++) {
+    for (int col = 0; col < 3; col++) {
+      if (fabs(pose(row, col) - middle(row, col)) > 0.01f) out++;
+    }
+  }
+  for (int a = 0; a < 3; a++) {
+    for (int b = 0; b < 3; b++) {
+      float dot = 0.0f;
+      for (int i = 0; i < 3; i++) dot += pose(i, a) * pose(i, b);
+      if (fabs(dot - ((a == b) ? 1.0f : 0.0f)) > 1.0e-5f) out++;
+    }
+  }
+  if (queue.getFirstItem().first.first != 102) out++;
+
+  queue.pop();
+  if (fabs((float)queue.getFirst().getValue("AnalogValue") - 0.25f) > 1.0e-6f) out++;
+
+  // The counts, as VRMain reports them.
+  MinVR::VRFrameProfiler profiler;
+  profiler.enable(4);
+  for (int frame = 0; frame < 2; frame++) {
+    profiler.beginFrame(frame);
+    for (std::map<std::string, long>::iterator it = dropped.begin(); it != dropped.end(); it++) {
+      profiler.addCount("droppedSamples", it->first, it->second);
+    }
+    profiler.addCount("droppedSamples", "Trigger", 1);
+    profiler.endFrame();
+  }
+  const MinVR::VRFrameStats &stats = profiler.getFrameStats();
+  if ((stats.getCount("droppedSamples Wand_Move") != 2) ||
+      (stats.getCount("droppedSamples Trigger") != 3) ||
+      (stats.getCount("droppedSamples") != 5) ||
+      (stats.getCount("nothing") != 0)) out++;
+  if (fabs(profiler.getAverageCount("droppedSamples") - 5.0) > 1.0e-9) out++;
+  if (profiler.getSummary().find("droppedSamples Trigger: 3.0 per frame") == std::string::npos) out++;
+
+  return out;
+}
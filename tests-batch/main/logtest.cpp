@@ -0,0 +1,188 @@
+// Debug messages are compiled out of this file, whatever the build.
+#undef VRLOG_MIN_LEVEL
+#define VRLOG_MIN_LEVEL VRLOG_LEVEL_STATUS
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include "main/VRLog.h"
+
+int testLogThreads();
+int testLogLevels();
+int testLogWakeUp();
+
+int logtest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testLogThreads();
+    break;
+
+  case 2:
+    output = testLogLevels();
+    break;
+
+  case 3:
+    output = testLogWakeUp();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+static void logFromThread(const int thread, const int n) {
+  for (int i = 0; i < n; i++) {
+    std::stringstream msg;
+    msg << "thread " << thread << " message " << i;
+    VRLOG_STATUS(msg.str());
+    // Stay under the size of the ring.
+    if ((i % 500) == 499) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+// Several threads log at once, into a file.  Every message should get
+// there, and each thread's in the order it logged them.
+int testLogThreads() {
+
+  int out = 0;
+
+  std::string fileName = MinVR::VRLog::getNodeFileName("logtest.log", "/MinVR/VRSetups/Threads", ".log");
+  if (fileName != "logtest-Threads.log") out++;
+  if (!MinVR::VRLog::setFile(fileName)) out++;
+
+  const int numThreads = 4;
+  const int numMessages = 2000;
+  long droppedBefore = MinVR::VRLog::getNumDropped();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    threads.push_back(std::thread(logFromThread, t, numMessages));
+  }
+  for (int t = 0; t < numThreads; t++) threads[t].join();
+
+  MinVR::VRLog::flush();
+  MinVR::VRLog::setFile("");
+
+  std::ifstream in(fileName.c_str());
+  std::vector<int> next(numThreads, 0);
+  std::string line;
+  int lines = 0;
+  while (std::getline(in, line)) {
+    int thread, message;
+    double time;
+    if (sscanf(line.c_str(), "[%lf] - thread %d message %d", &time, &thread, &message) != 3) continue;
+    lines++;
+    if ((thread < 0) || (thread >= numThreads) || (message != next[thread])) {
+      std::cout << "out of order: " << line << std::endl;
+      out++;
+    } else {
+      next[thread]++;
+    }
+  }
+  in.close();
+  remove(fileName.c_str());
+
+  std::cout << lines << " lines, " << MinVR::VRLog::getNumDropped() - droppedBefore
+            << " dropped" << std::endl;
+  if (MinVR::VRLog::getNumDropped() != droppedBefore) out++;
+  if (lines != numThreads * numMessages) out++;
+
+  return out;
+}
+
+static int evaluated = 0;
+
+static std::string countEvaluation(const std::string &message) {
+  evaluated++;
+  return message;
+}
+
+int testLogLevels() {
+
+  int out = 0;
+
+  // Compiled out: the argument is never looked at.
+  VRLOG_DEBUG(countEvaluation("compiled out"));
+  if (evaluated != 0) out++;
+
+  // Below the level set at run time: the same.
+  MinVR::VRLog::setLevel(VRLOG_LEVEL_WARNING);
+  VRLOG_STATUS(countEvaluation("filtered out"));
+  VRLOG_H1(countEvaluation("filtered out"));
+  if (evaluated != 0) out++;
+
+  VRLOG_WARNING(countEvaluation("a warning, as expected"));
+  if (evaluated != 1) out++;
+
+  MinVR::VRLog::setLevel(VRLOG_LEVEL_STATUS);
+  VRLOG_STATUS(countEvaluation("a status message"));
+  if (evaluated != 2) out++;
+
+  if (MinVR::VRLog::getLevelFromName("WARNING") != VRLOG_LEVEL_WARNING) out++;
+  if (MinVR::VRLog::getLevelFromName("DEBUG") != VRLOG_LEVEL_DEBUG) out++;
+  if (MinVR::VRLog::getLevelFromName("anything") != VRLOG_LEVEL_STATUS) out++;
+
+  if (MinVR::VRLog::getNodeFileName("logs/minvr", "Left", ".log") != "logs/minvr-Left.log") out++;
+
+  return out;
+}
+
+// The background thread sleeps when there is nothing to write, and is
+// woken by the next message, so that gets written without a flush().
+int testLogWakeUp() {
+
+  int out = 0;
+
+  std::string fileName = "logtest-WakeUp.log";
+  if (!MinVR::VRLog::setFile(fileName)) out++;
+
+  for (int i = 0; i < 5; i++) {
+    // Long enough for the thread to have gone to sleep.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::stringstream msg;
+    msg << "wake up " << i;
+    VRLOG_STATUS(msg.str());
+
+    // Wait up to a few seconds for it to show up in the file.
+    bool found = false;
+    for (int tries = 0; (tries < 300) && !found; tries++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      std::ifstream in(fileName.c_str());
+      std::string line;
+      while (std::getline(in, line)) {
+        if (line.find(msg.str()) != std::string::npos) found = true;
+      }
+    }
+    if (!found) {
+      std::cout << "\"" << msg.str() << "\" was not written." << std::endl;
+      out++;
+    }
+  }
+
+  MinVR::VRLog::setFile("");
+  remove(fileName.c_str());
+
+  return out;
+}
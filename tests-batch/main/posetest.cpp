@@ -0,0 +1,144 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include "input/VRPoseSlot.h"
+
+int testPosePrediction();
+int testPoseConcurrency();
+
+int posetest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testPosePrediction();
+    break;
+
+  case 2:
+    output = testPoseConcurrency();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+static bool near(const MinVR::VRMatrix4 &a, const MinVR::VRMatrix4 &b, const float tolerance) {
+  for (int row = 0; row < 4; row++) {
+    for (int col = 0; col < 4; col++) {
+      if (fabs(a(row, col) - b(row, col)) > tolerance) {
+        std::cout << "expected" << std::endl << b << std::endl << "got" << std::endl << a << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// A tracker moving and turning steadily is extrapolated along its path.
+int testPosePrediction() {
+
+  int out = 0;
+
+  MinVR::VRPoseSlot slot;
+  MinVR::VRMatrix4 pose;
+  double time;
+  if (slot.read(&pose, &time) || slot.predict(1.0, &pose)) out++;
+
+  // One pose gives no velocity, so it stays put.
+  MinVR::VRMatrix4 start = MinVR::VRMatrix4::translation(MinVR::VRVector3(1, 2, 3));
+  slot.publish(start, 1.0);
+  if (!slot.read(&pose, &time) || (time != 1.0) || !near(pose, start, 1.0e-6f)) out++;
+  if (!slot.predict(1.05, &pose) || !near(pose, start, 1.0e-6f)) out++;
+
+  // Moving along x at 2 units a second, and turning about y at 1 radian
+  // a second.
+  for (int i = 1; i <= 5; i++) {
+    float t = 0.01f * i;
+    slot.publish(MinVR::VRMatrix4::translation(MinVR::VRVector3(1 + 2 * t, 2, 3)) *
+                 MinVR::VRMatrix4::rotationY(t), 1.0 + t);
+  }
+  if (slot.getNumPublished() != 6) out++;
+
+  MinVR::VRMatrix4 expected = MinVR::VRMatrix4::translation(MinVR::VRVector3(1 + 2 * 0.08f, 2, 3)) *
+    MinVR::VRMatrix4::rotationY(0.08f);
+  if (!slot.predict(1.08, &pose) || !near(pose, expected, 1.0e-3f)) out++;
+
+  // Not before the last pose, and not at all once it is too old: a
+  // tracker that stops publishing stays where it was last seen.
+  MinVR::VRMatrix4 last = MinVR::VRMatrix4::translation(MinVR::VRVector3(1.1f, 2, 3)) *
+    MinVR::VRMatrix4::rotationY(0.05f);
+  if (!slot.predict(0.5, &pose) || !near(pose, last, 1.0e-3f)) out++;
+  double limit = 1.05 + MinVR::VRPoseSlot::getMaxPrediction();
+  if (!slot.predict(limit - 0.01, &pose) || near(pose, last, 1.0e-3f)) out++;
+  if (!slot.predict(limit + 0.01, &pose) || !near(pose, last, 1.0e-3f)) out++;
+  if (!slot.predict(limit + 10.0, &pose) || !near(pose, last, 1.0e-3f)) out++;
+
+  // A pose long after the last one starts again from rest.
+  slot.publish(start, 5.0);
+  if (!slot.predict(5.05, &pose) || !near(pose, start, 1.0e-6f)) out++;
+
+  // Slots are shared by name.
+  if ((MinVR::VRPoseSlot::get("Head_Move") != MinVR::VRPoseSlot::get("Head_Move")) ||
+      (MinVR::VRPoseSlot::get("Head_Move") == MinVR::VRPoseSlot::get("Hand_Move"))) out++;
+
+  return out;
+}
+
+// Readers never see half of one pose and half of another.
+int testPoseConcurrency() {
+
+  int out = 0;
+
+  MinVR::VRPoseSlot slot;
+  std::atomic<bool> done(false);
+  std::atomic<int> torn(0);
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; r++) {
+    readers.push_back(std::thread([&slot, &done, &torn]() {
+          MinVR::VRMatrix4 pose;
+          double time;
+          while (!done.load()) {
+            if (!slot.read(&pose, &time)) continue;
+            float k = (float)time;
+            if ((pose(0, 3) != k) || (pose(1, 3) != k) || (pose(2, 3) != k)) torn++;
+          }
+        }));
+  }
+
+  // Poses a whole second apart, so they give no velocity.
+  const int numPoses = 20000;
+  for (int k = 1; k <= numPoses; k++) {
+    slot.publish(MinVR::VRMatrix4::translation(MinVR::VRVector3((float)k, (float)k, (float)k)), k);
+  }
+  done.store(true);
+  for (size_t r = 0; r < readers.size(); r++) readers[r].join();
+
+  if (torn.load() != 0) out++;
+  if (slot.getNumPublished() != numPoses) out++;
+
+  MinVR::VRMatrix4 pose;
+  double time;
+  if (!slot.read(&pose, &time) || (time != numPoses) || (pose(0, 3) != numPoses)) out++;
+
+  return out;
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+#include "main/VRFrameProfiler.h"
+
+int testProfilerStats();
+int testProfilerTrace();
+
+int profilertest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testProfilerStats();
+    break;
+
+  case 2:
+    output = testProfilerTrace();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+// Runs one pretend frame, with an input device, two event handlers
+// called for three events, and a render.
+static void profileFrame(MinVR::VRFrameProfiler &profiler, const int frame) {
+
+  profiler.beginFrame(frame);
+  {
+    MinVR::VRProfileScope scope(&profiler, "input", 0);
+  }
+  for (int event = 0; event < 3; event++) {
+    profiler.addTime("eventHandler", 0, 0.001);
+    profiler.addTime("eventHandler", 1, 0.002);
+  }
+  {
+    MinVR::VRProfileScope scope(&profiler, "render", std::string("Window1"));
+  }
+  profiler.endFrame();
+}
+
+int testProfilerStats() {
+
+  int out = 0;
+
+  // Nothing is kept until it is turned on.
+  MinVR::VRFrameProfiler profiler;
+  profileFrame(profiler, 0);
+  if (profiler.isEnabled() || (profiler.getNumFrames() != 0)) out++;
+
+  profiler.enable(4);
+  for (int frame = 1; frame <= 6; frame++) profileFrame(profiler, frame);
+
+  // Only the last four are kept, latest first.
+  if (profiler.getNumFrames() != 4) out++;
+  if (profiler.getFrameStats(0).frame != 6) out++;
+  if (profiler.getFrameStats(3).frame != 3) out++;
+
+  const MinVR::VRFrameStats &stats = profiler.getFrameStats();
+  if (stats.samples.size() != 4) out++;
+  if (stats.samples[0].getLabel() != "input 0") out++;
+  if (stats.samples[3].getLabel() != "render Window1") out++;
+  if (stats.samples[3].isTotal || !stats.samples[1].isTotal) out++;
+
+  // Totals add up the calls.
+  if (stats.samples[2].calls != 3) out++;
+  if (fabs(stats.getTime("eventHandler 1") - 0.006) > 1.0e-9) out++;
+  if (fabs(profiler.getAverageTime("eventHandler 0") - 0.003) > 1.0e-9) out++;
+  if (stats.getTime("nothing") != 0.0) out++;
+
+  // Samples outside a frame go nowhere.
+  profiler.addTime("eventHandler", 0, 1.0);
+  if (fabs(profiler.getAverageTime("eventHandler 0") - 0.003) > 1.0e-9) out++;
+
+  std::cout << profiler.getSummary() << std::endl;
+
+  return out;
+}
+
+int testProfilerTrace() {
+
+  int out = 0;
+
+  std::string fileName =
+    MinVR::VRFrameProfiler::getTraceFileName("profiletest.json", "/MinVR/VRSetups/Left");
+  if (fileName != "profiletest-Left.json") out++;
+  if (MinVR::VRFrameProfiler::getTraceFileName("dir.d/trace", "Right") != "dir.d/trace-Right.json") out++;
+
+  {
+    MinVR::VRFrameProfiler profiler;
+    profiler.enable(10);
+    if (!profiler.writeTrace(fileName, "/MinVR/VRSetups/Left")) out++;
+    profileFrame(profiler, 7);
+    profileFrame(profiler, 8);
+  }
+
+  std::ifstream in(fileName.c_str());
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string trace = buffer.str();
+  remove(fileName.c_str());
+
+  std::cout << trace;
+
+  // A complete JSON array, with a name for the process, spans for the
+  // frames and their pieces, and counters for the totals.
+  if ((trace.find("[") != 0) || (trace.rfind("]") != trace.size() - 2)) out++;
+  if (trace.find("\"process_name\"") == std::string::npos) out++;
+  if (trace.find("\"args\":{\"name\":\"/MinVR/VRSetups/Left\"}") == std::string::npos) out++;
+  if (trace.find("{\"name\":\"frame\"") == std::string::npos) out++;
+  if (trace.find("{\"name\":\"render Window1\"") == std::string::npos) out++;
+  if (trace.find("\"args\":{\"frame\":8}") == std::string::npos) out++;
+  if (trace.find("{\"name\":\"eventHandler 1\",\"cat\":\"MinVR\",\"ph\":\"C\"") == std::string::npos) out++;
+
+  // 1 name, and 2 frames of 1 frame span, 2 spans and 2 totals each.
+  // Each event is on a line of its own.
+  int events = 0;
+  for (size_t p = trace.find("\n{"); p != std::string::npos;
+       p = trace.find("\n{", p + 1)) {
+    events++;
+  }
+  if (events != 11) out++;
+
+  return out;
+}
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <thread>
+#include <cstdio>
+#include "input/VRSampleRing.h"
+#include "input/VRBufferedInputDevice.h"
+
+int testRingOrder();
+int testRingThreads();
+
+int ringtest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testRingOrder();
+    break;
+
+  case 2:
+    output = testRingThreads();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+// A device that makes an analog event from each number it is given.
+class CountingDevice : public MinVR::VRBufferedInputDevice<int> {
+public:
+  CountingDevice() : MinVR::VRBufferedInputDevice<int>(4) {}
+
+  bool add(int sample) { return pushSample(sample); }
+
+protected:
+  void appendSampleEvents(const int &sample, MinVR::VRDataQueue *queue) {
+    MinVR::VRDataIndex event("Count");
+    event.addData("AnalogValue", sample);
+    queue->push(event);
+  }
+};
+
+// Samples come out in the order they went in, and the ones that don't
+// fit are dropped and counted.
+int testRingOrder() {
+
+  int out = 0;
+
+  MinVR::VRSampleRing<int> ring(5);
+  if (ring.capacity() != 8) out++;
+
+  int sample;
+  if (ring.pop(&sample)) out++;
+
+  // Round and round, to wrap the indices.
+  int next = 0, expected = 0;
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 5; i++) {
+      if (!ring.push(next++)) out++;
+    }
+    for (int i = 0; i < 5; i++) {
+      if (!ring.pop(&sample) || (sample != expected++)) out++;
+    }
+  }
+  if (ring.size() != 0) out++;
+
+  for (int i = 0; i < 10; i++) ring.push(i);
+  if ((ring.size() != 8) || (ring.getNumDropped() != 2)) out++;
+  for (int i = 0; i < 8; i++) {
+    if (!ring.pop(&sample) || (sample != i)) out++;
+  }
+
+  // The device turns its samples into events when they are asked for.
+  CountingDevice device;
+  for (int i = 1; i <= 5; i++) device.add(i);
+  if (device.getNumDroppedSamples() != 1) out++;
+
+  MinVR::VRDataQueue queue;
+  device.appendNewInputEventsSinceLastCall(&queue);
+  if (queue.size() != 4) out++;
+  int value = 1;
+  for (MinVR::VRDataQueue::iterator it = queue.begin(); it != queue.end(); it++) {
+    if ((int)it->second.getData().getValue("AnalogValue") != value++) out++;
+  }
+
+  queue.clear();
+  device.appendNewInputEventsSinceLastCall(&queue);
+  if (!queue.empty()) out++;
+
+  return out;
+}
+
+// Nothing is lost or reordered between two threads.
+int testRingThreads() {
+
+  int out = 0;
+
+  MinVR::VRSampleRing<long> ring(64);
+  const long numSamples = 200000;
+
+  std::thread producer([&ring, numSamples]() {
+      for (long i = 0; i < numSamples; i++) {
+        while (!ring.push(i)) std::this_thread::yield();
+      }
+    });
+
+  long expected = 0, sample;
+  while (expected < numSamples) {
+    if (ring.pop(&sample)) {
+      if (sample != expected) {
+        out++;
+        break;
+      }
+      expected++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  if (ring.pop(&sample)) out++;
+
+  return out;
+}
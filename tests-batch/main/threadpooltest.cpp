@@ -0,0 +1,170 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+#include <cstdio>
+#include "main/VRThreadPool.h"
+
+int testThreadPoolJobs();
+int testThreadPoolErrors();
+int testThreadPoolCallerWaits();
+
+int threadpooltest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testThreadPoolJobs();
+    break;
+
+  case 2:
+    output = testThreadPoolErrors();
+    break;
+
+  case 3:
+    output = testThreadPoolCallerWaits();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+// Every job runs once each time, always on the same thread, and the
+// first ones on the caller's.
+int testThreadPoolJobs() {
+
+  int out = 0;
+
+  MinVR::VRThreadPool pool(3);
+  if (pool.getNumThreads() != 3) out++;
+
+  const int numJobs = 7;
+  std::vector<int> calls(numJobs, 0);
+  std::vector<std::thread::id> threads(numJobs);
+
+  for (int round = 0; round < 1000; round++) {
+    pool.run(numJobs, [&calls, &threads, round](int i) {
+        calls[i]++;
+        if (round == 0) {
+          threads[i] = std::this_thread::get_id();
+        } else if (threads[i] != std::this_thread::get_id()) {
+          calls[i] = -1000000;
+        }
+      });
+
+    // Some rounds with little to do, which leave the workers idle.
+    pool.run(1, [&calls](int i) { calls[i]++; });
+  }
+
+  if (calls[0] != 2000) out++;
+  for (int i = 1; i < numJobs; i++) {
+    if (calls[i] != 1000) out++;
+  }
+
+  if ((threads[0] != std::this_thread::get_id()) ||
+      (threads[3] != std::this_thread::get_id()) ||
+      (threads[6] != std::this_thread::get_id())) out++;
+  if ((threads[1] == threads[0]) || (threads[1] == threads[2]) ||
+      (threads[1] != threads[4])) out++;
+
+  // A pool of one is the caller alone.
+  MinVR::VRThreadPool single(0);
+  if (single.getNumThreads() != 1) out++;
+  int sum = 0;
+  single.run(4, [&sum](int i) { sum += i; });
+  if (sum != 6) out++;
+
+  return out;
+}
+
+// Exceptions thrown by jobs come out of run(), after all the jobs are done.
+int testThreadPoolErrors() {
+
+  int out = 0;
+
+  MinVR::VRThreadPool pool(4, 0.0);
+  std::vector<int> calls(8, 0);
+
+  bool caught = false;
+  try {
+    pool.run(8, [&calls](int i) {
+        calls[i]++;
+        if (i == 5) throw std::runtime_error("job 5 went wrong");
+      });
+  } catch (std::runtime_error &e) {
+    caught = (std::string(e.what()) == "job 5 went wrong");
+  }
+  if (!caught) out++;
+  for (int i = 0; i < 8; i++) {
+    if (calls[i] != 1) out++;
+  }
+
+  // And the pool still works afterwards.
+  try {
+    pool.run(8, [&calls](int i) { calls[i]++; });
+  } catch (...) {
+    out++;
+  }
+  for (int i = 0; i < 8; i++) {
+    if (calls[i] != 2) out++;
+  }
+
+  return out;
+}
+
+// A pool that the caller doesn't work in runs every job on threads of its
+// own, and still always the same one for each job.
+int testThreadPoolCallerWaits() {
+
+  int out = 0;
+
+  MinVR::VRThreadPool pool(2, 200.0e-6, false);
+  if (pool.getNumThreads() != 2) out++;
+
+  const int numJobs = 5;
+  std::vector<int> calls(numJobs, 0);
+  std::vector<std::thread::id> threads(numJobs);
+
+  for (int round = 0; round < 1000; round++) {
+    pool.run(numJobs, [&calls, &threads, round](int i) {
+        calls[i]++;
+        if (round == 0) {
+          threads[i] = std::this_thread::get_id();
+        } else if (threads[i] != std::this_thread::get_id()) {
+          calls[i] = -1000000;
+        }
+      });
+
+    // A single job still goes to a thread of the pool.
+    pool.run(1, [&calls](int i) { calls[i]++; });
+  }
+
+  if (calls[0] != 2000) out++;
+  for (int i = 1; i < numJobs; i++) {
+    if (calls[i] != 1000) out++;
+  }
+
+  for (int i = 0; i < numJobs; i++) {
+    if (threads[i] == std::this_thread::get_id()) out++;
+  }
+  if ((threads[0] == threads[1]) || (threads[0] != threads[2]) ||
+      (threads[1] != threads[3]) || (threads[0] != threads[4])) out++;
+
+  return out;
+}
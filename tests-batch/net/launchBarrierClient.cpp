@@ -0,0 +1,58 @@
+#include "net/VRNetClient.h"
+#include "config/VRDataIndex.h"
+
+#ifndef WIN32
+#include <time.h>
+#endif
+
+// Program to launch one VRNetClient that goes through the swap buffers
+// barrier a number of times, noting when it was released each time.  It
+// reports each release time to the server with the next frame's event
+// data, so the test can work out how far apart the clients were
+// released.  Like the other launch programs, this is meant to be
+// started by a forked child process in the network tests.
+//
+// Arguments: client number, number of frames, and "tcp" or "datagram".
+int main(int argc, char* argv[]) {
+
+#ifdef WIN32
+  // The test that uses this does not run on Windows.
+  exit(0);
+#else
+  int clientNumber;
+  sscanf(argv[1], "%d", &clientNumber);
+
+  int numberOfFrames;
+  sscanf(argv[2], "%d", &numberOfFrames);
+
+  bool useDatagram = (std::string(argv[3]) == "datagram");
+
+  MinVR::VRNetClient client("localhost", "3490");
+  if (useDatagram) {
+    client.useDatagramSwapBarrier("239.255.42.99", "3491", "127.0.0.1");
+  }
+
+  struct timespec released;
+  for (int i = 0; i <= numberOfFrames; i++) {
+
+    // Report the last release (if any) along with this frame's events.
+    MinVR::VRDataQueue queue;
+    if (i > 0) {
+      MinVR::VRDataIndex e("release");
+      e.addData("client", clientNumber);
+      e.addData("frame", i - 1);
+      e.addData("sec", (int)released.tv_sec);
+      e.addData("usec", (int)(released.tv_nsec / 1000));
+      queue.push(e);
+    }
+    client.syncEventDataAcrossAllNodes(queue);
+
+    if (i < numberOfFrames) {
+      client.syncSwapBuffersAcrossAllNodes();
+      clock_gettime(CLOCK_MONOTONIC, &released);
+    }
+  }
+
+	exit(0);
+#endif
+}
@@ -0,0 +1,61 @@
+#include "net/VRNetClient.h"
+#include "config/VRDataIndex.h"
+
+#ifndef WIN32
+#include <time.h>
+#endif
+
+// Program to launch one VRNetClient that gets its configuration either
+// by reading the configuration file, the way a client normally does, or
+// from the server when it connects.  Once it has its configuration and
+// is connected, it tells the server when that was, and what it got, with
+// its first event data.  Like the other launch programs, this is meant
+// to be started by a forked child process in the network tests.
+//
+// Arguments: client number, "files" or "server", and the configuration file.
+int main(int argc, char* argv[]) {
+
+#ifdef WIN32
+  // The test that uses this does not run on Windows.
+  exit(0);
+#else
+  int clientNumber;
+  sscanf(argv[1], "%d", &clientNumber);
+
+  bool fromServer = (std::string(argv[2]) == "server");
+
+  MinVR::VRDataIndex config;
+  MinVR::VRNetClient *client;
+  if (fromServer) {
+    client = new MinVR::VRNetClient("localhost", "3490", &config);
+    client->negotiateWireFormat(MinVR::VRNetInterface::WIRE_FORMAT_BINARY);
+  } else {
+    config.processXMLFile(argv[3], "/");
+    client = new MinVR::VRNetClient("localhost", "3490");
+  }
+
+  struct timespec ready;
+  clock_gettime(CLOCK_MONOTONIC, &ready);
+
+  // A checksum of the configuration, so the server can tell it's the
+  // same as its own.
+  std::string serialized = config.serialize();
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < serialized.size(); i++) {
+    hash = (hash ^ (unsigned char)serialized[i]) * 16777619u;
+  }
+
+  MinVR::VRDataIndex e("ready");
+  e.addData("client", clientNumber);
+  e.addData("sec", (int)ready.tv_sec);
+  e.addData("usec", (int)(ready.tv_nsec / 1000));
+  e.addData("size", (int)serialized.size());
+  e.addData("hash", (int)(hash & 0x7fffffff));
+  MinVR::VRDataQueue queue;
+  queue.push(e);
+  client->syncEventDataAcrossAllNodes(queue);
+
+  delete client;
+	exit(0);
+#endif
+}
@@ -0,0 +1,72 @@
+#include "net/VRNetClient.h"
+#include "config/VRDataIndex.h"
+
+// Program to launch one VRNetClient that asks for the delta wire format,
+// and sends events with the same time stamps as the other clients' and
+// the server's, or no events at all in some frames.  It keeps a checksum
+// of the queue it puts together from each of the server's deltas, and
+// after the last frame sends those back to the server, which checks them
+// against the queues it merged.  Like the other launch programs, this is
+// meant to be started by a forked child process in the network tests.
+//
+// Arguments: client number and number of frames.
+
+// The time stamps, names, and contents of the queue, in order.
+static int checksum(const MinVR::VRDataQueue &queue) {
+  std::stringstream ss;
+  for (MinVR::VRDataQueue::const_iterator it = queue.begin(); it != queue.end(); ++it) {
+    ss << it->first.first << ":" << it->second.getData().serialize() << ";";
+  }
+  std::string s = ss.str();
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < s.size(); i++) {
+    hash = (hash ^ (unsigned char)s[i]) * 16777619u;
+  }
+  return (int)(hash & 0x7fffffff);
+}
+
+int main(int argc, char* argv[]) {
+
+  int clientNumber;
+  sscanf(argv[1], "%d", &clientNumber);
+
+  int numberOfFrames;
+  sscanf(argv[2], "%d", &numberOfFrames);
+
+  MinVR::VRNetClient client("localhost", "3490",
+                            MinVR::VRNetInterface::WIRE_FORMAT_BINARY_DELTA);
+
+  MinVR::VRIntArray checksums;
+  for (int frame = 0; frame < numberOfFrames; frame++) {
+
+    // Every third frame, nothing to say.  Otherwise two events at the
+    // frame's time, which the server and the other clients use too, and
+    // one a little later.
+    MinVR::VRDataQueue queue;
+    if ((frame + clientNumber) % 3 != 0) {
+      MinVR::VRDataIndex a("Client_Down");
+      a.addData("client", clientNumber);
+      a.addData("frame", frame);
+      queue.push(100LL * frame, MinVR::VRDataQueueItem(a));
+
+      MinVR::VRDataIndex b("Client_Up");
+      b.addData("client", clientNumber);
+      queue.push(100LL * frame, MinVR::VRDataQueueItem(b));
+
+      MinVR::VRDataIndex c("Client_Move");
+      c.addData("Position", MinVR::VRFloatArray(3, (float)clientNumber));
+      queue.push(100LL * frame + clientNumber, MinVR::VRDataQueueItem(c));
+    }
+
+    checksums.push_back(checksum(client.syncEventDataAcrossAllNodes(queue)));
+  }
+
+  MinVR::VRDataIndex report("report");
+  report.addData("client", clientNumber);
+  report.addData("checksums", checksums);
+  MinVR::VRDataQueue queue;
+  queue.push(report);
+  client.syncEventDataAcrossAllNodes(queue);
+
+  exit(0);
+}
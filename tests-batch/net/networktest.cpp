@@ -4,9 +4,15 @@
 #include "config/VRDataIndex.h"
 #include "config/VRDataQueue.h"
 
+#include <fstream>
+#include <sstream>
+
 int TestSwapBufferSignal();
 int TestExchangeEventData();
 int TestThree();
+int TestSwapBarrierSkew();
+int TestDistributedConfig();
+int TestDeltaEventData();
 
 int networktest(int argc, char* argv[]) {
 //int main(int argc, char* argv[]) {
@@ -37,6 +43,18 @@ int networktest(int argc, char* argv[]) {
     output = TestThree();
     break;
 
+  case 4:
+    output = TestSwapBarrierSkew();
+    break;
+
+  case 5:
+    output = TestDistributedConfig();
+    break;
+
+  case 6:
+    output = TestDeltaEventData();
+    break;
+
     // Add case statements to handle other values.
   default:
     std::cout << "Test #" << choice << " does not exist!\n";
@@ -136,7 +154,7 @@ int TestSwapBufferSignal() {
   for (int i = 0; i < numberOfClients; ++i) {
     int status;
 
-    while (-1 == waitpid(clientPIDs[i], &status, WNOHANG | WUNTRACED)) {
+    while (-1 == waitpid(clientPIDs[i], &status, WUNTRACED)) {
       std::cout << i << ":" << clientPIDs[i] << ":errno:" << errno << std::endl;
       // If errno == 10, the process has already ended.
       if (errno == 10) break;
@@ -212,6 +230,7 @@ int TestExchangeEventData() {
   std::cout << "All clients forked, open for business now." << std::endl;
 
 	MinVR::VRNetServer server = MinVR::VRNetServer("3490", numberOfClients);
+  server.setArrivalReportInterval(2);
 
   for (int i = 0; i < numberOfSends; i++) {
 
@@ -244,13 +263,20 @@ int TestExchangeEventData() {
     if (gsum != 55) out++;
   }
 
+  // Every frame's arrivals are counted, and the recent ones start over
+  // with each report.
+  const MinVR::VRNetServer::ArrivalStats &arrivals = server.getEventArrivalStats();
+  if (arrivals.numFrames != (unsigned long)numberOfSends) out++;
+  if (arrivals.numRecentFrames != (unsigned long)(numberOfSends % 2)) out++;
+  if (arrivals.offsets.size() != (size_t)numberOfClients) out++;
+
   std::cout << "done sending, now waiting for children to exit..." << std::endl;
 
   // Waits for all the child processes to finish running
   for (int i = 0; i < numberOfClients; ++i) {
     int status;
 
-    while (-1 == waitpid(clientPIDs[i], &status, WNOHANG | WUNTRACED)) {
+    while (-1 == waitpid(clientPIDs[i], &status, WUNTRACED)) {
       std::cout << i << ":" << clientPIDs[i] << ":errno:" << errno << std::endl;
       // If errno == 10, the process has already ended.
       if (errno == 10) break;
@@ -270,3 +296,356 @@ int TestExchangeEventData() {
 }
 
 int TestThree() { return 0; }
+
+#ifndef WIN32
+// Runs the swap buffers barrier for numberOfFrames frames with a set of
+// client processes on this machine, and works out from their reports
+// how far apart they were released in each frame.  Returns the number
+// of problems; the skew comes back in the last two arguments, in
+// microseconds.
+int RunSwapBarrier(const std::string &mode, int numberOfClients,
+                   int numberOfFrames, double &meanSkew, double &maxSkew) {
+
+  int out = 0;
+  std::vector<pid_t> clientPIDs(numberOfClients);
+
+  std::string launchBarrierClient = std::string(BINARYPATH) + "/bin/launchBarrierClient";
+
+  char clientNumberStr[16];
+  char numberOfFramesStr[16];
+  snprintf(numberOfFramesStr, sizeof(numberOfFramesStr), "%d", numberOfFrames);
+  for (int i = 0; i < numberOfClients; i++) {
+    clientPIDs[i] = fork();
+
+    if (clientPIDs[i] == 0) {
+      snprintf(clientNumberStr, sizeof(clientNumberStr), "%d", i);
+      int ret = execl(launchBarrierClient.c_str(),
+                      launchBarrierClient.c_str(),
+                      clientNumberStr, numberOfFramesStr, mode.c_str(),
+                      (char*)NULL);
+
+      // Shouldn't get here, unless the execl() fails.
+      if (ret < 0) {
+        std::cerr << "execl number " << i << " failed: " << errno << std::endl;
+        exit(1);
+      }
+    }
+  }
+
+  // release times in microseconds, by frame and client
+  std::vector<std::vector<long long> >
+    released(numberOfFrames, std::vector<long long>(numberOfClients, -1));
+
+  {
+    MinVR::VRNetServer server("3490", numberOfClients);
+    if (mode == "datagram") {
+      server.useDatagramSwapBarrier("239.255.42.99", "3491", "127.0.0.1");
+    }
+
+    for (int i = 0; i <= numberOfFrames; i++) {
+      MinVR::VRDataQueue queue =
+        server.syncEventDataAcrossAllNodes(MinVR::VRDataQueue());
+      for (MinVR::VRDataQueue::iterator it = queue.begin(); it != queue.end(); ++it) {
+        const MinVR::VRDataIndex &e = it->second.getData();
+        int frame = e.getValue("frame");
+        int client = e.getValue("client");
+        released[frame][client] = 1000000LL * (int)e.getValue("sec") +
+          (int)e.getValue("usec");
+      }
+
+      if (i < numberOfFrames) server.syncSwapBuffersAcrossAllNodes();
+    }
+  }
+
+  for (int i = 0; i < numberOfClients; ++i) {
+    int status;
+    waitpid(clientPIDs[i], &status, 0);
+    if (!checkClientExitStatus(status)) out++;
+  }
+
+  meanSkew = 0.0;
+  maxSkew = 0.0;
+  for (int f = 0; f < numberOfFrames; f++) {
+    long long first = released[f][0], last = released[f][0];
+    for (int c = 0; c < numberOfClients; c++) {
+      if (released[f][c] < 0) {
+        std::cout << "No release time for client " << c << " frame " << f << std::endl;
+        out++;
+      }
+      if (released[f][c] < first) first = released[f][c];
+      if (released[f][c] > last) last = released[f][c];
+    }
+    meanSkew += (double)(last - first) / numberOfFrames;
+    if ((double)(last - first) > maxSkew) maxSkew = (double)(last - first);
+  }
+
+  return out;
+}
+#endif
+
+int TestSwapBarrierSkew() {
+
+#ifdef WIN32
+  return 0;
+#else
+
+  // Compares the release skew with the TCP barrier and with the datagram
+  // barrier, all on the loopback interface.  The datagram should release
+  // the clients closer together, but timing on a busy test machine is
+  // too noisy to insist on it, so this only reports the numbers.
+  int numberOfClients = 8;
+  int numberOfFrames = 100;
+
+  double tcpMean, tcpMax, datagramMean, datagramMax;
+  int out = RunSwapBarrier("tcp", numberOfClients, numberOfFrames, tcpMean, tcpMax);
+  out += RunSwapBarrier("datagram", numberOfClients, numberOfFrames,
+                        datagramMean, datagramMax);
+
+  std::cout << "Release skew for " << numberOfClients << " clients over "
+            << numberOfFrames << " frames:" << std::endl;
+  std::cout << "  TCP barrier:      mean " << tcpMean << " us, max "
+            << tcpMax << " us" << std::endl;
+  std::cout << "  datagram barrier: mean " << datagramMean << " us, max "
+            << datagramMax << " us" << std::endl;
+
+  return out;
+#endif
+}
+
+#ifndef WIN32
+// Starts a set of client processes on this machine that get their
+// configuration either from the files or from the server, and works out
+// from their reports how long it was before they were all ready.
+// Returns the number of problems; the time comes back in the last
+// argument, in seconds.
+int RunConfigStartup(const std::string &mode, int numberOfClients,
+                     const std::string &configFile, double &startupTime) {
+
+  int out = 0;
+  std::vector<pid_t> clientPIDs(numberOfClients);
+
+  std::string launchConfigClient = std::string(BINARYPATH) + "/bin/launchConfigClient";
+
+  // The server reads the files either way, before it starts any clients.
+  MinVR::VRDataIndex config;
+  config.processXMLFile(configFile, "/");
+  std::string serialized = config.serialize();
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < serialized.size(); i++) {
+    hash = (hash ^ (unsigned char)serialized[i]) * 16777619u;
+  }
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  char clientNumberStr[16];
+  for (int i = 0; i < numberOfClients; i++) {
+    clientPIDs[i] = fork();
+
+    if (clientPIDs[i] == 0) {
+      snprintf(clientNumberStr, sizeof(clientNumberStr), "%d", i);
+      int ret = execl(launchConfigClient.c_str(),
+                      launchConfigClient.c_str(),
+                      clientNumberStr, mode.c_str(), configFile.c_str(),
+                      (char*)NULL);
+
+      // Shouldn't get here, unless the execl() fails.
+      if (ret < 0) {
+        std::cerr << "execl number " << i << " failed: " << errno << std::endl;
+        exit(1);
+      }
+    }
+  }
+
+  std::vector<long long> ready(numberOfClients, -1);
+  {
+    MinVR::VRNetServer server("3490", numberOfClients,
+                              MinVR::VRNetInterface::WIRE_FORMAT_BINARY, &config);
+
+    MinVR::VRDataQueue queue =
+      server.syncEventDataAcrossAllNodes(MinVR::VRDataQueue());
+    for (MinVR::VRDataQueue::iterator it = queue.begin(); it != queue.end(); ++it) {
+      const MinVR::VRDataIndex &e = it->second.getData();
+      int client = e.getValue("client");
+      ready[client] = 1000000LL * (int)e.getValue("sec") + (int)e.getValue("usec");
+
+      // Everybody has the same configuration.
+      if (((int)e.getValue("size") != (int)serialized.size()) ||
+          ((int)e.getValue("hash") != (int)(hash & 0x7fffffff))) {
+        std::cout << "Client " << client << " has a different configuration." << std::endl;
+        out++;
+      }
+    }
+  }
+
+  for (int i = 0; i < numberOfClients; ++i) {
+    int status;
+    waitpid(clientPIDs[i], &status, 0);
+    if (!checkClientExitStatus(status)) out++;
+  }
+
+  long long last = 0;
+  for (int c = 0; c < numberOfClients; c++) {
+    if (ready[c] < 0) {
+      std::cout << "No report from client " << c << std::endl;
+      out++;
+    }
+    if (ready[c] > last) last = ready[c];
+  }
+  startupTime = (double)(last - (1000000LL * start.tv_sec + start.tv_nsec / 1000)) / 1.0e6;
+
+  return out;
+}
+#endif
+
+int TestDistributedConfig() {
+
+#ifdef WIN32
+  return 0;
+#else
+
+  // Compares how long the clients take to start up when they each read
+  // the configuration file, and when the server sends it to them.  The
+  // file here is local, and the machine may be busy, so this only
+  // reports the numbers; on a cluster reading over NFS the difference is
+  // bigger.
+  int numberOfClients = 8;
+
+  std::string configFile = "networktest5.minvr";
+  {
+    std::ofstream file(configFile.c_str());
+    file << "<MinVR><Defaults><Window displaynodeType=\"VRGraphicsWindowNode\">"
+         << "<Width>1920</Width><Height>1080</Height><Border>0</Border>"
+         << "<Caption>MinVR</Caption></Window></Defaults><VRSetups>";
+    for (int setup = 0; setup < 400; setup++) {
+      file << "<Node" << setup << " hostType=\"VRClient\">"
+           << "<ServerIP>localhost</ServerIP><Port>3490</Port>"
+           << "<Wall type=\"floatarray\">-1.0,1.0,-1.0,1.0,0.5,0.25</Wall>"
+           << "<Left linkNode=\"/MinVR/Defaults/Window\"/>"
+           << "<Right linkNode=\"/MinVR/Defaults/Window\"/>"
+           << "</Node" << setup << ">";
+    }
+    file << "</VRSetups></MinVR>";
+  }
+
+  double filesTime, serverTime;
+  int out = RunConfigStartup("files", numberOfClients, configFile, filesTime);
+  out += RunConfigStartup("server", numberOfClients, configFile, serverTime);
+  std::remove(configFile.c_str());
+
+  std::cout << "Startup time for " << numberOfClients << " clients:" << std::endl;
+  std::cout << "  reading the configuration files: " << filesTime << " s" << std::endl;
+  std::cout << "  configuration from the server:   " << serverTime << " s" << std::endl;
+
+  return out;
+#endif
+}
+
+#ifndef WIN32
+// The same checksum as launchDeltaClient's.
+static int QueueChecksum(const MinVR::VRDataQueue &queue) {
+  std::stringstream ss;
+  for (MinVR::VRDataQueue::const_iterator it = queue.begin(); it != queue.end(); ++it) {
+    ss << it->first.first << ":" << it->second.getData().serialize() << ";";
+  }
+  std::string s = ss.str();
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < s.size(); i++) {
+    hash = (hash ^ (unsigned char)s[i]) * 16777619u;
+  }
+  return (int)(hash & 0x7fffffff);
+}
+#endif
+
+int TestDeltaEventData() {
+
+#ifdef WIN32
+  return 0;
+#else
+
+  // The clients ask for the delta format, and rebuild each frame's
+  // queue from their own events and the server's delta.  They send
+  // checksums of what they got at the end, which should match the queues
+  // the server merged.  The events of different nodes share time stamps,
+  // and some nodes have no events in some frames, so the merge order
+  // matters.
+  int out = 0;
+  int numberOfClients = 4;
+  int numberOfFrames = 12;
+
+  std::vector<pid_t> clientPIDs(numberOfClients);
+
+  std::string launchDeltaClient = std::string(BINARYPATH) + "/bin/launchDeltaClient";
+
+  char clientNumberStr[16];
+  char numberOfFramesStr[16];
+  snprintf(numberOfFramesStr, sizeof(numberOfFramesStr), "%d", numberOfFrames);
+  for (int i = 0; i < numberOfClients; i++) {
+    clientPIDs[i] = fork();
+
+    if (clientPIDs[i] == 0) {
+      snprintf(clientNumberStr, sizeof(clientNumberStr), "%d", i);
+      int ret = execl(launchDeltaClient.c_str(),
+                      launchDeltaClient.c_str(),
+                      clientNumberStr, numberOfFramesStr, (char*)NULL);
+
+      // Shouldn't get here, unless the execl() fails.
+      if (ret < 0) {
+        std::cerr << "execl number " << i << " failed: " << errno << std::endl;
+        exit(1);
+      }
+    }
+  }
+
+  std::vector<int> expected;
+  std::vector<bool> reported(numberOfClients, false);
+  {
+    MinVR::VRNetServer server("3490", numberOfClients,
+                              MinVR::VRNetInterface::WIRE_FORMAT_BINARY_DELTA);
+
+    for (int frame = 0; frame < numberOfFrames; frame++) {
+      MinVR::VRDataQueue queue;
+      if (frame % 2 == 0) {
+        MinVR::VRDataIndex e("Server_Down");
+        e.addData("frame", frame);
+        queue.push(100LL * frame, MinVR::VRDataQueueItem(e));
+      }
+      expected.push_back(QueueChecksum(server.syncEventDataAcrossAllNodes(queue)));
+    }
+
+    MinVR::VRDataQueue reports =
+      server.syncEventDataAcrossAllNodes(MinVR::VRDataQueue());
+    for (MinVR::VRDataQueue::iterator it = reports.begin(); it != reports.end(); ++it) {
+      const MinVR::VRDataIndex &e = it->second.getData();
+      int client = e.getValue("client");
+      MinVR::VRIntArray checksums = e.getValue("checksums");
+      reported[client] = true;
+      if (checksums.size() != expected.size()) {
+        std::cout << "Client " << client << " reported " << checksums.size()
+                  << " frames." << std::endl;
+        out++;
+        continue;
+      }
+      for (size_t f = 0; f < expected.size(); f++) {
+        if (checksums[f] != expected[f]) {
+          std::cout << "Client " << client << " has a different queue in frame "
+                    << f << "." << std::endl;
+          out++;
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < numberOfClients; ++i) {
+    int status;
+    waitpid(clientPIDs[i], &status, 0);
+    if (!checkClientExitStatus(status)) out++;
+    if (!reported[i]) {
+      std::cout << "No report from client " << i << std::endl;
+      out++;
+    }
+  }
+
+  return out;
+#endif
+}
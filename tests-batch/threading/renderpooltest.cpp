@@ -0,0 +1,181 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include "VRRenderPool.h"
+
+int testRenderPoolUnbalanced();
+int testRenderPoolNoStealing();
+
+int renderpooltest(int argc, char* argv[]) {
+
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  int output;
+
+  switch(choice) {
+  case 1:
+    output = testRenderPoolUnbalanced();
+    break;
+
+  case 2:
+    output = testRenderPoolNoStealing();
+    break;
+
+  default:
+    std::cout << "Test #" << choice << " does not exist!\n";
+    output = -1;
+  }
+
+  return output;
+}
+
+// A display node that counts what it is asked to do, and takes a while
+// to render if it is slow.  It also checks that the three actions of a
+// frame all run on the thread that rendered it, and that it hears about
+// /InitRender only the first time.
+class CountingNode : public MinVR::VRDisplayNode {
+public:
+  CountingNode(const std::string &name, int renderMicroseconds) :
+    MinVR::VRDisplayNode(name), renderMicroseconds(renderMicroseconds),
+    numRenders(0), numWaits(0), numDisplays(0), numWrong(0), numReleases(0) {}
+
+  std::string getType() const { return "CountingNode"; }
+
+  void render(MinVR::VRDataIndex *renderState, MinVR::VRRenderHandler */*renderHandler*/) {
+    if (int(renderState->getValue("/InitRender")) != ((numRenders == 0) ? 1 : 0)) numWrong++;
+    numRenders++;
+    thread = std::this_thread::get_id();
+    if (renderMicroseconds > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(renderMicroseconds));
+    }
+  }
+
+  void waitForRenderToComplete(MinVR::VRDataIndex */*renderState*/) {
+    numWaits++;
+    if (thread != std::this_thread::get_id()) numWrong++;
+  }
+
+  void displayFinishedRendering(MinVR::VRDataIndex *renderState) {
+    numDisplays++;
+    if (thread != std::this_thread::get_id()) numWrong++;
+    if (renderState->exists("/ReleaseContext")) numReleases++;
+  }
+
+  int renderMicroseconds;
+  int numRenders;
+  int numWaits;
+  int numDisplays;
+  int numWrong;
+  int numReleases;
+  std::thread::id thread;
+};
+
+// Runs the frames as VRThreadGroupNode does, and counts the nodes that
+// didn't do each thing exactly once a frame.
+static int runFrames(MinVR::VRRenderPool &pool, std::vector<CountingNode*> &nodes,
+                     int numFrames, bool released) {
+
+  int out = 0;
+
+  MinVR::VRDataIndex renderState;
+  for (int frame = 0; frame < numFrames; frame++) {
+    pool.run((frame == 0) ? MinVR::THREADACTION_Init : MinVR::THREADACTION_Render,
+             &renderState, NULL);
+    pool.run(MinVR::THREADACTION_WaitForRenderToComplete, &renderState, NULL);
+    pool.run(MinVR::THREADACTION_DisplayFinishedRendering, &renderState, NULL);
+  }
+
+  for (size_t f = 0; f < nodes.size(); f++) {
+    if ((nodes[f]->numRenders != numFrames) ||
+        (nodes[f]->numWaits != numFrames) ||
+        (nodes[f]->numDisplays != numFrames) ||
+        (nodes[f]->numReleases != (released ? numFrames : 0)) ||
+        (nodes[f]->numWrong != 0)) {
+      std::cout << "Node " << f << " rendered " << nodes[f]->numRenders
+                << ", waited " << nodes[f]->numWaits
+                << ", displayed " << nodes[f]->numDisplays
+                << " and released " << nodes[f]->numReleases
+                << " times in " << numFrames << " frames, with "
+                << nodes[f]->numWrong << " out of place." << std::endl;
+      out++;
+    }
+  }
+
+  return out;
+}
+
+// All the slow nodes start out with the first worker, so the others run
+// out of work and take some of them.  Each node still renders exactly
+// once a frame, however the nodes move.
+int testRenderPoolUnbalanced() {
+
+  int out = 0;
+
+  const int numThreads = 3;
+  std::vector<CountingNode*> nodes;
+  std::vector<MinVR::VRDisplayNode*> displayNodes;
+  for (int f = 0; f < 12; f++) {
+    nodes.push_back(new CountingNode("Node", (f % numThreads == 0) ? 2000 : 0));
+    displayNodes.push_back(nodes[f]);
+  }
+
+  {
+    MinVR::VRRenderPool pool(displayNodes, numThreads, true, std::vector<int>(), 200.0e-6);
+    if (pool.getNumThreads() != numThreads) out++;
+
+    out += runFrames(pool, nodes, 20, true);
+
+    if (pool.getNumSteals() == 0) {
+      std::cout << "No nodes were taken from the busy worker." << std::endl;
+      out++;
+    }
+  }
+
+  for (size_t f = 0; f < nodes.size(); f++) delete nodes[f];
+  return out;
+}
+
+// Without stealing, the nodes stay where they were dealt, however
+// unbalanced that is, and don't let go of their contexts.
+int testRenderPoolNoStealing() {
+
+  int out = 0;
+
+  const int numThreads = 3;
+  std::vector<CountingNode*> nodes;
+  std::vector<MinVR::VRDisplayNode*> displayNodes;
+  for (int f = 0; f < 7; f++) {
+    nodes.push_back(new CountingNode("Node", (f % numThreads == 0) ? 1000 : 0));
+    displayNodes.push_back(nodes[f]);
+  }
+
+  {
+    MinVR::VRRenderPool pool(displayNodes, numThreads, false, std::vector<int>(), 0.0);
+
+    out += runFrames(pool, nodes, 20, false);
+
+    if (pool.getNumSteals() != 0) out++;
+    for (int f = 0; f < 7; f++) {
+      if (pool.getOwner(f) != f % numThreads) out++;
+    }
+
+    // Nodes dealt to the same worker render on the same thread.
+    if ((nodes[0]->thread != nodes[3]->thread) || (nodes[0]->thread != nodes[6]->thread) ||
+        (nodes[1]->thread != nodes[4]->thread) || (nodes[0]->thread == nodes[1]->thread) ||
+        (nodes[0]->thread == std::this_thread::get_id())) out++;
+  }
+
+  for (size_t f = 0; f < nodes.size(); f++) delete nodes[f];
+  return out;
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <config/VRDataIndex.h>
+#include <config/VRConfigCache.h>
+
+// This program compiles MinVR configuration files into a cache that
+// VRMain can load without parsing any XML, which saves a lot of time
+// when every node of a cluster starts up at once.  To compile
+// desktop.minvr into desktop.minvr.cache, which VRMain will then use in
+// its place for as long as desktop.minvr doesn't change:
+//
+//  $ MVRCompile desktop.minvr
+//
+// Files that are always loaded together (because one links to another,
+// say) can go into one cache, which is named on the command line in
+// place of the files, and has to be named with -o:
+//
+//  $ MVRCompile -o cave.cache cave.minvr cave-tracking.minvr
+//  $ myprogram -c cave.cache
+//
+// And to find out if a cache is still good:
+//
+//  $ MVRCompile --check cave.cache
+//
+inline void printHelpMessage() {
+  std::cerr << "" << std::endl;
+  std::cerr << "usage: MVRCompile [ -o file.cache ] file.minvr [ file.minvr ... ]" << std::endl;
+  std::cerr << "       MVRCompile --check file.cache" << std::endl;
+  std::cerr << "  file.minvr - configuration files, read in order" << std::endl;
+  std::cerr << "  -o         - where to put the cache (default: the file, plus .cache;" << std::endl;
+  std::cerr << "               needed when there is more than one file)" << std::endl;
+  std::cerr << "  --check    - report whether the cache is up to date" << std::endl;
+  std::cerr << "" << std::endl;
+  std::cerr << "Parses the configuration files and writes the resulting data index" << std::endl;
+  std::cerr << "to a cache that VRMain can load directly, for as long as the" << std::endl;
+  std::cerr << "configuration files are unchanged." << std::endl;
+}
+
+int doTheRealWork(int argc, char **argv) {
+
+  std::vector<std::string> configFiles;
+  std::string cacheFile;
+
+  if (argc == 1) {
+    printHelpMessage();
+    return EXIT_SUCCESS;
+  }
+
+  if ((argc == 3) && (strcmp(argv[1], "--check") == 0)) {
+    MinVR::VRDataIndex index;
+    std::string whyNot;
+    if (MinVR::VRConfigCache::load(argv[2], &index, &whyNot)) {
+      std::cout << argv[2] << " is up to date." << std::endl;
+      return EXIT_SUCCESS;
+    }
+    std::cout << whyNot << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0) {
+      if (++i == argc) throw std::runtime_error("Need a file name after -o.");
+      cacheFile = argv[i];
+    } else if (argv[i][0] == '-') {
+      printHelpMessage();
+      return EXIT_SUCCESS;
+    } else {
+      configFiles.push_back(argv[i]);
+    }
+  }
+
+  if (configFiles.empty())
+    throw std::runtime_error("Need a configuration file.  (Try --usage.)");
+  // The default name is the one VRMain looks for next to the first file,
+  // and a cache of several files can't stand in for just that one.
+  if (cacheFile.empty()) {
+    if (configFiles.size() > 1)
+      throw std::runtime_error("Need -o to name the cache of several files.");
+    cacheFile = MinVR::VRConfigCache::getCacheFileName(configFiles[0]);
+  }
+
+  MinVR::VRConfigCache::compile(configFiles, cacheFile);
+  std::cout << "Wrote " << cacheFile << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char **argv) {
+
+  try {
+
+    return doTheRealWork(argc, argv);
+
+  } catch (const std::exception& e) {
+
+    std::cerr << "Oopsy-daisy: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
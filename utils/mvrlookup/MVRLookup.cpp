@@ -99,7 +99,9 @@ int doTheRealWork(int argc, char **argv) {
     break;
   }
     
-  case MinVR::VRCORETYPE_FLOATARRAY: {
+  case MinVR::VRCORETYPE_FLOATARRAY:
+  case MinVR::VRCORETYPE_MATRIX4:
+  case MinVR::VRCORETYPE_VEC3: {
     MinVR::VRFloatArray ia = index->getValue(argv[2]);
     if (nth >= (int)ia.size())
       throw std::runtime_error("N too large for array");